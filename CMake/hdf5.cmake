@@ -2,7 +2,8 @@ if (ENABLE_HDF5)
   find_package(HDF5 REQUIRED COMPONENTS C)
 
   if(NOT HDF5_IS_PARALLEL)
-    message(SEND_ERROR "Failed to locate parallel hdf5 installation")
+    message(WARNING "Serial HDF5 was found, files can only be written by "
+      "one MPI rank. Use a parallel HDF5 installation to write from more.")
   endif()
 
   add_library(sHDF5 INTERFACE)
@@ -23,6 +23,7 @@ int main(int argc, char **argv)
   std::string transportXml;
   std::string analysisXml;
   std::string connectionInfo;
+  int prefetchDepth = -1;
 
   opts::Options ops(argc, argv);
 
@@ -33,7 +34,11 @@ int main(int argc, char **argv)
       "SENSEI analysis XML configuration file")
 
     >> opts::Option('c', "connection-info", connectionInfo,
-       "transport specific connection information");
+       "transport specific connection information")
+
+    >> opts::Option('p', "prefetch-depth", prefetchDepth,
+       "number of steps to read ahead while the current step is analyzed,"
+       " overrides the transport XML");
 
   if (ops >> opts::Present('h', "help", "show help"))
     {
@@ -62,6 +67,10 @@ int main(int argc, char **argv)
     MPI_Abort(MPI_COMM_WORLD, -1);
     }
 
+  // read ahead, overlapping I/O for the next steps with the analysis
+  if (prefetchDepth >= 0)
+    dataAdaptor->SetPrefetchDepth(prefetchDepth);
+
   // connect and open the stream
   if (dataAdaptor->OpenStream())
     {
@@ -36,15 +36,21 @@ void Block::update_particles(float t, const OscillatorArray &oscillators)
 {
     // update the velocity field on the particle mesh
     const Oscillator *pOsc = oscillators.Data();
-    for (auto& particle : particles)
+    size_t n = particles.size();
+    for (size_t i = 0; i < n; ++i)
     {
-        particle.velocity = { 0, 0, 0 };
+        Oscillator::Vertex position = { particles.x[i], particles.y[i], particles.z[i] };
+        Oscillator::Vertex velocity = { 0, 0, 0 };
         for (unsigned long q = 0; q < oscillators.Size(); ++q)
         {
-            particle.velocity += pOsc[q].evaluateGradient(particle.position, t);
+            velocity += pOsc[q].evaluateGradient(position, t);
         }
         // scale the gradient to get "units" right for velocity
-        particle.velocity *= velocity_scale;
+        velocity *= velocity_scale;
+
+        particles.vx[i] = velocity[0];
+        particles.vy[i] = velocity[1];
+        particles.vz[i] = velocity[2];
     }
 }
 
@@ -53,72 +59,108 @@ void Block::move_particles(float dt, const sdiy::Master::ProxyWithLink& cp)
 {
     auto link = static_cast<sdiy::RegularGridLink*>(cp.link());
 
-    auto particle = particles.begin();
-    while (particle != particles.end())
+    size_t n = particles.size();
+
+    float *pos[3] = { particles.x.data(), particles.y.data(), particles.z.data() };
+    const float *vel[3] = { particles.vx.data(), particles.vy.data(), particles.vz.data() };
+
+    // the domain bounds, used to warp positions
+    sdiy::Bounds<float> wsdom = world_space_bounds(domain, origin, spacing);
+
+    for (int q = 0; q < 3; ++q)
     {
+        float *x = pos[q];
+        const float *v = vel[q];
+
         // update particle position
-        particle->position += particle->velocity * dt;
+        for (size_t i = 0; i < n; ++i)
+            x[i] += v[i] * dt;
 
         // warp position if needed
         // applies periodic bci
-        sdiy::Bounds<float> wsdom = world_space_bounds(domain, origin, spacing);
-        for (int i = 0; i < 3; ++i)
+        float dm = wsdom.min[q];
+        float dM = wsdom.max[q];
+        float dx = dM - dm;
+        bool planar = fabs(dx) < 1.0e-6f;
+        for (size_t i = 0; i < n; ++i)
         {
-            if ((particle->position[i] > wsdom.max[i]) ||
-              (particle->position[i] < wsdom.min[i]))
+            if ((x[i] > dM) || (x[i] < dm))
             {
-                float dm = wsdom.min[i];
-                float dx = wsdom.max[i] - dm;
-                if (fabs(dx) < 1.0e-6f)
+                if (planar)
                 {
-                  particle->position[i] = dm;
+                    x[i] = dm;
                 }
                 else
                 {
-                  float dp = particle->position[i] - dm;
-                  float dpdx = dp / dx;
-                  particle->position[i] = (dpdx - floor(dpdx))*dx + dm;
+                    float dp = x[i] - dm;
+                    float dpdx = dp / dx;
+                    x[i] = (dpdx - floor(dpdx))*dx + dm;
                 }
             }
         }
+    }
 
-        // check if the particle has left this block
-        // block bounds have ghost zones
-        if (!contains(domain, bounds, origin, spacing, nghost, particle->position))
-        {
-            bool enqueued = false;
+    // check which particles have left this block
+    // block bounds have ghost zones
+    sdiy::Bounds<float> wsblk = world_space_bounds(domain, bounds, origin, spacing, nghost);
 
-            // search neighbor blocks for one that now conatins this particle
-            for (int i = 0; i < link->size(); ++i)
-            {
-                // link bounds do not have ghost zones
-                if (contains(link->bounds(i), origin, spacing, particle->position))
-                {
-                    /*std::cerr << "moving " << *particle << " from " << gid
-                      << " to " << link->target(i).gid << std::endl;*/
+    std::vector<unsigned char> leaving(n);
+    size_t nLeaving = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        leaving[i] = !contains(wsblk, particles.x[i], particles.y[i], particles.z[i]);
+        nLeaving += leaving[i];
+    }
 
-                    cp.enqueue(link->target(i), *particle);
+    if (!nLeaving)
+        return;
 
-                    enqueued = true;
-                    break;
-                }
-            }
+    // link bounds do not have ghost zones
+    int nLinks = link->size();
+    std::vector<sdiy::Bounds<float>> wslink;
+    wslink.reserve(nLinks);
+    for (int j = 0; j < nLinks; ++j)
+        wslink.push_back(world_space_bounds(link->bounds(j), origin, spacing));
 
-            if (!enqueued)
-            {
-                std::cerr << "Error: could not find appropriate neighbor for particle: "
-                   << *particle << std::endl;
+    // search neighbor blocks for one that now conatins each particle, and
+    // send the particles to each neighbor in one message
+    std::vector<std::vector<Particle>> outgoing(nLinks);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!leaving[i])
+            continue;
 
-                abort();
+        int dest = -1;
+        for (int j = 0; j < nLinks; ++j)
+        {
+            if (contains(wslink[j], particles.x[i], particles.y[i], particles.z[i]))
+            {
+                dest = j;
+                break;
             }
-
-            particle = particles.erase(particle);
         }
-        else
+
+        if (dest < 0)
         {
-            ++particle;
+            std::cerr << "Error: could not find appropriate neighbor for particle: "
+               << particles.get(i) << std::endl;
+
+            abort();
         }
+
+        /*std::cerr << "moving " << particles.get(i) << " from " << gid
+          << " to " << link->target(dest).gid << std::endl;*/
+
+        outgoing[dest].push_back(particles.get(i));
+    }
+
+    for (int j = 0; j < nLinks; ++j)
+    {
+        if (!outgoing[j].empty())
+            cp.enqueue(link->target(j), outgoing[j]);
     }
+
+    particles.erase(leaving);
 }
 
 // --------------------------------------------------------------------------
@@ -130,9 +172,9 @@ void Block::handle_incoming_particles(const sdiy::Master::ProxyWithLink& cp)
         auto nbr = link->target(i).gid;
         while(cp.incoming(nbr))
         {
-            Particle particle;
-            cp.dequeue(nbr, particle);
-            particles.push_back(particle);
+            std::vector<Particle> incoming;
+            cp.dequeue(nbr, incoming);
+            particles.append(incoming);
         }
     }
 }
@@ -141,10 +183,9 @@ std::ostream &operator<<(std::ostream &os, const Block &b)
 {
     os << b.gid << ": " << b.bounds.min << " - " << b.bounds.max << std::endl;
 
-    auto it = b.particles.begin();
-    auto end = b.particles.end();
-    for (; it != end; ++it)
-        os << "    " << *it << std::endl;
+    size_t n = b.particles.size();
+    for (size_t i = 0; i < n; ++i)
+        os << "    " << b.particles.get(i) << std::endl;
 
     return os;
 }
@@ -50,7 +50,7 @@ struct Block
     sdiy::Point<float,3>              spacing; // mesh spacing
     int                               nghost; // number of ghost zones
     oscillator::Grid<float,3>         grid;   // container for the gridded data arrays
-    std::vector<Particle>             particles;
+    ParticleArray                     particles;
 
  private:
     // for create; to let Master manage the blocks
@@ -16,7 +16,7 @@
 #include <svtkUnsignedCharArray.h>
 #include <svtkUnstructuredGrid.h>
 #include <svtkPolyData.h>
-#include <svtkNew.h>
+#include <svtkSOADataArrayTemplate.h>
 
 #include <sdiy/master.hpp>
 
@@ -61,120 +61,121 @@ void getBlockExtent(const sdiy::DiscreteBounds &db, int *ext)
 
 static
 svtkImageData *newCartesianBlock(double *origin,
-  double *spacing, const sdiy::DiscreteBounds &cellExts,
-  bool structureOnly)
+  double *spacing, const sdiy::DiscreteBounds &cellExts)
 {
   svtkImageData *id = svtkImageData::New();
 
-  if (!structureOnly)
-    {
-    id->SetOrigin(origin);
-    id->SetSpacing(spacing);
-    id->SetExtent(cellExts.min[0], cellExts.max[0]+1,
-      cellExts.min[1], cellExts.max[1]+1, cellExts.min[2],
-      cellExts.max[2]+1);
-    }
+  id->SetOrigin(origin);
+  id->SetSpacing(spacing);
+  id->SetExtent(cellExts.min[0], cellExts.max[0]+1,
+    cellExts.min[1], cellExts.max[1]+1, cellExts.min[2],
+    cellExts.max[2]+1);
 
   return id;
 }
 
 static
 svtkUnstructuredGrid *newUnstructuredBlock(const double *origin,
-  const double *spacing, const sdiy::DiscreteBounds &cellExts,
-  bool structureOnly)
+  const double *spacing, const sdiy::DiscreteBounds &cellExts)
 {
   svtkUnstructuredGrid *ug = svtkUnstructuredGrid::New();
 
-  if (!structureOnly)
-    {
-    // Add points.
-    int nx = cellExts.max[0] - cellExts.min[0] + 1 + 1;
-    int ny = cellExts.max[1] - cellExts.min[1] + 1 + 1;
-    int nz = cellExts.max[2] - cellExts.min[2] + 1 + 1;
+  // Add points.
+  int nx = cellExts.max[0] - cellExts.min[0] + 1 + 1;
+  int ny = cellExts.max[1] - cellExts.min[1] + 1 + 1;
+  int nz = cellExts.max[2] - cellExts.min[2] + 1 + 1;
 
-    svtkPoints *pts = svtkPoints::New();
-    pts->SetDataTypeToDouble();
-    pts->SetNumberOfPoints(nx*ny*nz);
+  svtkPoints *pts = svtkPoints::New();
+  pts->SetDataTypeToDouble();
+  pts->SetNumberOfPoints(nx*ny*nz);
 
-    svtkIdType idx = 0;
+  svtkIdType idx = 0;
 
-    for(int k = cellExts.min[2]; k <= cellExts.max[2]+1; ++k)
+  for(int k = cellExts.min[2]; k <= cellExts.max[2]+1; ++k)
+    {
+    double z = origin[2] + spacing[2]*k;
+    for(int j = cellExts.min[1]; j <= cellExts.max[1]+1; ++j)
       {
-      double z = origin[2] + spacing[2]*k;
-      for(int j = cellExts.min[1]; j <= cellExts.max[1]+1; ++j)
+      double y = origin[1] + spacing[1]*j;
+      for(int i = cellExts.min[0]; i <= cellExts.max[0]+1; ++i)
         {
-        double y = origin[1] + spacing[1]*j;
-        for(int i = cellExts.min[0]; i <= cellExts.max[0]+1; ++i)
-          {
-          double x = origin[0] + spacing[0]*i;
-          pts->SetPoint(idx++, x,y,z);
-          }
+        double x = origin[0] + spacing[0]*i;
+        pts->SetPoint(idx++, x,y,z);
         }
       }
+    }
 
-    ug->SetPoints(pts);
-    pts->Delete();
+  ug->SetPoints(pts);
+  pts->Delete();
 
-    // Add cells
-    int ncx = nx - 1;
-    int ncy = ny - 1;
-    int ncz = nz - 1;
-    svtkIdType ncells = ncx*ncy*ncz;
+  // Add cells
+  int ncx = nx - 1;
+  int ncy = ny - 1;
+  int ncz = nz - 1;
+  svtkIdType ncells = ncx*ncy*ncz;
 
-    svtkIdTypeArray *nlist = svtkIdTypeArray::New();
-    nlist->SetNumberOfValues(ncells * 8);
+  svtkIdTypeArray *nlist = svtkIdTypeArray::New();
+  nlist->SetNumberOfValues(ncells * 8);
 
-    svtkUnsignedCharArray *cellTypes = svtkUnsignedCharArray::New();
-    cellTypes->SetNumberOfValues(ncells);
+  svtkUnsignedCharArray *cellTypes = svtkUnsignedCharArray::New();
+  cellTypes->SetNumberOfValues(ncells);
 
-    svtkIdTypeArray *cellLocations = svtkIdTypeArray::New();
-    cellLocations->SetNumberOfValues(ncells + 1);
+  svtkIdTypeArray *cellLocations = svtkIdTypeArray::New();
+  cellLocations->SetNumberOfValues(ncells + 1);
 
-    svtkIdType *nl = nlist->GetPointer(0);
-    unsigned char *ct = cellTypes->GetPointer(0);
-    svtkIdType *cl = cellLocations->GetPointer(0);
-    int nxny = nx*ny;
-    int offset = 0;
-    for(int k = 0; k < ncz; ++k)
-    for(int j = 0; j < ncy; ++j)
-    for(int i = 0; i < ncx; ++i)
-      {
-      *ct++ = SVTK_HEXAHEDRON;
+  svtkIdType *nl = nlist->GetPointer(0);
+  unsigned char *ct = cellTypes->GetPointer(0);
+  svtkIdType *cl = cellLocations->GetPointer(0);
+  int nxny = nx*ny;
+  int offset = 0;
+  for(int k = 0; k < ncz; ++k)
+  for(int j = 0; j < ncy; ++j)
+  for(int i = 0; i < ncx; ++i)
+    {
+    *ct++ = SVTK_HEXAHEDRON;
 
-      *cl++ = offset;
-      offset += 8;
+    *cl++ = offset;
+    offset += 8;
 
-      nl[0] = (k) * nxny + j*nx + i;
-      nl[1] = (k+1) * nxny + j*nx + i;
-      nl[2] = (k+1) * nxny + j*nx + i + 1;
-      nl[3] = (k) * nxny + j*nx + i + 1;
-      nl[4] = (k) * nxny + (j+1)*nx + i;
-      nl[5] = (k+1) * nxny + (j+1)*nx + i;
-      nl[6] = (k+1) * nxny + (j+1)*nx + i + 1;
-      nl[7] = (k) * nxny + (j+1)*nx + i + 1;
+    nl[0] = (k) * nxny + j*nx + i;
+    nl[1] = (k+1) * nxny + j*nx + i;
+    nl[2] = (k+1) * nxny + j*nx + i + 1;
+    nl[3] = (k) * nxny + j*nx + i + 1;
+    nl[4] = (k) * nxny + (j+1)*nx + i;
+    nl[5] = (k+1) * nxny + (j+1)*nx + i;
+    nl[6] = (k+1) * nxny + (j+1)*nx + i + 1;
+    nl[7] = (k) * nxny + (j+1)*nx + i + 1;
 
-      nl += 8;
-      }
+    nl += 8;
+    }
 
-    // new svtk layout, always 1 extra value
-    *cl = offset;
+  // new svtk layout, always 1 extra value
+  *cl = offset;
 
-    svtkCellArray *cells = svtkCellArray::New();
-    cells->SetData(cellLocations, nlist);
+  svtkCellArray *cells = svtkCellArray::New();
+  cells->SetData(cellLocations, nlist);
 
-    ug->SetCells(cellTypes, cells);
+  ug->SetCells(cellTypes, cells);
 
-    nlist->Delete();
-    cellTypes->Delete();
-    cellLocations->Delete();
-    cells->Delete();
-  }
+  nlist->Delete();
+  cellTypes->Delete();
+  cellLocations->Delete();
+  cells->Delete();
 
   return ug;
 }
 
+// wrap a component of the particles, zero copy
+template <typename T>
 static
-svtkPolyData *newParticleBlock(const std::vector<Particle> *particles,
+void setParticleComponent(svtkSOADataArrayTemplate<T> *da, int comp,
+  std::vector<T> &vals)
+{
+  da->SetArray(comp, vals.data(), vals.size(), true, true);
+}
+
+static
+svtkPolyData *newParticleBlock(ParticleArray *particles,
   bool structureOnly)
 {
   svtkPolyData *block = svtkPolyData::New();
@@ -182,45 +183,96 @@ svtkPolyData *newParticleBlock(const std::vector<Particle> *particles,
   if (structureOnly)
     return block;
 
-  svtkNew<svtkPoints> points;
-  svtkNew<svtkCellArray> cells;
-  points->Allocate(particles->size());
-  cells->Allocate(particles->size());
+  svtkIdType np = particles->size();
+
+  // the positions are passed zero copy
+  svtkSOADataArrayTemplate<float> *xyz = svtkSOADataArrayTemplate<float>::New();
+  xyz->SetNumberOfComponents(3);
 
-  svtkIdType pointId = 0;
-  for (const auto &p : *particles)
+  if (np)
     {
-    points->InsertNextPoint(p.position[0], p.position[1], p.position[2]);
-    cells->InsertNextCell(1, &pointId);
-    ++pointId;
+    setParticleComponent(xyz, 0, particles->x);
+    setParticleComponent(xyz, 1, particles->y);
+    setParticleComponent(xyz, 2, particles->z);
     }
-  block->SetPoints(points.Get());
-  block->SetVerts(cells.Get());
+
+  svtkPoints *points = svtkPoints::New();
+  points->SetData(xyz);
+  xyz->Delete();
+
+  // a vertex per particle
+  svtkIdTypeArray *offsets = svtkIdTypeArray::New();
+  offsets->SetNumberOfTuples(np + 1);
+  svtkIdType *po = offsets->GetPointer(0);
+
+  svtkIdTypeArray *conn = svtkIdTypeArray::New();
+  conn->SetNumberOfTuples(np);
+  svtkIdType *pc = conn->GetPointer(0);
+
+  for (svtkIdType i = 0; i < np; ++i)
+    {
+    po[i] = i;
+    pc[i] = i;
+    }
+  po[np] = np;
+
+  svtkCellArray *cells = svtkCellArray::New();
+  cells->SetData(offsets, conn);
+
+  block->SetPoints(points);
+  block->SetVerts(cells);
+
+  points->Delete();
+  offsets->Delete();
+  conn->Delete();
+  cells->Delete();
 
   return block;
 }
 
 static
-int newParticleArray(const std::vector<Particle> &particles,
-  const std::string &arrayName, svtkFloatArray *&fa)
+int newParticleArray(ParticleArray &particles,
+  const std::string &arrayName, svtkDataArray *&da)
 {
-  enum {PID, VEL, VELMAG};
+  da = nullptr;
 
-  fa = svtkFloatArray::New();
+  svtkIdType np = particles.size();
 
-  int aid = PID;
-  if (arrayName == "pid")
+  if (arrayName == "id")
     {
-    aid = PID;
+    // zero copy
+    svtkIntArray *ia = svtkIntArray::New();
+    if (np)
+      ia->SetArray(particles.id.data(), np, 1);
+    da = ia;
     }
   else if (arrayName == "velocity")
     {
-    aid = VEL;
-    fa->SetNumberOfComponents(3);
+    // zero copy
+    svtkSOADataArrayTemplate<float> *va = svtkSOADataArrayTemplate<float>::New();
+    va->SetNumberOfComponents(3);
+    if (np)
+      {
+      setParticleComponent(va, 0, particles.vx);
+      setParticleComponent(va, 1, particles.vy);
+      setParticleComponent(va, 2, particles.vz);
+      }
+    da = va;
     }
   else if (arrayName == "velocityMagnitude")
     {
-    aid = VELMAG;
+    svtkFloatArray *fa = svtkFloatArray::New();
+    fa->SetNumberOfTuples(np);
+
+    float *pfa = fa->GetPointer(0);
+    const float *vx = particles.vx.data();
+    const float *vy = particles.vy.data();
+    const float *vz = particles.vz.data();
+
+    for (svtkIdType i = 0; i < np; ++i)
+      pfa[i] = sqrt(vx[i]*vx[i] + vy[i]*vy[i] + vz[i]*vz[i]);
+
+    da = fa;
     }
   else
     {
@@ -228,35 +280,7 @@ int newParticleArray(const std::vector<Particle> &particles,
     return -1;
     }
 
-  unsigned int np = particles.size();
-
-  fa->SetName(arrayName.c_str());
-  fa->SetNumberOfTuples(np);
-
-  float *pfa = fa->GetPointer(0);
-
-  for (unsigned int i = 0; i < np; ++i)
-    {
-    switch (aid)
-      {
-      case PID:
-        pfa[i] = particles[i].id;
-        break;
-      case VEL:
-        pfa[3*i] = particles[i].velocity[0];
-        pfa[3*i+1] = particles[i].velocity[1];
-        pfa[3*i+2] = particles[i].velocity[2];
-        break;
-      case VELMAG:
-        {
-        float vx = particles[i].velocity[0];
-        float vy = particles[i].velocity[1];
-        float vz = particles[i].velocity[2];
-        pfa[i] = sqrt(vx*vx + vy*vy + vz*vz);
-        }
-        break;
-      }
-    }
+  da->SetName(arrayName.c_str());
 
   return 0;
 }
@@ -353,7 +377,7 @@ struct DataAdaptor::InternalsType
   sdiy::DiscreteBounds DomainExtent;                 // global index space
   BlockExtentMap BlockExtents;                       // local block extents, indexed by global block id
   BlockDataMap BlockData;                            // local data array, indexed by block id
-  std::map<long, const std::vector<Particle>*> ParticleData;
+  std::map<long, ParticleArray*> ParticleData;       // local particles, indexed by block id
   OscillatorArray Oscillators;                       // global list of oscillators
 
   double Origin[3];                                  // lower left corner of simulation domain
@@ -361,8 +385,62 @@ struct DataAdaptor::InternalsType
 
   int Shape[3];
   int NumGhostCells;                                 // number of ghost cells
+
+  // the geometry and ghost cells of a local block depend only on the
+  // decomposition. they are built on first use and shared by the meshes
+  // served each step until the decomposition changes
+  struct BlockCache
+  {
+    svtkSmartPointer<svtkImageData> CartesianBlock;
+    svtkSmartPointer<svtkUnstructuredGrid> UnstructuredBlock;
+    svtkSmartPointer<svtkUnsignedCharArray> GhostCells;
+  };
+
+  using BlockCacheMap = std::map<long, BlockCache>;
+
+  BlockCacheMap BlockCaches;                         // local block geometry, indexed by block id
+
+  svtkImageData *GetCartesianBlock(long gid);
+  svtkUnstructuredGrid *GetUnstructuredBlock(long gid);
+  svtkUnsignedCharArray *GetGhostCells(long gid);
 };
 
+//-----------------------------------------------------------------------------
+svtkImageData *DataAdaptor::InternalsType::GetCartesianBlock(long gid)
+{
+  BlockCache &cache = this->BlockCaches[gid];
+  if (!cache.CartesianBlock)
+    {
+    cache.CartesianBlock.TakeReference(newCartesianBlock(this->Origin,
+      this->Spacing, this->BlockExtents[gid]));
+    }
+  return cache.CartesianBlock;
+}
+
+//-----------------------------------------------------------------------------
+svtkUnstructuredGrid *DataAdaptor::InternalsType::GetUnstructuredBlock(long gid)
+{
+  BlockCache &cache = this->BlockCaches[gid];
+  if (!cache.UnstructuredBlock)
+    {
+    cache.UnstructuredBlock.TakeReference(newUnstructuredBlock(this->Origin,
+      this->Spacing, this->BlockExtents[gid]));
+    }
+  return cache.UnstructuredBlock;
+}
+
+//-----------------------------------------------------------------------------
+svtkUnsignedCharArray *DataAdaptor::InternalsType::GetGhostCells(long gid)
+{
+  BlockCache &cache = this->BlockCaches[gid];
+  if (!cache.GhostCells)
+    {
+    cache.GhostCells.TakeReference(newGhostCellsArray(this->Shape,
+      this->BlockExtents[gid], this->NumGhostCells));
+    }
+  return cache.GhostCells;
+}
+
 //-----------------------------------------------------------------------------
 senseiNewMacro(DataAdaptor);
 
@@ -386,6 +464,9 @@ void DataAdaptor::Initialize(size_t nblocks, size_t n_local_blocks,
 {
   this->Internals->NumBlocks = nblocks;
 
+  // the geometry and ghost cells depend on all of the following
+  this->Internals->BlockCaches.clear();
+
   for (int i = 0; i < 3; ++i)
     this->Internals->Origin[i] = origin[i];
 
@@ -412,19 +493,30 @@ void DataAdaptor::Initialize(size_t nblocks, size_t n_local_blocks,
 void DataAdaptor::SetBlockExtent(int gid, int xmin, int xmax, int ymin,
    int ymax, int zmin, int zmax)
 {
-  this->Internals->BlockExtents[gid].min[0] = xmin;
-  this->Internals->BlockExtents[gid].min[1] = ymin;
-  this->Internals->BlockExtents[gid].min[2] = zmin;
+  sdiy::DiscreteBounds &ext = this->Internals->BlockExtents[gid];
 
-  this->Internals->BlockExtents[gid].max[0] = xmax;
-  this->Internals->BlockExtents[gid].max[1] = ymax;
-  this->Internals->BlockExtents[gid].max[2] = zmax;
+  if ((ext.min[0] != xmin) || (ext.min[1] != ymin) || (ext.min[2] != zmin) ||
+    (ext.max[0] != xmax) || (ext.max[1] != ymax) || (ext.max[2] != zmax))
+    {
+    // the block moved, rebuild its geometry and ghost cells on next use
+    this->Internals->BlockCaches.erase(gid);
+
+    ext.min[0] = xmin;
+    ext.min[1] = ymin;
+    ext.min[2] = zmin;
+
+    ext.max[0] = xmax;
+    ext.max[1] = ymax;
+    ext.max[2] = zmax;
+    }
 }
 
 //-----------------------------------------------------------------------------
 void DataAdaptor::SetDomainExtent(int xmin, int xmax, int ymin,
    int ymax, int zmin, int zmax)
 {
+  this->Internals->BlockCaches.clear();
+
   this->Internals->DomainExtent.min[0] = xmin;
   this->Internals->DomainExtent.min[1] = ymin;
   this->Internals->DomainExtent.min[2] = zmin;
@@ -441,7 +533,7 @@ void DataAdaptor::SetBlockData(int gid, float* data)
 }
 
 //-----------------------------------------------------------------------------
-void DataAdaptor::SetParticleData(int gid, const std::vector<Particle> &particles)
+void DataAdaptor::SetParticleData(int gid, ParticleArray &particles)
 {
   this->Internals->ParticleData[gid] = &particles;
 }
@@ -520,16 +612,22 @@ int DataAdaptor::GetMesh(const std::string &meshName, bool structureOnly,
         }
       else if (unstructuredBlocks)
         {
-        svtkUnstructuredGrid *ug = newUnstructuredBlock(this->Internals->Origin,
-          this->Internals->Spacing, it->second, structureOnly);
+        // the points and cells are shared with the cached block, arrays
+        // added to this block are not
+        svtkUnstructuredGrid *ug = svtkUnstructuredGrid::New();
+
+        if (!structureOnly)
+          ug->ShallowCopy(this->Internals->GetUnstructuredBlock(it->first));
 
         mb->SetBlock(it->first, ug);
         ug->Delete();
         }
       else
         {
-        svtkImageData *id = newCartesianBlock(this->Internals->Origin,
-          this->Internals->Spacing, it->second, structureOnly);
+        svtkImageData *id = svtkImageData::New();
+
+        if (!structureOnly)
+          id->ShallowCopy(this->Internals->GetCartesianBlock(it->first));
 
         mb->SetBlock(it->first, id);
         id->Delete();
@@ -667,7 +765,7 @@ int DataAdaptor::AddArray(svtkDataObject* mesh, const std::string &meshName,
         return -1;
         }
 
-      svtkFloatArray *fa = nullptr;
+      svtkDataArray *da = nullptr;
       svtkDataSetAttributes *dsa = nullptr;
 
       if (meshId == BLOCK)
@@ -676,18 +774,20 @@ int DataAdaptor::AddArray(svtkDataObject* mesh, const std::string &meshName,
         svtkIdType nCells = getBlockNumCells(this->Internals->BlockExtents[it->first]);
 
         // zero coopy the array
-        fa = svtkFloatArray::New();
+        svtkFloatArray *fa = svtkFloatArray::New();
         fa->SetName("data");
         fa->SetArray(it->second, nCells, 1);
+        da = fa;
         }
       else
         {
         dsa = blk->GetAttributes(svtkDataObject::POINT);
-        newParticleArray(*this->Internals->ParticleData[it->first], arrayName, fa);
+        if (newParticleArray(*this->Internals->ParticleData[it->first], arrayName, da))
+          return -1;
         }
 
-      dsa->AddArray(fa);
-      fa->Delete();
+      dsa->AddArray(da);
+      da->Delete();
       }
     }
 
@@ -741,13 +841,9 @@ int DataAdaptor::AddGhostCellsArray(svtkDataObject *mesh, const std::string &mes
         return -1;
         }
 
+      // the ghost cells are shared by the blocks served each step
       svtkDataSetAttributes *dsa = blk->GetAttributes(svtkDataObject::CELL);
-
-      svtkUnsignedCharArray *ga = newGhostCellsArray(this->Internals->Shape,
-        it->second, this->Internals->NumGhostCells);
-
-      dsa->AddArray(ga);
-      ga->Delete();
+      dsa->AddArray(this->Internals->GetGhostCells(it->first));
       }
     }
 
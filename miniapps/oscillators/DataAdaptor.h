@@ -38,8 +38,10 @@ public:
   /// Set data for a specific block.
   void SetBlockData(int gid, float* data);
 
-  /// Set particles for a specific block
-  void SetParticleData(int gid, const std::vector<Particle> &particles);
+  /// Set particles for a specific block. The positions, ids, and velocities
+  /// are passed to the analysis zero copy and must not be modified or
+  /// reallocated until the analysis is finished with them.
+  void SetParticleData(int gid, ParticleArray &particles);
 
   /// Set the list of oscillators
   void SetOscillators(const OscillatorArray &oscillators);
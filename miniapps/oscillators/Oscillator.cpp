@@ -103,25 +103,29 @@ std::vector<Oscillator> read(const std::string &fn)
 }
 
 // **************************************************************************
-std::vector<Oscillator> fetch(sensei::DataAdaptor *data)
+// returns zero when the data adaptor has oscillators. an analysis may return
+// other data, which is not an error
+int fetch(sensei::DataAdaptor *data, std::vector<Oscillator> &oscillators)
 {
-  std::vector<Oscillator> oscillators;
-
   sensei::MeshMetadataMap mdMap;
   if (mdMap.Initialize(data))
     {
     SENSEI_ERROR("Failed to get metadata")
-    return oscillators;
+    return -1;
     }
 
   // get the mesh metadata object
   sensei::MeshMetadataPtr mmd;
-  if (mdMap.GetMeshMetadata("oscillators", mmd))
+  for (unsigned int i = 0; i < mdMap.Size(); ++i)
     {
-    SENSEI_ERROR("Failed to get metadata for mesh \"oscillators\"")
-    return oscillators;
+    sensei::MeshMetadataPtr tmp;
+    if (!mdMap.GetMeshMetadata(i, tmp) && (tmp->MeshName == "oscillators"))
+      mmd = tmp;
     }
 
+  if (!mmd)
+    return -1;
+
   if (mmd->NumBlocksLocal == std::vector<int>{ 1 })
     {
     svtkDataObject* mesh;
@@ -129,7 +133,7 @@ std::vector<Oscillator> fetch(sensei::DataAdaptor *data)
         data->AddArrays(mesh, "oscillators", svtkDataObject::POINT, mmd->ArrayName))
       {
       SENSEI_ERROR(<< data->GetClassName() << " failed to get mesh or add arrays.");
-      return oscillators;
+      return -1;
       }
 
     auto pd = svtkPolyData::SafeDownCast(svtkMultiBlockDataSet::SafeDownCast(mesh)->GetBlock(0));
@@ -156,7 +160,7 @@ std::vector<Oscillator> fetch(sensei::DataAdaptor *data)
     mesh->Delete();
     }
 
-  return oscillators;
+  return 0;
 }
 
 // **************************************************************************
@@ -231,15 +235,23 @@ void OscillatorArray::Initialize(const sdiy::mpi::communicator &comm,
 }
 
 // --------------------------------------------------------------------------
-void OscillatorArray::Initialize(const sdiy::mpi::communicator &comm,
+int OscillatorArray::Initialize(const sdiy::mpi::communicator &comm,
   sensei::DataAdaptor *da)
 {
   std::vector<Oscillator> tmp;
 
+  int haveOscillators = 0;
   if (comm.rank() == 0)
-    tmp = ::fetch(da);
+    haveOscillators = ::fetch(da, tmp) ? 0 : 1;
+
+  // keep the current oscillators when none were returned
+  MPI_Bcast(&haveOscillators, 1, MPI_INT, 0, comm);
+  if (!haveOscillators)
+    return -1;
 
   *this = bcast(comm, tmp);
+
+  return 0;
 }
 
 // --------------------------------------------------------------------------
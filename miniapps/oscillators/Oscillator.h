@@ -88,8 +88,10 @@ public:
     void Initialize(const sdiy::mpi::communicator &comm,
       const std::string &fn);
 
-    /// initialize the array from a data adaptor
-    void Initialize(const sdiy::mpi::communicator &comm,
+    /** initialize the array from the "oscillators" mesh of a data adaptor.
+     * when there is no such mesh the array is unchanged and -1 is returned.
+     */
+    int Initialize(const sdiy::mpi::communicator &comm,
       sensei::DataAdaptor *da);
 
     /// releases the array
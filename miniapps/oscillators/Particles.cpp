@@ -23,6 +23,74 @@ sdiy::DiscreteBounds remove_ghosts(const sdiy::DiscreteBounds &domain,
 }
 
 // --------------------------------------------------------------------------
+void ParticleArray::resize(size_t n)
+{
+    id.resize(n);
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    vx.resize(n, 0.0f);
+    vy.resize(n, 0.0f);
+    vz.resize(n, 0.0f);
+}
+
+// --------------------------------------------------------------------------
+void ParticleArray::append(const std::vector<Particle> &particles)
+{
+    size_t n0 = size();
+    size_t n = particles.size();
+
+    resize(n0 + n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Particle &particle = particles[i];
+        id[n0 + i] = particle.id;
+        x[n0 + i] = particle.position[0];
+        y[n0 + i] = particle.position[1];
+        z[n0 + i] = particle.position[2];
+        vx[n0 + i] = particle.velocity[0];
+        vy[n0 + i] = particle.velocity[1];
+        vz[n0 + i] = particle.velocity[2];
+    }
+}
+
+// --------------------------------------------------------------------------
+Particle ParticleArray::get(size_t i) const
+{
+    Particle particle;
+    particle.id = id[i];
+    particle.position = { x[i], y[i], z[i] };
+    particle.velocity = { vx[i], vy[i], vz[i] };
+    return particle;
+}
+
+// --------------------------------------------------------------------------
+template <typename T>
+static void compact(std::vector<T> &vals, const std::vector<unsigned char> &mask)
+{
+    size_t n = vals.size();
+    size_t j = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!mask[i])
+            vals[j++] = vals[i];
+    }
+    vals.resize(j);
+}
+
+// --------------------------------------------------------------------------
+void ParticleArray::erase(const std::vector<unsigned char> &mask)
+{
+    compact(id, mask);
+    compact(x, mask);
+    compact(y, mask);
+    compact(z, mask);
+    compact(vx, mask);
+    compact(vy, mask);
+    compact(vz, mask);
+}
+
 // --------------------------------------------------------------------------
 std::ostream &operator<<(std::ostream &os, const Particle &particle)
 {
@@ -19,6 +19,31 @@ struct Particle
 // put the particle in the stream in human readable format
 std::ostream &operator<<(std::ostream &os, const Particle &particle);
 
+// container for a set of particles. each member is stored in its own
+// contiguous array, so that the particles are updated with unit stride
+// loops and the arrays can be passed to SENSEI without copying them
+struct ParticleArray
+{
+    size_t size() const { return id.size(); }
+    bool empty() const { return id.empty(); }
+
+    void resize(size_t n);
+
+    // add particles at the end
+    void append(const std::vector<Particle> &particles);
+
+    // get the i-th particle
+    Particle get(size_t i) const;
+
+    // removes the particles with a non-zero entry in the mask. the order
+    // of the remaining particles is unchanged
+    void erase(const std::vector<unsigned char> &mask);
+
+    std::vector<int> id;
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+};
+
 // strips the ghost zones from the block, returns a copy
 // with ghosts removed. ghost zones don't go outside of the
 // computational domain.
@@ -66,7 +91,7 @@ sdiy::Bounds<coord_type> world_space_bounds(const sdiy::DiscreteBounds &domain,
 
 // gerate count particles
 template<typename coord_type>
-std::vector<Particle> GenerateRandomParticles(std::default_random_engine& rng,
+ParticleArray GenerateRandomParticles(std::default_random_engine& rng,
     const sdiy::DiscreteBounds &domain, const sdiy::DiscreteBounds &gbounds,
     const sdiy::Point<coord_type,3> &origin, const sdiy::Point<coord_type,3> &spacing,
     int nghost, int startId, int count)
@@ -78,19 +103,29 @@ std::vector<Particle> GenerateRandomParticles(std::default_random_engine& rng,
     std::uniform_real_distribution<coord_type> rgy(world_bounds.min[1], world_bounds.max[1]);
     std::uniform_real_distribution<coord_type> rgz(world_bounds.min[2], world_bounds.max[2]);
 
-    std::vector<Particle> particles;
+    ParticleArray particles;
+    particles.resize(count);
     for (int i = 0; i < count; ++i)
     {
-        Particle p;
-        p.id = startId + i;
-        p.position = { rgx(rng), rgy(rng), rgz(rng) };
-        p.velocity = { 0, 0, 0 };
-        particles.push_back(p);
+        particles.id[i] = startId + i;
+        particles.x[i] = rgx(rng);
+        particles.y[i] = rgy(rng);
+        particles.z[i] = rgz(rng);
     }
 
     return particles;
 }
 
+// return true if the point is inside the world space bounds
+template<typename coord_type>
+bool contains(const sdiy::Bounds<coord_type> &world_bounds,
+    coord_type x, coord_type y, coord_type z)
+{
+    return (x >= world_bounds.min[0]) && (x <= world_bounds.max[0]) &&
+           (y >= world_bounds.min[1]) && (y <= world_bounds.max[1]) &&
+           (z >= world_bounds.min[2]) && (z <= world_bounds.max[2]);
+}
+
 // return true if the particle is inside this block
 template<typename coord_type>
 bool contains(const sdiy::DiscreteBounds &bounds,
@@ -48,7 +48,7 @@ void set_data(int gid, float* data)
 }
 
 //-----------------------------------------------------------------------------
-void set_particles(int gid, const std::vector<Particle> &particles)
+void set_particles(int gid, ParticleArray &particles)
 {
   DataAdaptor->SetParticleData(gid, particles);
 }
@@ -23,7 +23,7 @@ namespace bridge
   void set_data(int gid, float* data);
 
   /// pass the particle based data for for the block identified by gid
-  void set_particles(int gid, const std::vector<Particle> &particles);
+  void set_particles(int gid, ParticleArray &particles);
 
   /// pass the list of oscillators
   void set_oscillators(const OscillatorArray &oscilators);
@@ -304,11 +304,11 @@ int main(int argc, char** argv)
         // If the analysis modified the oscillators, process the updates.
         if (daOut)
         {
-          oscillators.Initialize(comm, daOut);
+          int updated = !oscillators.Initialize(comm, daOut);
           daOut->ReleaseData();
           daOut->Delete();
 
-          if (verbose && (comm.rank() == 0))
+          if (updated && verbose && (comm.rank() == 0))
           {
             std::cerr << "oscillators returned from in situ analysis" << std::endl;
             oscillators.Print(std::cerr);
@@ -340,6 +340,9 @@ int main(int argc, char** argv)
         ++t_count;
     }
 
+    if (verbose && (comm.rank() == 0))
+        std::cerr << oscillators.Size() << " oscillators at the end of the run" << std::endl;
+
 #ifdef ENABLE_SENSEI
     {
     TimeEvent<128> event("oscillators::in_situ_finalize");
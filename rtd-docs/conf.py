@@ -85,6 +85,7 @@ language = None
 exclude_patterns = [u'_build', 'Thumbs.db', '.DS_Store', \
     'data_adaptor_api.rst', 'analysis_adaptor_api.rst', 'ascent_back_end.rst', \
     'catalyst_back_end.rst', 'histogram_back_end.rst', 'autocorrelation_back_end.rst', \
+    'quantile_back_end.rst', \
     'reaction_rate_demo.rst', 'pipeline_demo.rst']
 
 # The name of the Pygments (syntax highlighting) style to use.
@@ -163,9 +163,15 @@ int ADIOS2AnalysisAdaptor::FetchFromProducer(
       }
 
     // generate a global view of the metadata. everything we do from here
-    // on out depends on having the global view.
+    // on out depends on having the global view. when the block structure
+    // is unchanged since the last step only the array ranges are exchanged
     MPI_Comm comm = this->GetCommunicator();
-    mdOut->GlobalizeView(comm);
+    if (this->MetadataCache.GlobalizeView(comm, mdOut))
+      {
+      SENSEI_ERROR("Failed to globalize metadata for mesh \""
+        << mit.MeshName() << "\"")
+      return false;
+      }
 
     // ensure a composite data object
     svtkCompositeDataSetPtr cds = sensei::SVTKUtils::AsCompositeData(comm, dobj);
@@ -573,6 +579,9 @@ int ADIOS2AnalysisAdaptor::UpdateStream()
       SENSEI_ERROR("Failed to open \"" << buffer << "\" for writing")
       return -1;
       }
+
+    // the new file must be self contained
+    this->Schema->ClearPreviousMetadata();
     }
 
   return 0;
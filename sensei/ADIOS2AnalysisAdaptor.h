@@ -4,6 +4,7 @@
 #include "AnalysisAdaptor.h"
 #include "DataRequirements.h"
 #include "MeshMetadata.h"
+#include "MeshMetadataCache.h"
 
 #include <ADIOS2Schema.h>
 
@@ -151,6 +152,7 @@ protected:
   long StepIndex;
   long FileIndex;
   unsigned int Frequency;
+  MeshMetadataCache MetadataCache;
 
 private:
   ADIOS2AnalysisAdaptor(const ADIOS2AnalysisAdaptor&) = delete;
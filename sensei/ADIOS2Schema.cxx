@@ -666,6 +666,8 @@ class BinaryStreamSchema
 public:
   static int DefineVariables(AdiosHandle handles, const std::string &path);
 
+  // the put is deferred, the stream must not be modified until the puts
+  // have been performed
   static int Write(AdiosHandle handles, const std::string &path,
     const sensei::BinaryStream &md);
 
@@ -760,7 +762,7 @@ int BinaryStreamSchema::Write(AdiosHandle handles, const std::string &path,
 
   if (adios2_set_shape(internalBinVar, 1, &n) ||
       adios2_set_selection(internalBinVar, 1, &selectionStart, &n) ||
-      adios2_put_by_name(handles.engine, path.c_str(), str.GetData(), adios2_mode_sync))
+      adios2_put_by_name(handles.engine, path.c_str(), str.GetData(), adios2_mode_deferred))
     {
     SENSEI_ERROR("Failed to write BinaryStream at \"" << path << "\"")
     return -1;
@@ -1082,9 +1084,12 @@ int ArraySchema::Write(MPI_Comm comm, AdiosHandle handles, unsigned int i,
         return -1;
         }
 
-      // do the write
-      if (adios2_put(handles.engine, putVar,
-        da->GetVoidPointer(0), adios2_mode_sync))
+      // do the write. values interleaved from a SOA array are copied
+      // by ADIOS2 right away since the copy is not kept
+      svtkSmartPointer<svtkDataArray> aos;
+      void *pda = sensei::SVTKUtils::GetAOSPointer(da, aos);
+      if (adios2_put(handles.engine, putVar, pda,
+        aos ? adios2_mode_sync : adios2_mode_deferred))
         {
         SENSEI_ERROR("adios2_put block " << j << " array "
           << i << " failed")
@@ -1199,9 +1204,10 @@ int ArraySchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons
       array->SetNumberOfTuples(num_elem_local);
       array->SetName(array_name.c_str());
 
-      // /data_object_<id>/data_array_<id>/data
+      // /data_object_<id>/data_array_<id>/data. the get is deferred, it
+      // completes when the caller performs the gets
       if (adios2_get(handles.engine, vinfo, array->GetVoidPointer(0),
-        adios2_mode_sync))
+        adios2_mode_deferred))
         {
         SENSEI_ERROR("adios2_get \"" << array_name
           << "\" block " << j << " array " << i << " failed")
@@ -1407,9 +1413,13 @@ int PointSchema::Write(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
+        // points interleaved from a SOA array are copied by ADIOS2 right
+        // away since the copy is not kept
         svtkDataArray *da = ds->GetPoints()->GetData();
-        if (adios2_put(handles.engine, putVar,
-          da->GetVoidPointer(0), adios2_mode_sync))
+        svtkSmartPointer<svtkDataArray> aos;
+        void *pda = sensei::SVTKUtils::GetAOSPointer(da, aos);
+        if (adios2_put(handles.engine, putVar, pda,
+          aos ? adios2_mode_sync : adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put \"" << md->MeshName
             << "\" block " << j << " points failed")
@@ -1480,7 +1490,7 @@ int PointSchema::Read(MPI_Comm comm, AdiosHandle handles, const std::string &ons
         points->SetName("points");
 
         adios2_error getErr = adios2_get(handles.engine,
-          vinfo, points->GetVoidPointer(0), adios2_mode_sync);
+          vinfo, points->GetVoidPointer(0), adios2_mode_deferred);
 
         if (getErr != 0)
           {
@@ -1735,7 +1745,7 @@ int UnstructuredCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
 
         svtkDataArray *cta = ds->GetCellTypesArray();
         if (adios2_put(handles.engine, cellTypeVar,
-          cta->GetVoidPointer(0), adios2_mode_sync))
+          cta->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put cell types for mesh \""
             << md->MeshName << "\" block " << j << " failed")
@@ -1758,7 +1768,7 @@ int UnstructuredCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
         svtkDataArray *co = ds->GetCells()->GetOffsetsArray();
 
         if (adios2_put(handles.engine, cellOffsVar,
-          co->GetVoidPointer(0), adios2_mode_sync))
+          co->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put cell offsets for mesh \""
             << md->MeshName << "\" block " << j << " failed")
@@ -1779,7 +1789,7 @@ int UnstructuredCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
         svtkDataArray *cc = ds->GetCells()->GetConnectivityArray();
 
         if (adios2_put(handles.engine, cellConnVar,
-          cc->GetVoidPointer(0), adios2_mode_sync))
+          cc->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put cell offsets for mesh \""
             << md->MeshName << "\" block " << j << " failed")
@@ -1820,6 +1830,18 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
 
+    // the cells are passed to the datasets once the deferred gets of all
+    // local blocks have been performed
+    struct BlockCells
+      {
+      svtkUnstructuredGrid *Mesh;
+      svtkSmartPointer<svtkUnsignedCharArray> Types;
+      svtkSmartPointer<svtkDataArray> Offsets;
+      svtkSmartPointer<svtkDataArray> Connectivity;
+      };
+
+    std::vector<BlockCells> blockCells;
+
     // calc block offsets
     unsigned long long cell_types_block_offset = 0;
     unsigned long long cell_array_block_offset = 0;
@@ -1859,7 +1881,7 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
         ct->SetName("CellTypes");
 
         adios2_error ctErr = adios2_get(handles.engine,
-          ctVar, ct->GetVoidPointer(0), adios2_mode_sync);
+          ctVar, ct->GetVoidPointer(0), adios2_mode_deferred);
 
         if (ctErr != 0)
           {
@@ -1908,7 +1930,7 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           }
 
         adios2_error coErr = adios2_get(handles.engine,
-          coVar, co->GetVoidPointer(0), adios2_mode_sync);
+          coVar, co->GetVoidPointer(0), adios2_mode_deferred);
 
         if (coErr != 0)
           {
@@ -1956,7 +1978,7 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           }
 
         adios2_error caErr = adios2_get(handles.engine,
-          ccVar, cc->GetVoidPointer(0), adios2_mode_sync);
+          ccVar, cc->GetVoidPointer(0), adios2_mode_deferred);
 
         if (caErr)
           {
@@ -1964,11 +1986,6 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        // package cells
-        svtkCellArray *ca = svtkCellArray::New();
-        ca->SetData(co, cc);
-
-        // pass cells into the dataset
         svtkUnstructuredGrid *ds =
           dynamic_cast<svtkUnstructuredGrid*>(it->GetCurrentDataObject());
 
@@ -1978,9 +1995,13 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        ds->SetCells(ct, ca);
+        BlockCells bc;
+        bc.Mesh = ds;
+        bc.Types = ct;
+        bc.Offsets = co;
+        bc.Connectivity = cc;
+        blockCells.push_back(bc);
 
-        ca->Delete();
         ct->Delete();
         co->Delete();
         cc->Delete();
@@ -1995,6 +2016,26 @@ int UnstructuredCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
       it->GoToNextItem();
       }
 
+    if (adios2_perform_gets(handles.engine))
+      {
+      SENSEI_ERROR("adios2_perform_gets cells failed")
+      return -1;
+      }
+
+    // package cells and pass them into the datasets
+    size_t num_local = blockCells.size();
+    for (size_t j = 0; j < num_local; ++j)
+      {
+      BlockCells &bc = blockCells[j];
+
+      svtkCellArray *ca = svtkCellArray::New();
+      ca->SetData(bc.Offsets, bc.Connectivity);
+
+      bc.Mesh->SetCells(bc.Types, ca);
+
+      ca->Delete();
+      }
+
     sensei::Profiler::EndEvent("senseiADIOS2::UnstructuredCellSchema::Read", numBytes);
     }
 
@@ -2026,6 +2067,11 @@ struct PolydataCellSchema
   std::map<std::string, adios2_variable*> CellConnVars;
   std::map<std::string, std::vector<size_t>> CellConnStarts;
   std::map<std::string, std::vector<size_t>> CellConnCounts;
+
+  // the packed cells of the local blocks. these are held until the next
+  // step since the puts are deferred until the end of the step.
+  std::map<std::string, std::vector<int64_t>> CellTypeBuffers;
+  std::map<std::string, std::vector<svtkSmartPointer<svtkDataArray>>> CellArrayBuffers;
 };
 
 // --------------------------------------------------------------------------
@@ -2191,8 +2237,18 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
 
-    // write local blocks
     unsigned int num_blocks = md->NumBlocks;
+
+    // release the previous step's buffers. the cell type buffer is sized
+    // up front so that it is not reallocated while puts are pending
+    std::vector<int64_t> &cellTypes = this->CellTypeBuffers[md->MeshName];
+    cellTypes.assign(4*num_blocks, 0);
+
+    std::vector<svtkSmartPointer<svtkDataArray>> &cellArrays =
+      this->CellArrayBuffers[md->MeshName];
+    cellArrays.clear();
+
+    // write local blocks
     for (unsigned int j = 0; j < num_blocks; ++j)
       {
       // get local block
@@ -2211,8 +2267,11 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
         size_t ctStart = 4*j;
         size_t ctCount = 4;
 
-        int64_t ct[4] = {ds->GetNumberOfVerts(), ds->GetNumberOfLines(),
-            ds->GetNumberOfPolys(),  ds->GetNumberOfStrips()};
+        int64_t *ct = cellTypes.data() + 4*j;
+        ct[0] = ds->GetNumberOfVerts();
+        ct[1] = ds->GetNumberOfLines();
+        ct[2] = ds->GetNumberOfPolys();
+        ct[3] = ds->GetNumberOfStrips();
 
         // write the cell types
         if (adios2_set_selection(cellTypeVar, 1, &ctStart, &ctCount))
@@ -2222,7 +2281,7 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        if (adios2_put(handles.engine, cellTypeVar, ct, adios2_mode_sync))
+        if (adios2_put(handles.engine, cellTypeVar, ct, adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put cell types for mesh \""
             << md->MeshName << "\" block " << j << " failed")
@@ -2285,6 +2344,13 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
             }
           }
 
+        // hold the packed cells until the deferred puts are performed
+        cellArrays.push_back(co);
+        cellArrays.push_back(cc);
+
+        co->Delete();
+        cc->Delete();
+
         // write cell cell offset array
         if (adios2_set_selection(cellOffsVar, 1, &coStart, &coCount))
           {
@@ -2294,7 +2360,7 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
           }
 
         if (adios2_put(handles.engine, cellOffsVar,
-          co->GetVoidPointer(0), adios2_mode_sync))
+          co->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put cell offsets for mesh \""
             << md->MeshName << "\" block " << j << " failed")
@@ -2310,16 +2376,13 @@ int PolydataCellSchema::Write(MPI_Comm comm, AdiosHandle handles,
           }
 
         if (adios2_put(handles.engine, cellConnVar,
-          cc->GetVoidPointer(0), adios2_mode_sync))
+          cc->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put cell offsets for mesh \""
             << md->MeshName << "\" block " << j << " failed")
           return -1;
           }
 
-        co->Delete();
-        cc->Delete();
-
         // track number of bytes for profiling
         numBytes += 4 *sizeof(uint64_t) + (coCount + ccCount) * elemSize;
         }
@@ -2359,6 +2422,21 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
     unsigned long long cell_array_block_offset = 0;
 
     unsigned int num_blocks = md->NumBlocks;
+
+    // the cells are unpacked once the deferred gets of all local blocks
+    // have been performed. the cell type buffer is sized up front so that
+    // it is not reallocated while gets are pending
+    struct BlockCells
+      {
+      svtkPolyData *Mesh;
+      int64_t *Types;
+      svtkSmartPointer<svtkDataArray> Offsets;
+      svtkSmartPointer<svtkDataArray> Connectivity;
+      };
+
+    std::vector<BlockCells> blockCells;
+    std::vector<int64_t> cellTypes(4*num_blocks, 0);
+
     for (unsigned int j = 0; j < num_blocks; ++j)
       {
       // get the block size
@@ -2379,7 +2457,7 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
 
         size_t ctStart = 4 * j;
         size_t ctCount = 4;
-        int64_t ct[4] = {0};
+        int64_t *ct = cellTypes.data() + ctStart;
 
         if (adios2_set_selection(ctVar, 1, &ctStart, &ctCount))
           {
@@ -2389,7 +2467,7 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           }
 
         adios2_error ctErr = adios2_get(handles.engine,
-          ctVar, ct, adios2_mode_sync);
+          ctVar, ct, adios2_mode_deferred);
 
         if (ctErr != 0)
           {
@@ -2430,7 +2508,7 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           }
 
         adios2_error coErr = adios2_get(handles.engine,
-          coVar, co->GetVoidPointer(0), adios2_mode_sync);
+          coVar, co->GetVoidPointer(0), adios2_mode_deferred);
 
         if (coErr != 0)
           {
@@ -2471,7 +2549,7 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           }
 
         adios2_error caErr = adios2_get(handles.engine,
-          ccVar, cc->GetVoidPointer(0), adios2_mode_sync);
+          ccVar, cc->GetVoidPointer(0), adios2_mode_deferred);
 
         if (caErr)
           {
@@ -2479,35 +2557,6 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        // unpack cells
-        svtkCellArray *verts = svtkCellArray::New();
-        svtkCellArray *lines = svtkCellArray::New();
-        svtkCellArray *polys = svtkCellArray::New();
-        svtkCellArray *strips = svtkCellArray::New();
-
-        switch (md->CellArrayType)
-          {
-          svtkCellTemplateMacro(
-
-            using ARRAY_TT = svtkAOSDataArrayTemplate<SVTK_TT>;
-
-            ARRAY_TT *tco = dynamic_cast<ARRAY_TT*>(co);
-            ARRAY_TT *tcc = dynamic_cast<ARRAY_TT*>(cc);
-
-            size_t coId = 0;
-            size_t ccId = 0;
-
-            sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[0], tco, tcc, verts, coId, ccId);
-            sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[1], tco, tcc, lines, coId, ccId);
-            sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[2], tco, tcc, polys, coId, ccId);
-            sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[3], tco, tcc, strips, coId, ccId);
-            )
-          }
-
-        co->Delete();
-        cc->Delete();
-
-        // pass cells into the dataset
         svtkPolyData *ds =
           dynamic_cast<svtkPolyData*>(it->GetCurrentDataObject());
 
@@ -2517,15 +2566,15 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        ds->SetVerts(verts);
-        ds->SetLines(lines);
-        ds->SetPolys(polys);
-        ds->SetStrips(strips);
+        BlockCells bc;
+        bc.Mesh = ds;
+        bc.Types = ct;
+        bc.Offsets = co;
+        bc.Connectivity = cc;
+        blockCells.push_back(bc);
 
-        verts->Delete();
-        lines->Delete();
-        polys->Delete();
-        strips->Delete();
+        co->Delete();
+        cc->Delete();
 
         numBytes += (ccCount + coCount) * elemSize + 4 *sizeof(uint64_t);
         }
@@ -2537,6 +2586,54 @@ int PolydataCellSchema::Read(MPI_Comm comm, AdiosHandle handles,
       it->GoToNextItem();
       }
 
+    if (adios2_perform_gets(handles.engine))
+      {
+      SENSEI_ERROR("adios2_perform_gets cells failed")
+      return -1;
+      }
+
+    // unpack cells and pass them into the datasets
+    size_t num_local = blockCells.size();
+    for (size_t j = 0; j < num_local; ++j)
+      {
+      BlockCells &bc = blockCells[j];
+      int64_t *ct = bc.Types;
+
+      svtkCellArray *verts = svtkCellArray::New();
+      svtkCellArray *lines = svtkCellArray::New();
+      svtkCellArray *polys = svtkCellArray::New();
+      svtkCellArray *strips = svtkCellArray::New();
+
+      switch (md->CellArrayType)
+        {
+        svtkCellTemplateMacro(
+
+          using ARRAY_TT = svtkAOSDataArrayTemplate<SVTK_TT>;
+
+          ARRAY_TT *tco = dynamic_cast<ARRAY_TT*>(bc.Offsets.Get());
+          ARRAY_TT *tcc = dynamic_cast<ARRAY_TT*>(bc.Connectivity.Get());
+
+          size_t coId = 0;
+          size_t ccId = 0;
+
+          sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[0], tco, tcc, verts, coId, ccId);
+          sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[1], tco, tcc, lines, coId, ccId);
+          sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[2], tco, tcc, polys, coId, ccId);
+          sensei::SVTKUtils::UnpackCells<SVTK_TT>(ct[3], tco, tcc, strips, coId, ccId);
+          )
+        }
+
+      bc.Mesh->SetVerts(verts);
+      bc.Mesh->SetLines(lines);
+      bc.Mesh->SetPolys(polys);
+      bc.Mesh->SetStrips(strips);
+
+      verts->Delete();
+      lines->Delete();
+      polys->Delete();
+      strips->Delete();
+      }
+
     sensei::Profiler::EndEvent("senseiADIOS2::PolydataCellSchema::Read", numBytes);
     }
 
@@ -2647,18 +2744,18 @@ int LogicallyCartesianSchema::Write(MPI_Comm comm, AdiosHandle handles,
           case SVTK_RECTILINEAR_GRID:
             ierr = adios2_put(handles.engine, writeVar,
               dynamic_cast<svtkRectilinearGrid*>(dobj)->GetExtent(),
-              adios2_mode_sync);
+              adios2_mode_deferred);
             break;
 
           case SVTK_IMAGE_DATA:
           case SVTK_UNIFORM_GRID:
             ierr = adios2_put(handles.engine, writeVar,
-              dynamic_cast<svtkImageData*>(dobj)->GetExtent(), adios2_mode_sync);
+              dynamic_cast<svtkImageData*>(dobj)->GetExtent(), adios2_mode_deferred);
             break;
 
           case SVTK_STRUCTURED_GRID:
             ierr = adios2_put(handles.engine, writeVar,
-              dynamic_cast<svtkStructuredGrid*>(dobj)->GetExtent(), adios2_mode_sync);
+              dynamic_cast<svtkStructuredGrid*>(dobj)->GetExtent(), adios2_mode_deferred);
             break;
           }
 
@@ -2700,8 +2797,13 @@ int LogicallyCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
 
-    // read each block
+    // the extents are passed to the datasets once the deferred gets of all
+    // local blocks have been performed
     unsigned int num_blocks = md->NumBlocks;
+    std::vector<int> extents(6*num_blocks, 0);
+    std::vector<std::pair<svtkDataObject*, int*>> blockExtents;
+
+    // read each block
     for (unsigned int j = 0; j < num_blocks; ++j)
       {
       // read the variable for a local block
@@ -2726,34 +2828,22 @@ int LogicallyCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        int ext[6] = {0};
-        adios2_error getErr = adios2_get(handles.engine, vinfo, ext, adios2_mode_sync);
+        int *ext = extents.data() + hexplet_start;
+        adios2_error getErr = adios2_get(handles.engine, vinfo, ext, adios2_mode_deferred);
         if (getErr != 0)
           {
           SENSEI_ERROR("adios2_get extent block " << j << " failed")
           return -1;
           }
 
-        // update the svtk object
         svtkDataObject *dobj = it->GetCurrentDataObject();
         if (!dobj)
           {
           SENSEI_ERROR("Failed to get block " << j)
           return -1;
           }
-        switch (md->BlockType)
-          {
-          case SVTK_RECTILINEAR_GRID:
-            dynamic_cast<svtkRectilinearGrid*>(dobj)->SetExtent(ext);
-            break;
-          case SVTK_IMAGE_DATA:
-          case SVTK_UNIFORM_GRID:
-              dynamic_cast<svtkImageData*>(dobj)->SetExtent(ext);
-            break;
-          case SVTK_STRUCTURED_GRID:
-              dynamic_cast<svtkStructuredGrid*>(dobj)->SetExtent(ext);
-            break;
-          }
+
+        blockExtents.push_back(std::make_pair(dobj, ext));
 
         numBytes += 6*sizeof(int);
         }
@@ -2762,6 +2852,33 @@ int LogicallyCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
       }
     it->Delete();
 
+    if (adios2_perform_gets(handles.engine))
+      {
+      SENSEI_ERROR("adios2_perform_gets extents failed")
+      return -1;
+      }
+
+    // update the svtk objects
+    size_t num_local = blockExtents.size();
+    for (size_t j = 0; j < num_local; ++j)
+      {
+      svtkDataObject *dobj = blockExtents[j].first;
+      int *ext = blockExtents[j].second;
+      switch (md->BlockType)
+        {
+        case SVTK_RECTILINEAR_GRID:
+          dynamic_cast<svtkRectilinearGrid*>(dobj)->SetExtent(ext);
+          break;
+        case SVTK_IMAGE_DATA:
+        case SVTK_UNIFORM_GRID:
+            dynamic_cast<svtkImageData*>(dobj)->SetExtent(ext);
+          break;
+        case SVTK_STRUCTURED_GRID:
+            dynamic_cast<svtkStructuredGrid*>(dobj)->SetExtent(ext);
+          break;
+        }
+      }
+
     sensei::Profiler::EndEvent("senseiADIOS2::LogicallyCartesianSchema::Read", numBytes);
     }
 
@@ -2884,7 +3001,7 @@ int UniformCartesianSchema::Write(MPI_Comm comm, AdiosHandle handles,
           }
 
         if (adios2_put(handles.engine, originWriteVar,
-          ds->GetOrigin(), adios2_mode_sync))
+          ds->GetOrigin(), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put origin block " << j << " failed")
           return -1;
@@ -2898,7 +3015,7 @@ int UniformCartesianSchema::Write(MPI_Comm comm, AdiosHandle handles,
           }
 
         if (adios2_put(handles.engine, spacingWriteVar,
-          ds->GetSpacing(), adios2_mode_sync))
+          ds->GetSpacing(), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put spacing block " << j << " failed")
           return -1;
@@ -2934,8 +3051,13 @@ int UniformCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
 
-    // define for each block
+    // the origin and spacing are passed to the datasets once the deferred
+    // gets of all local blocks have been performed
     unsigned int num_blocks = md->NumBlocks;
+    std::vector<double> originSpacing(6*num_blocks, 0.0);
+    std::vector<std::pair<svtkImageData*, double*>> blockOriginSpacing;
+
+    // define for each block
     for (unsigned int j = 0; j < num_blocks; ++j)
       {
       // define the variable for a local block
@@ -2960,16 +3082,16 @@ int UniformCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
           }
 
         // /data_object_<id>/data_array_<id>/origin
-        double x0[3] = {0.0};
+        double *x0 = originSpacing.data() + 6*j;
 
-        if (adios2_get(handles.engine, origin_vinfo, x0, adios2_mode_sync))
+        if (adios2_get(handles.engine, origin_vinfo, x0, adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_get origin block " << j << " failed")
           return -1;
           }
 
         // /data_object_<id>/data_array_<id>/spacing
-        double dx[3] = {0.0};
+        double *dx = x0 + 3;
         std::string spacing_path = ons + "spacing";
         adios2_variable *spacing_vinfo = adios2_inquire_variable(handles.io, spacing_path.c_str());
         if (!spacing_vinfo)
@@ -2985,19 +3107,12 @@ int UniformCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        if (adios2_get(handles.engine, spacing_vinfo, dx, adios2_mode_sync))
+        if (adios2_get(handles.engine, spacing_vinfo, dx, adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_get spacing block " << j << " failed")
           return -1;
           }
 
-        if (adios2_perform_gets(handles.engine))
-          {
-          SENSEI_ERROR("adios2_perform_gets block " << j << " failed")
-          return -1;
-          }
-
-        // update the svtk object
         svtkImageData *ds = dynamic_cast<svtkImageData*>(it->GetCurrentDataObject());
         if (!ds)
           {
@@ -3005,8 +3120,7 @@ int UniformCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
           return -1;
           }
 
-        ds->SetOrigin(x0);
-        ds->SetSpacing(dx);
+        blockOriginSpacing.push_back(std::make_pair(ds, x0));
 
         numBytes += 6*sizeof(double);
         }
@@ -3015,6 +3129,22 @@ int UniformCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
       }
     it->Delete();
 
+    if (adios2_perform_gets(handles.engine))
+      {
+      SENSEI_ERROR("adios2_perform_gets origin and spacing failed")
+      return -1;
+      }
+
+    // update the svtk objects
+    size_t num_local = blockOriginSpacing.size();
+    for (size_t j = 0; j < num_local; ++j)
+      {
+      svtkImageData *ds = blockOriginSpacing[j].first;
+      double *x0 = blockOriginSpacing[j].second;
+      ds->SetOrigin(x0);
+      ds->SetSpacing(x0 + 3);
+      }
+
     sensei::Profiler::EndEvent("senseiADIOS2::UniformCartesianSchema::Read", numBytes);
     }
 
@@ -3232,7 +3362,7 @@ int StretchedCartesianSchema::Write(MPI_Comm comm, AdiosHandle handles,
 
         svtkDataArray *xda = ds->GetXCoordinates();
         if (adios2_put(handles.engine, xcVar,
-          xda->GetVoidPointer(0), adios2_mode_sync))
+          xda->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put x-coordinates block " << j << " failed")
           return -1;
@@ -3250,7 +3380,7 @@ int StretchedCartesianSchema::Write(MPI_Comm comm, AdiosHandle handles,
 
         svtkDataArray *yda = ds->GetYCoordinates();
         if (adios2_put(handles.engine, ycVar,
-          yda->GetVoidPointer(0), adios2_mode_sync))
+          yda->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put y-coordinates block " << j << " failed")
           return -1;
@@ -3267,7 +3397,7 @@ int StretchedCartesianSchema::Write(MPI_Comm comm, AdiosHandle handles,
           }
 
         if (adios2_put(handles.engine, zcVar,
-          zda->GetVoidPointer(0), adios2_mode_sync))
+          zda->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_put y-coordinates block " << j << " failed")
           return -1;
@@ -3346,7 +3476,7 @@ int StretchedCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
         x_coords->SetName("x_coords");
 
         if (adios2_get(handles.engine, xc_vinfo,
-          x_coords->GetVoidPointer(0), adios2_mode_sync))
+          x_coords->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_get x_coords block " << j << " failed")
           return -1;
@@ -3377,7 +3507,7 @@ int StretchedCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
         y_coords->SetName("y_coords");
 
         if (adios2_get(handles.engine, yc_vinfo,
-          y_coords->GetVoidPointer(0), adios2_mode_sync))
+          y_coords->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_get y_coords block " << j << " failed")
           return -1;
@@ -3408,19 +3538,14 @@ int StretchedCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
         z_coords->SetName("z_coords");
 
         if (adios2_get(handles.engine, zc_vinfo,
-          z_coords->GetVoidPointer(0), adios2_mode_sync))
+          z_coords->GetVoidPointer(0), adios2_mode_deferred))
           {
           SENSEI_ERROR("adios2_get z_coords block " << j << " failed")
           return -1;
           }
 
-        if (adios2_perform_gets(handles.engine))
-          {
-          SENSEI_ERROR("Failed to read stretched Cartesian block " << j)
-          return -1;
-          }
-
-        // update the svtk object
+        // update the svtk object. the coordinates are filled in when the
+        // deferred gets are performed
         svtkRectilinearGrid *ds = dynamic_cast<svtkRectilinearGrid*>(it->GetCurrentDataObject());
         if (!ds)
           {
@@ -3451,6 +3576,12 @@ int StretchedCartesianSchema::Read(MPI_Comm comm, AdiosHandle handles,
 
     it->Delete();
 
+    if (adios2_perform_gets(handles.engine))
+      {
+      SENSEI_ERROR("Failed to read stretched Cartesian coordinates")
+      return -1;
+      }
+
     sensei::Profiler::EndEvent("senseiADIOS2::StretchedCartesianSchema::Read", numBytes);
     }
 
@@ -3630,6 +3761,9 @@ struct DataObjectCollectionSchema::InternalsType
   DataObjectSchema DataObject;
   sensei::MeshMetadataMap SenderMdMap;
   sensei::MeshMetadataMap ReceiverMdMap;
+  std::vector<sensei::MeshMetadataPtr> WrittenMd;
+  std::vector<sensei::BinaryStream> WrittenMdStreams;
+  std::vector<sensei::MeshMetadataPtr> ReadMd;
   int BlockOwnerArrayMetadata;
 };
 
@@ -3673,9 +3807,22 @@ int DataObjectCollectionSchema::ReadMeshMetadata(MPI_Comm comm, InputStream &iSt
     if (BinaryStreamSchema::Read(comm, iStream, path, bs))
       return -1;
 
+    // the block structure is omitted when it has not changed since the
+    // previous step
+    sensei::MeshMetadataPtr prev;
+    if (i < this->Internals->ReadMd.size())
+      prev = this->Internals->ReadMd[i];
+
     sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
 
-    md->FromStream(bs);
+    if (md->FromStreamDelta(bs, prev))
+      {
+      SENSEI_ERROR("Failed to deserialize metadata for object " << i)
+      return -1;
+      }
+
+    this->Internals->ReadMd.resize(n_objects);
+    this->Internals->ReadMd[i] = md->NewCopy();
 
     // FIXME
     // Don't add internally generated arrays, as these
@@ -3881,10 +4028,19 @@ int DataObjectCollectionSchema::Write(MPI_Comm comm, AdiosHandle handles,
     return -1;
     }
 
+  this->Internals->WrittenMd.resize(n_objects);
+
+  // the metadata is held until the next step since the puts are deferred
+  // until the end of the step
+  this->Internals->WrittenMdStreams.resize(n_objects);
+
   for (unsigned int i = 0; i < n_objects; ++i)
     {
-    sensei::BinaryStream bs;
-    metadata[i]->ToStream(bs);
+    // write the block structure only if it changed
+    sensei::BinaryStream &bs = this->Internals->WrittenMdStreams[i];
+    bs.Clear();
+    metadata[i]->ToStreamDelta(bs, this->Internals->WrittenMd[i]);
+    this->Internals->WrittenMd[i] = metadata[i];
 
     std::ostringstream oss;
     oss << "data_object_" << i << "/";
@@ -3913,6 +4069,12 @@ int DataObjectCollectionSchema::Write(MPI_Comm comm, AdiosHandle handles,
   return 0;
 }
 
+// --------------------------------------------------------------------------
+void DataObjectCollectionSchema::ClearPreviousMetadata()
+{
+  this->Internals->WrittenMd.clear();
+}
+
 // --------------------------------------------------------------------------
 bool DataObjectCollectionSchema::CanRead(InputStream &iStream)
 {
@@ -3953,6 +4115,14 @@ int DataObjectCollectionSchema::ReadObject(MPI_Comm comm,
     }
   dobj = cd;
 
+  // complete any gets left pending by the mesh geometry
+  if (adios2_perform_gets(iStream.Handles.engine))
+    {
+    SENSEI_ERROR("adios2_perform_gets object " << doid << " \""
+      << object_name << "\" failed")
+    return -1;
+    }
+
   return 0;
 }
 
@@ -4026,6 +4196,14 @@ int DataObjectCollectionSchema::ReadArray(MPI_Comm comm,
     return -1;
     }
 
+  // the gets of all blocks were deferred, pull them across at once
+  if (adios2_perform_gets(iStream.Handles.engine))
+    {
+    SENSEI_ERROR("adios2_perform_gets data array \"" << array_name
+      << "\" from object \"" << object_name << "\" failed")
+    return -1;
+    }
+
   return 0;
 }
 
@@ -65,11 +65,17 @@ public:
   // get the number of meshes available. Available after ReadMeshMetadata
   int GetNumberOfObjects(unsigned int &num);
 
-  // write the object collection
+  // write the object collection. the block structure in the metadata of an
+  // object is written only when its generation differs from the previous
+  // step's, otherwise a marker telling the reader to reuse it is written.
   int Write(MPI_Comm comm, AdiosHandle handles, unsigned long time_step, double time,
     const std::vector<sensei::MeshMetadataPtr> &metadata,
     const std::vector<svtkCompositeDataSetPtr> &objects);
 
+  // forget the metadata written previously, so that the next call to Write
+  // includes the full block structure. call when opening a new file.
+  void ClearPreviousMetadata();
+
   // return true if the file is one of ours and the version the file was
   // written with is compatible with this revision of the schema
   bool CanRead(InputStream &iStream);
@@ -1,33 +1,41 @@
 #include "Autocorrelation.h"
+#include "AutocorrelationEngine.h"
 
 #include "DataAdaptor.h"
 #include "MeshMetadata.h"
 #include "MeshMetadataMap.h"
+#include "SVTKDataAdaptor.h"
 #include "SVTKUtils.h"
+#include "SMPUtils.h"
 #include "Profiler.h"
 #include "Error.h"
 
 // SVTK includes
+#include <svtkCellArray.h>
 #include <svtkCompositeDataIterator.h>
 #include <svtkCellData.h>
 #include <svtkFieldData.h>
 #include <svtkFloatArray.h>
 #include <svtkImageData.h>
+#include <svtkIntArray.h>
 #include <svtkMultiBlockDataSet.h>
 #include <svtkObjectFactory.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkPolyData.h>
+#include <svtkSMPThreadLocal.h>
 #include <svtkSmartPointer.h>
 #include <svtkStructuredData.h>
 #include <svtkUnsignedCharArray.h>
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <vector>
 
 #include <sdiy/master.hpp>
-#include <sdiy/reduce.hpp>
-#include <sdiy/partners/merge.hpp>
-#include <sdiy/io/numpy.hpp>
 #include <sdiy/grid.hpp>
-#include <sdiy/vertices.hpp>
 
 
 // http://stackoverflow.com/a/12580468
@@ -37,111 +45,162 @@ std::unique_ptr<T> make_unique(Args&& ...args)
   return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
 }
 
-template<class T>
-struct add_vectors
-{
-    using Vector = std::vector<T>;
-    Vector  operator()(const Vector& lhs, const Vector& rhs) const
-    {
-      Vector res(lhs.size(), 0);
-      for (size_t i = 0; i < lhs.size(); ++i)
-        res[i] = lhs[i] + rhs[i];
-      return res;
-    }
-};
-
-namespace sdiy { namespace mpi { namespace detail {
-template<class U> struct mpi_op<add_vectors<U>>
-{
-  static MPI_Op get()
-  { return MPI_SUM; }
-};
-}}}
 
 namespace sensei
 {
 
 using GridRef = sdiy::GridRef<float,3>;
 using Vertex  = GridRef::Vertex;
-using Vertex4D = Vertex::UPoint;
 
+// a block of the decomposition. the time history and autocorrelations of
+// its points are stored by the AutocorrelationEngine
 struct AutocorrelationImpl
 {
-  using Grid = sdiy::Grid<float,4>;
-  AutocorrelationImpl(size_t window_, int gid_, Vertex from_, Vertex to_):
+  AutocorrelationImpl(size_t window_, int gid_, Vertex from_, Vertex to_,
+    int engineId_):
     window(window_),
     gid(gid_),
     from(from_), to(to_),
     shape(to - from + Vertex::one()),
-    // init grid with (to - from + 1) in 3D, and window in the 4-th dimension
-    values(shape.lift(3, window)),
-    corr(shape.lift(3, window))
-  { corr = 0; }
+    engineId(engineId_)
+  {}
 
   static void* create()            { return new AutocorrelationImpl; }
   static void destroy(void* b)    { delete static_cast<AutocorrelationImpl*>(b); }
-  void process(float* data, unsigned char *ghostArray)
+
+  // number of points in the block
+  size_t size() const { return size_t(shape[0])*shape[1]*shape[2]; }
+
+  // the position of the i-th point, the first dimension varies fastest as
+  // in svtkImageData
+  Vertex vertex(size_t i) const
     {
-    GridRef g(data, shape);
+    Vertex v;
+    v[0] = i % shape[0];
+    i /= shape[0];
+    v[1] = i % shape[1];
+    v[2] = i / shape[1];
+    return v + from;
+    }
 
-    if (ghostArray)
-      {
-      sdiy::GridRef<unsigned char, 3> ghost(ghostArray, shape);
-      // record the values
-      sdiy::for_each(g.shape(), [&](const Vertex& v)
-        {
-        auto gv = (ghost(v) == 0) ? g(v) : 0;
+  size_t          window;
+  int             gid;
+  Vertex          from, to, shape;
+  int             engineId = -1; // the block's id in the AutocorrelationEngine
 
-        for (size_t i = 1; i <= window; ++i)
-        {
-        if (i > count) continue;    // during the initial fill, we don't get contributions to some shifts
+private:
+  AutocorrelationImpl() {}        // here just for create; to let Master manage the blocks (+ if we choose to add OOC later)
+};
 
-        auto uc = v.lift(3, i-1);
-        auto uv = v.lift(3, (offset + window - i) % window);
-        corr(uc) += values(uv)*gv;
-        }
+// a candidate for one of the strongest autocorrelations at a given lag
+struct AutocorrelationMax
+{
+  float Value;
+  int Lag;            // the lag - 1
+  int Position[3];
+};
 
-        auto u = v.lift(3, offset);
-        values(u) = gv;
-        });
-      }
-    else
+// orders by value and then position, the largest first
+bool operator>(const AutocorrelationMax &lhs, const AutocorrelationMax &rhs)
+{
+  if (lhs.Value != rhs.Value)
+    return lhs.Value > rhs.Value;
+  return std::lexicographical_compare(rhs.Position, rhs.Position + 3,
+    lhs.Position, lhs.Position + 3);
+}
+
+// offer a candidate to a heap of the kMax strongest autocorrelations. the
+// heap keeps the weakest at the front
+void PushMax(std::vector<AutocorrelationMax> &heap, size_t kMax,
+  const AutocorrelationMax &cand)
+{
+  std::greater<AutocorrelationMax> compare;
+  if (heap.size() < kMax)
+    {
+    heap.push_back(cand);
+    std::push_heap(heap.begin(), heap.end(), compare);
+    }
+  else if ((kMax > 0) && (cand > heap[0]))
+    {
+    std::pop_heap(heap.begin(), heap.end(), compare);
+    heap.back() = cand;
+    std::push_heap(heap.begin(), heap.end(), compare);
+    }
+}
+
+// sums the autocorrelations of a block's points and finds the strongest,
+// accumulating per thread results over ranges of the points
+struct AutocorrelationReduce
+{
+  using HeapsType = std::vector<std::vector<AutocorrelationMax>>;
+
+  AutocorrelationReduce(const AutocorrelationEngine *engine,
+    const AutocorrelationImpl *block, size_t window, size_t kMax,
+    std::vector<float> &sums, HeapsType &heaps) : Engine(engine),
+    Block(block), Window(window), KMax(kMax), Sums(sums), Heaps(heaps) {}
+
+  void Initialize()
+    {
+    this->LocalSums.Local().assign(this->Window, 0.0f);
+    this->LocalHeaps.Local() = HeapsType(this->Window);
+    }
+
+  void operator()(svtkIdType i0, svtkIdType i1)
+    {
+    std::vector<float> &sums = this->LocalSums.Local();
+    HeapsType &heaps = this->LocalHeaps.Local();
+
+    for (svtkIdType i = i0; i < i1; ++i)
       {
-      // record the values
-      sdiy::for_each(g.shape(), [&](const Vertex& v)
+      for (size_t w = 0; w < this->Window; ++w)
         {
-        auto gv = g(v);
+        float val = this->Engine->GetCorrelation(this->Block->engineId, i, w + 1);
+        sums[w] += val;
 
-        for (size_t i = 1; i <= window; ++i)
-        {
-        if (i > count) continue;    // during the initial fill, we don't get contributions to some shifts
+        std::vector<AutocorrelationMax> &heap = heaps[w];
+        if ((heap.size() < this->KMax) ||
+          ((this->KMax > 0) && (val >= heap[0].Value)))
+          {
+          Vertex v = this->Block->vertex(i);
 
-        auto uc = v.lift(3, i-1);
-        auto uv = v.lift(3, (offset + window - i) % window);
-        corr(uc) += values(uv)*gv;
-        }
+          AutocorrelationMax cand;
+          cand.Value = val;
+          cand.Lag = w;
+          cand.Position[0] = v[0];
+          cand.Position[1] = v[1];
+          cand.Position[2] = v[2];
 
-        auto u = v.lift(3, offset);
-        values(u) = gv;
-        });
+          PushMax(heap, this->KMax, cand);
+          }
+        }
       }
-    offset += 1;
-    offset %= window;
-
-    ++count;
     }
 
-  size_t          window;
-  int             gid;
-  Vertex          from, to, shape;
-  Grid            values;     // circular buffer of last `window` values
-  Grid            corr;       // autocorrelations for different time shifts
-
-  size_t          offset = 0;
-  size_t          count  = 0;
+  void Reduce()
+    {
+    // the heaps hold the top kMax under a total order, so the result does
+    // not depend on how the points were split amongst the threads
+    auto sit = this->LocalSums.begin();
+    auto hit = this->LocalHeaps.begin();
+    for (; sit != this->LocalSums.end(); ++sit, ++hit)
+      {
+      for (size_t w = 0; w < this->Window; ++w)
+        {
+        this->Sums[w] += (*sit)[w];
+        for (const AutocorrelationMax &cand : (*hit)[w])
+          PushMax(this->Heaps[w], this->KMax, cand);
+        }
+      }
+    }
 
-private:
-  AutocorrelationImpl() {}        // here just for create; to let Master manage the blocks (+ if we choose to add OOC later)
+  const AutocorrelationEngine *Engine;
+  const AutocorrelationImpl *Block;
+  size_t Window;
+  size_t KMax;
+  std::vector<float> &Sums;
+  HeapsType &Heaps;
+  svtkSMPThreadLocal<std::vector<float>> LocalSums;
+  svtkSMPThreadLocal<HeapsType> LocalHeaps;
 };
 
 //-----------------------------------------------------------------------------
@@ -155,10 +214,35 @@ public:
   std::string ArrayName;
   size_t Window;
   bool BlocksInitialized;
-  size_t NumberOfBlocks;
+  int Mode;
+  int NumberOfThreads;
+  int OutputFrequency;
+  long StepCount;
+  std::unique_ptr<AutocorrelationEngine> Engine;
+
+  // the results of the last call to ComputeResults, valid on rank 0
+  std::vector<float> Sums;
+  std::vector<std::vector<AutocorrelationMax>> Maxima;
+
+  // the results of the last output step, see GetResults
+  svtkSmartPointer<SVTKDataAdaptor> Results;
 
   AInternals() : KMax(3), Association(svtkDataObject::POINT),
-    Window(10), BlocksInitialized(false), NumberOfBlocks(0) {}
+    Window(10), BlocksInitialized(false),
+    Mode(AutocorrelationEngine::MODE_DIRECT), NumberOfThreads(1),
+    OutputFrequency(0), StepCount(0) {}
+
+  // add a block to the decomposition and the engine
+  void AddBlock(int bid, const Vertex &from, const Vertex &to)
+    {
+    int engineId = this->Engine->AddBlock(
+      size_t(to[0] - from[0] + 1)*(to[1] - from[1] + 1)*(to[2] - from[2] + 1));
+
+    AutocorrelationImpl* b = new AutocorrelationImpl(this->Window, bid,
+      from, to, engineId);
+
+    this->Master->add(bid, b, new sdiy::Link);
+    }
 
   void InitializeBlocks(svtkDataObject* dobj)
     {
@@ -166,6 +250,9 @@ public:
       {
       return;
       }
+
+    this->Engine = make_unique<AutocorrelationEngine>(this->Window,
+      this->Mode, this->NumberOfThreads);
     if (svtkImageData* img = svtkImageData::SafeDownCast(dobj))
       {
       int ext[6];
@@ -181,9 +268,7 @@ public:
       Vertex from { ext[0], ext[2], ext[4] };
       Vertex to   { ext[1], ext[3], ext[5] };
       int bid = this->Master->communicator().rank();
-      AutocorrelationImpl* b = new AutocorrelationImpl(this->Window, bid, from, to);
-      this->Master->add(bid, b, new sdiy::Link);
-      this->NumberOfBlocks = this->Master->communicator().size();
+      this->AddBlock(bid, from, to);
       }
     else if (svtkCompositeDataSet* cd = svtkCompositeDataSet::SafeDownCast(dobj))
       {
@@ -210,16 +295,199 @@ public:
           Vertex from { ext[0], ext[2], ext[4] };
           Vertex to   { ext[1], ext[3], ext[5] };
 
-          AutocorrelationImpl* b = new AutocorrelationImpl(this->Window, bid, from, to);
-          this->Master->add(bid, b, new sdiy::Link);
+          this->AddBlock(bid, from, to);
           }
         }
-      this->NumberOfBlocks = bid;
       }
     this->BlocksInitialized = true;
     }
+
+  // reduce the sum over all points of each lag and the KMax strongest
+  // autocorrelations of each lag to rank 0. the local candidates are pruned
+  // using, for each lag, the largest of the ranks' KMax-th strongest value,
+  // which is known to be no larger than the global KMax-th strongest. only
+  // the survivors are sent. this is a collective call
+  int ComputeResults(MPI_Comm comm);
+
+  // package the results as a point set, the points are the positions of the
+  // strongest autocorrelations. only rank 0 has points
+  svtkPolyData *NewResultsMesh(MPI_Comm comm);
 };
 
+//-----------------------------------------------------------------------------
+int Autocorrelation::AInternals::ComputeResults(MPI_Comm comm)
+{
+  TimeEvent<128> mark("Autocorrelation::ComputeResults");
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  size_t window = this->Window;
+  size_t kMax = this->KMax;
+
+  // apply any steps buffered by the engine
+  if (this->Engine)
+    this->Engine->Flush();
+
+  // the local sums and strongest autocorrelations. the heaps keep the
+  // weakest of the candidates at the front
+  std::vector<float> sums(window, 0.0f);
+  std::vector<std::vector<AutocorrelationMax>> heaps(window);
+  std::greater<AutocorrelationMax> compare;
+
+  unsigned int nBlocks = this->Master ? this->Master->size() : 0;
+  for (unsigned int lid = 0; lid < nBlocks; ++lid)
+    {
+    AutocorrelationImpl *b = this->Master->block<AutocorrelationImpl>(lid);
+
+    std::vector<float> blockSums(window, 0.0f);
+
+    // the points are split amongst SENSEI's threads
+    AutocorrelationReduce reduce(this->Engine.get(), b, window, kMax,
+      blockSums, heaps);
+
+    SMPUtils::For(0, b->size(), 4096, reduce);
+
+    for (size_t w = 0; w < window; ++w)
+      sums[w] += blockSums[w];
+    }
+
+  // start the reduction of the sums, overlapping it with the pruning
+  MPI_Request sumReq = MPI_REQUEST_NULL;
+  MPI_Ireduce(rank == 0 ? MPI_IN_PLACE : sums.data(), sums.data(), window,
+    MPI_FLOAT, MPI_SUM, 0, comm, &sumReq);
+
+  // the per lag pruning thresholds
+  std::vector<float> thresholds(window, std::numeric_limits<float>::lowest());
+  for (size_t w = 0; w < window; ++w)
+    {
+    if ((kMax > 0) && (heaps[w].size() == kMax))
+      thresholds[w] = heaps[w][0].Value;
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, thresholds.data(), window, MPI_FLOAT,
+    MPI_MAX, comm);
+
+  // gather the candidates that survive to rank 0
+  std::vector<AutocorrelationMax> cands;
+  for (size_t w = 0; w < window; ++w)
+    {
+    for (const AutocorrelationMax &cand : heaps[w])
+      {
+      if (cand.Value >= thresholds[w])
+        cands.push_back(cand);
+      }
+    }
+
+  int nBytes = cands.size()*sizeof(AutocorrelationMax);
+
+  std::vector<int> counts;
+  std::vector<int> displs;
+  if (rank == 0)
+    {
+    counts.resize(nRanks);
+    displs.resize(nRanks);
+    }
+
+  MPI_Gather(&nBytes, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm);
+
+  std::vector<AutocorrelationMax> allCands;
+  if (rank == 0)
+    {
+    int total = 0;
+    for (int i = 0; i < nRanks; ++i)
+      {
+      displs[i] = total;
+      total += counts[i];
+      }
+    allCands.resize(total / sizeof(AutocorrelationMax));
+    }
+
+  MPI_Gatherv(cands.data(), nBytes, MPI_BYTE, allCands.data(),
+    counts.data(), displs.data(), MPI_BYTE, 0, comm);
+
+  MPI_Wait(&sumReq, MPI_STATUS_IGNORE);
+
+  // select the strongest
+  if (rank == 0)
+    {
+    this->Sums.swap(sums);
+
+    this->Maxima.assign(window, std::vector<AutocorrelationMax>());
+    for (const AutocorrelationMax &cand : allCands)
+      this->Maxima[cand.Lag].push_back(cand);
+
+    for (size_t w = 0; w < window; ++w)
+      {
+      std::vector<AutocorrelationMax> &maxs = this->Maxima[w];
+      std::sort(maxs.begin(), maxs.end(), compare);
+      if (maxs.size() > kMax)
+        maxs.resize(kMax);
+      }
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+svtkPolyData *Autocorrelation::AInternals::NewResultsMesh(MPI_Comm comm)
+{
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  svtkPolyData *pd = svtkPolyData::New();
+
+  svtkPoints *pts = svtkPoints::New();
+  pts->SetDataTypeToFloat();
+
+  svtkCellArray *verts = svtkCellArray::New();
+
+  svtkFloatArray *corr = svtkFloatArray::New();
+  corr->SetName("autocorrelation");
+
+  svtkIntArray *lag = svtkIntArray::New();
+  lag->SetName("lag");
+
+  svtkFloatArray *sums = svtkFloatArray::New();
+  sums->SetName("autocorrelation_sum");
+
+  if (rank == 0)
+    {
+    size_t window = this->Maxima.size();
+    for (size_t w = 0; w < window; ++w)
+      {
+      for (const AutocorrelationMax &max : this->Maxima[w])
+        {
+        svtkIdType id = pts->InsertNextPoint(max.Position[0],
+          max.Position[1], max.Position[2]);
+        verts->InsertNextCell(1, &id);
+        corr->InsertNextValue(max.Value);
+        lag->InsertNextValue(max.Lag + 1);
+        }
+      }
+
+    size_t nSums = this->Sums.size();
+    for (size_t w = 0; w < nSums; ++w)
+      sums->InsertNextValue(this->Sums[w]);
+    }
+
+  pd->SetPoints(pts);
+  pd->SetVerts(verts);
+  pd->GetPointData()->AddArray(corr);
+  pd->GetPointData()->AddArray(lag);
+  pd->GetFieldData()->AddArray(sums);
+
+  pts->Delete();
+  verts->Delete();
+  corr->Delete();
+  lag->Delete();
+  sums->Delete();
+
+  return pd;
+}
+
 //-----------------------------------------------------------------------------
 senseiNewMacro(Autocorrelation);
 
@@ -243,6 +511,8 @@ void Autocorrelation::Initialize(size_t window, const std::string &meshName,
 
   AInternals& internals = (*this->Internals);
 
+  numThreads = SMPUtils::GetNumberOfThreads(numThreads);
+
   internals.Master = make_unique<sdiy::Master>(this->GetCommunicator(),
     numThreads, -1, &AutocorrelationImpl::create, &AutocorrelationImpl::destroy);
 
@@ -251,6 +521,53 @@ void Autocorrelation::Initialize(size_t window, const std::string &meshName,
   internals.ArrayName = arrayname;
   internals.Window = window;
   internals.KMax = kmax;
+  internals.NumberOfThreads = numThreads;
+}
+
+//-----------------------------------------------------------------------------
+int Autocorrelation::SetMode(int mode)
+{
+  if ((mode != Autocorrelation::MODE_DIRECT) && (mode != Autocorrelation::MODE_FFT))
+    {
+    SENSEI_ERROR("Invalid mode " << mode)
+    return -1;
+    }
+
+  this->Internals->Mode = mode == Autocorrelation::MODE_FFT ?
+    AutocorrelationEngine::MODE_FFT : AutocorrelationEngine::MODE_DIRECT;
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void Autocorrelation::SetOutputFrequency(int numberOfSteps)
+{
+  this->Internals->OutputFrequency = numberOfSteps;
+}
+
+//-----------------------------------------------------------------------------
+int Autocorrelation::SetMode(std::string modeStr)
+{
+  unsigned int n = modeStr.size();
+  for (unsigned int i = 0; i < n; ++i)
+    modeStr[i] = tolower(modeStr[i]);
+
+  int mode = 0;
+  if (modeStr == "direct")
+    {
+    mode = Autocorrelation::MODE_DIRECT;
+    }
+  else if (modeStr == "fft")
+    {
+    mode = Autocorrelation::MODE_FFT;
+    }
+  else
+    {
+    SENSEI_ERROR("invalid mode \"" << modeStr << "\"")
+    return -1;
+    }
+
+  return this->SetMode(mode);
 }
 
 //-----------------------------------------------------------------------------
@@ -258,7 +575,7 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
 {
   TimeEvent<128> mark("Autocorrelation::Execute");
 
-  // we do not return anything
+  // results are returned only when requested
   if (dataOut)
     {
     *dataOut = nullptr;
@@ -336,7 +653,8 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
           dataObj->GetCellData()->GetArray("svtkGhostType"));
         if (fa)
           {
-          corr->process(fa->GetPointer(0), gc ? gc->GetPointer(0) : nullptr);
+          internals.Engine->Process(corr->engineId, fa->GetPointer(0),
+            gc ? gc->GetPointer(0) : nullptr);
           }
         else
           {
@@ -357,7 +675,8 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
       ds->GetCellData()->GetArray("svtkGhostType"));
     if (fa)
       {
-      corr->process(fa->GetPointer(0), gc ? gc->GetPointer(0) : nullptr);
+      internals.Engine->Process(corr->engineId, fa->GetPointer(0),
+        gc ? gc->GetPointer(0) : nullptr);
       }
     else
       {
@@ -368,118 +687,71 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
 
   mesh->Delete();
 
+  // make the current results available. they are not returned through
+  // dataOut, which callers such as the oscillator miniapp treat as steering
+  // data
+  internals.StepCount += 1;
+  internals.Results = nullptr;
+  if ((internals.OutputFrequency > 0) &&
+    ((internals.StepCount % internals.OutputFrequency) == 0))
+    {
+    MPI_Comm comm = this->GetCommunicator();
+
+    internals.ComputeResults(comm);
+
+    svtkPolyData *pd = internals.NewResultsMesh(comm);
+
+    internals.Results = svtkSmartPointer<SVTKDataAdaptor>::New();
+    internals.Results->SetCommunicator(comm);
+    internals.Results->SetDataTime(dataIn->GetDataTime());
+    internals.Results->SetDataTimeStep(dataIn->GetDataTimeStep());
+    internals.Results->SetDataObject("autocorrelation", pd);
+    pd->Delete();
+    }
+
   return true;
 }
 
+//-----------------------------------------------------------------------------
+DataAdaptor *Autocorrelation::GetResults()
+{
+  return this->Internals ? this->Internals->Results : nullptr;
+}
+
 //-----------------------------------------------------------------------------
 void Autocorrelation::PrintResults(size_t k_max)
 {
   TimeEvent<128> mark("Autocorrelation::PrintResults");
 
   AInternals& internals = (*this->Internals);
-  size_t nblocks = internals.NumberOfBlocks;
-
-    // add up the autocorrellations
-  internals.Master->foreach([](AutocorrelationImpl* b, const sdiy::Master::ProxyWithLink& cp)
-                                     {
-                                        std::vector<float> sums(b->window, 0);
-                                        sdiy::for_each(b->corr.shape(), [&](const Vertex4D& v)
-                                        {
-                                            size_t w = v[3];
-                                            sums[w] += b->corr(v);
-                                        });
-
-                                        cp.all_reduce(sums, add_vectors<float>());
-                                     });
-  internals.Master->exchange();
-  if (internals.Master->communicator().rank() == 0)
+  internals.KMax = k_max;
+
+  MPI_Comm comm = this->GetCommunicator();
+  internals.ComputeResults(comm);
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  if (rank == 0)
     {
     // print out the autocorrelations
-    auto result = internals.Master->proxy(0).get<std::vector<float>>();
     std::cerr << "Autocorrelations:";
-    for (size_t i = 0; i < result.size(); ++i)
-      std::cerr << ' ' << result[i];
+    for (size_t i = 0; i < internals.Sums.size(); ++i)
+      std::cerr << ' ' << internals.Sums[i];
     std::cerr << std::endl;
-    }
 
-  internals.Master->foreach(
-    [](AutocorrelationImpl*, const sdiy::Master::ProxyWithLink& cp)
-    {
-    cp.collectives()->clear();
-    });
-
-
-  // select k strongest autocorrelations for each shift
-  sdiy::ContiguousAssigner     assigner(internals.Master->communicator().size(), nblocks);     // NB: this is coupled to main(...) in oscillator.cpp
-  sdiy::RegularDecomposer<sdiy::DiscreteBounds> decomposer(1, sdiy::interval(0, nblocks-1), nblocks);
-  sdiy::RegularMergePartners   partners(decomposer, 2);
-  //sdiy::RegularMergePartners   partners(3, nblocks, 2, true);
-  sdiy::reduce(*internals.Master, assigner, partners,
-              [k_max](void* b_, const sdiy::ReduceProxy& rp, const sdiy::RegularMergePartners&)
-              {
-                  AutocorrelationImpl* b = static_cast<AutocorrelationImpl*>(b_);
-                  //unsigned round = rp.round(); // current round number
-
-                  using MaxHeapVector = std::vector<std::vector<std::tuple<float,Vertex>>>;
-                  using Compare       = std::greater<std::tuple<float,Vertex>>;
-                  MaxHeapVector maxs(b->window);
-                  if (rp.in_link().size() == 0)
-                  {
-                      sdiy::for_each(b->corr.shape(), [&](const Vertex4D& v)
-                      {
-                          size_t offset = v[3];
-                          float val = b->corr(v);
-                          auto& max = maxs[offset];
-                          if (max.size() < k_max)
-                          {
-                              max.emplace_back(val, v.drop(3) + b->from);
-                              std::push_heap(max.begin(), max.end(), Compare());
-                          } else if (val > std::get<0>(max[0]))
-                          {
-                              std::pop_heap(max.begin(), max.end(), Compare());
-                              maxs[offset].back() = std::make_tuple(val, v.drop(3) + b->from);
-                              std::push_heap(max.begin(), max.end(), Compare());
-                          }
-                      });
-                  } else
-                  {
-                      for (long i = 0; i < rp.in_link().size(); ++i)
-                      {
-                          MaxHeapVector in_heaps;
-                          rp.dequeue(rp.in_link().target(i).gid, in_heaps);
-                          for (size_t j = 0; j < in_heaps.size(); ++j)
-                          {
-                              for (auto& x : in_heaps[j])
-                                  maxs[j].push_back(x);
-                          }
-                      }
-                      for (size_t j = 0; j < maxs.size(); ++j)
-                      {
-                          auto& max = maxs[j];
-                          std::make_heap(max.begin(), max.end(), Compare());
-                          while(max.size() > k_max)
-                          {
-                              std::pop_heap(max.begin(), max.end(), Compare());
-                              max.pop_back();
-                          }
-                      }
-                  }
-
-                  if (rp.out_link().size() > 0)
-                      rp.enqueue(rp.out_link().target(0), maxs);
-                  else
-                  {
-                      // print out the answer
-                      for (size_t i = 0; i < maxs.size(); ++i)
-                      {
-                          std::sort(maxs[i].begin(), maxs[i].end(), Compare());
-                          std::cerr << "Max autocorrelations for " << i << ":";
-                          for (auto& x : maxs[i])
-                              std::cerr << " (" << std::get<0>(x) << " at " << std::get<1>(x) << ")";
-                          std::cerr << std::endl;
-                      }
-                  }
-              });
+    // print out the strongest autocorrelations of each lag
+    for (size_t i = 0; i < internals.Maxima.size(); ++i)
+      {
+      std::cerr << "Max autocorrelations for " << i << ":";
+      for (const AutocorrelationMax &x : internals.Maxima[i])
+        {
+        std::cerr << " (" << x.Value << " at " << x.Position[0] << ' '
+          << x.Position[1] << ' ' << x.Position[2] << ")";
+        }
+      std::cerr << std::endl;
+      }
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -7,7 +7,12 @@
 
 namespace sensei
 {
-/// Performs a temporal autocorrelation on the simulation data
+/** Performs a temporal autocorrelation on the simulation data. The lagged
+ * products of each point are accumulated by a sensei::AutocorrelationEngine
+ * using a team of threads across the points of each block. For large windows
+ * the FFT mode, which buffers a batch of steps and updates all lags in Fourier
+ * space, is faster than the default direct mode.
+ */
 class SENSEI_EXPORT Autocorrelation : public AnalysisAdaptor
 {
 public:
@@ -26,14 +31,53 @@ public:
    * @param arrayName together with \c association, identifies the array to
    *         compute autocorrelation for.
    * @param kMax number of strongest autocorrelations to report
-   * @param numThreads number of threads in sdiy's thread pool
+   * @param numThreads number of threads in sdiy's thread pool, and used
+   *        across the points of each block. less than one uses the count
+   *        configured by SMPUtils::Initialize
    */
   void Initialize(size_t window, const std::string &meshName,
     int association, const std::string &arrayName, size_t kMax,
     int numThreads = 1);
 
-  /// Incrementally computes autocorrelation on the current simulation state
-  bool Execute(DataAdaptor* data, DataAdaptor**) override;
+  /// Methods of computing the autocorrelation.
+  enum {MODE_DIRECT=0, MODE_FFT=1};
+
+  /** Sets the method of computing the autocorrelation. MODE_DIRECT, the
+   * default, updates all lags each step. MODE_FFT buffers steps and updates
+   * all lags at once in Fourier space. This must be called before the first
+   * call to Execute.
+   */
+  int SetMode(int mode);
+
+  /// Sets the mode by string, either "direct" or "fft".
+  int SetMode(std::string mode);
+
+  /** Sets how often, in steps, the results are computed by Execute and made
+   * available by GetResults. When 0, the default, results are only reported
+   * by Finalize. Computing the results uses MPI collectives, the same
+   * frequency must be set on all ranks.
+   */
+  void SetOutputFrequency(int numberOfSteps);
+
+  /** Incrementally computes autocorrelation on the current simulation state.
+   * Nothing is returned through dataOut. The strongest autocorrelations are
+   * found with a reduction that prunes each rank's candidates using global
+   * per lag thresholds, so that only candidates that may be amongst the
+   * strongest are communicated.
+   */
+  bool Execute(DataAdaptor* data, DataAdaptor** dataOut) override;
+
+  /** Get the results computed by the last call to Execute, or nullptr when
+   * that step was not an output step. The results are a
+   * sensei::SVTKDataAdaptor with a mesh named "autocorrelation". This is a
+   * point set, with points on MPI rank 0 only, placed at the positions of the
+   * k-max strongest autocorrelations of each lag. The point data arrays
+   * "autocorrelation" and "lag" hold their values and lags, and the field
+   * data array "autocorrelation_sum" the sum over all points of each lag.
+   * The adaptor is owned by this instance and is valid until the next call
+   * to Execute or Finalize.
+   */
+  DataAdaptor *GetResults();
 
   /// Finishes the calculation and dumps the results
   int Finalize() override;
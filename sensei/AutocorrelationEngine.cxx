@@ -0,0 +1,368 @@
+#include "AutocorrelationEngine.h"
+#include "ThreadPool.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <future>
+#include <vector>
+
+namespace sensei
+{
+
+namespace AutocorrelationEngineCPU
+{
+// the number of points processed by a thread at a time
+constexpr size_t ChunkSize = 1024;
+
+using complex_t = std::complex<double>;
+
+/// returns the smallest power of 2 greater than or equal to n
+size_t next_pow2(size_t n)
+{
+  size_t p = 1;
+  while (p < n)
+    p *= 2;
+  return p;
+}
+
+/** An in place iterative radix 2 FFT.
+ *
+ * @param[in,out] a    the sequence to transform, of length n
+ * @param[in] n        the length of the sequence, a power of 2
+ * @param[in] rev      the bit reversal permutation of 0 to n - 1
+ * @param[in] tw       the twiddle factors exp(-2 pi i k / n) for k < n / 2
+ * @param[in] inverse  if set the unnormalized inverse transform is computed
+ */
+void fft(complex_t *a, size_t n, const size_t *rev, const complex_t *tw,
+  bool inverse)
+{
+  for (size_t i = 0; i < n; ++i)
+    {
+    if (i < rev[i])
+      std::swap(a[i], a[rev[i]]);
+    }
+
+  for (size_t len = 2; len <= n; len *= 2)
+    {
+    size_t half = len / 2;
+    size_t step = n / len;
+    for (size_t i = 0; i < n; i += len)
+      {
+      for (size_t j = 0; j < half; ++j)
+        {
+        complex_t w = inverse ? std::conj(tw[j*step]) : tw[j*step];
+        complex_t u = a[i + j];
+        complex_t v = a[i + j + half] * w;
+        a[i + j] = u + v;
+        a[i + j + half] = u - v;
+        }
+      }
+    }
+}
+}
+
+// the time history and autocorrelation of the points of a block
+struct AutocorrelationEngine::BlockType
+{
+  BlockType() : NumberOfPoints(0), Offset(0), Count(0), NumberBuffered(0) {}
+
+  size_t NumberOfPoints;
+  size_t Offset;          // MODE_DIRECT, the next position in the history
+  size_t Count;           // the number of steps processed
+  size_t NumberBuffered;  // MODE_FFT, the number of steps in the batch
+
+  // MODE_DIRECT, a circular buffer of 2 window values per point where each
+  // value is stored twice, window apart, so that the previous window values
+  // are contiguous starting at Offset. MODE_FFT, the previous window values
+  // followed by the batch, window + batch size values per point.
+  std::vector<float> History;
+
+  // window values per point, value k is the autocorrelation at lag window - k
+  std::vector<float> Correlation;
+};
+
+// the FFT plan
+struct AutocorrelationEngine::FFTType
+{
+  std::vector<size_t> Reverse;
+  std::vector<AutocorrelationEngineCPU::complex_t> Twiddle;
+};
+
+// --------------------------------------------------------------------------
+AutocorrelationEngine::AutocorrelationEngine(size_t window, int mode,
+  int numberOfThreads) : Window(std::max(size_t(1), window)),
+  Mode(mode == MODE_FFT ? MODE_FFT : MODE_DIRECT),
+  NumberOfThreads(std::max(1, numberOfThreads)), FFTSize(0), BatchSize(1)
+{
+  if (this->Mode == MODE_FFT)
+    {
+    // the batch fills the transform not needed for the history
+    size_t n = AutocorrelationEngineCPU::next_pow2(2*this->Window);
+    this->FFTSize = n;
+    this->BatchSize = n - this->Window;
+
+    this->FFT.reset(new FFTType);
+
+    unsigned int nBits = 0;
+    while ((size_t(1) << nBits) < n)
+      ++nBits;
+
+    this->FFT->Reverse.resize(n);
+    for (size_t i = 0; i < n; ++i)
+      {
+      size_t r = 0;
+      for (unsigned int b = 0; b < nBits; ++b)
+        r |= ((i >> b) & 1) << (nBits - 1 - b);
+      this->FFT->Reverse[i] = r;
+      }
+
+    this->FFT->Twiddle.resize(n / 2);
+    for (size_t k = 0; k < n / 2; ++k)
+      this->FFT->Twiddle[k] = std::polar(1.0, -2.0*M_PI*double(k)/double(n));
+    }
+
+  // the calling thread is one of the team
+  if (this->NumberOfThreads > 1)
+    this->Pool.reset(new ThreadPool(this->NumberOfThreads - 1));
+}
+
+// --------------------------------------------------------------------------
+AutocorrelationEngine::~AutocorrelationEngine()
+{}
+
+// --------------------------------------------------------------------------
+int AutocorrelationEngine::AddBlock(size_t numberOfPoints)
+{
+  BlockType block;
+  block.NumberOfPoints = numberOfPoints;
+
+  size_t historySize = this->Mode == MODE_FFT ?
+    this->Window + this->BatchSize : 2*this->Window;
+
+  block.History.resize(numberOfPoints*historySize, 0.0f);
+  block.Correlation.resize(numberOfPoints*this->Window, 0.0f);
+
+  this->Blocks.push_back(std::move(block));
+
+  return this->Blocks.size() - 1;
+}
+
+// --------------------------------------------------------------------------
+size_t AutocorrelationEngine::GetNumberOfBlocks() const
+{
+  return this->Blocks.size();
+}
+
+// --------------------------------------------------------------------------
+size_t AutocorrelationEngine::GetNumberOfPoints(int blockId) const
+{
+  return this->Blocks[blockId].NumberOfPoints;
+}
+
+// --------------------------------------------------------------------------
+float AutocorrelationEngine::GetCorrelation(int blockId, size_t point,
+  size_t lag) const
+{
+  const BlockType &block = this->Blocks[blockId];
+  return block.Correlation[point*this->Window + this->Window - lag];
+}
+
+// --------------------------------------------------------------------------
+void AutocorrelationEngine::Run(size_t numberOfPoints,
+  const std::function<void(int, size_t, size_t)> &func)
+{
+  size_t chunkSize = AutocorrelationEngineCPU::ChunkSize;
+  size_t nChunks = (numberOfPoints + chunkSize - 1) / chunkSize;
+
+  std::atomic<size_t> next(0);
+
+  auto work = [&](int tid)
+    {
+    for (size_t i = next++; i < nChunks; i = next++)
+      func(tid, i*chunkSize, std::min(numberOfPoints, (i + 1)*chunkSize));
+    };
+
+  int nThreads = std::min(size_t(this->NumberOfThreads), nChunks);
+
+  std::vector<std::future<void>> results;
+  for (int i = 1; i < nThreads; ++i)
+    results.push_back(this->Pool->Push([&work, i]() { work(i); }));
+
+  work(0);
+
+  for (auto &result : results)
+    result.wait();
+}
+
+// --------------------------------------------------------------------------
+int AutocorrelationEngine::Process(int blockId, const float *data,
+  const unsigned char *ghosts)
+{
+  if ((blockId < 0) || (size_t(blockId) >= this->Blocks.size()))
+    {
+    SENSEI_ERROR("Invalid block id " << blockId)
+    return -1;
+    }
+
+  if (!data)
+    {
+    SENSEI_ERROR("No data was provided for block " << blockId)
+    return -1;
+    }
+
+  if (this->Mode == MODE_FFT)
+    this->ProcessFFT(blockId, data, ghosts);
+  else
+    this->ProcessDirect(blockId, data, ghosts);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void AutocorrelationEngine::ProcessDirect(int blockId, const float *data,
+  const unsigned char *ghosts)
+{
+  BlockType &block = this->Blocks[blockId];
+
+  size_t window = this->Window;
+  size_t offset = block.Offset;
+
+  // during the initial fill there are no contributions to the larger lags
+  size_t j0 = block.Count < window ? window - block.Count : 0;
+
+  float *history = block.History.data();
+  float *correlation = block.Correlation.data();
+
+  this->Run(block.NumberOfPoints, [&](int, size_t p0, size_t p1)
+    {
+    for (size_t p = p0; p < p1; ++p)
+      {
+      float val = (ghosts && ghosts[p]) ? 0.0f : data[p];
+
+      float *buf = history + 2*window*p;
+      float *corr = correlation + window*p;
+
+      // the previous values, oldest first, line up with the lags, largest
+      // first
+      const float *prev = buf + offset;
+      for (size_t j = j0; j < window; ++j)
+        corr[j] += prev[j]*val;
+
+      buf[offset] = val;
+      buf[offset + window] = val;
+      }
+    });
+
+  block.Offset = (offset + 1) % window;
+  block.Count += 1;
+}
+
+// --------------------------------------------------------------------------
+void AutocorrelationEngine::ProcessFFT(int blockId, const float *data,
+  const unsigned char *ghosts)
+{
+  BlockType &block = this->Blocks[blockId];
+
+  size_t historySize = this->Window + this->BatchSize;
+  float *dest = block.History.data() + this->Window + block.NumberBuffered;
+
+  this->Run(block.NumberOfPoints, [&](int, size_t p0, size_t p1)
+    {
+    for (size_t p = p0; p < p1; ++p)
+      dest[historySize*p] = (ghosts && ghosts[p]) ? 0.0f : data[p];
+    });
+
+  block.NumberBuffered += 1;
+  block.Count += 1;
+
+  if (block.NumberBuffered == this->BatchSize)
+    this->FlushFFT(blockId);
+}
+
+// --------------------------------------------------------------------------
+void AutocorrelationEngine::FlushFFT(int blockId)
+{
+  using AutocorrelationEngineCPU::complex_t;
+
+  BlockType &block = this->Blocks[blockId];
+
+  size_t nBuf = block.NumberBuffered;
+  if (nBuf == 0)
+    return;
+
+  size_t window = this->Window;
+  size_t historySize = window + this->BatchSize;
+  size_t n = this->FFTSize;
+
+  const size_t *rev = this->FFT->Reverse.data();
+  const complex_t *tw = this->FFT->Twiddle.data();
+
+  float *history = block.History.data();
+  float *correlation = block.Correlation.data();
+
+  // per thread scratch space
+  std::vector<std::vector<complex_t>> scratch(this->NumberOfThreads);
+
+  this->Run(block.NumberOfPoints, [&](int tid, size_t p0, size_t p1)
+    {
+    std::vector<complex_t> &tmp = scratch[tid];
+    tmp.resize(2*n);
+    complex_t *a = tmp.data();
+    complex_t *b = a + n;
+
+    for (size_t p = p0; p < p1; ++p)
+      {
+      float *y = history + historySize*p;
+      float *corr = correlation + window*p;
+
+      // the contribution of the batch to lag l is the sum over the batch of
+      // z[k] y[window + k - l], where z is the batch and y the history
+      // followed by the batch. this is the cross correlation
+      // r[m] = sum z[k] y[k + m] at m = window - l, which lines up with the
+      // storage of the lags. y is transformed in the real part and z in the
+      // imaginary part.
+      size_t ny = window + nBuf;
+      for (size_t i = 0; i < n; ++i)
+        a[i] = complex_t(i < ny ? y[i] : 0.0, i < nBuf ? y[window + i] : 0.0);
+
+      AutocorrelationEngineCPU::fft(a, n, rev, tw, false);
+
+      // separate the transforms of the real sequences and multiply
+      for (size_t k = 0; k < n; ++k)
+        {
+        complex_t ak = a[k];
+        complex_t bk = std::conj(a[(n - k) & (n - 1)]);
+        complex_t yk = 0.5*(ak + bk);
+        complex_t zk = complex_t(0.0, -0.5)*(ak - bk);
+        b[k] = std::conj(zk)*yk;
+        }
+
+      AutocorrelationEngineCPU::fft(b, n, rev, tw, true);
+
+      for (size_t m = 0; m < window; ++m)
+        corr[m] += float(b[m].real() / n);
+
+      // the last window values become the history
+      std::copy(y + nBuf, y + nBuf + window, y);
+      }
+    });
+
+  block.NumberBuffered = 0;
+}
+
+// --------------------------------------------------------------------------
+int AutocorrelationEngine::Flush()
+{
+  if (this->Mode == MODE_FFT)
+    {
+    size_t nBlocks = this->Blocks.size();
+    for (size_t i = 0; i < nBlocks; ++i)
+      this->FlushFFT(i);
+    }
+  return 0;
+}
+
+}
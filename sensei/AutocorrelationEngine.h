@@ -0,0 +1,111 @@
+#ifndef AutocorrelationEngine_h
+#define AutocorrelationEngine_h
+
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace sensei
+{
+class ThreadPool;
+
+/// Streaming temporal autocorrelation of the points of many data blocks
+/** Accumulates, for each point of each block, the sum over time of the
+ * product of the point's value with its value 1 to window steps earlier.
+ * The time history of each point is stored contiguously so that the update
+ * of all lags is a contiguous multiply-add that can be vectorized, and the
+ * points of a block are split into chunks which are processed by a team of
+ * threads.
+ *
+ * Two modes are supported. MODE_DIRECT updates all lags each step, costing
+ * O(window) per point per step. MODE_FFT buffers a batch of steps and
+ * computes the contribution of the batch to all lags with a cross
+ * correlation in Fourier space, costing O(log window) per point per step,
+ * which is faster for large windows. In MODE_FFT the results are complete
+ * only after Flush has been called.
+ *
+ * Call the methods in the following order:
+ *
+ * AddBlock (once per local data block)
+ * Process (once per local data block each step)
+ * Flush
+ * GetCorrelation
+ *
+ * All methods returning int return 0 if successful.
+ */
+class AutocorrelationEngine
+{
+public:
+  /// The supported methods of computing the autocorrelation
+  enum {MODE_DIRECT=0, MODE_FFT=1};
+
+  AutocorrelationEngine() = delete;
+  AutocorrelationEngine(const AutocorrelationEngine&) = delete;
+  void operator=(const AutocorrelationEngine&) = delete;
+
+  /** Creates an engine computing lags 1 to window with the given mode using
+   * numberOfThreads threads */
+  AutocorrelationEngine(size_t window, int mode, int numberOfThreads);
+
+  ~AutocorrelationEngine();
+
+  /// get the number of threads used
+  int GetNumberOfThreads() const { return this->NumberOfThreads; }
+
+  /// get the number of steps buffered between updates in MODE_FFT
+  size_t GetBatchSize() const { return this->BatchSize; }
+
+  /** add a block with the given number of points. returns the id of the
+   * block, or -1 if an error occurred */
+  int AddBlock(size_t numberOfPoints);
+
+  /// get the number of blocks
+  size_t GetNumberOfBlocks() const;
+
+  /// get the number of points in a block
+  size_t GetNumberOfPoints(int blockId) const;
+
+  /** update the autocorrelation of a block with the current step's values.
+   * values where ghosts is non-zero are treated as 0. ghosts may be nullptr
+   */
+  int Process(int blockId, const float *data, const unsigned char *ghosts);
+
+  /// apply the buffered steps in MODE_FFT, does nothing in MODE_DIRECT
+  int Flush();
+
+  /** get the autocorrelation of a point at the given lag, where lag is in
+   * 1 to window */
+  float GetCorrelation(int blockId, size_t point, size_t lag) const;
+
+private:
+  /// update the lags of a block for one step, MODE_DIRECT
+  void ProcessDirect(int blockId, const float *data, const unsigned char *ghosts);
+
+  /// buffer one step of a block, MODE_FFT
+  void ProcessFFT(int blockId, const float *data, const unsigned char *ghosts);
+
+  /// update the lags of a block with the buffered steps, MODE_FFT
+  void FlushFFT(int blockId);
+
+  /** run the function on the team of threads over the points of a block and
+   * wait for completion. The function is passed the thread's rank and a
+   * range of points */
+  void Run(size_t numberOfPoints,
+    const std::function<void(int, size_t, size_t)> &func);
+
+  struct BlockType;
+  struct FFTType;
+
+private:
+  size_t Window;
+  int Mode;
+  int NumberOfThreads;
+  size_t FFTSize;
+  size_t BatchSize;
+  std::vector<BlockType> Blocks;
+  std::unique_ptr<FFTType> FFT;
+  std::unique_ptr<ThreadPool> Pool;
+};
+
+}
+#endif
@@ -0,0 +1,720 @@
+#include "CachingDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAbstractArray.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkFieldData.h>
+#include <svtkObjectFactory.h>
+#include <svtkSmartPointer.h>
+#include <svtkWeakPointer.h>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <tuple>
+#include <utility>
+
+using svtkDataObjectPtr = svtkSmartPointer<svtkDataObject>;
+using svtkCompositeDataIteratorPtr = svtkSmartPointer<svtkCompositeDataIterator>;
+
+namespace
+{
+// (mesh name, structure only)
+using MeshKey = std::pair<std::string, bool>;
+
+// (mesh name, structure only, association, array name)
+using ArrayKey = std::tuple<std::string, bool, int, std::string>;
+
+// **************************************************************************
+svtkDataObject *NewShallowCopy(svtkDataObject *dobj)
+{
+  if (!dobj)
+    return nullptr;
+
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj))
+    {
+    // copy the tree, sharing the arrays but not the leaves, so that arrays
+    // added by the caller do not end up in the cached mesh
+    svtkCompositeDataSet *cdo = cd->NewInstance();
+    cdo->CopyStructure(cd);
+
+    svtkCompositeDataIteratorPtr cdit;
+    cdit.TakeReference(cd->NewIterator());
+    for (cdit->InitTraversal(); !cdit->IsDoneWithTraversal(); cdit->GoToNextItem())
+      {
+      svtkDataObject *leaf = cd->GetDataSet(cdit);
+      svtkDataObject *leafo = leaf->NewInstance();
+      leafo->ShallowCopy(leaf);
+      cdo->SetDataSet(cdit, leafo);
+      leafo->Delete();
+      }
+
+    cdo->GetFieldData()->ShallowCopy(cd->GetFieldData());
+
+    return cdo;
+    }
+
+  svtkDataObject *dobjo = dobj->NewInstance();
+  dobjo->ShallowCopy(dobj);
+  return dobjo;
+}
+
+// **************************************************************************
+bool IsSubset(const sensei::MeshMetadataFlags &flags,
+  const sensei::MeshMetadataFlags &cached)
+{
+  return !((flags.BlockDecompSet() && !cached.BlockDecompSet()) ||
+    (flags.BlockSizeSet() && !cached.BlockSizeSet()) ||
+    (flags.BlockExtentsSet() && !cached.BlockExtentsSet()) ||
+    (flags.BlockBoundsSet() && !cached.BlockBoundsSet()) ||
+    (flags.BlockArrayRangeSet() && !cached.BlockArrayRangeSet()));
+}
+
+// **************************************************************************
+sensei::MeshMetadataFlags Union(const sensei::MeshMetadataFlags &a,
+  const sensei::MeshMetadataFlags &b)
+{
+  sensei::MeshMetadataFlags flags(a);
+
+  if (b.BlockDecompSet())
+    flags.SetBlockDecomp();
+
+  if (b.BlockSizeSet())
+    flags.SetBlockSize();
+
+  if (b.BlockExtentsSet())
+    flags.SetBlockExtents();
+
+  if (b.BlockBoundsSet())
+    flags.SetBlockBounds();
+
+  if (b.BlockArrayRangeSet())
+    flags.SetBlockArrayRange();
+
+  return flags;
+}
+}
+
+namespace sensei
+{
+
+struct CachingDataAdaptor::InternalsType
+{
+  InternalsType() : Source(), Valid(false), TimeStep(0), Time(0.0),
+    Generation(0), HaveMetadata(false), Hits(0), Misses(0) {}
+
+  // invalidate the cache if the source moved on to a new step
+  void Update();
+
+  // releases all cached data and reports statistics
+  void Clear();
+
+  // locate the key of a mesh handed out by this instance
+  int GetMeshKey(svtkDataObject *mesh, MeshKey &key);
+
+  // copy a cached array from the cached mesh into the caller's mesh
+  int CopyArray(svtkDataObject *cached, svtkDataObject *mesh,
+    int association, const std::string &arrayName);
+
+  // serve a request for the key. the first request for a key calls fetch,
+  // which calls the source, with the cache unlocked and the source locked.
+  // store is then called with the cache locked to add the result to the
+  // cache. requests for the key made in the meantime wait for the result
+  // without holding the lock. the lock must be held by the caller.
+  template <typename key_t>
+  int Request(std::unique_lock<std::mutex> &lock,
+    std::map<key_t, std::shared_future<int>> &requests, const key_t &key,
+    const std::function<int()> &fetch, const std::function<int()> &store);
+
+  // serve a request to add an array to a mesh. add is called to add the
+  // array to the mesh passed to it.
+  int AddArray(svtkDataObject *mesh, int association,
+    const std::string &arrayName, const char *eventName,
+    const std::function<int(DataAdaptor*, svtkDataObject*)> &add);
+
+  // serializes access to the cache from analyses running concurrently
+  std::mutex Mutex;
+
+  // serializes calls to the source, which need not be thread safe
+  std::mutex SourceMutex;
+
+  svtkSmartPointer<DataAdaptor> Source;
+
+  bool Valid;
+  long TimeStep;
+  double Time;
+
+  // incremented when the cache is cleared. requests that were in flight
+  // when the cache was cleared are discarded.
+  unsigned long Generation;
+
+  std::map<MeshKey, svtkDataObjectPtr> Meshes;
+  std::map<MeshKey, std::shared_future<int>> MeshRequests;
+  std::map<ArrayKey, std::shared_future<int>> ArrayRequests;
+
+  // meshes handed out in the current step. weak pointers are used to
+  // detect addresses that have been recycled after the caller deleted
+  // the mesh.
+  std::map<svtkDataObject*, std::pair<svtkWeakPointer<svtkDataObject>, MeshKey>> Issued;
+
+  bool HaveMetadata;
+  std::vector<MeshMetadataPtr> Metadata;
+  std::vector<MeshMetadataFlags> MetadataFlags;
+
+  unsigned long Hits;
+  unsigned long Misses;
+};
+
+//----------------------------------------------------------------------------
+void CachingDataAdaptor::InternalsType::Update()
+{
+  long step = this->Source->GetDataTimeStep();
+  double time = this->Source->GetDataTime();
+
+  if (this->Valid && ((step != this->TimeStep) || (time != this->Time)))
+    this->Clear();
+
+  this->Valid = true;
+  this->TimeStep = step;
+  this->Time = time;
+}
+
+//----------------------------------------------------------------------------
+void CachingDataAdaptor::InternalsType::Clear()
+{
+  if (Profiler::Enabled() && (this->Hits || this->Misses))
+    {
+    Profiler::StartEvent("CachingDataAdaptor::Hits");
+    Profiler::EndEvent("CachingDataAdaptor::Hits", this->Hits);
+    Profiler::StartEvent("CachingDataAdaptor::Misses");
+    Profiler::EndEvent("CachingDataAdaptor::Misses", this->Misses);
+    }
+
+  this->Meshes.clear();
+  this->MeshRequests.clear();
+  this->ArrayRequests.clear();
+  this->Issued.clear();
+  this->Metadata.clear();
+  this->MetadataFlags.clear();
+  this->HaveMetadata = false;
+
+  this->Valid = false;
+  ++this->Generation;
+  this->Hits = 0;
+  this->Misses = 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::InternalsType::GetMeshKey(svtkDataObject *mesh,
+  MeshKey &key)
+{
+  auto it = this->Issued.find(mesh);
+  if ((it == this->Issued.end()) || (it->second.first.GetPointer() != mesh))
+    return -1;
+
+  key = it->second.second;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::InternalsType::CopyArray(svtkDataObject *cached,
+  svtkDataObject *mesh, int association, const std::string &arrayName)
+{
+  SVTKUtils::BinaryDatasetFunction copyArray =
+    [&](svtkDataSet *ds, svtkDataSet *dsOut) -> int
+    {
+    svtkFieldData *dsa = SVTKUtils::GetAttributes(ds, association);
+    svtkFieldData *dsaOut = SVTKUtils::GetAttributes(dsOut, association);
+
+    if (!dsa || !dsaOut)
+      return -1;
+
+    // not all blocks are required to have the array
+    if (svtkAbstractArray *aa = dsa->GetAbstractArray(arrayName.c_str()))
+      dsaOut->AddArray(aa);
+
+    return 0;
+    };
+
+  return SVTKUtils::Apply(cached, mesh, copyArray);
+}
+
+//----------------------------------------------------------------------------
+template <typename key_t>
+int CachingDataAdaptor::InternalsType::Request(
+  std::unique_lock<std::mutex> &lock,
+  std::map<key_t, std::shared_future<int>> &requests, const key_t &key,
+  const std::function<int()> &fetch, const std::function<int()> &store)
+{
+  unsigned long generation = this->Generation;
+
+  auto it = requests.find(key);
+  if (it != requests.end())
+    {
+    ++this->Hits;
+
+    std::shared_future<int> result = it->second;
+
+    lock.unlock();
+    int ierr = result.get();
+    lock.lock();
+
+    if (generation != this->Generation)
+      {
+      SENSEI_ERROR("The cache was invalidated while a request was served")
+      return -1;
+      }
+
+    return ierr;
+    }
+
+  ++this->Misses;
+
+  std::promise<int> promise;
+  requests[key] = promise.get_future().share();
+
+  lock.unlock();
+
+  int ierr = 0;
+    {
+    std::lock_guard<std::mutex> sourceLock(this->SourceMutex);
+    ierr = fetch();
+    }
+
+  lock.lock();
+
+  if (generation != this->Generation)
+    {
+    SENSEI_ERROR("The cache was invalidated while a request was served")
+    ierr = -1;
+    }
+  else if (!ierr)
+    {
+    ierr = store();
+    }
+
+  promise.set_value(ierr);
+
+  return ierr;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::InternalsType::AddArray(svtkDataObject *mesh,
+  int association, const std::string &arrayName, const char *eventName,
+  const std::function<int(DataAdaptor*, svtkDataObject*)> &add)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+
+  if (!this->Source)
+    {
+    SENSEI_ERROR("No data adaptor has been set")
+    return -1;
+    }
+
+  this->Update();
+
+  svtkSmartPointer<DataAdaptor> source = this->Source;
+
+  // meshes that did not come from the cache are passed through
+  MeshKey mkey;
+  if (this->GetMeshKey(mesh, mkey))
+    {
+    ++this->Misses;
+    lock.unlock();
+    std::lock_guard<std::mutex> sourceLock(this->SourceMutex);
+    return add(source, mesh);
+    }
+
+  ArrayKey akey(mkey.first, mkey.second, association, arrayName);
+
+  // the source adds the array to a copy of the cached mesh, so that the
+  // cached mesh is not modified while other threads read from it. the
+  // array is moved into the cached mesh with the cache locked.
+  svtkDataObjectPtr fetched;
+  if (!this->ArrayRequests.count(akey))
+    fetched.TakeReference(NewShallowCopy(this->Meshes[mkey]));
+
+  auto fetch = [&]() -> int
+    {
+    TimeEvent<128> mark(eventName);
+    return add(source, fetched);
+    };
+
+  auto store = [&]() -> int
+    {
+    return this->CopyArray(fetched, this->Meshes[mkey],
+      association, arrayName);
+    };
+
+  if (this->Request(lock, this->ArrayRequests, akey, fetch, store))
+    return -1;
+
+  return this->CopyArray(this->Meshes[mkey], mesh, association, arrayName);
+}
+
+
+//----------------------------------------------------------------------------
+senseiNewMacro(CachingDataAdaptor);
+
+//----------------------------------------------------------------------------
+CachingDataAdaptor::CachingDataAdaptor() :
+  Internals(std::make_shared<InternalsType>())
+{
+}
+
+//----------------------------------------------------------------------------
+CachingDataAdaptor::~CachingDataAdaptor()
+{
+}
+
+//----------------------------------------------------------------------------
+void CachingDataAdaptor::ShareCache(CachingDataAdaptor *other)
+{
+  if (other)
+    this->Internals = other->Internals;
+}
+
+//----------------------------------------------------------------------------
+void CachingDataAdaptor::SetDataAdaptor(DataAdaptor *source)
+{
+  std::lock_guard<std::mutex> lock(this->Internals->Mutex);
+
+  if (this->Internals->Source.GetPointer() == source)
+    return;
+
+  this->Internals->Clear();
+  this->Internals->Source = source;
+}
+
+//----------------------------------------------------------------------------
+DataAdaptor *CachingDataAdaptor::GetDataAdaptor()
+{
+  return this->Internals->Source.GetPointer();
+}
+
+//----------------------------------------------------------------------------
+unsigned long CachingDataAdaptor::GetNumberOfHits()
+{
+  std::lock_guard<std::mutex> lock(this->Internals->Mutex);
+  return this->Internals->Hits;
+}
+
+//----------------------------------------------------------------------------
+unsigned long CachingDataAdaptor::GetNumberOfMisses()
+{
+  std::lock_guard<std::mutex> lock(this->Internals->Mutex);
+  return this->Internals->Misses;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::CacheMetadata(const MeshMetadataFlags &flags)
+{
+  std::lock_guard<std::mutex> lock(this->Internals->Mutex);
+
+  if (!this->Internals->Source)
+    {
+    SENSEI_ERROR("No data adaptor has been set")
+    return -1;
+    }
+
+  this->Internals->Update();
+
+  std::lock_guard<std::mutex> sourceLock(this->Internals->SourceMutex);
+
+  unsigned int nMeshes = 0;
+  if (this->Internals->Source->GetNumberOfMeshes(nMeshes))
+    {
+    SENSEI_ERROR("Failed to get the number of meshes")
+    return -1;
+    }
+
+  std::vector<MeshMetadataPtr> metadata(nMeshes);
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    metadata[i] = MeshMetadata::New(flags);
+    if (this->Internals->Source->GetMeshMetadata(i, metadata[i]))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh " << i)
+      return -1;
+      }
+    }
+
+  this->Internals->Metadata.swap(metadata);
+  this->Internals->MetadataFlags.assign(nMeshes, flags);
+  this->Internals->HaveMetadata = true;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
+{
+  std::unique_lock<std::mutex> lock(this->Internals->Mutex);
+
+  if (!this->Internals->Source)
+    {
+    SENSEI_ERROR("No data adaptor has been set")
+    return -1;
+    }
+
+  this->Internals->Update();
+
+  if (this->Internals->HaveMetadata)
+    {
+    numMeshes = this->Internals->Metadata.size();
+    return 0;
+    }
+
+  svtkSmartPointer<DataAdaptor> source = this->Internals->Source;
+  lock.unlock();
+
+  std::lock_guard<std::mutex> sourceLock(this->Internals->SourceMutex);
+  return source->GetNumberOfMeshes(numMeshes);
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::GetMeshMetadata(unsigned int id,
+  MeshMetadataPtr &metadata)
+{
+  std::unique_lock<std::mutex> lock(this->Internals->Mutex);
+
+  if (!this->Internals->Source)
+    {
+    SENSEI_ERROR("No data adaptor has been set")
+    return -1;
+    }
+
+  this->Internals->Update();
+
+  svtkSmartPointer<DataAdaptor> source = this->Internals->Source;
+
+  if (!this->Internals->HaveMetadata)
+    {
+    lock.unlock();
+    std::lock_guard<std::mutex> sourceLock(this->Internals->SourceMutex);
+    return source->GetMeshMetadata(id, metadata);
+    }
+
+  if (id >= this->Internals->Metadata.size())
+    {
+    SENSEI_ERROR("Index " << id << " out of bounds")
+    return -1;
+    }
+
+  // the cached metadata may lack fields the caller asked for. in that
+  // case fetch it again with both sets of flags and replace the cached
+  // copy so that subsequent requests are served from the cache
+  MeshMetadataFlags cachedFlags = this->Internals->MetadataFlags[id];
+  if (!IsSubset(metadata->Flags, cachedFlags))
+    {
+    ++this->Internals->Misses;
+
+    unsigned long generation = this->Internals->Generation;
+    lock.unlock();
+
+    MeshMetadataFlags flags = Union(cachedFlags, metadata->Flags);
+    MeshMetadataPtr md = MeshMetadata::New(flags);
+      {
+      std::lock_guard<std::mutex> sourceLock(this->Internals->SourceMutex);
+      if (source->GetMeshMetadata(id, md))
+        {
+        SENSEI_ERROR("Failed to get metadata for mesh " << id)
+        return -1;
+        }
+      }
+
+    lock.lock();
+
+    if (generation == this->Internals->Generation)
+      {
+      this->Internals->Metadata[id] = md;
+      this->Internals->MetadataFlags[id] = flags;
+      }
+
+    *metadata = *md;
+    return 0;
+    }
+
+  *metadata = *this->Internals->Metadata[id];
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::GetMesh(const std::string &meshName,
+  bool structureOnly, svtkDataObject *&mesh)
+{
+  mesh = nullptr;
+
+  std::unique_lock<std::mutex> lock(this->Internals->Mutex);
+
+  if (!this->Internals->Source)
+    {
+    SENSEI_ERROR("No data adaptor has been set")
+    return -1;
+    }
+
+  this->Internals->Update();
+
+  svtkSmartPointer<DataAdaptor> source = this->Internals->Source;
+  MeshKey key(meshName, structureOnly);
+  svtkDataObjectPtr fetched;
+
+  auto fetch = [&]() -> int
+    {
+    TimeEvent<128> mark("CachingDataAdaptor::GetMesh miss");
+
+    svtkDataObject *dobj = nullptr;
+    if (source->GetMesh(meshName, structureOnly, dobj))
+      return -1;
+
+    fetched.TakeReference(dobj);
+    return 0;
+    };
+
+  auto store = [&]() -> int
+    {
+    // it is not an error for a rank to have no data
+    this->Internals->Meshes[key] = fetched;
+    return 0;
+    };
+
+  if (this->Internals->Request(lock, this->Internals->MeshRequests,
+    key, fetch, store))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  svtkDataObject *cached = this->Internals->Meshes[key];
+  if (!cached)
+    return 0;
+
+  mesh = NewShallowCopy(cached);
+
+  this->Internals->Issued[mesh] = std::make_pair(
+    svtkWeakPointer<svtkDataObject>(mesh), key);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::AddArray(svtkDataObject* mesh,
+  const std::string &meshName, int association, const std::string &arrayName)
+{
+  auto add = [&](DataAdaptor *source, svtkDataObject *dobj) -> int
+    {
+    return source->AddArray(dobj, meshName, association, arrayName);
+    };
+
+  if (this->Internals->AddArray(mesh, association, arrayName,
+    "CachingDataAdaptor::AddArray miss", add))
+    {
+    SENSEI_ERROR("Failed to add " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" to mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::AddGhostNodesArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  auto add = [&](DataAdaptor *source, svtkDataObject *dobj) -> int
+    {
+    return source->AddGhostNodesArray(dobj, meshName);
+    };
+
+  if (this->Internals->AddArray(mesh, svtkDataObject::POINT, "svtkGhostType",
+    "CachingDataAdaptor::AddGhostNodesArray miss", add))
+    {
+    SENSEI_ERROR("Failed to add ghost nodes to mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::AddGhostCellsArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  auto add = [&](DataAdaptor *source, svtkDataObject *dobj) -> int
+    {
+    return source->AddGhostCellsArray(dobj, meshName);
+    };
+
+  if (this->Internals->AddArray(mesh, svtkDataObject::CELL, "svtkGhostType",
+    "CachingDataAdaptor::AddGhostCellsArray miss", add))
+    {
+    SENSEI_ERROR("Failed to add ghost cells to mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int CachingDataAdaptor::ReleaseData()
+{
+  std::lock_guard<std::mutex> lock(this->Internals->Mutex);
+  this->Internals->Clear();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+double CachingDataAdaptor::GetDataTime()
+{
+  if (this->Internals->Source)
+    return this->Internals->Source->GetDataTime();
+  return this->DataAdaptor::GetDataTime();
+}
+
+//----------------------------------------------------------------------------
+void CachingDataAdaptor::SetDataTime(double time)
+{
+  if (this->Internals->Source)
+    this->Internals->Source->SetDataTime(time);
+  else
+    this->DataAdaptor::SetDataTime(time);
+}
+
+//----------------------------------------------------------------------------
+long CachingDataAdaptor::GetDataTimeStep()
+{
+  if (this->Internals->Source)
+    return this->Internals->Source->GetDataTimeStep();
+  return this->DataAdaptor::GetDataTimeStep();
+}
+
+//----------------------------------------------------------------------------
+void CachingDataAdaptor::SetDataTimeStep(long index)
+{
+  if (this->Internals->Source)
+    this->Internals->Source->SetDataTimeStep(index);
+  else
+    this->DataAdaptor::SetDataTimeStep(index);
+}
+
+//----------------------------------------------------------------------------
+void CachingDataAdaptor::PrintSelf(ostream& os, svtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Source: " << this->Internals->Source.GetPointer() << std::endl
+    << indent << "Meshes: " << this->Internals->Meshes.size() << std::endl
+    << indent << "Arrays: " << this->Internals->ArrayRequests.size() << std::endl
+    << indent << "Hits: " << this->Internals->Hits << std::endl
+    << indent << "Misses: " << this->Internals->Misses << std::endl;
+}
+
+}
@@ -0,0 +1,133 @@
+#ifndef sensei_CachingDataAdaptor_h
+#define sensei_CachingDataAdaptor_h
+
+#include "DataAdaptor.h"
+
+#include <string>
+#include <memory>
+
+class svtkDataObject;
+
+namespace sensei
+{
+
+/** A sensei::DataAdaptor that decorates another data adaptor and memoizes
+ * the meshes and arrays it produces during a single time step. When several
+ * analyses process the same step each of them calls GetMesh and AddArray on
+ * the simulation's data adaptor. With this decorator the simulation's data
+ * adaptor is only asked once per (mesh, structureOnly) and once per (mesh,
+ * structureOnly, association, array). Callers receive shallow copies of the
+ * cached objects and take ownership of them as usual, so they are free to add
+ * their own arrays to them without modifying the cached objects.
+ *
+ * The cache is invalidated when ReleaseData is called or when the time step or
+ * time reported by the decorated data adaptor changes. ReleaseData is not
+ * forwarded, the simulation's bridge code remains responsible for releasing
+ * the decorated adaptor's data.
+ *
+ * When profiling is enabled cache misses are timed and the number of hits and
+ * misses in each step are logged when the cache is invalidated in events named
+ * "CachingDataAdaptor::Hits" and "CachingDataAdaptor::Misses". The count is
+ * stored in the event's bytes field.
+ *
+ * Several instances may share one cache (see ShareCache) while keeping their
+ * own communicators, so that they can be used by analyses running
+ * concurrently on different threads. The cache is not locked while the
+ * decorated data adaptor is called. Requests for a mesh or array that is
+ * being fetched by another thread wait for that fetch to complete. Calls to
+ * the decorated data adaptor are serialized, but they are made by whichever
+ * thread misses first. The order of the calls may therefore differ between
+ * ranks, and when instances are used concurrently the decorated data adaptor
+ * must not make collective calls in GetMesh, AddArray, AddGhostNodesArray, or
+ * AddGhostCellsArray. Metadata that requires collective calls should be
+ * fetched up front with CacheMetadata.
+ *
+ * sensei::ConfigurableAnalysis inserts an instance of this class automatically
+ * when more than one analysis is configured.
+ */
+class SENSEI_EXPORT CachingDataAdaptor : public DataAdaptor
+{
+public:
+  static CachingDataAdaptor *New();
+  senseiTypeMacro(CachingDataAdaptor, DataAdaptor);
+
+  /// Prints the current state of the adaptor.
+  void PrintSelf(ostream& os, svtkIndent indent) override;
+
+  /** Set the data adaptor whose meshes and arrays are cached. Setting a new
+   * data adaptor invalidates the cache. A reference to the adaptor is held
+   * until it is replaced or the cache is released.
+   */
+  void SetDataAdaptor(DataAdaptor *source);
+
+  /// Get the data adaptor whose meshes and arrays are cached.
+  DataAdaptor *GetDataAdaptor();
+
+  /** Use the cache of another instance. Meshes and arrays cached through
+   * either instance are then served to both. The data adaptor being cached
+   * is shared as well. Each instance keeps its own communicator, which lets
+   * analyses running concurrently make collective calls through their
+   * instance without interfering with each other.
+   */
+  void ShareCache(CachingDataAdaptor *other);
+
+  /** Fetch the metadata of all meshes from the data adaptor now and serve
+   * subsequent GetNumberOfMeshes and GetMeshMetadata calls from the cache
+   * until it is invalidated. The metadata is generated with the passed flags.
+   * This is used to keep any collective calls the data adaptor makes while
+   * generating metadata on the calling thread when analyses run concurrently.
+   * Requests for optional fields that were not generated are forwarded to
+   * the data adaptor and replace the cached metadata of that mesh.
+   *
+   * @returns zero if successful, non zero if an error occurred
+   */
+  int CacheMetadata(const MeshMetadataFlags &flags);
+
+  /// Get the number of requests served from the cache in the current step.
+  unsigned long GetNumberOfHits();
+
+  /// Get the number of requests forwarded in the current step.
+  unsigned long GetNumberOfMisses();
+
+  int GetNumberOfMeshes(unsigned int &numMeshes) override;
+
+  int GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  int GetMesh(const std::string &meshName, bool structureOnly,
+    svtkDataObject *&mesh) override;
+
+  int AddGhostNodesArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int AddGhostCellsArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int AddArray(svtkDataObject* mesh, const std::string &meshName,
+    int association, const std::string &arrayName) override;
+
+  /** Invalidates the cache, releasing all cached meshes and arrays. This does
+   * not call ReleaseData on the decorated data adaptor.
+   */
+  int ReleaseData() override;
+
+  double GetDataTime() override;
+  void SetDataTime(double time) override;
+
+  long GetDataTimeStep() override;
+  void SetDataTimeStep(long index) override;
+
+protected:
+  CachingDataAdaptor();
+  ~CachingDataAdaptor();
+
+  CachingDataAdaptor(const CachingDataAdaptor&) = delete;
+  void operator=(const CachingDataAdaptor&) = delete;
+
+private:
+  struct InternalsType;
+  std::shared_ptr<InternalsType> Internals;
+};
+
+}
+
+#endif
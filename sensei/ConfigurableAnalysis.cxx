@@ -4,9 +4,13 @@
 #include <svtkDataObject.h>
 
 #include <vector>
+#include <deque>
+#include <future>
+#include <memory>
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <cstdlib>
 #include <errno.h>
 
 #include "ConfigurableAnalysis.h"
@@ -17,9 +21,15 @@
 #include "XMLUtils.h"
 #include "STLUtils.h"
 #include "DataRequirements.h"
+#include "CachingDataAdaptor.h"
+#include "SnapshotDataAdaptor.h"
+#include "InTransitDataAdaptor.h"
+#include "ThreadPool.h"
+#include "SMPUtils.h"
 
 #include "Autocorrelation.h"
 #include "Histogram.h"
+#include "QuantileAnalysis.h"
 #ifdef ENABLE_VTK_IO
 #include "VTKPosthocIO.h"
 #ifdef ENABLE_VTK_MPI
@@ -77,7 +87,8 @@ using namespace STLUtils; // for operator<< overloads
 struct ConfigurableAnalysis::InternalsType
 {
   InternalsType()
-    : Comm(MPI_COMM_NULL)
+    : Comm(MPI_COMM_NULL), EnableCache(true), Concurrent(false),
+    NumThreads(0), Asynchronous(false), QueueDepth(1), NextSnapshot(0)
   {
   }
 
@@ -89,11 +100,34 @@ struct ConfigurableAnalysis::InternalsType
     AnalysisAdaptorPtr adaptor,
     std::function<int()> initializer = []() { return 0; });
 
+  // executes the ai'th analysis, timing how long it takes. the run is
+  // aborted if the analysis fails.
+  void Execute(int ai, DataAdaptor *data, DataAdaptor **dataOut);
+
+  // returns the cache instance used by the ai'th analysis
+  CachingDataAdaptor *GetCache(unsigned int ai);
+
+  // sets up for concurrent execution of the analyses. falls back to
+  // serial execution if the MPI library does not support it
+  int InitializeConcurrent();
+
+  // sets up for asynchronous execution of the analyses. falls back to
+  // serial execution if the MPI library does not support it
+  int InitializeAsynchronous();
+
+  // snapshots the simulation's data and queues the analyses for execution
+  // on the pool's thread. blocks while QueueDepth steps are pending.
+  void ExecuteAsynchronous(DataAdaptor *data);
+
+  // waits for all pending steps to complete
+  void WaitAsynchronous();
+
   // creates, initializes from xml, and adds the analysis
   // if it has been compiled into the build and is enabled.
   // a status message indicating success/failure is printed
   // by rank 0
   int AddHistogram(pugi::xml_node node);
+  int AddQuantile(pugi::xml_node node);
   int AddVTKmContour(pugi::xml_node node);
   int AddVTKmVolumeReduction(pugi::xml_node node);
   int AddVTKmCDF(pugi::xml_node node);
@@ -133,8 +167,205 @@ public:
   MPI_Comm Comm;
 
   std::vector<std::string> LogEventNames;
+
+  // when more than one analysis is configured, the meshes and arrays
+  // fetched from the simulation are shared through this cache. it can
+  // be disabled by setting the cache attribute of the root element to 0
+  bool EnableCache;
+
+  // when running concurrently each analysis gets its own instance with its
+  // own communicator, all of the instances share one cache.
+  std::vector<svtkSmartPointer<CachingDataAdaptor>> Caches;
+
+  // when enabled the analyses are executed concurrently by the threads of
+  // the pool. the analysis that provides the output data is executed on the
+  // calling thread.
+  bool Concurrent;
+  unsigned int NumThreads;
+  std::unique_ptr<ThreadPool> Pool;
+
+  // when enabled the analyses are executed by the pool's thread on a
+  // snapshot of the simulation's data while the simulation continues.
+  // there is one snapshot per step that may be pending, their buffers
+  // are recycled.
+  bool Asynchronous;
+  unsigned int QueueDepth;
+  DataRequirements SnapshotRequirements;
+  std::vector<svtkSmartPointer<SnapshotDataAdaptor>> Snapshots;
+  unsigned int NextSnapshot;
+  std::deque<std::future<void>> Pending;
 };
 
+// --------------------------------------------------------------------------
+void ConfigurableAnalysis::InternalsType::Execute(int ai,
+  DataAdaptor *data, DataAdaptor **dataOut)
+{
+  AnalysisAdaptorPtr &analysis = this->Analyses[ai];
+
+  const char* analysisName = nullptr;
+  bool logEnabled = Profiler::Enabled();
+  if (logEnabled)
+    {
+    analysisName = this->LogEventNames[3 * ai + 1].c_str();
+    Profiler::StartEvent(analysisName);
+    }
+
+  if (!analysis->Execute(data, dataOut))
+    {
+    SENSEI_ERROR("Failed to execute " << analysis->GetClassName())
+    MPI_Abort(analysis->GetCommunicator(), -1);
+    }
+
+  if (logEnabled)
+    Profiler::EndEvent(analysisName);
+}
+
+// --------------------------------------------------------------------------
+CachingDataAdaptor *ConfigurableAnalysis::InternalsType::GetCache(unsigned int ai)
+{
+  // MPI_Comm_dup is collective, all ranks create the instances in the
+  // same order
+  while (this->Caches.size() <= ai)
+    {
+    auto cache = svtkSmartPointer<CachingDataAdaptor>::New();
+
+    if (this->Comm != MPI_COMM_NULL)
+      cache->SetCommunicator(this->Comm);
+
+    if (!this->Caches.empty())
+      cache->ShareCache(this->Caches[0]);
+
+    this->Caches.push_back(cache);
+    }
+
+  return this->Caches[ai];
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::InitializeConcurrent()
+{
+  unsigned int nAnalyses = this->Analyses.size();
+
+  if (!this->Concurrent || (nAnalyses < 2))
+    {
+    this->Concurrent = false;
+    return 0;
+    }
+
+  // the analyses make MPI calls from the pool's threads
+  int threadLevel = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&threadLevel);
+  if (threadLevel < MPI_THREAD_MULTIPLE)
+    {
+    SENSEI_WARNING("Concurrent execution requires MPI_THREAD_MULTIPLE."
+      " The analyses will be executed serially.")
+    this->Concurrent = false;
+    return 0;
+    }
+
+  // one of the analyses is executed by the calling thread
+  unsigned int nThreads = this->NumThreads;
+  if ((nThreads < 1) || (nThreads > nAnalyses - 1))
+    nThreads = nAnalyses - 1;
+
+  this->Pool.reset(new ThreadPool(nThreads));
+
+  SENSEI_STATUS("Configured concurrent execution of " << nAnalyses
+    << " analyses using " << nThreads << " threads")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::InitializeAsynchronous()
+{
+  if (!this->Asynchronous || this->Analyses.empty())
+    {
+    this->Asynchronous = false;
+    return 0;
+    }
+
+  // the analyses make MPI calls from the pool's thread while the
+  // simulation makes MPI calls from the main thread
+  int threadLevel = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&threadLevel);
+  if (threadLevel < MPI_THREAD_MULTIPLE)
+    {
+    SENSEI_WARNING("Asynchronous execution requires MPI_THREAD_MULTIPLE."
+      " The analyses will be executed serially.")
+    this->Asynchronous = false;
+    return 0;
+    }
+
+  if (this->QueueDepth < 1)
+    this->QueueDepth = 1;
+
+  // MPI_Comm_dup is collective, all ranks create the instances in the
+  // same order. each has its own communicator since a snapshot is taken
+  // while the previous one is being processed
+  for (unsigned int i = 0; i < this->QueueDepth; ++i)
+    {
+    auto snap = svtkSmartPointer<SnapshotDataAdaptor>::New();
+
+    if (this->Comm != MPI_COMM_NULL)
+      snap->SetCommunicator(this->Comm);
+
+    this->Snapshots.push_back(snap);
+    }
+
+  // a single thread so that the steps are processed in order
+  this->Pool.reset(new ThreadPool(1));
+
+  SENSEI_STATUS("Configured asynchronous execution of "
+    << this->Analyses.size() << " analyses with a queue depth of "
+    << this->QueueDepth)
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void ConfigurableAnalysis::InternalsType::ExecuteAsynchronous(DataAdaptor *data)
+{
+  // wait for a snapshot to become available
+  if (this->Pending.size() >= this->QueueDepth)
+    {
+    TimeEvent<128> mark("ConfigurableAnalysis::Wait");
+    while (this->Pending.size() >= this->QueueDepth)
+      {
+      this->Pending.front().wait();
+      this->Pending.pop_front();
+      }
+    }
+
+  // the snapshots are used round robin, the one used QueueDepth steps ago
+  // has been processed
+  SnapshotDataAdaptor *snap = this->Snapshots[this->NextSnapshot];
+  this->NextSnapshot = (this->NextSnapshot + 1) % this->QueueDepth;
+
+  if (snap->Snapshot(data, this->SnapshotRequirements))
+    {
+    SENSEI_ERROR("Failed to take a snapshot of the simulation data")
+    MPI_Abort(snap->GetCommunicator(), -1);
+    }
+
+  this->Pending.push_back(this->Pool->Push([this, snap]() {
+    unsigned int nAnalyses = this->Analyses.size();
+    for (unsigned int ai = 0; ai < nAnalyses; ++ai)
+      this->Execute(ai, snap, nullptr);
+    snap->ReleaseData();
+    }));
+}
+
+// --------------------------------------------------------------------------
+void ConfigurableAnalysis::InternalsType::WaitAsynchronous()
+{
+  while (!this->Pending.empty())
+    {
+    this->Pending.front().wait();
+    this->Pending.pop_front();
+    }
+}
+
 // --------------------------------------------------------------------------
 int ConfigurableAnalysis::InternalsType::TimeInitialization(
   AnalysisAdaptorPtr adaptor, std::function<int()> initializer)
@@ -168,39 +399,152 @@ int ConfigurableAnalysis::InternalsType::TimeInitialization(
 // --------------------------------------------------------------------------
 int ConfigurableAnalysis::InternalsType::AddHistogram(pugi::xml_node node)
 {
-  if (XMLUtils::RequireAttribute(node, "mesh") || XMLUtils::RequireAttribute(node, "array"))
-    {
-    SENSEI_ERROR("Failed to initialize Histogram");
-    return -1;
-    }
+  int bins = node.attribute("bins").as_int(10);
+  int threads = node.attribute("threads").as_int(-1);
+  std::string fileName = node.attribute("file").value();
 
-  int association = 0;
-  std::string assocStr = node.attribute("association").as_string("point");
-  if (SVTKUtils::GetAssociation(assocStr, association))
+  // the bin edges may be fixed or carried over from step to step, which
+  // skips the global range calculation and allows accumulation over time
+  int window = node.attribute("window").as_int(0);
+  std::string binning = node.attribute("binning").as_string(
+    window > 0 ? "adaptive" : "global");
+
+  // histograms of many arrays on many meshes can be computed together. these
+  // are given in mesh elements. otherwise a single array is given in the
+  // mesh, array, and association attributes.
+  DataRequirements reqs;
+  if (node.child("mesh"))
     {
-    SENSEI_ERROR("Failed to initialize Histogram");
-    return -1;
+    if (reqs.Initialize(node) || reqs.Empty())
+      {
+      SENSEI_ERROR("Failed to initialize Histogram");
+      return -1;
+      }
     }
+  else
+    {
+    if (XMLUtils::RequireAttribute(node, "mesh") || XMLUtils::RequireAttribute(node, "array"))
+      {
+      SENSEI_ERROR("Failed to initialize Histogram");
+      return -1;
+      }
 
-  std::string mesh = node.attribute("mesh").value();
-  std::string array = node.attribute("array").value();
-  int bins = node.attribute("bins").as_int(10);
-  std::string fileName = node.attribute("file").value();
+    int association = 0;
+    std::string assocStr = node.attribute("association").as_string("point");
+    if (SVTKUtils::GetAssociation(assocStr, association))
+      {
+      SENSEI_ERROR("Failed to initialize Histogram");
+      return -1;
+      }
+
+    std::string mesh = node.attribute("mesh").value();
+    std::string array = node.attribute("array").value();
+
+    reqs.AddRequirement(mesh, association, array);
+    }
 
   auto histogram = svtkSmartPointer<Histogram>::New();
 
   if (this->Comm != MPI_COMM_NULL)
     histogram->SetCommunicator(this->Comm);
 
+  histogram->SetNumberOfThreads(threads);
+
+  if (histogram->SetBinning(binning))
+    {
+    SENSEI_ERROR("Failed to initialize Histogram");
+    return -1;
+    }
+
+  if (binning == "fixed")
+    {
+    if (XMLUtils::RequireAttribute(node, "min") || XMLUtils::RequireAttribute(node, "max") ||
+      histogram->SetRange(node.attribute("min").as_double(), node.attribute("max").as_double()))
+      {
+      SENSEI_ERROR("Failed to initialize Histogram");
+      return -1;
+      }
+    }
+
+  if (histogram->SetWindow(window))
+    {
+    SENSEI_ERROR("Histogram accumulation over a window requires fixed or adaptive binning")
+    return -1;
+    }
+
   this->TimeInitialization(histogram, [&]() {
-      histogram->Initialize(bins, mesh, association, array, fileName);
+      histogram->Initialize(bins, reqs, fileName);
       return 0;
     });
   this->Analyses.push_back(histogram.GetPointer());
 
-  SENSEI_STATUS("Configured histogram with " << bins
-    << " bins on " << assocStr << " data array \"" << array
-    << "\" on mesh \"" << mesh << "\" writing output to "
+  MeshRequirementsIterator mit = reqs.GetMeshRequirementsIterator();
+  for (; mit; ++mit)
+    {
+    ArrayRequirementsIterator ait = reqs.GetArrayRequirementsIterator(mit.MeshName());
+    for (; ait; ++ait)
+      {
+      SENSEI_STATUS("Configured histogram with " << bins
+        << " " << binning << " bins"
+        << (window > 0 ? " accumulated over " + std::to_string(window) + " steps" : "")
+        << " on " << SVTKUtils::GetAttributesName(ait.Association())
+        << " data array \"" << ait.Array() << "\" on mesh \""
+        << mit.MeshName() << "\" writing output to "
+        << (fileName.empty() ? "cout" : "file"))
+      }
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddQuantile(pugi::xml_node node)
+{
+  if (XMLUtils::RequireAttribute(node, "mesh") || XMLUtils::RequireAttribute(node, "array"))
+    {
+    SENSEI_ERROR("Failed to initialize QuantileAnalysis");
+    return -1;
+    }
+
+  std::string meshName = node.attribute("mesh").value();
+  std::string arrayName = node.attribute("array").value();
+  std::string fileName = node.attribute("file").value();
+
+  std::string assocStr = node.attribute("association").as_string("point");
+  int assoc = 0;
+  if (SVTKUtils::GetAssociation(assocStr, assoc))
+    {
+    SENSEI_ERROR("Failed to initialize QuantileAnalysis");
+    return -1;
+    }
+
+  int quantiles = node.attribute("quantiles").as_int(10);
+
+  auto adaptor = svtkSmartPointer<QuantileAnalysis>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    adaptor->SetCommunicator(this->Comm);
+
+  // the accuracy is given either by the size of the sketch or by the error
+  if ((node.attribute("error") &&
+    adaptor->SetError(node.attribute("error").as_double())) ||
+    (node.attribute("sketch-size") &&
+    adaptor->SetSketchSize(node.attribute("sketch-size").as_int())))
+    {
+    SENSEI_ERROR("Failed to initialize QuantileAnalysis");
+    return -1;
+    }
+
+  this->TimeInitialization(adaptor, [&]() {
+    adaptor->Initialize(meshName, assoc, arrayName, quantiles, fileName);
+    return 0;
+  });
+
+  this->Analyses.push_back(adaptor.GetPointer());
+
+  SENSEI_STATUS("Configured QuantileAnalysis " << assocStr
+    << " data array \"" << arrayName << "\" on mesh \"" << meshName
+    << "\" quantiles " << quantiles << " writing output to "
     << (fileName.empty() ? "cout" : "file"))
 
   return 0;
@@ -301,14 +645,14 @@ int ConfigurableAnalysis::InternalsType::AddVTKmCDF(pugi::xml_node node)
   auto field = node.attribute("field").as_string();
   auto assoc = node.attribute("association").as_string();
   auto quantiles = node.attribute("quantiles").as_int(10);
-  auto exchangeSize = node.attribute("exchange-size").as_int(quantiles);
+  auto sketchSize = node.attribute("sketch-size").as_int(200);
 
   bool haveWorkDir = !!node.attribute("working-directory");
   std::string workDir =  haveWorkDir ? node.attribute("working-directory").as_string() : ".";
 
   auto analysis = svtkSmartPointer<VTKmCDFAnalysis>::New();
   this->TimeInitialization(analysis, [&]() {
-    analysis->Initialize(mesh, field, assoc, workDir, quantiles, exchangeSize, this->Comm);
+    analysis->Initialize(mesh, field, assoc, workDir, quantiles, sketchSize, this->Comm);
     return 0;
   });
   this->Analyses.push_back(analysis.GetPointer());
@@ -482,6 +826,16 @@ int ConfigurableAnalysis::InternalsType::AddHDF5(pugi::xml_node node)
         }
     }
 
+  // chunked, compressed, and aggregated writes
+  dataE->SetChunkSize(node.attribute("chunk_size").as_ullong(0));
+  dataE->SetCompressionLevel(node.attribute("compression_level").as_int(0));
+  dataE->SetShuffle(node.attribute("shuffle").as_int(0));
+  dataE->SetNumWriters(node.attribute("writers").as_int(0));
+
+  pugi::xml_node hints = node.child("hints");
+  for (pugi::xml_attribute hint : hints.attributes())
+    dataE->SetHint(hint.name(), hint.value());
+
   DataRequirements req;
   if (req.Initialize(node))
     {
@@ -844,14 +1198,24 @@ int ConfigurableAnalysis::InternalsType::AddAutoCorrelation(pugi::xml_node node)
   int window = node.attribute("window").as_int(10);
   int kMax = node.attribute("k-max").as_int(3);
   int numThreads = node.attribute("n-threads").as_int(1);
+  std::string mode = node.attribute("mode").as_string("direct");
+  int outputFrequency = node.attribute("output-frequency").as_int(0);
 
   auto adaptor = svtkSmartPointer<Autocorrelation>::New();
 
   if (this->Comm != MPI_COMM_NULL)
     adaptor->SetCommunicator(this->Comm);
 
+  if (adaptor->SetMode(mode))
+    {
+    SENSEI_ERROR("Failed to initialize Autocorrelation");
+    return -1;
+    }
+
+  adaptor->SetOutputFrequency(outputFrequency);
+
   this->TimeInitialization(adaptor, [&]() {
-    adaptor->Initialize(window, meshName, assoc, arrayName, kMax);
+    adaptor->Initialize(window, meshName, assoc, arrayName, kMax, numThreads);
     return 0;
   });
 
@@ -860,7 +1224,7 @@ int ConfigurableAnalysis::InternalsType::AddAutoCorrelation(pugi::xml_node node)
   SENSEI_STATUS("Configured Autocorrelation " << assocStr
     << " data array \"" << arrayName << "\" on mesh \"" << meshName
     << "\" window " << window << " k-max " << kMax
-    << " n-threads " << numThreads)
+    << " n-threads " << numThreads << " mode " << mode)
 
   return 0;
 }
@@ -885,6 +1249,8 @@ int ConfigurableAnalysis::InternalsType::AddPosthocIO(pugi::xml_node node)
   std::string mode = node.attribute("mode").as_string("visit");
   std::string writer = node.attribute("writer").as_string("xml");
   std::string ghostArrayName = node.attribute("ghost_array_name").as_string("");
+  std::string aggregate = node.attribute("aggregate").as_string("none");
+  std::string compressor = node.attribute("compressor").as_string("none");
   int verbose = node.attribute("verbose").as_int(0);
   unsigned int frequency = node.attribute("frequency").as_uint(0);
 
@@ -898,7 +1264,8 @@ int ConfigurableAnalysis::InternalsType::AddPosthocIO(pugi::xml_node node)
   adaptor->SetFrequency(frequency);
 
   if (adaptor->SetOutputDir(outputDir) || adaptor->SetMode(mode) ||
-    adaptor->SetWriter(writer) || adaptor->SetDataRequirements(req))
+    adaptor->SetWriter(writer) || adaptor->SetAggregation(aggregate) ||
+    adaptor->SetCompressor(compressor) || adaptor->SetDataRequirements(req))
     {
     SENSEI_ERROR("Failed to initialize the VTKPosthocIO analysis")
     return -1;
@@ -987,6 +1354,17 @@ int ConfigurableAnalysis::InternalsType::AddPythonAnalysis(pugi::xml_node node)
   pyAnalysis->SetScriptModule(scriptModule);
   pyAnalysis->SetInitializeSource(initSource);
 
+  // run the script in the simulation's process or in a worker process
+  std::string execution = node.attribute("execution").as_string("embedded");
+  if (pyAnalysis->SetExecution(execution))
+    return -1;
+
+  // the meshes and arrays passed to a worker process, when none are named
+  // all are passed
+  DataRequirements req;
+  if (req.Initialize(node) || pyAnalysis->SetDataRequirements(req))
+    return -1;
+
   if (this->TimeInitialization(pyAnalysis, [&]() {
       return pyAnalysis->Initialize(); }))
     {
@@ -1001,7 +1379,7 @@ int ConfigurableAnalysis::InternalsType::AddPythonAnalysis(pugi::xml_node node)
     scriptFile.empty() ?  scriptModule.c_str() : scriptFile.c_str();
 
   SENSEI_STATUS("Configured python with " << scriptType
-    << " \"" << scriptName << "\"")
+    << " \"" << scriptName << "\" " << execution << " execution")
 
   return 0;
 #endif
@@ -1195,6 +1573,7 @@ ConfigurableAnalysis::ConfigurableAnalysis()
 //----------------------------------------------------------------------------
 ConfigurableAnalysis::~ConfigurableAnalysis()
 {
+  this->Internals->WaitAsynchronous();
   delete this->Internals;
 }
 
@@ -1241,6 +1620,60 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
 {
   TimeEvent<128> event("ConfigurableAnalysis::Initialize");
 
+  this->Internals->EnableCache = root.attribute("cache").as_int(1);
+
+  std::string execution = root.attribute("execution").as_string("serial");
+  if ((execution != "serial") && (execution != "concurrent")
+    && (execution != "asynchronous"))
+    {
+    SENSEI_ERROR("Invalid execution mode \"" << execution << "\"")
+    MPI_Abort(this->GetCommunicator(), -1);
+    }
+  this->Internals->Concurrent = (execution == "concurrent");
+  this->Internals->NumThreads = root.attribute("threads").as_uint(0);
+  this->Internals->Asynchronous = (execution == "asynchronous");
+  this->Internals->QueueDepth = root.attribute("queue-depth").as_uint(1);
+
+  // the threads used by the analyses' parallel loops and engines
+  if (root.attribute("smp-backend") || root.attribute("smp-threads") ||
+    root.attribute("smp-max-threads"))
+    {
+    // only an explicit auto divides the node's cores amongst its ranks
+    std::string smpThreads = root.attribute("smp-threads").as_string("1");
+    int nThreads = smpThreads == "auto" ? 0 : std::atoi(smpThreads.c_str());
+    if (nThreads < 1 && smpThreads != "auto")
+      {
+      SENSEI_ERROR("Invalid smp-threads \"" << smpThreads << "\"")
+      MPI_Abort(this->GetCommunicator(), -1);
+      }
+    int maxThreads = root.attribute("smp-max-threads").as_int(0);
+
+    if (SMPUtils::Initialize(this->GetCommunicator(),
+      root.attribute("smp-backend").as_string("auto"), nThreads, maxThreads))
+      {
+      SENSEI_ERROR("Failed to initialize the SMP backend")
+      MPI_Abort(this->GetCommunicator(), -1);
+      }
+
+    int rank = 0;
+    MPI_Comm_rank(this->GetCommunicator(), &rank);
+    if (rank == 0)
+      SENSEI_STATUS("Configured SMP backend " << SMPUtils::GetBackend()
+        << " with " << SMPUtils::GetNumberOfThreads(0)
+        << " threads per rank")
+    }
+
+  // the meshes and arrays copied when executing asynchronously. when
+  // none are named everything is copied
+  if (pugi::xml_node snapshot = root.child("snapshot"))
+    {
+    if (this->Internals->SnapshotRequirements.Initialize(snapshot))
+      {
+      SENSEI_ERROR("Failed to initialize the snapshot requirements")
+      MPI_Abort(this->GetCommunicator(), -1);
+      }
+    }
+
   // create and configure analysis adaptors
   for (pugi::xml_node node = root.child("analysis");
     node; node = node.next_sibling("analysis"))
@@ -1251,6 +1684,7 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
     std::string type = node.attribute("type").value();
     if (!(((type == "histogram") && !this->Internals->AddHistogram(node))
       || ((type == "autocorrelation") && !this->Internals->AddAutoCorrelation(node))
+      || ((type == "quantile") && !this->Internals->AddQuantile(node))
       || ((type == "adios1") && !this->Internals->AddAdios1(node))
       || ((type == "adios2") && !this->Internals->AddAdios2(node))
       || ((type == "ascent") && !this->Internals->AddAscent(node))
@@ -1288,6 +1722,9 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
       }
     }
 
+  this->Internals->InitializeConcurrent();
+  this->Internals->InitializeAsynchronous();
+
   return 0;
 }
 
@@ -1302,27 +1739,74 @@ bool ConfigurableAnalysis::Execute(DataAdaptor* data, DataAdaptor** dataOut)
 
   TimeEvent<128> event("ConfigurableAnalysis::Execute");
 
-  int ai = 0;
-  AnalysisAdaptorVector::iterator iter = this->Internals->Analyses.begin();
-  AnalysisAdaptorVector::iterator end = this->Internals->Analyses.end();
-  for (; iter != end; ++iter, ++ai)
+  // in transit data adaptors serve data that is already a copy, and
+  // analyses may reconfigure their partitioners
+  if (this->Internals->Asynchronous &&
+    !dynamic_cast<InTransitDataAdaptor*>(data))
     {
-    const char* analysisName = nullptr;
-    bool logEnabled = Profiler::Enabled();
-    if (logEnabled)
+    this->Internals->ExecuteAsynchronous(data);
+    return true;
+    }
+
+  // share meshes and arrays between the analyses. in transit data adaptors
+  // are passed through since analyses may reconfigure their partitioners
+  // which changes the data they serve.
+  unsigned int nAnalyses = this->Internals->Analyses.size();
+  bool inTransit = dynamic_cast<InTransitDataAdaptor*>(data);
+
+  CachingDataAdaptor *cache = nullptr;
+  if (this->Internals->EnableCache && (nAnalyses > 1) && !inTransit)
+    {
+    cache = this->Internals->GetCache(0);
+    cache->SetDataAdaptor(data);
+    }
+
+  if (this->Internals->Concurrent && cache)
+    {
+    // the simulation's data adaptor may make collective calls while
+    // generating metadata. fetch it here so that this happens on the
+    // calling thread
+    MeshMetadataFlags flags;
+    flags.SetAll();
+    if (cache->CacheMetadata(flags))
       {
-      analysisName = this->Internals->LogEventNames[3 * ai + 1].c_str();
-      Profiler::StartEvent(analysisName);
+      SENSEI_ERROR("Failed to get metadata")
+      MPI_Abort(this->GetCommunicator(), -1);
       }
 
-    if (!(*iter)->Execute(data, dataOut))
+    // each analysis gets its own instance, allocate them up front since
+    // this involves collective calls
+    this->Internals->GetCache(nAnalyses - 1);
+
+    // all but the last analysis run on the pool's threads. the last
+    // analysis is the one whose output is returned, it runs here.
+    std::vector<std::future<void>> results;
+    for (unsigned int ai = 0; ai < nAnalyses - 1; ++ai)
       {
-      SENSEI_ERROR("Failed to execute " << (*iter)->GetClassName())
-      MPI_Abort(this->GetCommunicator(), -1);
+      DataAdaptor *dataIn = this->Internals->GetCache(ai);
+      results.push_back(this->Internals->Pool->Push([this, ai, dataIn]() {
+        this->Internals->Execute(ai, dataIn, nullptr);
+        }));
       }
 
-    if (logEnabled)
-      Profiler::EndEvent(analysisName);
+    this->Internals->Execute(nAnalyses - 1,
+      this->Internals->GetCache(nAnalyses - 1), dataOut);
+
+    for (unsigned int ai = 0; ai < nAnalyses - 1; ++ai)
+      results[ai].wait();
+    }
+  else
+    {
+    DataAdaptor *dataIn = cache ? cache : data;
+    for (unsigned int ai = 0; ai < nAnalyses; ++ai)
+      this->Internals->Execute(ai, dataIn, dataOut);
+    }
+
+  // the simulation is free to modify its data once we return
+  if (cache)
+    {
+    cache->ReleaseData();
+    cache->SetDataAdaptor(nullptr);
     }
 
   return true;
@@ -1333,6 +1817,9 @@ int ConfigurableAnalysis::Finalize()
 {
   TimeEvent<128> event("ConfigurableAnalysis::Finalize");
 
+  // complete the pending steps
+  this->Internals->WaitAsynchronous();
+
   int ai = 0;
   AnalysisAdaptorVector::iterator iter = this->Internals->Analyses.begin();
   AnalysisAdaptorVector::iterator end = this->Internals->Analyses.end();
@@ -1356,6 +1843,9 @@ int ConfigurableAnalysis::Finalize()
       Profiler::EndEvent(analysisName);
     }
 
+  // shut down the thread pool
+  this->Internals->Pool.reset();
+
   return 0;
 }
 
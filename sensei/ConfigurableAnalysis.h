@@ -30,6 +30,81 @@ namespace sensei
  * | sensei::PythonAnalysis | Invokes user provided Pythons scripts that process simulation data |
  * | sensei::SliceExtract | Computes planar slices and iso-surfaces on simulation data |
  *
+ * When more than one analysis is configured the simulation's data adaptor is
+ * wrapped in a sensei::CachingDataAdaptor so that meshes and arrays are
+ * fetched from the simulation once per time step and shared by all analyses.
+ * The cache can be disabled by setting the `cache` attribute of the root
+ * element to 0, for example `<sensei cache="0">`.
+ *
+ * By default the analyses are executed one after another. Independent analyses
+ * may instead be executed concurrently on a pool of threads by setting the
+ * `execution` attribute of the root element to `concurrent`. The optional
+ * `threads` attribute sets the size of the pool, by default one thread less
+ * than the number of analyses is used. For example:
+ *
+ * ```xml
+ * <sensei execution="concurrent" threads="3">
+ *   ...
+ * </sensei>
+ * ```
+ *
+ * Each analysis has its own duplicate of the communicator, so that collective
+ * calls made by analyses running at the same time do not interleave. The last
+ * analysis, whose output is returned to the caller, is executed on the calling
+ * thread. Calls to the simulation's data adaptor are serialized and its
+ * metadata is fetched on the calling thread before the analyses are started.
+ * Meshes and arrays are fetched by whichever analysis asks for them first, in
+ * an order that can differ between ranks, so the simulation's data adaptor
+ * must not make collective calls when serving them. Concurrent execution
+ * requires MPI_THREAD_MULTIPLE, is not used with in transit data adaptors,
+ * which communicate when serving data, and requires the cache. Otherwise the
+ * analyses are executed serially.
+ *
+ * Setting the `execution` attribute to `asynchronous` lets the simulation
+ * continue while the analyses run. Execute copies the simulation's data into
+ * a sensei::SnapshotDataAdaptor and returns immediately, the analyses are then
+ * executed one after another on a background thread. The `queue-depth`
+ * attribute sets how many steps may be pending before Execute blocks waiting
+ * for the oldest one to complete, by default 1. The meshes and arrays to copy
+ * are named in an optional `snapshot` element using the mesh element format of
+ * sensei::DataRequirements, when it is omitted all of the simulation's data is
+ * copied. For example:
+ *
+ * ```xml
+ * <sensei execution="asynchronous" queue-depth="2">
+ *   <snapshot>
+ *     <mesh name="mesh">
+ *       <cell_arrays> data </cell_arrays>
+ *     </mesh>
+ *   </snapshot>
+ *   ...
+ * </sensei>
+ * ```
+ *
+ * In asynchronous mode analysis output is not returned to the caller, and the
+ * remaining steps are completed by Finalize. Asynchronous execution requires
+ * MPI_THREAD_MULTIPLE and is not used with in transit data adaptors.
+ *
+ * Loops over the points and cells of a block, for instance binning in the
+ * histogram and the reductions of the autocorrelation, run in parallel on the
+ * threads of each rank using sensei::SMPUtils. The `smp-threads` attribute of
+ * the root element sets the number of threads per rank, one when it is not
+ * given, while `auto` divides the cores of each node evenly amongst its
+ * ranks. The `smp-max-threads` attribute caps the threads of every analysis,
+ * including those with their own `threads` settings, to leave cores to a
+ * simulation using OpenMP. The optional `smp-backend` attribute names the
+ * expected svtkSMPTools backend, one of `sequential`, `openmp`, or `tbb`,
+ * which is selected when SENSEI is configured by the CMake variable
+ * SVTK_SMP_IMPLEMENTATION_TYPE. For example:
+ *
+ * ```xml
+ * <sensei smp-backend="openmp" smp-threads="auto" smp-max-threads="4">
+ *   ...
+ * </sensei>
+ * ```
+ *
+ * When none of these attributes are given the analyses' loops run on one
+ * thread.
  */
 class SENSEI_EXPORT ConfigurableAnalysis : public AnalysisAdaptor
 {
@@ -1,6 +1,10 @@
 #include "ConfigurableInTransitDataAdaptor.h"
 #include "InTransitDataAdaptor.h"
+#include "SnapshotDataAdaptor.h"
+#include "DataRequirements.h"
+#include "ThreadPool.h"
 #include "XMLUtils.h"
+#include "Profiler.h"
 #include "Error.h"
 #ifdef ENABLE_ADIOS1
 #include "ADIOS1DataAdaptor.h"
@@ -13,26 +17,184 @@
 #endif
 
 #include <pugixml.hpp>
+#include <deque>
+#include <future>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <svtkObjectFactory.h>
+#include <svtkSmartPointer.h>
 
 namespace sensei
 {
 
 struct ConfigurableInTransitDataAdaptor::InternalsType
 {
-  InternalsType() : Adaptor(nullptr) {}
+  InternalsType() : Adaptor(nullptr), Current(nullptr), EndOfStream(false),
+    Finished(false) {}
 
   ~InternalsType()
   {
+    this->StopPrefetch();
+
     if (this->Adaptor)
       Adaptor->Delete();
   }
 
+  // returns the data adaptor serving the current step, the snapshot when
+  // prefetching and the transport otherwise
+  DataAdaptor *GetData()
+  {
+    if (this->Current)
+      return this->Current;
+    return this->Adaptor;
+  }
+
+  // returns true when steps are read on the background thread
+  bool Prefetching() const { return bool(this->Pool); }
+
+  // start reading steps on the background thread
+  int StartPrefetch(MPI_Comm comm, unsigned int depth,
+    const DataRequirements &reqs);
+
+  // queue a read of the next step into the snapshot
+  void QueueRead(SnapshotDataAdaptor *snap);
+
+  // wait for the oldest read to complete and make it the current step.
+  // returns 1 when the stream has ended
+  int WaitRead();
+
+  // wait for the queued reads and release the snapshots
+  void StopPrefetch();
+
   InTransitDataAdaptor *Adaptor;
+
+  // prefetching
+  DataRequirements PrefetchRequirements;
+  std::vector<svtkSmartPointer<SnapshotDataAdaptor>> Snapshots;
+  std::deque<std::pair<SnapshotDataAdaptor*, std::future<int>>> Pending;
+  SnapshotDataAdaptor *Current;
+  bool EndOfStream; // only touched by the pool's thread
+  bool Finished;
+  std::unique_ptr<ThreadPool> Pool;
 };
 
+// --------------------------------------------------------------------------
+int ConfigurableInTransitDataAdaptor::InternalsType::StartPrefetch(
+  MPI_Comm comm, unsigned int depth, const DataRequirements &reqs)
+{
+  // the transport makes MPI calls from the pool's thread while the
+  // analyses make MPI calls from the main thread
+  int threadLevel = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&threadLevel);
+  if (threadLevel < MPI_THREAD_MULTIPLE)
+    {
+    SENSEI_WARNING("Prefetching requires MPI_THREAD_MULTIPLE."
+      " Steps will be read on demand.")
+    return 0;
+    }
+
+  this->PrefetchRequirements = reqs;
+  this->EndOfStream = false;
+  this->Finished = false;
+
+  // one snapshot for the step being processed and one for each step read
+  // ahead. MPI_Comm_dup is collective, all ranks create them in order
+  this->Snapshots.clear();
+  for (unsigned int i = 0; i <= depth; ++i)
+    {
+    auto snap = svtkSmartPointer<SnapshotDataAdaptor>::New();
+    snap->SetCommunicator(comm);
+    this->Snapshots.push_back(snap);
+    }
+
+  // a single thread so that the steps are read in order
+  this->Pool.reset(new ThreadPool(1));
+
+  for (unsigned int i = 0; i <= depth; ++i)
+    this->QueueRead(this->Snapshots[i]);
+
+  SENSEI_STATUS("Configured prefetching " << depth << " steps ahead")
+
+  return this->WaitRead() < 0 ? -1 : 0;
+}
+
+// --------------------------------------------------------------------------
+void ConfigurableInTransitDataAdaptor::InternalsType::QueueRead(
+  SnapshotDataAdaptor *snap)
+{
+  std::future<int> status = this->Pool->Push([this, snap]() -> int {
+    if (this->EndOfStream)
+      return 1;
+
+    TimeEvent<128> mark("ConfigurableInTransitDataAdaptor::Prefetch");
+
+    // read the current step of the stream
+    if (snap->Snapshot(this->Adaptor, this->PrefetchRequirements))
+      {
+      SENSEI_ERROR("Failed to read step " << this->Adaptor->GetDataTimeStep())
+      this->EndOfStream = true;
+      return -1;
+      }
+
+    this->Adaptor->ReleaseData();
+
+    // begin the next step
+    if (this->Adaptor->AdvanceStream())
+      this->EndOfStream = true;
+
+    return 0;
+    });
+
+  this->Pending.push_back(std::make_pair(snap, std::move(status)));
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableInTransitDataAdaptor::InternalsType::WaitRead()
+{
+  TimeEvent<128> mark("ConfigurableInTransitDataAdaptor::WaitPrefetch");
+
+  this->Current = nullptr;
+
+  if (this->Pending.empty())
+    {
+    this->Finished = true;
+    return 1;
+    }
+
+  SnapshotDataAdaptor *snap = this->Pending.front().first;
+  int ierr = this->Pending.front().second.get();
+  this->Pending.pop_front();
+
+  if (ierr)
+    {
+    this->Finished = true;
+    return ierr;
+    }
+
+  this->Current = snap;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void ConfigurableInTransitDataAdaptor::InternalsType::StopPrefetch()
+{
+  if (!this->Pool)
+    return;
+
+  while (!this->Pending.empty())
+    {
+    this->Pending.front().second.wait();
+    this->Pending.pop_front();
+    }
+
+  this->Pool.reset();
+  this->Current = nullptr;
+  this->Snapshots.clear();
+}
+
 //----------------------------------------------------------------------------
 senseiNewMacro(ConfigurableInTransitDataAdaptor);
 
@@ -132,6 +294,7 @@ int ConfigurableInTransitDataAdaptor::Initialize(pugi::xml_node &root)
   // get rid of the existing adaptor, if any, now
   if (this->Internals->Adaptor)
     {
+    this->Internals->StopPrefetch();
     this->Internals->Adaptor->Delete();
     this->Internals->Adaptor = nullptr;
     }
@@ -148,6 +311,10 @@ int ConfigurableInTransitDataAdaptor::Initialize(pugi::xml_node &root)
   // everything is good, take ownership of the concrete instance
   this->Internals->Adaptor = adaptor;
 
+  // prefetching is handled here for all transports
+  this->SetPrefetchDepth(adaptor->GetPrefetchDepth());
+  this->SetPrefetchRequirements(adaptor->GetPrefetchRequirements());
+
   SENSEI_STATUS("Configured \"" << adaptor->GetClassName())
 
   return 0;
@@ -180,6 +347,12 @@ int ConfigurableInTransitDataAdaptor::GetSenderMeshMetadata(unsigned int id,
     return -1;
     }
 
+  if (this->Internals->Prefetching())
+    {
+    SENSEI_ERROR("GetSenderMeshMetadata is not available while prefetching")
+    return -1;
+    }
+
   return this->Internals->Adaptor->GetSenderMeshMetadata(id, metadata);
 }
 
@@ -193,6 +366,12 @@ int ConfigurableInTransitDataAdaptor::GetReceiverMeshMetadata(unsigned int id,
     return -1;
     }
 
+  if (this->Internals->Prefetching())
+    {
+    SENSEI_ERROR("GetReceiverMeshMetadata is not available while prefetching")
+    return -1;
+    }
+
   return this->Internals->Adaptor->GetReceiverMeshMetadata(id, metadata);
 }
 
@@ -206,6 +385,12 @@ int ConfigurableInTransitDataAdaptor::SetReceiverMeshMetadata(unsigned int id,
     return -1;
     }
 
+  if (this->Internals->Prefetching())
+    {
+    SENSEI_ERROR("SetReceiverMeshMetadata is not available while prefetching")
+    return -1;
+    }
+
   return this->Internals->Adaptor->SetReceiverMeshMetadata(id, metadata);
 }
 
@@ -241,7 +426,19 @@ int ConfigurableInTransitDataAdaptor::OpenStream()
     return -1;
     }
 
-  return this->Internals->Adaptor->OpenStream();
+  if (this->Internals->Adaptor->OpenStream())
+    return -1;
+
+  // read ahead on a background thread
+  unsigned int depth = this->GetPrefetchDepth();
+  if ((depth > 0) && this->Internals->StartPrefetch(this->GetCommunicator(),
+    depth, this->GetPrefetchRequirements()))
+    {
+    SENSEI_ERROR("Failed to start prefetching")
+    return -1;
+    }
+
+  return 0;
 }
 
 // -------------------------------------------------------------------------------
@@ -253,6 +450,8 @@ int ConfigurableInTransitDataAdaptor::CloseStream()
     return -1;
     }
 
+  this->Internals->StopPrefetch();
+
   return this->Internals->Adaptor->CloseStream();
 }
 
@@ -265,6 +464,20 @@ int ConfigurableInTransitDataAdaptor::AdvanceStream()
     return -1;
     }
 
+  if (this->Internals->Prefetching())
+    {
+    if (this->Internals->Finished)
+      return 1;
+
+    // recycle the current step's snapshot for a read and move on to the
+    // oldest step read
+    SnapshotDataAdaptor *snap = this->Internals->Current;
+    snap->ReleaseData();
+    this->Internals->QueueRead(snap);
+
+    return this->Internals->WaitRead();
+    }
+
   return this->Internals->Adaptor->AdvanceStream();
 }
 
@@ -277,6 +490,9 @@ int ConfigurableInTransitDataAdaptor::StreamGood()
     return -1;
     }
 
+  if (this->Internals->Prefetching())
+    return !this->Internals->Finished;
+
   return this->Internals->Adaptor->StreamGood();
 }
 
@@ -301,7 +517,7 @@ int ConfigurableInTransitDataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
     return -1;
     }
 
-  return this->Internals->Adaptor->GetNumberOfMeshes(numMeshes);
+  return this->Internals->GetData()->GetNumberOfMeshes(numMeshes);
 }
 
 // -------------------------------------------------------------------------------
@@ -314,7 +530,7 @@ int ConfigurableInTransitDataAdaptor::GetMeshMetadata(unsigned int id,
     return -1;
     }
 
-  return this->Internals->Adaptor->GetMeshMetadata(id, metadata);
+  return this->Internals->GetData()->GetMeshMetadata(id, metadata);
 }
 
 // -------------------------------------------------------------------------------
@@ -327,7 +543,7 @@ int ConfigurableInTransitDataAdaptor::GetMesh(const std::string &meshName,
     return -1;
     }
 
-  return this->Internals->Adaptor->GetMesh(meshName, structureOnly, mesh);
+  return this->Internals->GetData()->GetMesh(meshName, structureOnly, mesh);
 }
 
 // -------------------------------------------------------------------------------
@@ -340,7 +556,7 @@ int ConfigurableInTransitDataAdaptor::AddGhostNodesArray(svtkDataObject* mesh,
     return -1;
     }
 
-  return this->Internals->Adaptor->AddGhostNodesArray(mesh, meshName);
+  return this->Internals->GetData()->AddGhostNodesArray(mesh, meshName);
 }
 
 // -------------------------------------------------------------------------------
@@ -353,7 +569,7 @@ int ConfigurableInTransitDataAdaptor::AddGhostCellsArray(svtkDataObject* mesh,
     return -1;
     }
 
-  return this->Internals->Adaptor->AddGhostCellsArray(mesh, meshName);
+  return this->Internals->GetData()->AddGhostCellsArray(mesh, meshName);
 }
 
 // -------------------------------------------------------------------------------
@@ -366,7 +582,7 @@ int ConfigurableInTransitDataAdaptor::AddArray(svtkDataObject* mesh,
     return -1;
     }
 
-  return this->Internals->Adaptor->AddArray(mesh, meshName, association, arrayName);
+  return this->Internals->GetData()->AddArray(mesh, meshName, association, arrayName);
 }
 
 // -------------------------------------------------------------------------------
@@ -379,7 +595,7 @@ int ConfigurableInTransitDataAdaptor::AddArrays(svtkDataObject* mesh,
     return -1;
     }
 
-  return this->Internals->Adaptor->AddArrays(mesh, meshName, association, arrayName);
+  return this->Internals->GetData()->AddArrays(mesh, meshName, association, arrayName);
 }
 
 // -------------------------------------------------------------------------------
@@ -391,31 +607,31 @@ int ConfigurableInTransitDataAdaptor::ReleaseData()
     return -1;
     }
 
-  return this->Internals->Adaptor->ReleaseData();
+  return this->Internals->GetData()->ReleaseData();
 }
 
 // -------------------------------------------------------------------------------
 double ConfigurableInTransitDataAdaptor::GetDataTime()
 {
-  return this->Internals->Adaptor->GetDataTime();
+  return this->Internals->GetData()->GetDataTime();
 }
 
 // -------------------------------------------------------------------------------
 void ConfigurableInTransitDataAdaptor::SetDataTime(double time)
 {
-  this->Internals->Adaptor->SetDataTime(time);
+  this->Internals->GetData()->SetDataTime(time);
 }
 
 // -------------------------------------------------------------------------------
 long ConfigurableInTransitDataAdaptor::GetDataTimeStep()
 {
-  return this->Internals->Adaptor->GetDataTimeStep();
+  return this->Internals->GetData()->GetDataTimeStep();
 }
 
 // -------------------------------------------------------------------------------
 void ConfigurableInTransitDataAdaptor::SetDataTimeStep(long index)
 {
-  this->Internals->Adaptor->SetDataTimeStep(index);
+  this->Internals->GetData()->SetDataTimeStep(index);
 }
 
 }
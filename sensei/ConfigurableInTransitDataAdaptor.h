@@ -39,6 +39,29 @@ namespace sensei
  *   </transport>
  * <sensei>
  * ```
+ *
+ * When the `prefetch-depth` attribute of the transport element is greater
+ * than zero the steps are read ahead of time on a background thread, see
+ * InTransitDataAdaptor::SetPrefetchDepth. Each step's receiver partitioned
+ * meshes and arrays are copied into a sensei::SnapshotDataAdaptor, after which
+ * the stream is advanced and reading of the next step begins. The data
+ * adaptor API serves the current step's snapshot, while up to depth steps are
+ * in flight. The meshes and arrays read may be limited by a `prefetch` element.
+ * Prefetching requires MPI_THREAD_MULTIPLE. The sender and receiver metadata
+ * API is not available while prefetching, and the partitioner must be set
+ * before the stream is opened.
+ *
+ * ```xml
+ * <sensei>
+ *   <transport type="adios2" engine="SST" filename="test.bp" prefetch-depth="1">
+ *     <prefetch>
+ *       <mesh name="mesh">
+ *         <cell_arrays> data </cell_arrays>
+ *       </mesh>
+ *     </prefetch>
+ *   </transport>
+ * <sensei>
+ * ```
  */
 class SENSEI_EXPORT ConfigurableInTransitDataAdaptor : public sensei::InTransitDataAdaptor
 {
@@ -4,6 +4,8 @@
 #include "MappedPartitioner.h"
 #include "PlanarPartitioner.h"
 #include "PlanarSlicePartitioner.h"
+#include "WeightedPartitioner.h"
+#include "SpaceFillingCurvePartitioner.h"
 #include "XMLUtils.h"
 #include "Profiler.h"
 
@@ -80,6 +82,14 @@ int ConfigurablePartitioner::Initialize(pugi::xml_node &partNode)
     {
     tmp = PlanarSlicePartitioner::New();
     }
+  else if (partType == "weighted")
+    {
+    tmp = WeightedPartitioner::New();
+    }
+  else if (partType == "sfc")
+    {
+    tmp = SpaceFillingCurvePartitioner::New();
+    }
   else
     {
     SENSEI_ERROR("Failed to construct a partitioner. \""
@@ -10,6 +10,8 @@
 #include "MappedPartitioner.h"
 #include "PlanarSlicePartitioner.h"
 #include "IsoSurfacePartitioner.h"
+#include "WeightedPartitioner.h"
+#include "SpaceFillingCurvePartitioner.h"
 #include "ConfigurablePartitioner.h"
 #include "SVTKUtils.h"
 #include "Error.h"
@@ -290,6 +292,85 @@ SENSEI_IN_TRANSIT_DATA_ADAPTOR_IGNORE_CPP_API(sensei::##CLASS)
 /****************************************************************************
  * DataAdaptor
  ***************************************************************************/
+%newobject sensei::DataAdaptor::GetMeshArrays;
+%extend sensei::DataAdaptor
+{
+// ------------------------------------------------------------------------
+svtkDataObject *GetMeshArrays(const std::string &meshName, int association,
+  const std::vector<std::string> &arrayNames, bool structureOnly = true)
+{
+  svtkDataObject *mesh = nullptr;
+  const char *failed = nullptr;
+
+  // the GIL is released while the simulation provides the data. data
+  // adaptors implemented in Python acquire it in their callbacks
+  Py_BEGIN_ALLOW_THREADS
+  if (self->GetMesh(meshName, structureOnly, mesh))
+    {
+    failed = "";
+    }
+  else
+    {
+    size_t nArrays = arrayNames.size();
+    for (size_t i = 0; !failed && (i < nArrays); ++i)
+      {
+      if (self->AddArray(mesh, meshName, association, arrayNames[i]))
+        failed = arrayNames[i].c_str();
+      }
+    }
+  Py_END_ALLOW_THREADS
+
+  if (failed && !failed[0])
+    {
+    PyErr_Format(PyExc_RuntimeError,
+      "DataAdaptor : Failed to get mesh \"%s\"", meshName.c_str());
+    PyErr_Print();
+    }
+  else if (failed)
+    {
+    PyErr_Format(PyExc_RuntimeError,
+      "DataAdaptor : Failed to add %s data array \"%s\" to mesh \"%s\"",
+      sensei::SVTKUtils::GetAttributesName(association),
+      failed, meshName.c_str());
+    PyErr_Print();
+    }
+
+  return mesh;
+}
+
+%pythoncode
+%{
+def GetNumpyArrays(self, meshName, association, arrayNames, structureOnly=True):
+    """Fetch a mesh and the named arrays in one call, and return a dict
+    mapping each array name to a list with a zero-copy numpy view of the
+    array on each local block, or None where a block lacks the array.
+    The views keep the mesh alive."""
+    import svtk
+    from svtk.numpy_support import svtk_to_numpy
+
+    mesh = self.GetMeshArrays(meshName, association, arrayNames, structureOnly)
+
+    blocks = []
+    if isinstance(mesh, svtk.svtkCompositeDataSet):
+        it = mesh.NewIterator()
+        it.InitTraversal()
+        while not it.IsDoneWithTraversal():
+            blocks.append(it.GetCurrentDataObject())
+            it.GoToNextItem()
+    elif mesh is not None:
+        blocks.append(mesh)
+
+    arrays = {}
+    for name in arrayNames:
+        views = []
+        for block in blocks:
+            arr = block.GetAttributes(association).GetArray(name)
+            views.append(None if arr is None else svtk_to_numpy(arr, owner=mesh))
+        arrays[name] = views
+
+    return arrays
+%}
+};
 SENSEI_WRAP_DATA_ADAPTOR(DataAdaptor)
 
 /****************************************************************************
@@ -301,6 +382,8 @@ SENSEI_WRAP_DATA_ADAPTOR(DataAdaptor)
 %shared_ptr(sensei::MappedPartitioner)
 %shared_ptr(sensei::PlanarSlicePartitioner)
 %shared_ptr(sensei::IsoSurfacePartitioner)
+%shared_ptr(sensei::WeightedPartitioner)
+%shared_ptr(sensei::SpaceFillingCurvePartitioner)
 %shared_ptr(sensei::ConfigurablePartitioner)
 
 %define PARTITIONER_API(cname)
@@ -326,6 +409,8 @@ PARTITIONER_API(PlanarPartitioner)
 PARTITIONER_API(MappedPartitioner)
 PARTITIONER_API(PlanarSlicePartitioner)
 PARTITIONER_API(IsoSurfacePartitioner)
+PARTITIONER_API(WeightedPartitioner)
+PARTITIONER_API(SpaceFillingCurvePartitioner)
 PARTITIONER_API(ConfigurablePartitioner)
 
 %include "Partitioner.h"
@@ -334,6 +419,8 @@ PARTITIONER_API(ConfigurablePartitioner)
 %include "MappedPartitioner.h"
 %include "PlanarSlicePartitioner.h"
 %include "IsoSurfacePartitioner.h"
+%include "WeightedPartitioner.h"
+%include "SpaceFillingCurvePartitioner.h"
 %include "ConfigurablePartitioner.h"
 
 /****************************************************************************
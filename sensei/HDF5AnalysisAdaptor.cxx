@@ -211,23 +211,24 @@ bool HDF5AnalysisAdaptor::Execute(DataAdaptor* dataAdaptor, DataAdaptor** daOut)
         }
 
       // generate a global view of the metadata. everything we do from here
-      // on out depends on having the global view.
-      if (!md->GlobalView)
+      // on out depends on having the global view. when the block structure
+      // is unchanged since the last step the cached view is reused
+      if (this->m_MetadataCache.GlobalizeView(comm, md))
         {
-          sensei::MPIUtils::GlobalViewV(comm, md->BlockOwner);
-          sensei::MPIUtils::GlobalViewV(comm, md->BlockIds);
-          sensei::MPIUtils::GlobalViewV(comm, md->BlockNumPoints);
-          sensei::MPIUtils::GlobalViewV(comm, md->BlockNumCells);
-          sensei::MPIUtils::GlobalViewV(comm, md->BlockCellArraySize);
-          sensei::MPIUtils::GlobalViewV(comm, md->BlockExtents);
-          md->GlobalView = true;
+          SENSEI_ERROR("Failed to globalize metadata for mesh \""
+                       << mit.MeshName() << "\"");
+          return false;
         }
 
       // ensure multiblock
       svtkCompositeDataSetPtr cds = SVTKUtils::AsCompositeData(comm, dobj);
 
       // write
-      this->m_HDF5Writer->WriteMesh(md, cds.Get());
+      if (!this->m_HDF5Writer->WriteMesh(md, cds.Get()))
+        {
+          SENSEI_ERROR("Failed to write mesh \"" << mit.MeshName() << "\"");
+          return false;
+        }
 
       ++mit;
     }
@@ -244,6 +245,7 @@ bool HDF5AnalysisAdaptor::InitializeHDF5()
     {
       this->m_HDF5Writer =
         new senseiHDF5::WriteStream(this->GetCommunicator(), m_DoStreaming);
+      this->m_HDF5Writer->SetOptions(this->m_Options);
       if (!this->m_HDF5Writer->Init(this->m_FileName))
         {
           return -1;
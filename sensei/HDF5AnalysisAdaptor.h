@@ -4,6 +4,7 @@
 #include "AnalysisAdaptor.h"
 #include "DataRequirements.h"
 #include "MeshMetadata.h"
+#include "MeshMetadataCache.h"
 
 #include "hdf5.h"
 #include <mpi.h>
@@ -46,6 +47,28 @@ public:
   /// Enables MPI collective I/O
   void SetCollective(bool s) { m_Collective = s; }
 
+  /** Sets the size in bytes of the chunks of the datasets. Zero, the
+   * default, writes contiguous datasets.
+   */
+  void SetChunkSize(unsigned long size) { m_Options.ChunkSize = size; }
+
+  /** Sets the deflate compression level, 1-9. Zero, the default, disables
+   * compression.
+   */
+  void SetCompressionLevel(int level) { m_Options.CompressionLevel = level; }
+
+  /// Enables the shuffle filter, applied before compression
+  void SetShuffle(bool s) { m_Options.Shuffle = s; }
+
+  /** Sets the number of ranks that write. The other ranks send their blocks
+   * to a writer. Zero, the default, means that all ranks write.
+   */
+  void SetNumWriters(int n) { m_Options.NumWriters = n; }
+
+  /// Sets an MPI-IO hint, for instance cb_nodes or cb_buffer_size
+  void SetHint(const std::string &key, const std::string &value)
+  { m_Options.Hints[key] = value; }
+
   std::string GetFileName() const { return this->m_FileName; }
 
   /// data requirements tell the adaptor what to push
@@ -82,6 +105,8 @@ protected:
   std::string m_FileName;
   bool m_DoStreaming = false;
   bool m_Collective = false;
+  senseiHDF5::WriteOptions m_Options;
+  MeshMetadataCache m_MetadataCache;
 
 private:
   senseiHDF5::WriteStream *m_HDF5Writer;
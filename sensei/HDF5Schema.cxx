@@ -40,13 +40,24 @@
 #include <svtkUnsignedLongLongArray.h>
 #include <svtkUnstructuredGrid.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <map>
+#include <numeric>
 #include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include <unistd.h>
+#include <poll.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
 
 #include "BlockPartitioner.h"
 
@@ -114,56 +125,37 @@ hid_t gHDF5_IDType()
 
 hid_t gGetHDF5Type(svtkDataArray *da)
 {
-  if(dynamic_cast<svtkFloatArray *>(da))
+  // dispatch on the value type so that arrays of any memory layout, for
+  // instance svtkSOADataArrayTemplate, are handled
+  switch(da->GetDataType())
     {
+    case SVTK_FLOAT:
       return H5T_NATIVE_FLOAT;
-    }
-  else if(dynamic_cast<svtkDoubleArray *>(da))
-    {
+    case SVTK_DOUBLE:
       return H5T_NATIVE_DOUBLE;
-    }
-  else if(dynamic_cast<svtkCharArray *>(da))
-    {
+    case SVTK_CHAR:
       return H5T_NATIVE_CHAR;
-    }
-  else if(dynamic_cast<svtkIntArray *>(da))
-    {
+    case SVTK_INT:
       return H5T_NATIVE_INT;
-    }
-  else if(dynamic_cast<svtkLongArray *>(da))
-    {
+    case SVTK_LONG:
       if(sizeof(long) == 4)
         return H5T_NATIVE_INT; // 32 bits
       return H5T_NATIVE_LONG;  // 64 bits
-    }
-  else if(dynamic_cast<svtkLongLongArray *>(da))
-    {
+    case SVTK_LONG_LONG:
       return H5T_NATIVE_LONG; // 64 bits
-    }
-  else if(dynamic_cast<svtkUnsignedCharArray *>(da))
-    {
+    case SVTK_UNSIGNED_CHAR:
       return H5T_NATIVE_UCHAR;
-    }
-  else if(dynamic_cast<svtkUnsignedIntArray *>(da))
-    {
+    case SVTK_UNSIGNED_INT:
       return H5T_NATIVE_UINT;
-    }
-  else if(dynamic_cast<svtkUnsignedLongArray *>(da))
-    {
+    case SVTK_UNSIGNED_LONG:
       if(sizeof(unsigned long) == 4)
         return H5T_NATIVE_UINT; // 32 bits
       return H5T_NATIVE_ULONG;  // 64 bits
-    }
-  else if(dynamic_cast<svtkUnsignedLongLongArray *>(da))
-    {
+    case SVTK_UNSIGNED_LONG_LONG:
       return H5T_NATIVE_ULONG; // 64 bits
-    }
-  else if(dynamic_cast<svtkIdTypeArray *>(da))
-    {
+    case SVTK_ID_TYPE:
       return gHDF5_IDType();
-    }
-  else
-    {
+    default:
       SENSEI_ERROR("the HDF5  type for data array \""
                    << da->GetClassName() << "\" is currently not implemented")
       MPI_Abort(MPI_COMM_WORLD, -1);
@@ -171,6 +163,59 @@ hid_t gGetHDF5Type(svtkDataArray *da)
   return -1;
 }
 
+// codes for the native types, used to communicate a dataset's type
+hid_t gH5TypeFromCode(int code)
+{
+  switch(code)
+    {
+    case 0: return H5T_NATIVE_CHAR;
+    case 1: return H5T_NATIVE_UCHAR;
+    case 2: return H5T_NATIVE_INT;
+    case 3: return H5T_NATIVE_UINT;
+    case 4: return H5T_NATIVE_LONG;
+    case 5: return H5T_NATIVE_ULONG;
+    case 6: return H5T_NATIVE_FLOAT;
+    case 7: return H5T_NATIVE_DOUBLE;
+    }
+  return -1;
+}
+
+int gH5TypeCode(hid_t h5Type)
+{
+  for(int i = 0; i < 8; ++i)
+    {
+      if(H5Tequal(h5Type, gH5TypeFromCode(i)) > 0)
+        return i;
+    }
+
+  SENSEI_ERROR("No code for HDF5 type " << h5Type);
+  MPI_Abort(MPI_COMM_WORLD, -1);
+  return -1;
+}
+
+// send and receive in pieces that fit in an MPI count
+static const unsigned long gMaxMessageSize = 1ul << 30;
+
+static void gSendBytes(const void *buf, unsigned long n, int dest, MPI_Comm comm)
+{
+  const char *pbuf = static_cast<const char *>(buf);
+  for(unsigned long i = 0; i < n; i += gMaxMessageSize)
+    {
+      int count = std::min(gMaxMessageSize, n - i);
+      MPI_Send(pbuf + i, count, MPI_BYTE, dest, 0, comm);
+    }
+}
+
+static void gRecvBytes(void *buf, unsigned long n, int src, MPI_Comm comm)
+{
+  char *pbuf = static_cast<char *>(buf);
+  for(unsigned long i = 0; i < n; i += gMaxMessageSize)
+    {
+      int count = std::min(gMaxMessageSize, n - i);
+      MPI_Recv(pbuf + i, count, MPI_BYTE, src, 0, comm, MPI_STATUS_IGNORE);
+    }
+}
+
 hid_t gSVTKToH5Type(int svtkt)
 {
   switch(svtkt)
@@ -398,6 +443,138 @@ bool DefaultStreamHandler::Summary()
 // if using char, do 11111 and use 0 to indicate end... so only need to check
 // whether the last char is 0?
 
+// the longest interval between checks for the step manifest
+static const int gMaxWaitDelayMs = 128;
+
+//
+// waits for the step manifest to change. inotify reports changes made on
+// this node immediately. changes made on other nodes of a parallel file
+// system are not reported, these are found by stat'ing the manifest with
+// exponential backoff, which is also the fallback where inotify is not
+// available
+//
+class ManifestWatcher
+{
+public:
+  ManifestWatcher(const std::string &fileName)
+    : m_FileName(fileName)
+    , m_Fd(-1)
+    , m_DelayMs(1)
+  {
+    GetStat(m_LastStat);
+
+#if defined(__linux__)
+    size_t slash = fileName.rfind('/');
+    std::string dirName =
+      slash == std::string::npos ? "." : fileName.substr(0, slash + 1);
+
+    m_BaseName =
+      slash == std::string::npos ? fileName : fileName.substr(slash + 1);
+
+    m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if((m_Fd >= 0) &&
+       (inotify_add_watch(m_Fd, dirName.c_str(),
+                          IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE) < 0))
+      {
+        close(m_Fd);
+        m_Fd = -1;
+      }
+#endif
+  }
+
+  ~ManifestWatcher()
+  {
+    if(m_Fd >= 0)
+      close(m_Fd);
+  }
+
+  // returns when the manifest may have changed or maxSec elapsed
+  void Wait(double maxSec)
+  {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    while(true)
+      {
+        double remMs = 1000.0 * maxSec - std::chrono::duration<double,
+          std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        if(remMs <= 0.0)
+          return;
+
+        int delayMs = std::min(m_DelayMs, int(remMs) + 1);
+        m_DelayMs = std::min(2 * m_DelayMs, gMaxWaitDelayMs);
+
+        if(m_Fd >= 0)
+          {
+            pollfd pfd;
+            pfd.fd = m_Fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if((poll(&pfd, 1, delayMs) > 0) && Drain())
+              return;
+          }
+        else
+          {
+            usleep(1000 * delayMs);
+          }
+
+        // changed on another node
+        struct stat st;
+        GetStat(st);
+        if((st.st_size != m_LastStat.st_size) ||
+           (st.st_ino != m_LastStat.st_ino) ||
+           (st.st_mtime != m_LastStat.st_mtime))
+          {
+            m_LastStat = st;
+            return;
+          }
+      }
+  }
+
+private:
+  void GetStat(struct stat &st)
+  {
+    if(stat(m_FileName.c_str(), &st))
+      memset(&st, 0, sizeof(st));
+  }
+
+  // read the queued events, returns true if one concerned the manifest
+  bool Drain()
+  {
+    bool changed = false;
+#if defined(__linux__)
+    char buf[4096]
+      __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    ssize_t len = 0;
+    while((len = read(m_Fd, buf, sizeof(buf))) > 0)
+      {
+        for(char *ptr = buf; ptr < buf + len;)
+          {
+            struct inotify_event *evt =
+              reinterpret_cast<struct inotify_event *>(ptr);
+
+            if(evt->len && (m_BaseName == evt->name))
+              changed = true;
+
+            ptr += sizeof(struct inotify_event) + evt->len;
+          }
+      }
+#endif
+    if(changed)
+      GetStat(m_LastStat);
+
+    return changed;
+  }
+
+  std::string m_FileName;
+  std::string m_BaseName;
+  int m_Fd;
+  int m_DelayMs;
+  struct stat m_LastStat;
+};
+
 //
 //
 //
@@ -405,18 +582,8 @@ PerStepStreamHandler::PerStepStreamHandler(const std::string &hostFile,
     ReadStream *client)
   : StreamHandler(true, hostFile, client)
 {
-  unsigned int AllowedTimeOutSec = 300;
-
-  // loop until timestep showed
-  unsigned int counter = 0;
-  while(counter < AllowedTimeOutSec)
-    {
-      GetCurrAvailStep();
-      if(m_NumStepsWritten > 0)
-        break;
-      sleep(2);
-      counter += 5;
-    }
+  // wait for the first step
+  WaitForSteps(1, 300.0);
 }
 
 PerStepStreamHandler::PerStepStreamHandler(const std::string &hostFile,
@@ -469,88 +636,103 @@ bool PerStepStreamHandler::Summary()
       return true;
     }
 
-  if(m_Client->m_Rank > 0)
-    return true;
-
-  std::ofstream outfile;
-  outfile.open(m_FileName, std::ios::out | std::ios::app);
-
-  if(outfile.fail())
-    throw std::ios_base::failure(std::strerror(errno));
-
-  outfile << 0;
-
-  outfile.close();
+  UpdateAvailStep(true);
 
   return true;
 }
 
-void PerStepStreamHandler::GetCurrAvailStep()
+void PerStepStreamHandler::ReadManifest()
 {
   if(m_AllStepsWritten)
     return;
 
+  // the manifest holds a 1 for each complete step, and a 0 once the writer
+  // is done. it is replaced atomically so it is never seen partially written
   int counter = -1;
-  if(m_Client->m_Rank == 0)
+
+  std::ifstream curr(m_FileName);
+  if(curr.is_open())
     {
-      std::ifstream curr(m_FileName);
       std::string line;
-      if(curr.is_open())
+      getline(curr, line);
+      curr.close();
+
+      counter = line.size();
+      if(!line.empty() && ('0' == line.back()))
         {
-          // while ( getline (curr,line) )
-          getline(curr, line);
-          curr.close();
+          counter--;
+          m_AllStepsWritten = true;
+        }
+    }
 
-          counter = line.size();
-          if('0' == line.back())
-            {
-              counter--;
-              m_AllStepsWritten = true;
-            }
-        } // else {
-      // counter = -1; // no such file
-      //}
-      m_NumStepsWritten = counter;
+  m_NumStepsWritten = counter;
+}
 
-      counter *= 10;
-      if(m_AllStepsWritten)
-        counter += 1;
-      MPI_Bcast(&counter, 1, MPI_INT, 0, m_Client->m_Comm);
-    }
-  else
+void PerStepStreamHandler::WaitForSteps(int nSteps, double timeoutSec)
+{
+  sensei::TimeEvent<128> mark("PerStepStreamHandler::WaitForSteps");
+
+  if(m_Client->m_Rank == 0)
     {
-      MPI_Bcast(&counter, 1, MPI_INT, 0, m_Client->m_Comm);
-      int c = counter % 10;
-      if(1 == c)
+      // start watching before looking so that no update is missed
+      ManifestWatcher watcher(m_FileName);
+
+      std::chrono::steady_clock::time_point t0 =
+        std::chrono::steady_clock::now();
+
+      while(true)
         {
-          counter = (counter - 1) / 10;
-          m_AllStepsWritten = true;
-        }
-      else
-        counter = counter / 10;
+          ReadManifest();
+
+          if((m_NumStepsWritten >= nSteps) || m_AllStepsWritten)
+            break;
+
+          // the reader removed the manifest, all finished
+          if((m_NumStepsWritten < 0) && (m_TimeStepCounter > 0))
+            break;
 
-      m_NumStepsWritten = counter;
+          double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - t0).count();
+
+          if(elapsed > timeoutSec)
+            break;
+
+          watcher.Wait(timeoutSec - elapsed);
+        }
     }
+
+  // share with the other ranks
+  int state[2] = {m_NumStepsWritten, int(m_AllStepsWritten)};
+  MPI_Bcast(state, 2, MPI_INT, 0, m_Client->m_Comm);
+
+  m_NumStepsWritten = state[0];
+  m_AllStepsWritten = state[1];
 }
 
-void PerStepStreamHandler::UpdateAvailStep()
+void PerStepStreamHandler::UpdateAvailStep(bool done)
 {
-  // testing sleep(m_TimeStepCounter*10);
   if(m_Client->m_Rank > 0)
     {
       return;
     }
 
-  std::ofstream outfile;
+  // write the manifest next to the final one, then rename it into place
+  std::string tmpName = m_FileName + ".tmp";
 
-  outfile.open(m_FileName, std::ios::out | std::ios::app);
+  std::ofstream outfile;
+  outfile.open(tmpName, std::ios::out | std::ios::trunc);
 
   if(outfile.fail())
     throw std::ios_base::failure(std::strerror(errno));
 
-  outfile << 1;
-  outfile.flush();
+  outfile << std::string(m_TimeStepCounter, '1');
+  if(done)
+    outfile << 0;
+
   outfile.close();
+
+  if(std::rename(tmpName.c_str(), m_FileName.c_str()))
+    throw std::ios_base::failure(std::strerror(errno));
 }
 
 bool PerStepStreamHandler::NoMoreStep()
@@ -561,27 +743,15 @@ bool PerStepStreamHandler::NoMoreStep()
   if(m_AllStepsWritten && (0 == (m_NumStepsWritten - m_TimeStepCounter)))
     return true;
 
-  unsigned int counter = 0;
-  unsigned int MAXWAIT = 900;
-
-  while (true)
-  {
-    GetCurrAvailStep();
-    if ((m_NumStepsWritten < 0) && (m_TimeStepCounter > 0))
-      return true; // all finished
-
-    if ((m_NumStepsWritten - m_TimeStepCounter) > 0)
-      return false;
+  WaitForSteps(m_TimeStepCounter + 1, 900.0);
 
-    if (m_AllStepsWritten && (0 == (m_NumStepsWritten - m_TimeStepCounter)))
-      return true;
+  if((m_NumStepsWritten < 0) && (m_TimeStepCounter > 0))
+    return true; // all finished
 
-    sleep(1);
+  if((m_NumStepsWritten - m_TimeStepCounter) > 0)
+    return false;
 
-    counter++;
-    if(counter > MAXWAIT)
-      return true;
-  }
+  // the writer is done, or timed out
   return true;
 }
 
@@ -652,18 +822,45 @@ BasicStream::BasicStream(MPI_Comm comm, bool streaming)
   m_Comm = comm;
 
   m_PropertyListId = H5Pcreate(H5P_FILE_ACCESS);
+#ifdef H5_HAVE_PARALLEL
   H5Pset_fapl_mpio(m_PropertyListId, comm, MPI_INFO_NULL);
+#endif
 
   m_CollectiveTxf = H5P_DEFAULT;
 }
 
 void BasicStream::SetCollectiveTxf()
 {
+#ifdef H5_HAVE_PARALLEL
   if(m_Size > 1)
     {
       m_CollectiveTxf = H5Pcreate(H5P_DATASET_XFER);
       H5Pset_dxpl_mpio(m_CollectiveTxf, H5FD_MPIO_COLLECTIVE);
     }
+#endif
+}
+
+void BasicStream::SetHints(const std::map<std::string, std::string> &hints)
+{
+#ifdef H5_HAVE_PARALLEL
+  if(hints.empty())
+    return;
+
+  MPI_Info info;
+  MPI_Info_create(&info);
+
+  std::map<std::string, std::string>::const_iterator it = hints.begin();
+  for(; it != hints.end(); ++it)
+    MPI_Info_set(info, it->first.c_str(), it->second.c_str());
+
+  // the file access property list keeps a copy
+  H5Pset_fapl_mpio(m_PropertyListId, m_Comm, info);
+
+  MPI_Info_free(&info);
+#else
+  // MPI-IO hints have no effect with serial HDF5
+  (void)hints;
+#endif
 }
 
 BasicStream::~BasicStream()
@@ -814,8 +1011,18 @@ bool ReadStream::ReadMetadata(unsigned int &nMesh)
       if(!ReadBinary(path, bs))
         return false;
 
+      // the block structure is omitted when it has not changed since the
+      // previous step
+      sensei::MeshMetadataPtr prev;
+      if (i < m_PreviousMetadata.size())
+        prev = m_PreviousMetadata[i];
+
       sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
-      md->FromStream(bs);
+      if (md->FromStreamDelta(bs, prev))
+        return false;
+
+      m_PreviousMetadata.resize(nMesh);
+      m_PreviousMetadata[i] = md->NewCopy();
 
       // add internally generated arrays
       md->ArrayName.push_back("SenderBlockOwner");
@@ -1126,32 +1333,38 @@ bool MeshFlow::WriteTo(WriteStream *output, const sensei::MeshMetadataPtr &md)
         it->GoToNextItem();
       }
     it->Delete();
+
+    if(!output->FlushVars())
+      return false;
   }
 
   {
     unsigned int num_arrays = md->NumArrays;
     for (unsigned int i = 0; i < num_arrays; ++i) {
       ArrayFlow arrayFlow(md, m_MeshID, i);
-      Unload(&arrayFlow, md, output);
+      if(!Unload(&arrayFlow, md, output))
+        return false;
     }
   }
 
   {
     if (md->NumGhostCells) {
       ArrayFlow arrayFlow(m_MeshID, svtkDataObject::CELL, md);
-      Unload(&arrayFlow, md, output);
+      if(!Unload(&arrayFlow, md, output))
+        return false;
     }
 
     if (md->NumGhostNodes) {
       ArrayFlow arrayFlow(m_MeshID, svtkDataObject::POINT, md);
-      Unload(&arrayFlow, md, output);
+      if(!Unload(&arrayFlow, md, output))
+        return false;
     }
   }
 
   return true;
 }
 
-void MeshFlow::Unload(ArrayFlow *arrayFlowPtr,
+bool MeshFlow::Unload(ArrayFlow *arrayFlowPtr,
                       const sensei::MeshMetadataPtr &md, 
 		      WriteStream *output) 
 {
@@ -1171,6 +1384,9 @@ void MeshFlow::Unload(ArrayFlow *arrayFlowPtr,
   }
 
   it->Delete();
+
+  // the array data is written by deferred writes
+  return output->FlushVars();
 }
 
 //
@@ -1325,19 +1541,16 @@ bool ArrayFlow::load(unsigned int block_id,
                      svtkCompositeDataIterator *it,
                      ReadStream *reader)
 {
-  unsigned long long num_elem_local =
-    m_NumArrayComponent * (m_ArrayCenter == svtkDataObject::POINT
-                           ? m_Metadata->BlockNumPoints[block_id]
-                           : m_Metadata->BlockNumCells[block_id]);
+  unsigned long long num_tuples_local = getLocalElement(block_id);
+  unsigned long long num_elem_local = m_NumArrayComponent * num_tuples_local;
 
   uint64_t start = m_BlockOffset;
   uint64_t count = num_elem_local;
-  ;
 
   svtkDataArray *array = svtkDataArray::CreateDataArray(GetArrayType());
   array->SetNumberOfComponents(m_NumArrayComponent);
   array->SetName(GetArrayName().c_str());
-  array->SetNumberOfTuples(num_elem_local);
+  array->SetNumberOfTuples(num_tuples_local);
 
   if(!reader->ReadVar1D(m_ArrayPath, start, count, array->GetVoidPointer(0)))
     return false;
@@ -1400,11 +1613,13 @@ bool ArrayFlow::unload(unsigned int block_id,
   // if (-1 == m_ArrayVarID)
   // m_ArrayVarID = output->CreateVar(m_ArrayPath, arraySpace, h5TypeCurrArray);
 
+  // WriteVar is done with the values when it returns
+  svtkSmartPointer<svtkDataArray> aos;
   output->WriteVar(m_ArrayVarID,
                    m_ArrayPath,
                    arraySpace,
                    h5TypeCurrArray,
-                   da->GetVoidPointer(0));
+                   sensei::SVTKUtils::GetAOSPointer(da, aos));
 
   return true;
 }
@@ -1444,8 +1659,7 @@ bool PolydataCellFlow::load(unsigned int block_id,
                             ReadStream *reader)
 {
   // /data_object_<id>/cell_types
-  unsigned long long cell_array_size_local =
-    m_Metadata->BlockCellArraySize[block_id];
+  unsigned long long cell_array_size_local = getCellArraySize(block_id);
   unsigned long long num_cells_local = m_Metadata->BlockNumCells[block_id];
 
   std::vector<svtkIdType> cell_array(cell_array_size_local);
@@ -1493,7 +1707,7 @@ bool PolydataCellFlow::load(unsigned int block_id,
   // find first and last poly and number of polys
   unsigned long n_polys = 0;
   svtkIdType *poly_begin = p_cells;
-  while((i < num_cells_local) && (p_types[i] == SVTK_VERTEX))
+  while((i < num_cells_local) && (p_types[i] == SVTK_POLYGON))
     {
       p_cells += p_cells[0] + 1;
       ++n_polys;
@@ -1504,7 +1718,7 @@ bool PolydataCellFlow::load(unsigned int block_id,
   // find first and last strip and number of strips
   unsigned long n_strips = 0;
   svtkIdType *strip_begin = p_cells;
-  while((i < num_cells_local) && (p_types[i] == SVTK_VERTEX))
+  while((i < num_cells_local) && (p_types[i] == SVTK_TRIANGLE_STRIP))
     {
       p_cells += p_cells[0] + 1;
       ++n_strips;
@@ -1597,8 +1811,7 @@ bool PolydataCellFlow::unload(unsigned int block_id,
   hid_t h5TypeCellType = H5T_NATIVE_CHAR;
 
   unsigned long long num_cells_local = m_Metadata->BlockNumCells[block_id];
-  unsigned long long cell_array_size_local =
-    m_Metadata->BlockCellArraySize[block_id];
+  unsigned long long cell_array_size_local = getCellArraySize(block_id);
 
   svtkPolyData *pd = dynamic_cast<svtkPolyData *>(it->GetCurrentDataObject());
 
@@ -1678,7 +1891,7 @@ bool PolydataCellFlow::update(unsigned int block_id)
 {
   m_CellTypesBlockOffset += m_Metadata->BlockNumCells[block_id];
   ;
-  m_CellArrayBlockOffset += m_Metadata->BlockCellArraySize[block_id];
+  m_CellArrayBlockOffset += getCellArraySize(block_id);
 
   return true;
 }
@@ -1699,8 +1912,7 @@ bool UnstructuredCellFlow::load(unsigned int block_id,
                                 ReadStream *reader)
 {
   // /data_object_<id>/cell_types
-  unsigned long long cell_array_size_local =
-    m_Metadata->BlockCellArraySize[block_id];
+  unsigned long long cell_array_size_local = getCellArraySize(block_id);
   unsigned long long num_cells_local = m_Metadata->BlockNumCells[block_id];
   uint64_t ct_start = m_CellTypesBlockOffset;
   uint64_t ct_count = num_cells_local;
@@ -1763,7 +1975,7 @@ bool UnstructuredCellFlow::update(unsigned int block_id)
 {
   m_CellTypesBlockOffset += m_Metadata->BlockNumCells[block_id];
   ;
-  m_CellArrayBlockOffset += m_Metadata->BlockCellArraySize[block_id];
+  m_CellArrayBlockOffset += getCellArraySize(block_id);
 
   return true;
 }
@@ -1776,8 +1988,7 @@ bool UnstructuredCellFlow::unload(unsigned int block_id,
   hid_t h5TypeCellType = H5T_NATIVE_CHAR;
 
   unsigned long long num_cells_local = m_Metadata->BlockNumCells[block_id];
-  unsigned long long cell_array_size_local =
-    m_Metadata->BlockCellArraySize[block_id];
+  unsigned long long cell_array_size_local = getCellArraySize(block_id);
 
   svtkUnstructuredGrid *ds =
     dynamic_cast<svtkUnstructuredGrid *>(it->GetCurrentDataObject());
@@ -1831,7 +2042,7 @@ SVTKObjectFlow::SVTKObjectFlow(const sensei::MeshMetadataPtr &md,
   for(unsigned int j = 0; j < num_blocks; ++j)
     {
     m_TotalCell += md->BlockNumCells[j];
-    m_TotalArraySize += md->BlockCellArraySize[j];
+    m_TotalArraySize += getCellArraySize(j);
     }
 
   m_PointType = senseiHDF5::gSVTKToH5Type(m_Metadata->CoordinateType);
@@ -1923,11 +2134,13 @@ bool PointFlow::unload(unsigned int block_id,
   // if (-1 == m_PointVarID)
   // m_PointVarID = output->CreateVar(m_PointVarName, space, m_PointType);
 
+  svtkSmartPointer<svtkDataArray> aos;
   output->WriteVar(m_PointVarID,
                    m_PointVarName,
                    space,
                    m_PointType,
-                   ds->GetPoints()->GetData()->GetVoidPointer(0));
+                   sensei::SVTKUtils::GetAOSPointer(
+                     ds->GetPoints()->GetData(), aos));
 
   return true;
 }
@@ -2285,6 +2498,16 @@ WriteStream::WriteStream(MPI_Comm comm, bool streaming)
 
 bool WriteStream::Init(const std::string &filename)
 {
+#ifndef H5_HAVE_PARALLEL
+  // without MPI-IO each file can only be written by a single rank
+  if(m_Size > 1)
+    {
+      SENSEI_ERROR("Writing \"" << filename << "\" from " << m_Size
+                   << " ranks requires parallel HDF5");
+      return false;
+    }
+#endif
+
   if(m_StreamingOn)
     m_Streamer = new PerStepStreamHandler(filename, this);
   else
@@ -2360,6 +2583,21 @@ bool WriteStream::WriteVar(hid_t &varID,
   std::string evtName = oss.str();
   sensei::TimeEvent<128> mark(evtName.c_str());
 
+  // in the deferred mode the block is copied and written by FlushVars
+  if(m_Options.Deferred())
+    {
+      PendingVar &var = m_PendingVars[name];
+      var.m_TypeCode = gH5TypeCode(h5Type);
+      var.m_Global = space.m_Global;
+      var.m_Start.push_back(space.m_Start);
+      var.m_Count.push_back(space.m_Count);
+
+      const char *pdata = static_cast<const char *>(data);
+      var.m_Data.insert(var.m_Data.end(), pdata,
+                        pdata + space.m_Count * H5Tget_size(h5Type));
+      return true;
+    }
+
   if(-1 == varID)
     varID = CreateVar(name, space, h5Type);
 
@@ -2373,6 +2611,275 @@ bool WriteStream::WriteVar(hid_t &varID,
   return true;
 }
 
+void WriteStream::SetOptions(const WriteOptions &opts)
+{
+  m_Options = opts;
+
+  SetHints(m_Options.Hints);
+
+  if(m_Options.CompressionLevel)
+    {
+#if !H5_VERSION_GE(1, 10, 2)
+      if(m_Size > 1)
+        {
+          SENSEI_WARNING("Parallel compression requires HDF5 1.10.2 or "
+                         "later. Compression is disabled");
+          m_Options.CompressionLevel = 0;
+        }
+#endif
+      if(m_Options.CompressionLevel && (H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0))
+        {
+          SENSEI_WARNING("The deflate filter is not available. Compression "
+                         "is disabled");
+          m_Options.CompressionLevel = 0;
+        }
+
+      // filters require chunking
+      if(m_Options.CompressionLevel && !m_Options.ChunkSize)
+        m_Options.ChunkSize = 1ul << 20;
+    }
+
+  // each dataset is written by one collective call, parallel filters require
+  // collective transfers
+  if(m_Options.Deferred() && (H5P_DEFAULT == m_CollectiveTxf))
+    SetCollectiveTxf();
+}
+
+hid_t WriteStream::CreateChunkedVar(const std::string &name,
+                                    hsize_t global,
+                                    hid_t h5Type)
+{
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+
+  if(m_Options.ChunkSize && global)
+    {
+      hsize_t chunk = m_Options.ChunkSize / H5Tget_size(h5Type);
+      chunk = std::min(std::max(chunk, hsize_t(1)), global);
+
+      H5Pset_chunk(dcpl, 1, &chunk);
+
+      if(m_Options.Shuffle)
+        H5Pset_shuffle(dcpl);
+
+      if(m_Options.CompressionLevel)
+        H5Pset_deflate(dcpl, m_Options.CompressionLevel);
+    }
+
+  hid_t fileSpace = H5Screate_simple(1, &global, NULL);
+
+  hid_t varID = H5Dcreate(m_Streamer->m_TimeStepId,
+                          name.c_str(),
+                          h5Type,
+                          fileSpace,
+                          H5P_DEFAULT,
+                          dcpl,
+                          H5P_DEFAULT);
+
+  H5Sclose(fileSpace);
+  H5Pclose(dcpl);
+
+  return varID;
+}
+
+bool WriteStream::FlushVars()
+{
+  if(!m_Options.Deferred())
+    return true;
+
+  sensei::TimeEvent<128> mark("WriteStream::FlushVars");
+
+  // dataset creation and collective writes involve all ranks, including the
+  // ones that have no blocks. share the datasets' descriptions
+  sensei::BinaryStream desc;
+  desc.Pack(int(m_PendingVars.size()));
+  std::map<std::string, PendingVar>::iterator it = m_PendingVars.begin();
+  for(; it != m_PendingVars.end(); ++it)
+    {
+      desc.Pack(it->first);
+      desc.Pack(it->second.m_TypeCode);
+      desc.Pack((unsigned long)it->second.m_Global);
+    }
+
+  int nBytes = desc.Size();
+  std::vector<int> counts(m_Size);
+  MPI_Allgather(&nBytes, 1, MPI_INT, counts.data(), 1, MPI_INT, m_Comm);
+
+  std::vector<int> displ(m_Size, 0);
+  for(int i = 1; i < m_Size; ++i)
+    displ[i] = displ[i - 1] + counts[i - 1];
+
+  int totalBytes = displ[m_Size - 1] + counts[m_Size - 1];
+
+  sensei::BinaryStream allDesc;
+  allDesc.Resize(totalBytes);
+  MPI_Allgatherv(desc.GetData(), nBytes, MPI_BYTE, allDesc.GetData(),
+                 counts.data(), displ.data(), MPI_BYTE, m_Comm);
+  allDesc.SetWritePos(totalBytes);
+
+  for(int i = 0; i < m_Size; ++i)
+    {
+      int nVars = 0;
+      allDesc.Unpack(nVars);
+      for(int j = 0; j < nVars; ++j)
+        {
+          std::string name;
+          int typeCode = -1;
+          unsigned long global = 0;
+
+          allDesc.Unpack(name);
+          allDesc.Unpack(typeCode);
+          allDesc.Unpack(global);
+
+          PendingVar &var = m_PendingVars[name];
+          var.m_TypeCode = typeCode;
+          var.m_Global = global;
+        }
+    }
+
+  // with aggregation, consecutive groups of ranks send their blocks to the
+  // group's first rank which writes them
+  int groupSize = 1;
+  if((m_Options.NumWriters > 0) && (m_Options.NumWriters < m_Size))
+    groupSize = (m_Size + m_Options.NumWriters - 1) / m_Options.NumWriters;
+
+  int writer = (m_Rank / groupSize) * groupSize;
+  int groupEnd = std::min(writer + groupSize, m_Size);
+
+  bool ok = true;
+
+  for(it = m_PendingVars.begin(); it != m_PendingVars.end(); ++it)
+    {
+      PendingVar &var = it->second;
+      hid_t h5Type = gH5TypeFromCode(var.m_TypeCode);
+      size_t elemSize = H5Tget_size(h5Type);
+
+      if(m_Rank != writer)
+        {
+          unsigned long n = var.m_Start.size();
+          MPI_Send(&n, 1, MPI_UNSIGNED_LONG, writer, 0, m_Comm);
+          gSendBytes(var.m_Start.data(), n * sizeof(hsize_t), writer, m_Comm);
+          gSendBytes(var.m_Count.data(), n * sizeof(hsize_t), writer, m_Comm);
+          gSendBytes(var.m_Data.data(), var.m_Data.size(), writer, m_Comm);
+
+          var.m_Start.clear();
+          var.m_Count.clear();
+          var.m_Data.clear();
+        }
+      else
+        {
+          for(int r = m_Rank + 1; r < groupEnd; ++r)
+            {
+              unsigned long n = 0;
+              MPI_Recv(&n, 1, MPI_UNSIGNED_LONG, r, 0, m_Comm, MPI_STATUS_IGNORE);
+
+              size_t n0 = var.m_Start.size();
+              var.m_Start.resize(n0 + n);
+              var.m_Count.resize(n0 + n);
+              gRecvBytes(var.m_Start.data() + n0, n * sizeof(hsize_t), r, m_Comm);
+              gRecvBytes(var.m_Count.data() + n0, n * sizeof(hsize_t), r, m_Comm);
+
+              hsize_t nElem = 0;
+              for(unsigned long k = 0; k < n; ++k)
+                nElem += var.m_Count[n0 + k];
+
+              size_t d0 = var.m_Data.size();
+              var.m_Data.resize(d0 + nElem * elemSize);
+              gRecvBytes(var.m_Data.data() + d0, nElem * elemSize, r, m_Comm);
+            }
+        }
+
+      // the data of a union of hyperslabs is in file order. sort the blocks,
+      // and merge adjacent ones
+      unsigned long nBlocks = var.m_Start.size();
+      std::vector<unsigned long> order(nBlocks);
+      std::iota(order.begin(), order.end(), 0);
+      std::sort(order.begin(), order.end(),
+                [&var](unsigned long a, unsigned long b) -> bool
+                { return var.m_Start[a] < var.m_Start[b]; });
+
+      std::vector<size_t> dataOffset(nBlocks, 0);
+      for(unsigned long k = 1; k < nBlocks; ++k)
+        dataOffset[k] = dataOffset[k - 1] + var.m_Count[k - 1] * elemSize;
+
+      std::vector<char> data(var.m_Data.size());
+      std::vector<hsize_t> runStart;
+      std::vector<hsize_t> runCount;
+      size_t pos = 0;
+      for(unsigned long k = 0; k < nBlocks; ++k)
+        {
+          unsigned long b = order[k];
+          size_t nb = var.m_Count[b] * elemSize;
+
+          memcpy(data.data() + pos, var.m_Data.data() + dataOffset[b], nb);
+          pos += nb;
+
+          if(!runStart.empty() &&
+             (runStart.back() + runCount.back() == var.m_Start[b]))
+            {
+              runCount.back() += var.m_Count[b];
+            }
+          else if(var.m_Count[b])
+            {
+              runStart.push_back(var.m_Start[b]);
+              runCount.push_back(var.m_Count[b]);
+            }
+        }
+      std::vector<char>().swap(var.m_Data);
+
+      std::ostringstream oss;
+      oss << "H5BytesWrote=" << data.size();
+      std::string evtName = oss.str();
+      sensei::TimeEvent<128> wmark(evtName.c_str());
+
+      hid_t varID = CreateChunkedVar(it->first, var.m_Global, h5Type);
+      if(varID < 0)
+        {
+          SENSEI_ERROR("Failed to create \"" << it->first << "\"");
+          return false;
+        }
+
+      hid_t fileSpace = H5Dget_space(varID);
+
+      hsize_t nElem = data.size() / elemSize;
+      hid_t memSpace = H5Screate_simple(1, &nElem, NULL);
+
+      unsigned long nRuns = runStart.size();
+      if(nRuns)
+        {
+          H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, &runStart[0], NULL,
+                              &runCount[0], NULL);
+
+          for(unsigned long k = 1; k < nRuns; ++k)
+            H5Sselect_hyperslab(fileSpace, H5S_SELECT_OR, &runStart[k], NULL,
+                                &runCount[k], NULL);
+        }
+      else
+        {
+          H5Sselect_none(fileSpace);
+          H5Sselect_none(memSpace);
+        }
+
+      char dummy = 0;
+      herr_t err = H5Dwrite(varID, h5Type, memSpace, fileSpace,
+                            m_CollectiveTxf, data.empty() ? &dummy : data.data());
+
+      H5Sclose(memSpace);
+      H5Sclose(fileSpace);
+      H5Dclose(varID);
+
+      // keep going so the remaining collective writes are matched
+      if(err < 0)
+        {
+          SENSEI_ERROR("Failed to write \"" << it->first << "\"");
+          ok = false;
+        }
+    }
+
+  m_PendingVars.clear();
+
+  return ok;
+}
+
 /*
 bool WriteStream::WriteVar(const std::string& name,
                              const HDF5SpaceGuard& space,
@@ -2400,8 +2907,13 @@ bool WriteStream::WriteMetadata(sensei::MeshMetadataPtr &md)
   std::string path;
   gGetNameStr(path, m_MeshCounter, "meshdata");
 
+  // write the block structure only if it changed
+  if (m_MeshCounter >= m_PreviousMetadata.size())
+    m_PreviousMetadata.resize(m_MeshCounter + 1);
+
   sensei::BinaryStream bs;
-  md->ToStream(bs);
+  md->ToStreamDelta(bs, m_PreviousMetadata[m_MeshCounter]);
+  m_PreviousMetadata[m_MeshCounter] = md;
 
   WriteBinary(path, bs);
   return true;
@@ -2466,10 +2978,10 @@ bool WriteStream::WriteMesh(sensei::MeshMetadataPtr &md,
   WriteMetadata(md);
 
   MeshFlow m(svtkPtr, m_MeshCounter);
-  m.WriteTo(this, md);
+  bool ok = m.WriteTo(this, md);
 
   m_MeshCounter++;
-  return true;
+  return ok;
 }
 
 } // namespace senseiHDF5
@@ -11,6 +11,7 @@ typedef struct _ADIOS_FILE ADIOS_FILE;
 //#include <adios_read.h>
 #include <cstdint>
 #include <mpi.h>
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
@@ -63,6 +64,7 @@ class HDF5SpaceGuard
 {
 public:
   HDF5SpaceGuard(hsize_t global, hsize_t s, hsize_t c)
+    : m_Global(global), m_Start(s), m_Count(c)
   {
     m_ndim = 1;
 
@@ -90,9 +92,40 @@ public:
   hid_t m_FileSpaceID;
   hid_t m_MemSpaceID;
 
+  hsize_t m_Global;
+  hsize_t m_Start;
+  hsize_t m_Count;
+
   unsigned int m_ndim;
 };
 
+//
+// options for the chunked, compressed, and aggregated write mode. when none
+// are set datasets are contiguous and written as each block is visited
+//
+struct WriteOptions
+{
+  // the size of the chunks in bytes. 0 for contiguous datasets
+  unsigned long ChunkSize = 0;
+
+  // deflate compression level 1-9. 0 for no compression
+  int CompressionLevel = 0;
+
+  // apply the shuffle filter before compression
+  bool Shuffle = false;
+
+  // the number of ranks that write. the others send their data to a writer.
+  // 0 for all ranks
+  int NumWriters = 0;
+
+  // MPI-IO hints, for instance cb_nodes and cb_buffer_size
+  std::map<std::string, std::string> Hints;
+
+  // when set the blocks are gathered and each dataset written once
+  bool Deferred() const
+  { return ChunkSize || CompressionLevel || NumWriters; }
+};
+
 class BasicStream;
 class ReadStream;
 class WriteStream;
@@ -140,6 +173,11 @@ private:
   unsigned int m_TimeStepTotal = 0;
 };
 
+// Each step is written to its own file. The writer's rank 0 publishes the
+// number of complete steps in a manifest, m_FileName, which is rewritten and
+// atomically renamed into place after each step. The reader's rank 0 watches
+// the manifest's directory with inotify where available and stats the
+// manifest with exponential backoff otherwise, then broadcasts the result.
 class PerStepStreamHandler : public StreamHandler
 {
 public:
@@ -159,8 +197,14 @@ private:
 
   // hid_t m_HostFileId;
   bool NoMoreStep();
-  void GetCurrAvailStep();
-  void UpdateAvailStep();
+
+  // reader: rank 0 waits until at least nSteps steps are available, the
+  // writer is done, or the timeout expires, then broadcasts the manifest
+  void WaitForSteps(int nSteps, double timeoutSec);
+  void ReadManifest();
+
+  // writer: rank 0 publishes the manifest, replacing it atomically
+  void UpdateAvailStep(bool done = false);
 
   int m_NumStepsWritten = -1; // -1 if not able to detect. otherwise >=1
 
@@ -183,6 +227,7 @@ public:
 
   void CloseTimeStep();
   void SetCollectiveTxf();
+  void SetHints(const std::map<std::string, std::string> &hints);
   MPI_Comm m_Comm;
   int m_Rank;
   int m_Size;
@@ -191,6 +236,9 @@ public:
 
   sensei::MeshMetadataMap m_AllMeshInfo; // sender
   sensei::MeshMetadataMap m_AllMeshInfoReceiver;
+  // the metadata of each mesh written/read in the previous step. the block
+  // structure is written only when it changes
+  std::vector<sensei::MeshMetadataPtr> m_PreviousMetadata;
 
 #ifdef NEVER
   hid_t m_TimeStepGroupId;
@@ -237,8 +285,32 @@ public:
                 hid_t h5Type,
                 void *data);
 
+  // set the options of the chunked, compressed, and aggregated write mode.
+  // must be called before Init
+  void SetOptions(const WriteOptions &opts);
+
+  // in the deferred write mode, create and write the datasets of the blocks
+  // passed to WriteVar since the last call. collective, does nothing
+  // otherwise
+  bool FlushVars();
+
 private:
+  // the blocks of a dataset waiting to be written
+  struct PendingVar
+  {
+    int m_TypeCode = -1;
+    hsize_t m_Global = 0;
+    std::vector<hsize_t> m_Start;
+    std::vector<hsize_t> m_Count;
+    std::vector<char> m_Data;
+  };
+
+  hid_t CreateChunkedVar(const std::string &name, hsize_t global,
+                         hid_t h5Type);
+
   unsigned int m_MeshCounter;
+  WriteOptions m_Options;
+  std::map<std::string, PendingVar> m_PendingVars;
 };
 
 class ReadStream : public BasicStream
@@ -305,7 +377,7 @@ public:
 private:
   bool ValidateMetaData(const sensei::MeshMetadataPtr &md);
 
-  void Unload(ArrayFlow *arrayFlowPtr, 
+  bool Unload(ArrayFlow *arrayFlowPtr, 
 	      const sensei::MeshMetadataPtr &md,
               WriteStream *output);
   void Load(ArrayFlow *arrayFlowPtr, 
@@ -330,6 +402,15 @@ public:
                       WriteStream *output) = 0;
 
 protected:
+  // cells are stored in the legacy layout, each cell's number of points
+  // followed by its point ids, while the metadata reports the size of the
+  // connectivity alone
+  unsigned long long getCellArraySize(unsigned int block_id) const
+  {
+    return m_Metadata->BlockCellArraySize[block_id] +
+      m_Metadata->BlockNumCells[block_id];
+  }
+
   const sensei::MeshMetadataPtr &m_Metadata;
   unsigned int m_MeshID;
 
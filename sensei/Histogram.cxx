@@ -4,6 +4,8 @@
 #include "MeshMetadataMap.h"
 #include "Profiler.h"
 #include "HistogramInternals.h"
+#include "HistogramEngine.h"
+#include "DataRequirements.h"
 #include "SVTKUtils.h"
 #include "Error.h"
 
@@ -16,6 +18,7 @@
 #include <svtkUnsignedCharArray.h>
 
 #include <algorithm>
+#include <map>
 #include <vector>
 
 namespace
@@ -23,7 +26,7 @@ namespace
 // **************************************************************************
 int Write(const std::string &fileName, int step, double time,
   const std::string &meshName, const std::string &arrayName,
-  sensei::Histogram::Data &result)
+  sensei::Histogram::Data &result, bool streaming)
 {
   // write the histogram to a file
   char fname[1024] = {'\0'};
@@ -51,6 +54,12 @@ int Write(const std::string &fileName, int step, double time,
   for (int i = 0; i < result.NumberOfBins; ++i)
     fprintf(file, "%d ", result.Histogram[i]);
   fprintf(file, "\n");
+  if (streaming)
+    {
+    fprintf(file, "underflow : %u\n", result.Underflow);
+    fprintf(file, "overflow : %u\n", result.Overflow);
+    fprintf(file, "num steps : %d\n", result.NumberOfSteps);
+    }
   fclose(file);
 
   return 0;
@@ -58,7 +67,8 @@ int Write(const std::string &fileName, int step, double time,
 
 // **************************************************************************
 int Write(int step, double time, const std::string &meshName,
-  const std::string &arrayName, sensei::Histogram::Data &result)
+  const std::string &arrayName, sensei::Histogram::Data &result,
+  bool streaming)
 {
   // write the histogram to std::cout
   int origPrec = cout.precision();
@@ -75,6 +85,12 @@ int Write(int step, double time, const std::string &meshName,
       << ": " << std::fixed << result.Histogram[i] << std::endl;
     }
 
+  if (streaming)
+    {
+    std::cout << "underflow " << result.Underflow << " overflow "
+      << result.Overflow << " steps " << result.NumberOfSteps << std::endl;
+    }
+
   std::cout.precision(origPrec);
 
   return 0;
@@ -87,8 +103,9 @@ namespace sensei
 senseiNewMacro(Histogram);
 
 //-----------------------------------------------------------------------------
-Histogram::Histogram() : NumberOfBins(0),
-  Association(svtkDataObject::FIELD_ASSOCIATION_POINTS)
+Histogram::Histogram() : NumberOfBins(0), NumberOfThreads(-1),
+  Binning(BINNING_GLOBAL), RangeMin(1.0), RangeMax(0.0), Window(0),
+  LastStep(0), LastTime(0.0)
 {
 }
 
@@ -102,10 +119,125 @@ void Histogram::Initialize(int bins, const std::string &meshName,
   int association, const std::string& arrayName, const std::string &fileName)
 {
   this->NumberOfBins = bins;
-  this->MeshName = meshName;
-  this->ArrayName = arrayName;
-  this->Association = association;
   this->FileName = fileName;
+
+  Histogram::Variable var;
+  var.MeshName = meshName;
+  var.Association = association;
+  var.ArrayName = arrayName;
+
+  this->Variables.assign(1, var);
+}
+
+//-----------------------------------------------------------------------------
+void Histogram::Initialize(int bins, const DataRequirements &reqs,
+  const std::string &fileName)
+{
+  this->NumberOfBins = bins;
+  this->FileName = fileName;
+  this->Variables.clear();
+
+  MeshRequirementsIterator mit = reqs.GetMeshRequirementsIterator();
+  for (; mit; ++mit)
+    {
+    ArrayRequirementsIterator ait = reqs.GetArrayRequirementsIterator(mit.MeshName());
+    for (; ait; ++ait)
+      {
+      Histogram::Variable var;
+      var.MeshName = mit.MeshName();
+      var.Association = ait.Association();
+      var.ArrayName = ait.Array();
+
+      this->Variables.push_back(var);
+      }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void Histogram::SetNumberOfThreads(int numberOfThreads)
+{
+  this->NumberOfThreads = numberOfThreads;
+  this->Engine = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+int Histogram::SetBinning(int binning)
+{
+  if ((binning != Histogram::BINNING_GLOBAL) &&
+    (binning != Histogram::BINNING_FIXED) &&
+    (binning != Histogram::BINNING_ADAPTIVE))
+    {
+    SENSEI_ERROR("Invalid binning mode " << binning)
+    return -1;
+    }
+
+  if ((binning == Histogram::BINNING_GLOBAL) && (this->Window > 0))
+    {
+    SENSEI_ERROR("Histograms can not be accumulated with global binning")
+    return -1;
+    }
+
+  this->Binning = binning;
+  this->Engine = nullptr;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Histogram::SetBinning(std::string binningStr)
+{
+  unsigned int n = binningStr.size();
+  for (unsigned int i = 0; i < n; ++i)
+    binningStr[i] = tolower(binningStr[i]);
+
+  int binning = 0;
+  if (binningStr == "global")
+    {
+    binning = Histogram::BINNING_GLOBAL;
+    }
+  else if (binningStr == "fixed")
+    {
+    binning = Histogram::BINNING_FIXED;
+    }
+  else if (binningStr == "adaptive")
+    {
+    binning = Histogram::BINNING_ADAPTIVE;
+    }
+  else
+    {
+    SENSEI_ERROR("invalid binning mode \"" << binningStr << "\"")
+    return -1;
+    }
+
+  return this->SetBinning(binning);
+}
+
+//-----------------------------------------------------------------------------
+int Histogram::SetRange(double binMin, double binMax)
+{
+  if (!(binMax > binMin))
+    {
+    SENSEI_ERROR("Invalid range [" << binMin << ", " << binMax << "]")
+    return -1;
+    }
+
+  this->RangeMin = binMin;
+  this->RangeMax = binMax;
+  this->Engine = nullptr;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Histogram::SetWindow(int numberOfSteps)
+{
+  if ((numberOfSteps > 0) && (this->Binning == Histogram::BINNING_GLOBAL))
+    {
+    SENSEI_ERROR("Histograms can not be accumulated with global binning")
+    return -1;
+    }
+
+  this->Window = std::max(0, numberOfSteps);
+  this->Engine = nullptr;
+  return 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -133,22 +265,6 @@ bool Histogram::Execute(DataAdaptor* data, DataAdaptor** dataOut)
     return false;
     }
 
-  // get the mesh metadata object
-  MeshMetadataPtr mmd;
-  if (mdMap.GetMeshMetadata(this->MeshName, mmd))
-    {
-    SENSEI_ERROR("Failed to get metadata for mesh \"" << this->MeshName << "\"")
-    return false;
-    }
-
-  // get the mesh object
-  svtkDataObject *dobj = nullptr;
-  if (data->GetMesh(this->MeshName, true, dobj))
-    {
-    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
-    return false;
-    }
-
   int rank = 0;
   MPI_Comm comm = this->GetCommunicator();
   MPI_Comm_rank(comm, &rank);
@@ -166,144 +282,295 @@ bool Histogram::Execute(DataAdaptor* data, DataAdaptor** dataOut)
   const char *aDevId = "";
 #endif
 
+  // the fixed and adaptive binning modes are implemented on the CPU
+  if ((deviceId >= 0) && (this->Binning != Histogram::BINNING_GLOBAL))
+    {
+    deviceId = -1;
+    aDevId = "";
+    }
+
   // get the current time and step
   int step = data->GetDataTimeStep();
   double time = data->GetDataTime();
 
+  this->LastStep = step;
+  this->LastTime = time;
+
+  unsigned int nVars = this->Variables.size();
+
   if (rank == 0)
     {
-    SENSEI_STATUS("Step = " << step << " Time = " << time
-      << " Computing the histogram on mesh \""
-      << this->MeshName << "\" array \"" << this->ArrayName
-      << "\" using " << (deviceId < 0 ? "the CPU" : "CUDA GPU ")
-      << aDevId)
+    for (unsigned int i = 0; i < nVars; ++i)
+      {
+      SENSEI_STATUS("Step = " << step << " Time = " << time
+        << " Computing the histogram on mesh \""
+        << this->Variables[i].MeshName << "\" array \""
+        << this->Variables[i].ArrayName << "\" using "
+        << (deviceId < 0 ? "the CPU" : "CUDA GPU ") << aDevId)
+      }
     }
 
+  // fetch each mesh once with all of the arrays that are needed from it
+  std::map<std::string, std::vector<unsigned int>> meshVars;
+  for (unsigned int i = 0; i < nVars; ++i)
+    meshVars[this->Variables[i].MeshName].push_back(i);
 
-  // create a new histogram computation. this class does all the work.
-  std::shared_ptr<sensei::HistogramInternals>
-    internals(new sensei::HistogramInternals(comm, deviceId, this->NumberOfBins));
+  std::vector<svtkCompositeDataSetPtr> meshes(nVars);
 
-  if (!dobj)
+  for (auto &mv : meshVars)
     {
+    const std::string &meshName = mv.first;
+
+    // get the mesh metadata object
+    MeshMetadataPtr mmd;
+    if (mdMap.GetMeshMetadata(meshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    // get the mesh object
+    svtkDataObject *dobj = nullptr;
+    if (data->GetMesh(meshName, true, dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      return false;
+      }
+
     // it is not an necessarilly an error if all ranks do not have
     // a dataset to process. However, all ranks must participate due
     // to the use of MPI collectives.
-    internals->Initialize();
-    internals->ComputeHistogram();
-    internals->Clear();
-    return true;
-    }
+    if (!dobj)
+      continue;
 
-  // fetch the array that the hiostogram will be computed on
-  if (data->AddArray(dobj, this->MeshName, this->Association, this->ArrayName))
-    {
-    SENSEI_ERROR(<< data->GetClassName() << " failed to add "
-      << (this->Association == svtkDataObject::POINT ? "point" : "cell")
-      << " data array \""  << this->ArrayName << "\"")
+    // fetch the arrays that the histograms will be computed on
+    for (unsigned int i : mv.second)
+      {
+      const Histogram::Variable &var = this->Variables[i];
+      if (data->AddArray(dobj, meshName, var.Association, var.ArrayName))
+        {
+        SENSEI_ERROR(<< data->GetClassName() << " failed to add "
+          << (var.Association == svtkDataObject::POINT ? "point" : "cell")
+          << " data array \""  << var.ArrayName << "\"")
 
-    // abort to avoid deadlocks in collective calls
-    MPI_Abort(comm, -1);
-    return false;
-    }
+        // abort to avoid deadlocks in collective calls
+        MPI_Abort(comm, -1);
+        return false;
+        }
+      }
 
-  // add the ghost zones
-  if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
-    data->AddGhostCellsArray(dobj, this->MeshName))
-    {
-    SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
-    // abort to avoid deadlocks in collective calls
-    MPI_Abort(comm, -1);
-    return false;
-    }
+    // add the ghost zones
+    if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
+      data->AddGhostCellsArray(dobj, meshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
+      // abort to avoid deadlocks in collective calls
+      MPI_Abort(comm, -1);
+      return false;
+      }
 
-  if (mmd->NumGhostNodes && data->AddGhostNodesArray(dobj, this->MeshName))
-    {
-    SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
-    // abort to avoid deadlocks in collective calls
-    MPI_Abort(comm, -1);
-    return false;
+    if (mmd->NumGhostNodes && data->AddGhostNodesArray(dobj, meshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
+      // abort to avoid deadlocks in collective calls
+      MPI_Abort(comm, -1);
+      return false;
+      }
+
+    svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+    for (unsigned int i : mv.second)
+      meshes[i] = mesh;
     }
 
-  // add all blocks of data
-  svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
-  svtkSmartPointer<svtkCompositeDataIterator> iter;
-  iter.TakeReference(mesh->NewIterator());
-  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  if (deviceId < 0)
     {
-    // get the local mesh
-    svtkDataObject *curObj = iter->GetCurrentDataObject();
-
-    // get the array to compute histogram for
-    svtkDataArray* array = this->GetArray(curObj, this->ArrayName);
-    if (!array)
+    // compute all of the histograms together on the CPU. the engine, and
+    // its threads, are reused each step.
+    if (!this->Engine)
       {
-      SENSEI_WARNING("Data block " << iter->GetCurrentFlatIndex()
-        << " of mesh \"" << this->MeshName << " has no array named \""
-        << this->ArrayName << "\"")
-      continue;
+      std::shared_ptr<HistogramEngine> engine = std::make_shared<HistogramEngine>(
+        comm, this->NumberOfBins, this->NumberOfThreads);
+
+      if (engine->SetBinning(this->Binning) ||
+        ((this->Binning == Histogram::BINNING_FIXED) &&
+        engine->SetRange(this->RangeMin, this->RangeMax)) ||
+        engine->SetWindow(this->Window))
+        {
+        SENSEI_ERROR("Failed to configure the histogram engine")
+        return false;
+        }
+
+      this->Engine = engine;
       }
 
-    // and get the ghost cell array
-    svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
-      this->GetArray(curObj, this->GetGhostArrayName()));
+    this->Engine->Initialize(nVars);
+
+    for (unsigned int i = 0; i < nVars; ++i)
+      {
+      if (!meshes[i])
+        continue;
+
+      const Histogram::Variable &var = this->Variables[i];
+
+      // add all blocks of data
+      svtkSmartPointer<svtkCompositeDataIterator> iter;
+      iter.TakeReference(meshes[i]->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+        {
+        // get the local mesh
+        svtkDataObject *curObj = iter->GetCurrentDataObject();
+
+        // get the array to compute histogram for
+        svtkDataArray* array = this->GetArray(curObj, var.Association, var.ArrayName);
+        if (!array)
+          {
+          SENSEI_WARNING("Data block " << iter->GetCurrentFlatIndex()
+            << " of mesh \"" << var.MeshName << " has no array named \""
+            << var.ArrayName << "\"")
+          continue;
+          }
+
+        // and get the ghost cell array
+        svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
+          this->GetArray(curObj, var.Association, this->GetGhostArrayName()));
+
+        // add this blocks contribution to the calculation
+        if (this->Engine->AddLocalData(i, array, ghostArray))
+          {
+          SENSEI_ERROR("Failed to add array \"" << var.ArrayName
+            << "\" data block " << iter->GetCurrentFlatIndex() << " of mesh \""
+            << var.MeshName << "\"")
+          // abort to prevent deadlock in collective calls
+          MPI_Abort(comm, -1);
+          }
+        }
+      }
 
-    // add this blocks contribution to the calculation
-    if (internals->AddLocalData(array, ghostArray))
+    // compute the histograms. this is an MPI collective, all MPI ranks must
+    // participate. after this call returns MPI rank 0 holds the histograms
+    if (this->Engine->ComputeHistograms())
       {
-      SENSEI_ERROR("Failed to add array \"" << this->ArrayName
-        << "\" data block " << iter->GetCurrentFlatIndex() << " of mesh \""
-        << this->MeshName << "\"")
+      SENSEI_ERROR("Failed to compute the histograms")
       // abort to prevent deadlock in collective calls
       MPI_Abort(comm, -1);
       }
-    }
 
-  // compute the histogram. this is an MPI collective, all MPI ranks must participate.
-  // after this call returns MPI rank 0 holds the histogram
-  if (internals->ComputeHistogram())
-    {
-    SENSEI_ERROR("Failed to compute the histogram for array \""
-      << this->ArrayName << "\" of mesh \"" << this->MeshName << "\"")
-    // abort to prevent deadlock in collective calls
-    MPI_Abort(comm, -1);
+    for (unsigned int i = 0; i < nVars; ++i)
+      this->Engine->GetHistogram(i, this->Variables[i].LastResult);
+
+    // the bin edges and accumulated histograms are kept for the next step
+    this->Engine->ReleaseData();
     }
+  else
+    {
+    // compute the histograms one at a time on the GPU
+    for (unsigned int i = 0; i < nVars; ++i)
+      {
+      Histogram::Variable &var = this->Variables[i];
 
-  // store a copy of the histogram. this can be acccessed from scripts ofr
-  // regression testing etc.
-  Histogram::Data result;
+      // create a new histogram computation. this class does all the work.
+      std::shared_ptr<sensei::HistogramInternals> internals(
+        new sensei::HistogramInternals(comm, deviceId, this->NumberOfBins));
 
-  internals->GetHistogram(result.NumberOfBins, result.BinMin,
-    result.BinMax, result.BinWidth, result.Histogram);
+      internals->Initialize();
 
-  this->LastResult = result;
+      if (meshes[i])
+        {
+        // add all blocks of data
+        svtkSmartPointer<svtkCompositeDataIterator> iter;
+        iter.TakeReference(meshes[i]->NewIterator());
+        for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+          {
+          // get the local mesh
+          svtkDataObject *curObj = iter->GetCurrentDataObject();
+
+          // get the array to compute histogram for
+          svtkDataArray* array = this->GetArray(curObj, var.Association, var.ArrayName);
+          if (!array)
+            {
+            SENSEI_WARNING("Data block " << iter->GetCurrentFlatIndex()
+              << " of mesh \"" << var.MeshName << " has no array named \""
+              << var.ArrayName << "\"")
+            continue;
+            }
+
+          // and get the ghost cell array
+          svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
+            this->GetArray(curObj, var.Association, this->GetGhostArrayName()));
+
+          // add this blocks contribution to the calculation
+          if (internals->AddLocalData(array, ghostArray))
+            {
+            SENSEI_ERROR("Failed to add array \"" << var.ArrayName
+              << "\" data block " << iter->GetCurrentFlatIndex() << " of mesh \""
+              << var.MeshName << "\"")
+            // abort to prevent deadlock in collective calls
+            MPI_Abort(comm, -1);
+            }
+          }
+        }
 
-  // write the results if on MPI rank 0
+      // compute the histogram. this is an MPI collective, all MPI ranks must participate.
+      // after this call returns MPI rank 0 holds the histogram
+      if (internals->ComputeHistogram())
+        {
+        SENSEI_ERROR("Failed to compute the histogram for array \""
+          << var.ArrayName << "\" of mesh \"" << var.MeshName << "\"")
+        // abort to prevent deadlock in collective calls
+        MPI_Abort(comm, -1);
+        }
+
+      Histogram::Data &result = var.LastResult;
+      internals->GetHistogram(result.NumberOfBins, result.BinMin,
+        result.BinMax, result.BinWidth, result.Histogram);
+
+      internals->Clear();
+      }
+    }
+
+  // write the results, when accumulating only at the end of a window
   if (rank == 0)
     {
-    if (this->FileName.empty())
+    for (unsigned int i = 0; i < nVars; ++i)
       {
-      ::Write(step, time, this->MeshName, this->ArrayName, result);
-      }
-    else
-      {
-      if (::Write(this->FileName, step, time, this->MeshName, this->ArrayName, result))
-        {
-        SENSEI_ERROR("Failed to write histogram.")
+      if ((this->Window > 0) &&
+        (this->Variables[i].LastResult.NumberOfSteps < this->Window))
+        continue;
+
+      if (this->Write(i, step, time))
         return false;
-        }
       }
     }
 
-  internals->Clear();
-
   return true;
 }
 
 //-----------------------------------------------------------------------------
-svtkDataArray* Histogram::GetArray(svtkDataObject* dobj, const std::string& arrayname)
+int Histogram::Write(unsigned int varId, int step, double time)
+{
+  Histogram::Variable &var = this->Variables[varId];
+  bool streaming = this->Binning != Histogram::BINNING_GLOBAL;
+
+  if (this->FileName.empty())
+    {
+    ::Write(step, time, var.MeshName, var.ArrayName, var.LastResult,
+      streaming);
+    }
+  else if (::Write(this->FileName, step, time, var.MeshName,
+    var.ArrayName, var.LastResult, streaming))
+    {
+    SENSEI_ERROR("Failed to write histogram.")
+    return -1;
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+svtkDataArray* Histogram::GetArray(svtkDataObject* dobj, int association,
+  const std::string& arrayname)
 {
-  if (svtkFieldData* fd = dobj->GetAttributesAsFieldData(this->Association))
+  if (svtkFieldData* fd = dobj->GetAttributesAsFieldData(association))
     {
     return fd->GetArray(arrayname.c_str());
     }
@@ -313,13 +580,54 @@ svtkDataArray* Histogram::GetArray(svtkDataObject* dobj, const std::string& arra
 //-----------------------------------------------------------------------------
 int Histogram::GetHistogram(Histogram::Data &result)
 {
-  result = this->LastResult;
+  if (this->Variables.empty())
+    {
+    SENSEI_ERROR("No histograms have been configured")
+    return -1;
+    }
+
+  result = this->Variables[0].LastResult;
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int Histogram::GetHistogram(const std::string &meshName, int association,
+  const std::string &arrayName, Histogram::Data &result)
+{
+  for (const Histogram::Variable &var : this->Variables)
+    {
+    if ((var.MeshName == meshName) && (var.Association == association)
+      && (var.ArrayName == arrayName))
+      {
+      result = var.LastResult;
+      return 0;
+      }
+    }
+
+  SENSEI_ERROR("No histogram of " << SVTKUtils::GetAttributesName(association)
+    << " data array \"" << arrayName << "\" on mesh \"" << meshName << "\"")
+  return -1;
+}
+
 //-----------------------------------------------------------------------------
 int Histogram::Finalize()
 {
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+
+  // write the partially accumulated windows
+  if ((rank == 0) && (this->Window > 0))
+    {
+    unsigned int nVars = this->Variables.size();
+    for (unsigned int i = 0; i < nVars; ++i)
+      {
+      int nSteps = this->Variables[i].LastResult.NumberOfSteps;
+      if ((nSteps > 0) && (nSteps < this->Window) &&
+        this->Write(i, this->LastStep, this->LastTime))
+        return -1;
+      }
+    }
+
   return 0;
 }
 
@@ -4,14 +4,30 @@
 #include "AnalysisAdaptor.h"
 #include <mpi.h>
 #include <vector>
+#include <memory>
 
 class svtkDataObject;
 class svtkDataArray;
 
 namespace sensei
 {
-
-/// Computes a histogram in parallel.
+class DataRequirements;
+class HistogramEngine;
+
+/** Computes histograms in parallel. A single instance can compute histograms
+ * of any number of arrays on any number of meshes. On the CPU all of the
+ * histograms are computed together by a multithreaded sensei::HistogramEngine
+ * which makes one sweep over the data for the ranges and one for the bins,
+ * and one MPI reduction for each. When CUDA is enabled the histograms are
+ * computed one after another on the GPU.
+ *
+ * The sweep for the ranges can be skipped by fixing the bin edges
+ * (BINNING_FIXED) or by carrying them over from the previous step
+ * (BINNING_ADAPTIVE), in which case values outside of the edges are counted
+ * as underflow and overflow and the bins are adjusted when the data no longer
+ * fits. With these modes histograms may also be accumulated over a window of
+ * steps, see SetWindow. These modes always run on the CPU.
+ */
 class SENSEI_EXPORT Histogram : public AnalysisAdaptor
 {
 public:
@@ -20,11 +36,46 @@ public:
 
   senseiTypeMacro(Histogram, AnalysisAdaptor);
 
-  /// initialize for the run
+  /// initialize for the run to compute the histogram of one array
   void Initialize(int bins, const std::string &meshName,
     int association, const std::string& arrayName,
     const std::string &fileName);
 
+  /// initialize for the run to compute the histograms of the named arrays
+  void Initialize(int bins, const DataRequirements &reqs,
+    const std::string &fileName);
+
+  /** Set the number of threads used on the CPU. If less than 1, the default,
+   * the count configured by SMPUtils::Initialize is used, or one thread when
+   * none was configured.
+   */
+  void SetNumberOfThreads(int numberOfThreads);
+
+  /// Methods of determining the bin edges.
+  enum {BINNING_GLOBAL=0, BINNING_FIXED=1, BINNING_ADAPTIVE=2};
+
+  /** Sets how the bin edges are determined. BINNING_GLOBAL, the default,
+   * computes the global range of the data each step. BINNING_FIXED uses the
+   * edges set by SetRange. BINNING_ADAPTIVE computes the global range the
+   * first step and then uses the edges of the previous step, adjusting them
+   * when the data no longer fits.
+   */
+  int SetBinning(int binning);
+
+  /// Sets the binning mode by string, "global", "fixed", or "adaptive".
+  int SetBinning(std::string binning);
+
+  /// Sets the bin edges used by BINNING_FIXED.
+  int SetRange(double binMin, double binMax);
+
+  /** Sets the number of steps to accumulate histograms over. Results are
+   * written at the end of each window, and a partial window is written by
+   * Finalize. When 0, the default, each step is independent. This requires
+   * BINNING_FIXED or BINNING_ADAPTIVE, set the binning mode first. Returns
+   * non-zero if the binning mode is BINNING_GLOBAL.
+   */
+  int SetWindow(int numberOfSteps);
+
   /// compute the histogram for this time step
   bool Execute(DataAdaptor* data, DataAdaptor**) override;
 
@@ -34,18 +85,26 @@ public:
   /// the computed histogram may be accessed through the following data structure.
   struct Data
   {
-      Data() : NumberOfBins(1), BinMin(1.0), BinMax(0.0), BinWidth(1.0), Histogram() {}
+      Data() : NumberOfBins(1), BinMin(1.0), BinMax(0.0), BinWidth(1.0),
+        Histogram(), Underflow(0), Overflow(0), NumberOfSteps(0) {}
 
       int NumberOfBins; ///< The number of bins in the histogram
       double BinMin;    ///< The left most bin edge
       double BinMax;    ///< The right most bin edge
       double BinWidth;  ///< The width of the equally spaced bins
       std::vector<unsigned int> Histogram; ///< The counts of each bin
+      unsigned int Underflow; ///< The count of values below the left most edge
+      unsigned int Overflow;  ///< The count of values above the right most edge
+      int NumberOfSteps;      ///< The number of steps accumulated
   };
 
-  /// return the histogram computed by the most recent call to Execute
+  /// return the first histogram computed by the most recent call to Execute
   int GetHistogram(Histogram::Data &data);
 
+  /// return the named histogram computed by the most recent call to Execute
+  int GetHistogram(const std::string &meshName, int association,
+    const std::string &arrayName, Histogram::Data &data);
+
 protected:
   Histogram();
   ~Histogram();
@@ -53,15 +112,33 @@ protected:
   Histogram(const Histogram&) = delete;
   void operator=(const Histogram&) = delete;
 
+  /// write the result of the variable to a file or cout
+  int Write(unsigned int varId, int step, double time);
+
   static const char *GetGhostArrayName();
-  svtkDataArray* GetArray(svtkDataObject* dobj, const std::string& arrayname);
+  static svtkDataArray* GetArray(svtkDataObject* dobj, int association,
+    const std::string& arrayname);
+
+  /// a histogram to compute
+  struct Variable
+  {
+    std::string MeshName;
+    int Association;
+    std::string ArrayName;
+    Histogram::Data LastResult;
+  };
 
   int NumberOfBins;
-  std::string MeshName;
-  std::string ArrayName;
-  int Association;
+  int NumberOfThreads;
+  int Binning;
+  double RangeMin;
+  double RangeMax;
+  int Window;
+  int LastStep;
+  double LastTime;
   std::string FileName;
-  Histogram::Data LastResult;
+  std::vector<Variable> Variables;
+  std::shared_ptr<HistogramEngine> Engine;
 };
 
 }
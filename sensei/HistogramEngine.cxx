@@ -0,0 +1,872 @@
+#include "senseiConfig.h"
+#include "HistogramEngine.h"
+#include "ThreadPool.h"
+#include "SMPUtils.h"
+#include "SVTKUtils.h"
+#include "MemoryUtils.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <svtkDataArray.h>
+#include <svtkUnsignedCharArray.h>
+
+namespace sensei
+{
+
+namespace HistogramEngineCPU
+{
+// the number of values processed by a thread at a time
+constexpr size_t ChunkSize = 65536;
+
+// the inner loops are unrolled by this amount, with independent
+// accumulators in each lane, so that the compiler can vectorize them
+constexpr size_t Lanes = 8;
+
+/** Computes the minimum and maximum of the valid values in a block of data.
+ *
+ * @param[in] data      the array to calculate the range of
+ * @param[in] ghosts    an array of 0 and non zero, 0 where data is valid, or
+ *                      nullptr if all data is valid
+ * @param[in] nVals     the length of the array
+ * @param[in,out] gMin  the minimum is accumulated here
+ * @param[in,out] gMax  the maximum is accumulated here
+ */
+template <typename data_t>
+void block_range(const data_t *data, const unsigned char *ghosts,
+  size_t nVals, double &gMin, double &gMax)
+{
+  const data_t maxVal = std::numeric_limits<data_t>::max();
+  const data_t lowestVal = std::numeric_limits<data_t>::lowest();
+
+  data_t lo[Lanes];
+  data_t hi[Lanes];
+  for (size_t l = 0; l < Lanes; ++l)
+    {
+    lo[l] = maxVal;
+    hi[l] = lowestVal;
+    }
+
+  size_t nBulk = (nVals / Lanes) * Lanes;
+
+  if (ghosts)
+    {
+    // ghosted values are replaced by the identity of the reduction
+    for (size_t i = 0; i < nBulk; i += Lanes)
+      {
+      for (size_t l = 0; l < Lanes; ++l)
+        {
+        data_t val = data[i + l];
+        bool valid = ghosts[i + l] == 0;
+        data_t vlo = valid ? val : maxVal;
+        data_t vhi = valid ? val : lowestVal;
+        lo[l] = vlo < lo[l] ? vlo : lo[l];
+        hi[l] = vhi > hi[l] ? vhi : hi[l];
+        }
+      }
+
+    for (size_t i = nBulk; i < nVals; ++i)
+      {
+      data_t val = data[i];
+      bool valid = ghosts[i] == 0;
+      data_t vlo = valid ? val : maxVal;
+      data_t vhi = valid ? val : lowestVal;
+      lo[0] = vlo < lo[0] ? vlo : lo[0];
+      hi[0] = vhi > hi[0] ? vhi : hi[0];
+      }
+    }
+  else
+    {
+    for (size_t i = 0; i < nBulk; i += Lanes)
+      {
+      for (size_t l = 0; l < Lanes; ++l)
+        {
+        data_t val = data[i + l];
+        lo[l] = val < lo[l] ? val : lo[l];
+        hi[l] = val > hi[l] ? val : hi[l];
+        }
+      }
+
+    for (size_t i = nBulk; i < nVals; ++i)
+      {
+      data_t val = data[i];
+      lo[0] = val < lo[0] ? val : lo[0];
+      hi[0] = val > hi[0] ? val : hi[0];
+      }
+    }
+
+  for (size_t l = 0; l < Lanes; ++l)
+    {
+    // skip lanes that saw only ghosts
+    if (lo[l] <= hi[l])
+      {
+      gMin = std::min(gMin, double(lo[l]));
+      gMax = std::max(gMax, double(hi[l]));
+      }
+    }
+}
+
+/** Computes the slot of a value in a histogram with underflow and overflow
+ * slots. Slot 0 counts values below the lower edge, slots 1 to nBins the
+ * bins, and slot nBins + 1 values above the upper edge. The upper edge is
+ * included in the last bin. NaN's are placed in slot 0.
+ */
+template <typename calc_t>
+size_t bin_slot(calc_t val, calc_t lo, calc_t hi, calc_t w, calc_t last,
+  calc_t above)
+{
+  calc_t x = (val - lo) / w;
+  x = val == hi ? last : x;
+  x = x >= calc_t(-1) ? x : calc_t(-1);
+  x = x <= above ? x : above;
+  return size_t(x + calc_t(1));
+}
+
+/** Computes a histogram of a block of data. The histgoram must be
+ * pre-initialized to zero, multiple invokations accumulate results for new
+ * data. Values outside of the range are counted in the underflow and overflow
+ * slots, see bin_slot. When track_range is set the minimum and maximum of the
+ * valid values are computed in the same pass.
+ *
+ * @param[in] data      the array to calculate the histogram for
+ * @param[in] ghosts    an array of 0 and non zero, 0 where data is valid, or
+ *                      nullptr if all data is valid
+ * @param[in] nVals     the length of the array
+ * @param[in] minVal    the lower bin edge
+ * @param[in] maxVal    the upper bin edge
+ * @param[in] width     the width of histogram bins
+ * @param[in] nBins     the number of bins
+ * @param[in,out] hist  the histogram, with nBins + 2 slots
+ * @param[in,out] gMin  the minimum is accumulated here when track_range is set
+ * @param[in,out] gMax  the maximum is accumulated here when track_range is set
+ */
+template <typename data_t, bool track_range>
+void block_histogram_kernel(const data_t *data, const unsigned char *ghosts,
+  size_t nVals, double minVal, double maxVal, double width, size_t nBins,
+  unsigned int *hist, double &gMin, double &gMax)
+{
+  // bin floating point data in its own precision, integers in double
+  using calc_t = typename std::conditional<
+    std::is_floating_point<data_t>::value, data_t, double>::type;
+
+  const calc_t lo = minVal;
+  const calc_t hi = maxVal;
+  const calc_t w = width;
+  const calc_t last = calc_t(nBins - 1);
+  const calc_t above = calc_t(nBins);
+
+  const data_t maxVal_t = std::numeric_limits<data_t>::max();
+  const data_t lowestVal_t = std::numeric_limits<data_t>::lowest();
+
+  data_t rlo[Lanes];
+  data_t rhi[Lanes];
+  for (size_t l = 0; l < Lanes; ++l)
+    {
+    rlo[l] = maxVal_t;
+    rhi[l] = lowestVal_t;
+    }
+
+  size_t nBulk = (nVals / Lanes) * Lanes;
+
+  size_t bin[Lanes];
+  unsigned int inc[Lanes];
+
+  for (size_t i = 0; i < nBulk; i += Lanes)
+    {
+    // compute the bins and increments without branching. NaN's and
+    // ghosts increment the underflow slot by 0
+    for (size_t l = 0; l < Lanes; ++l)
+      {
+      data_t val = data[i + l];
+      bool valid = (val == val) && !(ghosts && ghosts[i + l]);
+      bin[l] = bin_slot<calc_t>(calc_t(val), lo, hi, w, last, above);
+      inc[l] = valid;
+      if (track_range)
+        {
+        data_t vlo = valid ? val : maxVal_t;
+        data_t vhi = valid ? val : lowestVal_t;
+        rlo[l] = vlo < rlo[l] ? vlo : rlo[l];
+        rhi[l] = vhi > rhi[l] ? vhi : rhi[l];
+        }
+      }
+
+    for (size_t l = 0; l < Lanes; ++l)
+      hist[bin[l]] += inc[l];
+    }
+
+  for (size_t i = nBulk; i < nVals; ++i)
+    {
+    data_t val = data[i];
+    bool valid = (val == val) && !(ghosts && ghosts[i]);
+    hist[bin_slot<calc_t>(calc_t(val), lo, hi, w, last, above)] += valid;
+    if (track_range)
+      {
+      data_t vlo = valid ? val : maxVal_t;
+      data_t vhi = valid ? val : lowestVal_t;
+      rlo[0] = vlo < rlo[0] ? vlo : rlo[0];
+      rhi[0] = vhi > rhi[0] ? vhi : rhi[0];
+      }
+    }
+
+  if (track_range)
+    {
+    for (size_t l = 0; l < Lanes; ++l)
+      {
+      // skip lanes that saw only ghosts
+      if (rlo[l] <= rhi[l])
+        {
+        gMin = std::min(gMin, double(rlo[l]));
+        gMax = std::max(gMax, double(rhi[l]));
+        }
+      }
+    }
+}
+
+/// selects the kernel that computes the range in the same pass, or not
+template <typename data_t>
+void block_histogram(bool track_range, const data_t *data,
+  const unsigned char *ghosts, size_t nVals, double minVal, double maxVal,
+  double width, size_t nBins, unsigned int *hist, double &gMin, double &gMax)
+{
+  if (track_range)
+    {
+    block_histogram_kernel<data_t, true>(data, ghosts, nVals, minVal,
+      maxVal, width, nBins, hist, gMin, gMax);
+    }
+  else
+    {
+    block_histogram_kernel<data_t, false>(data, ghosts, nVals, minVal,
+      maxVal, width, nBins, hist, gMin, gMax);
+    }
+}
+}
+
+// the bin edges and results of one of the variables, kept across steps
+struct HistogramEngine::VariableType
+{
+  VariableType() : HaveEdges(false), Min(0.0), Max(0.0), Width(1.0),
+    DataMin(std::numeric_limits<double>::max()),
+    DataMax(std::numeric_limits<double>::lowest()), Result() {}
+
+  bool HaveEdges;      // set when the edges below are valid
+  double Min;          // the lower bin edge
+  double Max;          // the upper bin edge
+  double Width;        // the bin width
+  double DataMin;      // the global minimum of the data, adaptive mode only
+  double DataMax;      // the global maximum of the data, adaptive mode only
+  Histogram::Data Result; // the counts are only valid on rank 0
+};
+
+// a block of local data belonging to one of the variables
+struct HistogramEngine::BlockType
+{
+  int VarId;
+  int DataType;
+  size_t NumberOfValues;
+  std::shared_ptr<void> Data;
+  std::shared_ptr<unsigned char> Ghosts;
+};
+
+// a contiguous range of values in a block, the unit of work of a thread
+struct HistogramEngine::ChunkType
+{
+  size_t BlockId;
+  size_t Start;
+  size_t End;
+};
+
+// --------------------------------------------------------------------------
+HistogramEngine::HistogramEngine(MPI_Comm comm, int numberOfBins,
+  int numberOfThreads) : Comm(comm), NumberOfBins(numberOfBins),
+  NumberOfThreads(numberOfThreads), NumberOfVariables(0),
+  Binning(Histogram::BINNING_GLOBAL), RangeMin(1.0), RangeMax(0.0), Window(0)
+{
+  // by default the count configured for SENSEI is used, or one thread when
+  // none was configured. either is capped by the SENSEI wide maximum
+  this->NumberOfThreads = SMPUtils::GetNumberOfThreads(this->NumberOfThreads);
+
+  // the calling thread is one of the team
+  if (this->NumberOfThreads > 1)
+    this->Pool.reset(new ThreadPool(this->NumberOfThreads - 1));
+}
+
+// --------------------------------------------------------------------------
+HistogramEngine::~HistogramEngine()
+{}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::SetBinning(int binning)
+{
+  if ((binning != Histogram::BINNING_GLOBAL) &&
+    (binning != Histogram::BINNING_FIXED) &&
+    (binning != Histogram::BINNING_ADAPTIVE))
+    {
+    SENSEI_ERROR("Invalid binning mode " << binning)
+    return -1;
+    }
+
+  if ((binning == Histogram::BINNING_GLOBAL) && (this->Window > 0))
+    {
+    SENSEI_ERROR("Histograms can not be accumulated with global binning")
+    return -1;
+    }
+
+  this->Binning = binning;
+  this->Variables.clear();
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::SetRange(double binMin, double binMax)
+{
+  if (!(binMax > binMin))
+    {
+    SENSEI_ERROR("Invalid range [" << binMin << ", " << binMax << "]")
+    return -1;
+    }
+
+  this->RangeMin = binMin;
+  this->RangeMax = binMax;
+  this->Variables.clear();
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::SetWindow(int numberOfSteps)
+{
+  if ((numberOfSteps > 0) && (this->Binning == Histogram::BINNING_GLOBAL))
+    {
+    SENSEI_ERROR("Histograms can not be accumulated with global binning")
+    return -1;
+    }
+
+  this->Window = std::max(0, numberOfSteps);
+  this->Variables.clear();
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::ReleaseData()
+{
+  this->Blocks.clear();
+  this->Chunks.clear();
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::Clear()
+{
+  this->NumberOfVariables = 0;
+  this->Variables.clear();
+  this->ReleaseData();
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::Initialize(int numberOfVariables)
+{
+  this->ReleaseData();
+
+  // the edges and accumulated results are kept from step to step
+  if (numberOfVariables != int(this->Variables.size()))
+    this->Variables.assign(numberOfVariables, VariableType());
+
+  this->NumberOfVariables = numberOfVariables;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::AddLocalData(int varId, svtkDataArray *da,
+  svtkUnsignedCharArray *ghosts)
+{
+  // validate the input
+  if ((varId < 0) || (varId >= this->NumberOfVariables))
+    {
+    SENSEI_ERROR("AddLocalData failed, invalid variable id " << varId)
+    return -1;
+    }
+
+  if (!da)
+    {
+    SENSEI_ERROR("AddLocalData failed, null data array")
+    return -1;
+    }
+
+  if (da->GetNumberOfComponents() != 1)
+    {
+    SENSEI_ERROR("Histogram on array \""
+      << (da->GetName() ? da->GetName() : "")
+      << "\" cannot be computed because the array has "
+      << da->GetNumberOfComponents() << " components")
+    return -1;
+    }
+
+  size_t nVals = da->GetNumberOfTuples();
+
+  BlockType block;
+  block.VarId = varId;
+  block.DataType = da->GetDataType();
+  block.NumberOfValues = nVals;
+
+  // get pointers accessible on the CPU
+  if (ghosts)
+    block.Ghosts = sensei::MemoryUtils::MakeCpuAccessible(
+      ghosts->GetPointer(0), nVals);
+
+  switch (block.DataType)
+    {
+    svtkTemplateMacro(
+      SVTK_TT *pDa = sensei::SVTKUtils::GetPointer<SVTK_TT>(da);
+      if (!pDa)
+        return -1;
+      block.Data = sensei::MemoryUtils::MakeCpuAccessible(pDa, nVals);
+      );
+    default:
+      {
+      SENSEI_ERROR("Unsupported dispatch " << da->GetClassName());
+      return -1;
+      }
+    }
+
+  // split the block into chunks for the threads
+  size_t blockId = this->Blocks.size();
+  for (size_t i = 0; i < nVals; i += HistogramEngineCPU::ChunkSize)
+    {
+    ChunkType chunk;
+    chunk.BlockId = blockId;
+    chunk.Start = i;
+    chunk.End = std::min(nVals, i + HistogramEngineCPU::ChunkSize);
+    this->Chunks.push_back(chunk);
+    }
+
+  this->Blocks.push_back(block);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void HistogramEngine::Run(const std::function<void(int)> &func)
+{
+  std::vector<std::future<void>> results;
+  for (int i = 1; i < this->NumberOfThreads; ++i)
+    results.push_back(this->Pool->Push([&func, i]() { func(i); }));
+
+  func(0);
+
+  for (auto &result : results)
+    result.wait();
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::ComputeRanges()
+{
+  int nVars = this->NumberOfVariables;
+  size_t nChunks = this->Chunks.size();
+
+  // find the variables that need new edges. with global binning this is
+  // every step, otherwise only the first. all ranks make the same choice.
+  std::vector<int> needRange(nVars, 0);
+  int nNeedRange = 0;
+  for (int j = 0; j < nVars; ++j)
+    {
+    VariableType &var = this->Variables[j];
+
+    if (this->Binning == Histogram::BINNING_FIXED)
+      {
+      var.Min = this->RangeMin;
+      var.Max = this->RangeMax;
+      var.Width = (var.Max - var.Min) / this->NumberOfBins;
+      var.HaveEdges = true;
+      }
+    else if ((this->Binning == Histogram::BINNING_GLOBAL) || !var.HaveEdges)
+      {
+      needRange[j] = 1;
+      ++nNeedRange;
+      }
+    }
+
+  if (nNeedRange == 0)
+    return 0;
+
+  // each thread reduces into private storage
+  std::vector<std::vector<double>> threadMin(this->NumberOfThreads,
+    std::vector<double>(nVars, std::numeric_limits<double>::max()));
+
+  std::vector<std::vector<double>> threadMax(this->NumberOfThreads,
+    std::vector<double>(nVars, std::numeric_limits<double>::lowest()));
+
+  std::atomic<size_t> next(0);
+
+  this->Run([&](int tid)
+    {
+    std::vector<double> &tMin = threadMin[tid];
+    std::vector<double> &tMax = threadMax[tid];
+
+    for (size_t i = next++; i < nChunks; i = next++)
+      {
+      const ChunkType &chunk = this->Chunks[i];
+      const BlockType &block = this->Blocks[chunk.BlockId];
+
+      if (!needRange[block.VarId])
+        continue;
+
+      const unsigned char *pGhosts = block.Ghosts ?
+        block.Ghosts.get() + chunk.Start : nullptr;
+
+      switch (block.DataType)
+        {
+        svtkTemplateMacro(
+          const SVTK_TT *pDa = static_cast<const SVTK_TT*>(block.Data.get());
+          HistogramEngineCPU::block_range<SVTK_TT>(pDa + chunk.Start,
+            pGhosts, chunk.End - chunk.Start, tMin[block.VarId],
+            tMax[block.VarId]);
+          );
+        }
+      }
+    });
+
+  // merge the threads' results. the minimum is negated so that the ranges
+  // of all variables can be reduced in a single call
+  std::vector<double> range(2*nVars);
+  for (int j = 0; j < nVars; ++j)
+    {
+    double vMin = std::numeric_limits<double>::max();
+    double vMax = std::numeric_limits<double>::lowest();
+
+    for (int i = 0; i < this->NumberOfThreads; ++i)
+      {
+      vMin = std::min(vMin, threadMin[i][j]);
+      vMax = std::max(vMax, threadMax[i][j]);
+      }
+
+    range[j] = -vMin;
+    range[nVars + j] = vMax;
+    }
+
+  // compute the min and max across all MPI ranks
+  MPI_Allreduce(MPI_IN_PLACE, range.data(), 2*nVars, MPI_DOUBLE,
+    MPI_MAX, this->Comm);
+
+  for (int j = 0; j < nVars; ++j)
+    {
+    if (!needRange[j])
+      continue;
+
+    VariableType &var = this->Variables[j];
+    var.Min = -range[j];
+    var.Max = range[nVars + j];
+
+    // check the result
+    if (fabs(var.Max - var.Min) < 1.0e-6)
+      {
+      SENSEI_ERROR("Invalid range detected for variable " << j << " ["
+        << var.Min << ", " << var.Max << "]")
+      return -1;
+      }
+
+    var.Width = (var.Max - var.Min) / this->NumberOfBins;
+    var.HaveEdges = true;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::ComputeBins()
+{
+  int rank = 0;
+  MPI_Comm_rank(this->Comm, &rank);
+
+  int nVars = this->NumberOfVariables;
+  size_t nChunks = this->Chunks.size();
+
+  // each variable has an underflow slot, the bins, and an overflow slot
+  size_t nBins = this->NumberOfBins;
+  size_t nSlots = nBins + 2;
+  size_t nTotal = nVars*nSlots;
+
+  // in the adaptive mode the range is computed while binning
+  bool trackRange = this->Binning == Histogram::BINNING_ADAPTIVE;
+
+  // each thread accumulates into private storage
+  std::vector<std::vector<unsigned int>> threadHist(this->NumberOfThreads);
+
+  std::vector<std::vector<double>> threadMin(this->NumberOfThreads,
+    std::vector<double>(nVars, std::numeric_limits<double>::max()));
+
+  std::vector<std::vector<double>> threadMax(this->NumberOfThreads,
+    std::vector<double>(nVars, std::numeric_limits<double>::lowest()));
+
+  std::atomic<size_t> next(0);
+
+  this->Run([&](int tid)
+    {
+    std::vector<unsigned int> &tHist = threadHist[tid];
+    tHist.resize(nTotal, 0u);
+
+    std::vector<double> &tMin = threadMin[tid];
+    std::vector<double> &tMax = threadMax[tid];
+
+    for (size_t i = next++; i < nChunks; i = next++)
+      {
+      const ChunkType &chunk = this->Chunks[i];
+      const BlockType &block = this->Blocks[chunk.BlockId];
+      int j = block.VarId;
+      const VariableType &var = this->Variables[j];
+
+      const unsigned char *pGhosts = block.Ghosts ?
+        block.Ghosts.get() + chunk.Start : nullptr;
+
+      switch (block.DataType)
+        {
+        svtkTemplateMacro(
+          const SVTK_TT *pDa = static_cast<const SVTK_TT*>(block.Data.get());
+          HistogramEngineCPU::block_histogram<SVTK_TT>(trackRange,
+            pDa + chunk.Start, pGhosts, chunk.End - chunk.Start, var.Min,
+            var.Max, var.Width, nBins, tHist.data() + j*nSlots, tMin[j],
+            tMax[j]);
+          );
+        }
+      }
+    });
+
+  // merge the threads' results
+  std::vector<unsigned int> hist(threadHist[0]);
+  for (int i = 1; i < this->NumberOfThreads; ++i)
+    {
+    const unsigned int *tHist = threadHist[i].data();
+    for (size_t k = 0; k < nTotal; ++k)
+      hist[k] += tHist[k];
+    }
+
+  // start the reduction of the range, which is only needed for the next
+  // step, and overlap it with the reduction of the bins. the minimum is
+  // negated so that the ranges of all variables are reduced in one call
+  std::vector<double> range;
+  MPI_Request rangeReq = MPI_REQUEST_NULL;
+  if (trackRange)
+    {
+    range.resize(2*nVars);
+    for (int j = 0; j < nVars; ++j)
+      {
+      double vMin = std::numeric_limits<double>::max();
+      double vMax = std::numeric_limits<double>::lowest();
+
+      for (int i = 0; i < this->NumberOfThreads; ++i)
+        {
+        vMin = std::min(vMin, threadMin[i][j]);
+        vMax = std::max(vMax, threadMax[i][j]);
+        }
+
+      range[j] = -vMin;
+      range[nVars + j] = vMax;
+      }
+
+    MPI_Iallreduce(MPI_IN_PLACE, range.data(), 2*nVars, MPI_DOUBLE,
+      MPI_MAX, this->Comm, &rangeReq);
+    }
+
+  // sum up contributions from each MPI rank to MPI rank 0, the histograms of
+  // all variables are reduced in a single call
+  std::vector<unsigned int> gHist;
+  if (rank == 0)
+    gHist.resize(nTotal);
+
+  MPI_Reduce(hist.data(), rank == 0 ? gHist.data() : nullptr,
+    nTotal, MPI_UNSIGNED, MPI_SUM, 0, this->Comm);
+
+  // update the results
+  for (int j = 0; j < nVars; ++j)
+    {
+    VariableType &var = this->Variables[j];
+    Histogram::Data &result = var.Result;
+
+    // start a new window
+    if ((this->Window < 1) || (result.NumberOfSteps >= this->Window))
+      {
+      result.NumberOfSteps = 0;
+      result.Underflow = 0;
+      result.Overflow = 0;
+      result.Histogram.clear();
+      }
+
+    result.NumberOfBins = this->NumberOfBins;
+    result.BinMin = var.Min;
+    result.BinMax = var.Max;
+    result.BinWidth = var.Width;
+    result.NumberOfSteps += 1;
+
+    if (rank == 0)
+      {
+      const unsigned int *vHist = gHist.data() + j*nSlots;
+
+      unsigned int underflow = vHist[0];
+      unsigned int overflow = vHist[nBins + 1];
+
+      result.Histogram.resize(nBins, 0u);
+      for (size_t k = 0; k < nBins; ++k)
+        result.Histogram[k] += vHist[k + 1];
+
+      if (this->Binning == Histogram::BINNING_GLOBAL)
+        {
+        // the edges span the data, values out of bounds are due to
+        // round off and belong in the first and last bins
+        result.Histogram[0] += underflow;
+        result.Histogram[nBins - 1] += overflow;
+        }
+      else
+        {
+        result.Underflow += underflow;
+        result.Overflow += overflow;
+        }
+      }
+    }
+
+  // finish the range reduction
+  if (trackRange)
+    {
+    MPI_Wait(&rangeReq, MPI_STATUS_IGNORE);
+
+    for (int j = 0; j < nVars; ++j)
+      {
+      VariableType &var = this->Variables[j];
+      var.DataMin = -range[j];
+      var.DataMax = range[nVars + j];
+      }
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::UpdateBins()
+{
+  if (this->Binning != Histogram::BINNING_ADAPTIVE)
+    return 0;
+
+  int rank = 0;
+  MPI_Comm_rank(this->Comm, &rank);
+
+  long nBins = this->NumberOfBins;
+
+  // the same decisions are made on all ranks since the range of the data and
+  // the number of steps accumulated are known everywhere
+  for (int j = 0; j < this->NumberOfVariables; ++j)
+    {
+    VariableType &var = this->Variables[j];
+    Histogram::Data &result = var.Result;
+
+    // no valid data anywhere
+    if (var.DataMin > var.DataMax)
+      continue;
+
+    bool exceeds = (var.DataMin < var.Min) || (var.DataMax > var.Max);
+
+    if ((this->Window > 0) && (result.NumberOfSteps < this->Window))
+      {
+      // in the middle of a window the bins may only grow. the width is
+      // multiplied by a power of two and the new edges are aligned with the
+      // old ones so that the accumulated counts can be merged exactly
+      if (!exceeds)
+        continue;
+
+      // the number of old bins needed below and above the lower edge
+      long nBelow = var.DataMin < var.Min ?
+        long(ceil((var.Min - var.DataMin) / var.Width)) : 0;
+
+      long nAbove = std::max(nBins,
+        long(ceil((var.DataMax - var.Min) / var.Width)));
+
+      long nNeeded = nBelow + nAbove;
+
+      long factor = 1;
+      while (nBins*factor < nNeeded)
+        factor *= 2;
+
+      // center the data in the new bins
+      long shift = nBelow + (nBins*factor - nNeeded) / 2;
+
+      if (rank == 0)
+        {
+        std::vector<unsigned int> hist(nBins, 0u);
+        for (long k = 0; k < nBins; ++k)
+          hist[(k + shift) / factor] += result.Histogram[k];
+        result.Histogram.swap(hist);
+        }
+
+      var.Min = var.Min - shift*var.Width;
+      var.Width = var.Width*factor;
+      var.Max = var.Min + nBins*var.Width;
+
+      result.BinMin = var.Min;
+      result.BinMax = var.Max;
+      result.BinWidth = var.Width;
+      }
+    else
+      {
+      // between windows the bins are fit to the data when it no longer
+      // fits, or when it uses less than half of the bins. some room is
+      // left so that slowly drifting data does not rebin every step
+      double span = var.Max - var.Min;
+      double dataSpan = var.DataMax - var.DataMin;
+
+      if (!exceeds && (dataSpan >= 0.5*span))
+        continue;
+
+      if (dataSpan < 1.0e-6)
+        {
+        // constant data, center the current bins on it
+        var.Min = var.DataMin - 0.5*span;
+        var.Max = var.DataMin + 0.5*span;
+        }
+      else
+        {
+        double pad = 0.05*dataSpan;
+        var.Min = var.DataMin - pad;
+        var.Max = var.DataMax + pad;
+        }
+
+      var.Width = (var.Max - var.Min) / nBins;
+      }
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::ComputeHistograms()
+{
+  if (this->ComputeRanges() || this->ComputeBins() || this->UpdateBins())
+    return -1;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramEngine::GetHistogram(int varId, Histogram::Data &data)
+{
+  int rank = 0;
+  MPI_Comm_rank(this->Comm, &rank);
+
+  if (rank == 0)
+    {
+    if ((varId < 0) || (varId >= this->NumberOfVariables) ||
+      this->Variables[varId].Result.Histogram.empty())
+      {
+      SENSEI_ERROR("Failed calculation detected. MPI rank 0 has no histogram"
+        " to return for variable " << varId)
+      return -1;
+      }
+
+    data = this->Variables[varId].Result;
+    }
+
+  return 0;
+}
+
+}
@@ -0,0 +1,149 @@
+#ifndef HistogramEngine_h
+#define HistogramEngine_h
+
+class svtkUnsignedCharArray;
+class svtkDataArray;
+
+#include "Histogram.h"
+
+#include <mpi.h>
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace sensei
+{
+class ThreadPool;
+
+/// Distributed MPI+threads parallel histogram of many arrays at once
+/** Computes histograms of any number of variables, each made of multiple
+ * local data blocks, on the CPU. The blocks of all variables are split into
+ * chunks which are processed by a team of threads, each thread accumulating
+ * into private bins that are merged when the sweep completes. The data is
+ * visited twice, once to find the ranges and once to bin. The inner loops
+ * mask ghost values without branching so that they can be vectorized. The
+ * ranges of all variables are reduced with a single MPI_Allreduce, and the
+ * bins of all variables with a single MPI_Reduce. The data arrays must have
+ * only one component.
+ *
+ * The bin edges are determined by the binning mode. With
+ * Histogram::BINNING_GLOBAL the global range of the data is computed each
+ * step. With Histogram::BINNING_FIXED the edges are set by SetRange and with
+ * Histogram::BINNING_ADAPTIVE the edges are carried over from the previous
+ * step. In the latter two modes the data is visited only once, values falling
+ * outside of the edges are counted as underflow and overflow. In the adaptive
+ * mode the global range of the data is tracked during binning, and is reduced
+ * with a non-blocking collective overlapped with the reduction of the bins.
+ * When the range exceeds the edges, or occupies less than half of them, the
+ * data is rebinned the next step.
+ *
+ * With the fixed and adaptive modes the histograms may be accumulated over a
+ * window of time steps, see SetWindow. When the range grows in the middle of a
+ * window the bins are widened by a power of two with edges aligned to the old
+ * ones so that the accumulated counts can be merged exactly.
+ *
+ * Call the methods in the following order:
+ *
+ * Initialize
+ * AddLocalData (once per local data block of each variable)
+ * ComputeHistograms
+ * GetHistogram (once per variable)
+ * ReleaseData
+ *
+ * The thread pool, bin edges, and accumulated histograms are kept across calls
+ * to Initialize so that an instance can be reused each time step. All methods
+ * return 0 if successful.
+ */
+class HistogramEngine
+{
+public:
+  HistogramEngine() = delete;
+  HistogramEngine(const HistogramEngine&) = delete;
+  void operator=(const HistogramEngine&) = delete;
+
+  /** Creates an engine using numberOfThreads threads. If numberOfThreads is
+   * less than 1 the count configured by SMPUtils::Initialize is used, or one
+   * thread when none was configured. The count is capped by SMPUtils'
+   * maximum. This call uses MPI collectives, all ranks must participate.
+   */
+  HistogramEngine(MPI_Comm comm, int numberOfBins, int numberOfThreads);
+
+  ~HistogramEngine();
+
+  /// get the number of threads used
+  int GetNumberOfThreads() const { return this->NumberOfThreads; }
+
+  /** set how the bin edges are determined, one of Histogram::BINNING_GLOBAL,
+   * Histogram::BINNING_FIXED, or Histogram::BINNING_ADAPTIVE. The default is
+   * Histogram::BINNING_GLOBAL. */
+  int SetBinning(int binning);
+
+  /// set the bin edges used by Histogram::BINNING_FIXED
+  int SetRange(double binMin, double binMax);
+
+  /** set the number of steps to accumulate histograms over. When 0, the
+   * default, each step's histogram is computed independently. Accumulation
+   * is not supported by Histogram::BINNING_GLOBAL */
+  int SetWindow(int numberOfSteps);
+
+  /** set up for a new calculation on the given number of variables. all
+   * ranks must pass the same number. If the number of variables changes the
+   * bin edges and accumulated histograms are reset */
+  int Initialize(int numberOfVariables);
+
+  /** add block local contributions to variable varId. The arrays are
+   * referenced, not copied, and must remain valid until the histograms have
+   * been computed */
+  int AddLocalData(int varId, svtkDataArray *da, svtkUnsignedCharArray *ghosts);
+
+  /** compute the histograms of all variables. this call uses MPI collectives,
+   * all ranks must participate */
+  int ComputeHistograms();
+
+  /** return the computed histogram of variable varId, only valid on MPI rank
+   * 0. When accumulating over a window this is the sum of the steps of the
+   * current window processed so far */
+  int GetHistogram(int varId, Histogram::Data &data);
+
+  /// release references to the data added by AddLocalData
+  int ReleaseData();
+
+  /** free all cached memory and reset all internal parameters */
+  int Clear();
+
+private:
+  /** compute the global min and max of the variables that need new bin
+   * edges, and set their edges */
+  int ComputeRanges();
+
+  /** compute the local histograms and reduce them to rank 0 */
+  int ComputeBins();
+
+  /** update the bin edges of the adaptive mode for the next step */
+  int UpdateBins();
+
+  /** run the function on the team of threads and wait for completion. The
+   * function is passed the thread's rank */
+  void Run(const std::function<void(int)> &func);
+
+  struct VariableType;
+  struct BlockType;
+  struct ChunkType;
+
+private:
+  MPI_Comm Comm;
+  int NumberOfBins;
+  int NumberOfThreads;
+  int NumberOfVariables;
+  int Binning;
+  double RangeMin;
+  double RangeMax;
+  int Window;
+  std::vector<VariableType> Variables;
+  std::vector<BlockType> Blocks;
+  std::vector<ChunkType> Chunks;
+  std::unique_ptr<ThreadPool> Pool;
+};
+
+}
+#endif
@@ -2,6 +2,7 @@
 #include "HistogramInternals.h"
 #include "SVTKUtils.h"
 #include "MemoryUtils.h"
+#include "SMPUtils.h"
 #include "Error.h"
 
 #if defined(ENABLE_CUDA)
@@ -29,6 +30,7 @@
 #include <svtkDataObject.h>
 #include <svtkFieldData.h>
 #include <svtkObjectFactory.h>
+#include <svtkSMPThreadLocal.h>
 
 namespace sensei
 {
@@ -235,16 +237,33 @@ void block_local_histogram(data_t *data, unsigned char *ghosts,
   size_t nVals, data_t minVal, data_t width, unsigned int *hist,
   size_t nBins)
 {
-  (void) nBins;
+  // each thread bins a range of the values in to its own histogram, these
+  // are summed after
+  svtkSMPThreadLocal<std::vector<unsigned int>> localHist;
 
-  for (size_t i = 0; i < nVals; ++i)
+  sensei::SMPUtils::For(0, nVals, 65536, [&](svtkIdType i0, svtkIdType i1)
     {
-    // find the bin for this value
-    size_t j = (data[i] - minVal) / width;
+    std::vector<unsigned int> &lhist = localHist.Local();
+    if (lhist.empty())
+      lhist.resize(nBins, 0);
 
-    // update the bin count if the data point is not from a ghost zone
-    unsigned int inc_valid = ghosts[i] ? 0 : 1;
-    hist[j] += inc_valid;
+    unsigned int *phist = lhist.data();
+    for (svtkIdType i = i0; i < i1; ++i)
+      {
+      // find the bin for this value
+      size_t j = (data[i] - minVal) / width;
+
+      // update the bin count if the data point is not from a ghost zone
+      unsigned int inc_valid = ghosts[i] ? 0 : 1;
+      phist[j] += inc_valid;
+      }
+    });
+
+  for (auto it = localHist.begin(); it != localHist.end(); ++it)
+    {
+    const std::vector<unsigned int> &lhist = *it;
+    for (size_t j = 0; j < lhist.size(); ++j)
+      hist[j] += lhist[j];
     }
 }
 }
@@ -363,7 +382,7 @@ int HistogramInternals::AddLocalData(svtkDataArray *da,
       pGhosts = std::shared_ptr<unsigned char>(
         (unsigned char*)malloc(nVals), sensei::MemoryUtils::FreeCpuPtr);
 
-      memset(pGhosts.get(), 0, nVals);
+      sensei::SMPUtils::Fill(pGhosts.get(), nVals, (unsigned char)0);
 #if defined(ENABLE_CUDA)
       }
 #endif
@@ -462,17 +481,32 @@ int HistogramInternals::ComputeRange()
           {
 #endif
           // calculate range taking into account ghost zones on the CPU
-          SVTK_TT *rpDa = pDa.get();
-          unsigned char *rpGhosts = pGhosts.get();
-          for (size_t i = 0; i < nVals; ++i)
+          const SVTK_TT *rpDa = pDa.get();
+          const unsigned char *rpGhosts = pGhosts.get();
+
+          svtkSMPThreadLocal<SVTK_TT> localMin(blockMin);
+          svtkSMPThreadLocal<SVTK_TT> localMax(blockMax);
+
+          sensei::SMPUtils::For(0, nVals, 65536, [&](svtkIdType i0, svtkIdType i1)
             {
-            if (rpGhosts[i] == 0)
+            SVTK_TT &lmin = localMin.Local();
+            SVTK_TT &lmax = localMax.Local();
+            for (svtkIdType i = i0; i < i1; ++i)
               {
-              SVTK_TT value = rpDa[i];
-              blockMin = std::min(blockMin, value);
-              blockMax = std::max(blockMax, value);
+              if (rpGhosts[i] == 0)
+                {
+                SVTK_TT value = rpDa[i];
+                lmin = std::min(lmin, value);
+                lmax = std::max(lmax, value);
+                }
               }
-            }
+            });
+
+          for (auto it = localMin.begin(); it != localMin.end(); ++it)
+            blockMin = std::min(blockMin, *it);
+
+          for (auto it = localMax.begin(); it != localMax.end(); ++it)
+            blockMax = std::max(blockMax, *it);
 #if defined(SENSEI_DEBUG)
           std::cerr << "HistogramInternals::ComputeRange CPU ["
              << blockMin << ", " << blockMax << "]" << std::endl;
@@ -3,6 +3,7 @@
 #include "Partitioner.h"
 #include "ConfigurablePartitioner.h"
 #include "BlockPartitioner.h"
+#include "DataRequirements.h"
 #include "Error.h"
 #include "Profiler.h"
 
@@ -21,12 +22,14 @@ namespace sensei
 
 struct InTransitDataAdaptor::InternalsType
 {
-  InternalsType() : Part(BlockPartitioner::New()) {}
+  InternalsType() : Part(BlockPartitioner::New()), PrefetchDepth(0) {}
   ~InternalsType() {}
 
   PartitionerPtr Part;
   std::map<unsigned int, MeshMetadataPtr> ReceiverMetadata;
   std::string ConnectionInfo;
+  unsigned int PrefetchDepth;
+  DataRequirements PrefetchRequirements;
 };
 
 //----------------------------------------------------------------------------
@@ -67,6 +70,16 @@ int InTransitDataAdaptor::Initialize(pugi::xml_node &node)
     this->Internals->Part = tmp;
     }
 
+  // look for the optional prefetch depth and the data to prefetch
+  this->Internals->PrefetchDepth = node.attribute("prefetch-depth").as_uint(0);
+
+  pugi::xml_node prefetchNode = node.child("prefetch");
+  if (prefetchNode && this->Internals->PrefetchRequirements.Initialize(prefetchNode))
+    {
+    SENSEI_ERROR("Failed to initialize the prefetch requirements from XML")
+    return -1;
+    }
+
   return 0;
 }
 
@@ -88,6 +101,32 @@ sensei::PartitionerPtr InTransitDataAdaptor::GetPartitioner()
   return this->Internals->Part;
 }
 
+//----------------------------------------------------------------------------
+int InTransitDataAdaptor::SetPrefetchDepth(unsigned int depth)
+{
+  this->Internals->PrefetchDepth = depth;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+unsigned int InTransitDataAdaptor::GetPrefetchDepth()
+{
+  return this->Internals->PrefetchDepth;
+}
+
+//----------------------------------------------------------------------------
+int InTransitDataAdaptor::SetPrefetchRequirements(const DataRequirements &reqs)
+{
+  this->Internals->PrefetchRequirements = reqs;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+const DataRequirements &InTransitDataAdaptor::GetPrefetchRequirements()
+{
+  return this->Internals->PrefetchRequirements;
+}
+
 //----------------------------------------------------------------------------
 int InTransitDataAdaptor::GetReceiverMeshMetadata(unsigned int id,
   MeshMetadataPtr &metadata)
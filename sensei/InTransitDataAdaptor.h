@@ -10,6 +10,7 @@ namespace pugi { class xml_node; }
 
 namespace sensei
 {
+class DataRequirements;
 
 /** Defines the control API for in transit data movement.  The
  * InTransitDataAdaptor layers a control API onto the sensei::DataAdaptor API.
@@ -84,6 +85,26 @@ public:
   /// Return the current partitioner.
   virtual sensei::PartitionerPtr GetPartitioner();
 
+  /** Set/get the prefetch depth, the number of steps read ahead of the one
+   * being processed. When the depth is greater than zero the next steps are
+   * read on a background thread while the current step is analyzed, which
+   * overlaps I/O with analysis. The default of 0 reads each step on demand.
+   * Prefetching is implemented by sensei::ConfigurableInTransitDataAdaptor
+   * for all of the transports. The depth may be given in XML with the
+   * `prefetch-depth` attribute of the transport element. It must be set
+   * before the stream is opened.
+   */
+  virtual int SetPrefetchDepth(unsigned int depth);
+  virtual unsigned int GetPrefetchDepth();
+
+  /** Set/get the meshes and arrays read when prefetching. When empty, the
+   * default, all meshes and arrays are read. These may be given in XML by a
+   * `prefetch` element, nested in the transport element, holding mesh
+   * elements in the format of sensei::DataRequirements.
+   */
+  virtual int SetPrefetchRequirements(const sensei::DataRequirements &reqs);
+  virtual const sensei::DataRequirements &GetPrefetchRequirements();
+
   /// Opens a stream and connects to the simulation.
   virtual int OpenStream() = 0;
 
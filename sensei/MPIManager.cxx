@@ -19,9 +19,11 @@ MPIManager::MPIManager(int &argc, char **&argv)
   Profiler::StartEvent("AppInitialize");
 
 #if defined(SENSEI_HAS_MPI)
+  // ask for full thread support, which enables concurrent execution of
+  // analyses in ConfigurableAnalysis, but only require what we use
   int required = MPI_THREAD_SERIALIZED;
   int provided = 0;
-  MPI_Init_thread(&argc, &argv, required, &provided);
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
   if (provided < required)
     {
     SENSEI_ERROR("This MPI does not support thread serialized");
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <mutex>
 
 namespace sensei
 {
@@ -264,6 +265,208 @@ void GlobalViewV(MPI_Comm comm, const std::vector<std::array<cpp_t,N>> &ldata,
     }
 }
 
+/// @cond
+/// the node local and node leader communicators cached on a communicator
+struct HierarchicalComms
+{
+  MPI_Comm Node;
+  MPI_Comm Leaders;
+};
+
+/// frees the cached communicators when the communicator is freed
+inline int FreeHierarchicalComms(MPI_Comm, int, void *attr, void *)
+{
+  HierarchicalComms *hc = static_cast<HierarchicalComms*>(attr);
+  MPI_Comm_free(&hc->Node);
+  if (hc->Leaders != MPI_COMM_NULL)
+    MPI_Comm_free(&hc->Leaders);
+  delete hc;
+  return MPI_SUCCESS;
+}
+/// @endcond
+
+/** get communicators for two level communication. nodeComm contains the
+ * ranks of comm that share a node, and leaderComm contains rank 0 of each
+ * nodeComm. leaderComm is MPI_COMM_NULL on the other ranks. The communicators
+ * are created the first time they are requested, which uses MPI collectives
+ * on comm, and are cached on comm until it is freed. The caller must not free
+ * them.
+ */
+inline void GetHierarchicalComms(MPI_Comm comm, MPI_Comm &nodeComm,
+  MPI_Comm &leaderComm)
+{
+  // the keyval is created once, even when called from multiple threads
+  static int keyval = MPI_KEYVAL_INVALID;
+  static std::once_flag keyvalCreated;
+  std::call_once(keyvalCreated, []()
+    {
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, FreeHierarchicalComms,
+      &keyval, nullptr);
+    });
+
+  HierarchicalComms *hc = nullptr;
+  int found = 0;
+  MPI_Comm_get_attr(comm, keyval, &hc, &found);
+
+  if (!found)
+    {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+
+    hc = new HierarchicalComms;
+
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank,
+      MPI_INFO_NULL, &hc->Node);
+
+    int nodeRank = 0;
+    MPI_Comm_rank(hc->Node, &nodeRank);
+
+    MPI_Comm_split(comm, nodeRank == 0 ? 0 : MPI_UNDEFINED, rank,
+      &hc->Leaders);
+
+    MPI_Comm_set_attr(comm, keyval, hc);
+    }
+
+  nodeComm = hc->Node;
+  leaderComm = hc->Leaders;
+}
+
+/** A two level version of GlobalViewV for use at high concurrency. The local
+ * data is gathered to a leader rank on each node, the leaders exchange the
+ * data of their nodes, and the result is broadcast within each node. Only one
+ * rank per node takes part in the exchange across nodes. The result is
+ * identical to GlobalViewV, the data is ordered by rank in comm.
+ */
+template <typename cpp_t>
+void GlobalViewVHierarchical(MPI_Comm comm, const std::vector<cpp_t> &ldata,
+  std::vector<int> &gcounts, std::vector<int> &goffset,
+  std::vector<cpp_t> &gdata)
+{
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  MPI_Comm nodeComm = MPI_COMM_NULL;
+  MPI_Comm leaderComm = MPI_COMM_NULL;
+  GetHierarchicalComms(comm, nodeComm, leaderComm);
+
+  int nodeRank = 0;
+  int nNodeRanks = 1;
+
+  MPI_Comm_rank(nodeComm, &nodeRank);
+  MPI_Comm_size(nodeComm, &nNodeRanks);
+
+  MPI_Datatype dataType = mpi_tt<cpp_t>::datatype();
+
+  // gather the rank and the number of items of each rank on the node
+  int nLocal = ldata.size();
+  int linfo[2] = {rank, nLocal};
+
+  std::vector<int> ninfo(nodeRank == 0 ? 2*nNodeRanks : 0);
+
+  MPI_Gather(linfo, 2, MPI_INT, ninfo.data(), 2, MPI_INT, 0, nodeComm);
+
+  // gather the data of the node
+  std::vector<int> ncounts;
+  std::vector<int> noffset;
+  int nNode = 0;
+
+  if (nodeRank == 0)
+    {
+    ncounts.resize(nNodeRanks);
+    noffset.resize(nNodeRanks);
+    for (int i = 0; i < nNodeRanks; ++i)
+      {
+      ncounts[i] = ninfo[2*i + 1];
+      noffset[i] = nNode;
+      nNode += ncounts[i];
+      }
+    }
+
+  std::vector<cpp_t> ndata(nNode);
+
+  MPI_Gatherv(ldata.data(), nLocal, dataType, ndata.data(),
+    ncounts.data(), noffset.data(), dataType, 0, nodeComm);
+
+  gcounts.assign(nRanks, 0);
+  goffset.assign(nRanks, 0);
+
+  int nTotal = 0;
+
+  if (nodeRank == 0)
+    {
+    // exchange the number of ranks and items of each node
+    int nNodes = 1;
+    MPI_Comm_size(leaderComm, &nNodes);
+
+    int lsize[2] = {nNodeRanks, nNode};
+    std::vector<int> sizes(2*nNodes);
+
+    MPI_Allgather(lsize, 2, MPI_INT, sizes.data(), 2, MPI_INT, leaderComm);
+
+    std::vector<int> icounts(nNodes);
+    std::vector<int> ioffset(nNodes);
+    std::vector<int> dcounts(nNodes);
+    std::vector<int> doffset(nNodes);
+
+    for (int i = 0, nInfo = 0; i < nNodes; ++i)
+      {
+      icounts[i] = 2*sizes[2*i];
+      ioffset[i] = nInfo;
+      nInfo += icounts[i];
+
+      dcounts[i] = sizes[2*i + 1];
+      doffset[i] = nTotal;
+      nTotal += dcounts[i];
+      }
+
+    // exchange the ranks and the data of each node
+    std::vector<int> info(2*nRanks);
+
+    MPI_Allgatherv(ninfo.data(), 2*nNodeRanks, MPI_INT, info.data(),
+      icounts.data(), ioffset.data(), MPI_INT, leaderComm);
+
+    std::vector<cpp_t> data(nTotal);
+
+    MPI_Allgatherv(ndata.data(), nNode, dataType, data.data(),
+      dcounts.data(), doffset.data(), dataType, leaderComm);
+
+    // put the data in rank order
+    for (int i = 0; i < nRanks; ++i)
+      gcounts[info[2*i]] = info[2*i + 1];
+
+    for (int i = 1; i < nRanks; ++i)
+      goffset[i] = goffset[i-1] + gcounts[i-1];
+
+    gdata.resize(nTotal);
+
+    for (int i = 0, q = 0; i < nRanks; ++i)
+      {
+      int n = info[2*i + 1];
+      std::copy(data.begin() + q, data.begin() + q + n,
+        gdata.begin() + goffset[info[2*i]]);
+      q += n;
+      }
+    }
+
+  // send the result to the other ranks on the node
+  MPI_Bcast(gcounts.data(), nRanks, MPI_INT, 0, nodeComm);
+
+  if (nodeRank != 0)
+    {
+    for (int i = 0; i < nRanks; ++i)
+      {
+      goffset[i] = nTotal;
+      nTotal += gcounts[i];
+      }
+    gdata.resize(nTotal);
+    }
+
+  MPI_Bcast(gdata.data(), nTotal, dataType, 0, nodeComm);
+}
+
 /** use this if you don't need counts & offsets and want the result to replace
  * the input.
  */
@@ -6,6 +6,9 @@
 
 #include <utility>
 #include <algorithm>
+#include <iterator>
+#include <cstdlib>
+#include <cstring>
 
 namespace sensei
 {
@@ -88,6 +91,7 @@ int MeshMetadata::ToStream(sensei::BinaryStream &str) const
   str.Pack(this->NumGhostNodes);
   str.Pack(this->NumLevels);
   str.Pack(this->StaticMesh);
+  str.Pack(this->Generation);
   str.Pack(this->ArrayName);
   str.Pack(this->ArrayCentering);
   str.Pack(this->ArrayComponents);
@@ -131,6 +135,7 @@ int MeshMetadata::FromStream(sensei::BinaryStream &str)
   str.Unpack(this->NumGhostNodes);
   str.Unpack(this->NumLevels);
   str.Unpack(this->StaticMesh);
+  str.Unpack(this->Generation);
   str.Unpack(this->ArrayName);
   str.Unpack(this->ArrayCentering);
   str.Unpack(this->ArrayComponents);
@@ -173,6 +178,7 @@ int MeshMetadata::ToStream(ostream &str) const
   str << "NumGhostNodes = " << this->NumGhostNodes << std::endl;
   str << "NumLevels = " << this->NumLevels << std::endl;
   str << "StaticMesh = " << this->StaticMesh << std::endl;
+  str << "Generation = " << this->Generation << std::endl;
   str << "ArrayName = " << this->ArrayName << std::endl;
   str << "ArrayCentering = " << this->ArrayCentering << std::endl;
   str << "ArrayComponents = " << this->ArrayComponents << std::endl;
@@ -195,6 +201,127 @@ int MeshMetadata::ToStream(ostream &str) const
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int MeshMetadata::ToStreamDelta(sensei::BinaryStream &str,
+  const MeshMetadataPtr &previous) const
+{
+  int unchanged = previous && this->Generation &&
+    (previous->Generation == this->Generation) &&
+    (previous->MeshName == this->MeshName);
+
+  str.Pack(unchanged);
+
+  if (!unchanged)
+    return this->ToStream(str);
+
+  // the block structure is omitted, only the fields that may change while
+  // it stays the same are written
+  str.Pack(this->Generation);
+  str.Pack(this->MeshName);
+  str.Pack(this->GlobalView);
+  str.Pack(this->NumArrays);
+  str.Pack(this->NumGhostCells);
+  str.Pack(this->NumGhostNodes);
+  str.Pack(this->StaticMesh);
+  str.Pack(this->ArrayName);
+  str.Pack(this->ArrayCentering);
+  str.Pack(this->ArrayComponents);
+  str.Pack(this->ArrayType);
+  str.Pack(this->ArrayRange);
+  str.Pack(this->BlockArrayRange);
+  this->Flags.ToStream(str);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int MeshMetadata::FromStreamDelta(sensei::BinaryStream &str,
+  const MeshMetadataPtr &previous)
+{
+  int unchanged = 0;
+  str.Unpack(unchanged);
+
+  if (!unchanged)
+    return this->FromStream(str);
+
+  unsigned long generation = 0;
+  std::string meshName;
+
+  str.Unpack(generation);
+  str.Unpack(meshName);
+
+  if (!previous || (previous->Generation != generation) ||
+    (previous->MeshName != meshName))
+    {
+    SENSEI_ERROR("The block structure of mesh \"" << meshName
+      << "\" generation " << generation << " was omitted but the "
+      "previous metadata " << (previous ? "is of a different generation" :
+      "was not provided"))
+    return -1;
+    }
+
+  *this = *previous;
+
+  str.Unpack(this->GlobalView);
+  str.Unpack(this->NumArrays);
+  str.Unpack(this->NumGhostCells);
+  str.Unpack(this->NumGhostNodes);
+  str.Unpack(this->StaticMesh);
+  str.Unpack(this->ArrayName);
+  str.Unpack(this->ArrayCentering);
+  str.Unpack(this->ArrayComponents);
+  str.Unpack(this->ArrayType);
+  str.Unpack(this->ArrayRange);
+  str.Unpack(this->BlockArrayRange);
+  this->Flags.FromStream(str);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+bool MeshMetadata::SameBlockStructure(const MeshMetadataPtr &other) const
+{
+  return (this->MeshType == other->MeshType) &&
+    (this->BlockType == other->BlockType) &&
+    (this->NumLevels == other->NumLevels) &&
+    (this->NumBlocksLocal == other->NumBlocksLocal) &&
+    (this->BlockOwner == other->BlockOwner) &&
+    (this->BlockIds == other->BlockIds) &&
+    (this->BlockNumPoints == other->BlockNumPoints) &&
+    (this->BlockNumCells == other->BlockNumCells) &&
+    (this->BlockCellArraySize == other->BlockCellArraySize) &&
+    (this->BlockExtents == other->BlockExtents) &&
+    (this->BlockBounds == other->BlockBounds) &&
+    (this->RefRatio == other->RefRatio) &&
+    (this->BlocksPerLevel == other->BlocksPerLevel) &&
+    (this->BlockLevel == other->BlockLevel);
+}
+
+// --------------------------------------------------------------------------
+int MeshMetadata::CopyBlockStructure(const MeshMetadataPtr &other)
+{
+  this->NumBlocks = other->NumBlocks;
+  this->NumPoints = other->NumPoints;
+  this->NumCells = other->NumCells;
+  this->CellArraySize = other->CellArraySize;
+  this->Extent = other->Extent;
+  this->Bounds = other->Bounds;
+
+  this->NumBlocksLocal = other->NumBlocksLocal;
+  this->BlockOwner = other->BlockOwner;
+  this->BlockIds = other->BlockIds;
+  this->BlockNumPoints = other->BlockNumPoints;
+  this->BlockNumCells = other->BlockNumCells;
+  this->BlockCellArraySize = other->BlockCellArraySize;
+  this->BlockExtents = other->BlockExtents;
+  this->BlockBounds = other->BlockBounds;
+  this->RefRatio = other->RefRatio;
+  this->BlocksPerLevel = other->BlocksPerLevel;
+  this->BlockLevel = other->BlockLevel;
+
+  return 0;
+}
+
 // --------------------------------------------------------------------------
 int MeshMetadata::Validate(MPI_Comm comm, const MeshMetadataFlags &requiredFlags)
 {
@@ -384,24 +511,102 @@ int MeshMetadata::Validate(MPI_Comm comm, const MeshMetadataFlags &requiredFlags
   return err ? -1 : 0;
 }
 
+// --------------------------------------------------------------------------
+template <typename T>
+void UnpackAppend(BinaryStream &str, std::vector<T> &dest)
+{
+  std::vector<T> tmp;
+  str.Unpack(tmp);
+  dest.insert(dest.end(), std::make_move_iterator(tmp.begin()),
+    std::make_move_iterator(tmp.end()));
+}
+
 // --------------------------------------------------------------------------
 int MeshMetadata::GlobalizeView(MPI_Comm comm)
+{
+  int method = GLOBALIZE_FLAT;
+
+  const char *tmp = getenv("SENSEI_HIERARCHICAL_METADATA");
+  if (tmp && atoi(tmp))
+    method = GLOBALIZE_HIERARCHICAL;
+
+  return this->GlobalizeView(comm, method);
+}
+
+// --------------------------------------------------------------------------
+int MeshMetadata::GlobalizeView(MPI_Comm comm, int method)
 {
   TimeEvent<128> mark("MeshMetadata::GlobalizeView");
   if (!this->GlobalView)
     {
-    MPIUtils::GlobalViewV(comm, this->BlockOwner);
-    MPIUtils::GlobalViewV(comm, this->BlockIds);
-    MPIUtils::GlobalViewV(comm, this->NumBlocksLocal);
-    MPIUtils::GlobalViewV(comm, this->BlockNumPoints);
-    MPIUtils::GlobalViewV(comm, this->BlockNumCells);
-    MPIUtils::GlobalViewV(comm, this->BlockCellArraySize);
-    MPIUtils::GlobalViewV(comm, this->BlockExtents);
-    MPIUtils::GlobalViewV(comm, this->BlockBounds);
-    MPIUtils::GlobalViewV(comm, this->BlockArrayRange);
-    MPIUtils::GlobalViewV(comm, this->BlockLevel);
-
-    MPIUtils::GlobalCounts(comm, this->BlocksPerLevel);
+    // pack the block level metadata so that it can be exchanged with a
+    // single collective. empty fields are packed too, so that the fields of
+    // each rank can be found while unpacking
+    BinaryStream ls;
+    ls.Pack(this->BlockOwner);
+    ls.Pack(this->BlockIds);
+    ls.Pack(this->NumBlocksLocal);
+    ls.Pack(this->BlockNumPoints);
+    ls.Pack(this->BlockNumCells);
+    ls.Pack(this->BlockCellArraySize);
+    ls.Pack(this->BlockExtents);
+    ls.Pack(this->BlockBounds);
+    ls.Pack(this->BlockArrayRange);
+    ls.Pack(this->BlockLevel);
+    ls.Pack(this->BlocksPerLevel);
+
+    std::vector<unsigned char> ldata(ls.GetData(), ls.GetData() + ls.Size());
+    std::vector<unsigned char> gdata;
+    std::vector<int> counts, offsets;
+
+    if (method == GLOBALIZE_HIERARCHICAL)
+      MPIUtils::GlobalViewVHierarchical(comm, ldata, counts, offsets, gdata);
+    else
+      MPIUtils::GlobalViewV(comm, ldata, counts, offsets, gdata);
+
+    // unpack in rank order, the per block fields are concatenated and the
+    // per level counts summed
+    BinaryStream gs;
+    gs.Resize(gdata.size());
+    memcpy(gs.GetData(), gdata.data(), gdata.size());
+    gs.SetWritePos(gdata.size());
+    gs.SetReadPos(0);
+
+    std::vector<int> blocksPerLevel;
+    blocksPerLevel.swap(this->BlocksPerLevel);
+    this->BlocksPerLevel.assign(blocksPerLevel.size(), 0);
+
+    this->BlockOwner.clear();
+    this->BlockIds.clear();
+    this->NumBlocksLocal.clear();
+    this->BlockNumPoints.clear();
+    this->BlockNumCells.clear();
+    this->BlockCellArraySize.clear();
+    this->BlockExtents.clear();
+    this->BlockBounds.clear();
+    this->BlockArrayRange.clear();
+    this->BlockLevel.clear();
+
+    int nRanks = counts.size();
+    for (int i = 0; i < nRanks; ++i)
+      {
+      UnpackAppend(gs, this->BlockOwner);
+      UnpackAppend(gs, this->BlockIds);
+      UnpackAppend(gs, this->NumBlocksLocal);
+      UnpackAppend(gs, this->BlockNumPoints);
+      UnpackAppend(gs, this->BlockNumCells);
+      UnpackAppend(gs, this->BlockCellArraySize);
+      UnpackAppend(gs, this->BlockExtents);
+      UnpackAppend(gs, this->BlockBounds);
+      UnpackAppend(gs, this->BlockArrayRange);
+      UnpackAppend(gs, this->BlockLevel);
+
+      gs.Unpack(blocksPerLevel);
+      unsigned int nLevels = std::min(blocksPerLevel.size(),
+        this->BlocksPerLevel.size());
+      for (unsigned int j = 0; j < nLevels; ++j)
+        this->BlocksPerLevel[j] += blocksPerLevel[j];
+      }
 
     STLUtils::ReduceRange(this->BlockBounds, this->Bounds);
     STLUtils::ReduceRange(this->BlockExtents, this->Extent);
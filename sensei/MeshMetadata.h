@@ -136,6 +136,34 @@ struct SENSEI_EXPORT MeshMetadata
   /// serialize/deserialize for communication and/or I/O
   int ToStream(ostream &str) const;
 
+  /** serialize for I/O omitting the block structure if it has not changed
+   * since previous was serialized, as indicated by Generation. a marker
+   * recording if the block structure was omitted is written first. previous
+   * may be null.
+   */
+  int ToStreamDelta(sensei::BinaryStream &str,
+    const sensei::MeshMetadataPtr &previous) const;
+
+  /** deserialize a stream written by ToStreamDelta. previous holds the
+   * metadata deserialized from the previous stream of the same mesh, the
+   * block structure is taken from it when it was omitted. previous may be
+   * null when the block structure is present. return 0 if successful.
+   */
+  int FromStreamDelta(sensei::BinaryStream &str,
+    const sensei::MeshMetadataPtr &previous);
+
+  /** return true if the block decomposition, block sizes, extents, bounds,
+   * and AMR levels of this and other are the same. the array metadata is not
+   * compared.
+   */
+  bool SameBlockStructure(const sensei::MeshMetadataPtr &other) const;
+
+  /** replace the block decomposition, block sizes, extents, bounds, and AMR
+   * levels, and the dataset level totals derived from them, with those of
+   * other.
+   */
+  int CopyBlockStructure(const sensei::MeshMetadataPtr &other);
+
   /** return true if the Flags match the arrays. will return false
    * if the a flag is set and a coresponding array is empty. an
    * error message will be printed naming the missing the array
@@ -151,10 +179,26 @@ struct SENSEI_EXPORT MeshMetadata
   int Validate(MPI_Comm comm,
     const sensei::MeshMetadataFlags &requiredFlags = 0xffffffffffffffff);
 
+  /// the supported methods of constructing the global view
+  enum {GLOBALIZE_FLAT=0, GLOBALIZE_HIERARCHICAL=1};
+
   /** construct a global view of the metadata. return 0 if successful.
+   * this call uses MPI collectives. the block level metadata of each rank is
+   * packed into a single buffer and the buffers are exchanged with one
+   * MPI_Allgather of the sizes and one MPI_Allgatherv. if the environment
+   * variable SENSEI_HIERARCHICAL_METADATA is set to a non-zero value
+   * GLOBALIZE_HIERARCHICAL is used.
+   */
+  int GlobalizeView(MPI_Comm comm);
+
+  /** construct a global view of the metadata using the given method. with
+   * GLOBALIZE_HIERARCHICAL the metadata is gathered to a leader rank on each
+   * node, the leaders exchange the metadata of their nodes, and the result is
+   * broadcast within each node. this reduces the number of ranks taking part
+   * in the global exchange at high concurrency. return 0 if successful.
    * this call uses MPI collectives
    */
-  int GlobalizeView(MPI_Comm);
+  int GlobalizeView(MPI_Comm comm, int method);
 
   /** removes all block level information from the instance. initialize
    * the related dataset level information.
@@ -199,6 +243,7 @@ struct SENSEI_EXPORT MeshMetadata
   int NumGhostNodes;                 ///< number of ghost node layers (all)
   int NumLevels;                     ///< number of AMR levels (AMR)
   int StaticMesh;                    ///< non zero if the mesh does not change in time (all)
+  unsigned long Generation;          ///< changes when the block structure changes, 0 if not tracked. see MeshMetadataCache
 
   std::vector<std::string> ArrayName; ///< name of each data array (all)
   std::vector<int> ArrayCentering;    ///< centering of each data array (all)
@@ -238,7 +283,7 @@ protected:
     NumBlocksLocal(), Extent(), Bounds(), CoordinateType(SVTK_DOUBLE),
     NumPoints(0), NumCells(0), CellArraySize(0), CellArrayType(SVTK_TYPE_INT64),
     NumArrays(0), NumGhostCells(0), NumGhostNodes(0), NumLevels(0),
-    StaticMesh(0), ArrayName(), ArrayCentering(), ArrayType(),
+    StaticMesh(0), Generation(0), ArrayName(), ArrayCentering(), ArrayType(),
     ArrayRange(),BlockOwner(), BlockIds(), BlockNumPoints(), BlockNumCells(),
     BlockCellArraySize(), BlockExtents(), BlockBounds(), BlockArrayRange(),
     RefRatio(), BlocksPerLevel(), BlockLevel(), PeriodicBoundary(), Flags()
@@ -0,0 +1,97 @@
+#include "MeshMetadataCache.h"
+#include "BinaryStream.h"
+#include "MPIUtils.h"
+#include "STLUtils.h"
+#include "Profiler.h"
+#include "Error.h"
+
+#include <vector>
+#include <cstring>
+
+namespace sensei
+{
+
+// --------------------------------------------------------------------------
+int MeshMetadataCache::GlobalizeView(MPI_Comm comm, const MeshMetadataPtr &md)
+{
+  TimeEvent<128> mark("MeshMetadataCache::GlobalizeView");
+
+  if (md->GlobalView)
+    return 0;
+
+  CacheEntry &entry = this->Entries[md->MeshName];
+
+  // all ranks have a cached view of the mesh, or none do
+  if (entry.Local)
+    {
+    int changed = md->StaticMesh ? 0 : !md->SameBlockStructure(entry.Local);
+
+    // exchange the changed flags along with the block array ranges, which
+    // are needed in any case
+    BinaryStream ls;
+    ls.Pack(changed);
+    ls.Pack(md->BlockArrayRange);
+
+    std::vector<unsigned char> ldata(ls.GetData(), ls.GetData() + ls.Size());
+    std::vector<unsigned char> gdata;
+    std::vector<int> counts, offsets;
+
+    MPIUtils::GlobalViewV(comm, ldata, counts, offsets, gdata);
+
+    BinaryStream gs;
+    gs.Resize(gdata.size());
+    memcpy(gs.GetData(), gdata.data(), gdata.size());
+    gs.SetWritePos(gdata.size());
+    gs.SetReadPos(0);
+
+    int anyChanged = 0;
+    std::vector<std::vector<std::array<double,2>>> blockArrayRange;
+
+    int nRanks = counts.size();
+    for (int i = 0; i < nRanks; ++i)
+      {
+      int rankChanged = 0;
+      gs.Unpack(rankChanged);
+      anyChanged |= rankChanged;
+
+      std::vector<std::vector<std::array<double,2>>> rankRange;
+      gs.Unpack(rankRange);
+      blockArrayRange.insert(blockArrayRange.end(),
+        rankRange.begin(), rankRange.end());
+      }
+
+    if (!anyChanged)
+      {
+      md->CopyBlockStructure(entry.Global);
+      md->BlockArrayRange.swap(blockArrayRange);
+      STLUtils::ReduceRange(md->BlockArrayRange, md->ArrayRange);
+      md->Generation = entry.Generation;
+      md->GlobalView = true;
+      return 0;
+      }
+    }
+
+  // the block structure is new or changed
+  entry.Local = md->NewCopy();
+
+  if (md->GlobalizeView(comm))
+    {
+    SENSEI_ERROR("Failed to globalize the metadata of mesh \""
+      << md->MeshName << "\"")
+    return -1;
+    }
+
+  entry.Generation += 1;
+  md->Generation = entry.Generation;
+  entry.Global = md->NewCopy();
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void MeshMetadataCache::Clear()
+{
+  this->Entries.clear();
+}
+
+}
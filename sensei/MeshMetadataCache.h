@@ -0,0 +1,57 @@
+#ifndef MeshMetadataCache_h
+#define MeshMetadataCache_h
+
+#include "MeshMetadata.h"
+
+#include <mpi.h>
+#include <map>
+#include <string>
+
+namespace sensei
+{
+
+/// Caches the global view of mesh metadata across time steps
+/** When the block structure of a mesh, its decomposition, block sizes,
+ * extents, bounds, and AMR levels, is the same as the last time the mesh was
+ * seen, the cached global view of the block structure is reused and only the
+ * block array ranges are exchanged. The change is detected by comparing the
+ * local view to the one cached, unless the mesh is flagged as static by
+ * MeshMetadata::StaticMesh in which case the comparison is skipped. The ranks
+ * agree on the outcome in the same collective that exchanges the array
+ * ranges. A full MeshMetadata::GlobalizeView is made when the structure
+ * changes on any rank.
+ *
+ * The cache numbers each version of a mesh's block structure, starting at 1,
+ * in MeshMetadata::Generation. I/O back ends can compare generations to
+ * skip writing an unchanged block structure, see
+ * MeshMetadata::ToStreamDelta.
+ */
+class SENSEI_EXPORT MeshMetadataCache
+{
+public:
+  /** construct a global view of the metadata, reusing the cached view of the
+   * block structure when possible, and set the metadata's Generation. this
+   * call uses MPI collectives. return 0 if successful.
+   */
+  int GlobalizeView(MPI_Comm comm, const MeshMetadataPtr &md);
+
+  /// removes all cached metadata
+  void Clear();
+
+private:
+  struct CacheEntry
+  {
+    CacheEntry() : Generation(0) {}
+
+    unsigned long Generation;
+    MeshMetadataPtr Local;
+    MeshMetadataPtr Global;
+  };
+
+  // the cached metadata of each mesh
+  std::map<std::string, CacheEntry> Entries;
+};
+
+}
+
+#endif
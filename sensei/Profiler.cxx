@@ -3,55 +3,144 @@
 #include "Error.h"
 
 #include <sys/time.h>
+#include <time.h>
 #include <fstream>
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
 #include <stdint.h>
 #include <strings.h>
-#include <cstdlib>
-#include <cstdlib>
 #include <cstdio>
+#include <cctype>
 
 #include <map>
-#include <list>
 #include <vector>
 #include <iomanip>
 #include <limits>
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 namespace impl
 {
 #if defined(ENABLE_PROFILER)
 
-// container for data captured in a timing Event
+// a completed timing event. the name is an index into the table of interned
+// names and the times are nanoseconds on the monotonic clock
 struct Event
 {
-  Event();
+  uint32_t Name;
+  int32_t Depth;
+  long long NumBytes;
+  uint64_t Time[2];
 
-  // serializes the Event in CSV format into the stream.
-  void ToStream(std::ostream &str) const;
+  enum { START=0, END=1 }; // record fields
+};
 
-  enum { START=0, END=1, DELTA=2 }; // record fields
+// an event that has been started but not yet ended
+struct ActiveEvent
+{
+  uint32_t Name;
+  long long NumBytes;
+  uint64_t Start;
+};
 
-  // user provided identifier for the record
-  std::string Name;
+// an event as it is written in the binary log
+struct DiskEvent
+{
+  uint32_t Name;
+  uint32_t Thread;
+  uint64_t Time[2];
+  int64_t NumBytes;
+  int32_t Depth;
+  int32_t Pad;
+};
 
-  // Event duration, initially start Time, end Time and duration
-  // are recorded. when summarizing this contains min,max and sum
-  // of the summariezed set of events
-  double Time[3];
+// the binary log is made of one chunk per rank and per flush. each chunk
+// starts with this header, followed by the thread id table, the name table,
+// and the events. strings are stored as a 32 bit length and the characters.
+struct DiskHeader
+{
+  char Magic[8];
+  int32_t Rank;
+  uint32_t NumThreads;
+  uint32_t NumNames;
+  uint32_t Pad;
+  uint64_t NumEvents;
+  double EpochOffset;
+};
 
-  // the number of bytes, if this is an I/O or datamovement operation
-  // else -1
-  long long NumBytes;
+static const char diskMagic[8] = {'S','N','S','P','R','O','F','1'};
+
+// the number of bins in the duration histograms. bin k counts durations of
+// 2^k to 2^(k+1) nanoseconds, the last bin counts everything longer
+static const int numBins = 48;
+
+// running statistics of the events of one name. times are in nanoseconds
+struct EventStats
+{
+  EventStats() : Count(0), Total(0),
+    Min(std::numeric_limits<uint64_t>::max()), Max(0), Bytes(0), Hist{0} {}
+
+  void Update(uint64_t dt, long long nBytes);
+  void Update(const EventStats &other);
+
+  uint64_t Count;
+  uint64_t Total;
+  uint64_t Min;
+  uint64_t Max;
+  long long Bytes;
+  uint64_t Hist[numBins];
+};
+
+// --------------------------------------------------------------------------
+void EventStats::Update(uint64_t dt, long long nBytes)
+{
+  int bin = dt ? 63 - __builtin_clzll(dt) : 0;
+
+  this->Count += 1;
+  this->Total += dt;
+  this->Min = std::min(this->Min, dt);
+  this->Max = std::max(this->Max, dt);
+  this->Bytes += nBytes > 0 ? nBytes : 0;
+  this->Hist[std::min(bin, numBins - 1)] += 1;
+}
+
+// --------------------------------------------------------------------------
+void EventStats::Update(const EventStats &other)
+{
+  this->Count += other.Count;
+  this->Total += other.Total;
+  this->Min = std::min(this->Min, other.Min);
+  this->Max = std::max(this->Max, other.Max);
+  this->Bytes += other.Bytes;
+  for (int i = 0; i < numBins; ++i)
+    this->Hist[i] += other.Hist[i];
+}
+
+// the events of one thread. only the owning thread writes to the log, other
+// threads read it when the logs are merged in Flush and Finalize. the events
+// are stored in a ring buffer that is allocated when the thread first logs
+// an event. when it is full the oldest events are overwritten.
+struct ThreadLog
+{
+  ThreadLog() : Index(0), Count(0) {}
+
+  uint32_t Index;
+  std::string Tid;
+  std::vector<Event> Events;
+  std::atomic<uint64_t> Count;
+  std::vector<ActiveEvent> Active;
 
-  // how deep is the Event stack
-  int Depth;
+  // the statistics of the events, indexed by name id
+  std::vector<EventStats> Stats;
 
-  // the thread id that generated the Event
-  std::thread::id Tid;
+  // the thread's view of the interned names, keyed by the hash of the name.
+  // lookups that hit here take no locks.
+  std::unordered_map<uint64_t,
+    std::vector<std::pair<std::string, uint32_t>>> Names;
 };
 
 #if !defined(SENSEI_HAS_MPI)
@@ -59,55 +148,509 @@ using MPI_Comm = void*;
 #define MPI_COMM_NULL nullptr
 #endif
 static MPI_Comm comm = MPI_COMM_NULL;
+static int rank = 0;
 
-static int loggingEnabled = 0x00;
+// set between Initialize and Finalize
+static bool initialized = false;
+
+static std::atomic<int> loggingEnabled(0x00);
+
+static int logFormat = sensei::Profiler::FORMAT_CSV;
 
 static std::string timerLogFile = "timer.csv";
+static std::string summaryLogFile = "timer_summary.csv";
+
+// the ranks that write full traces, and whether this is one of them
+static std::string traceRanks = "all";
+static bool traceRank = true;
 
-using eventLogType = std::list<impl::Event>;
-using threadMapType = std::unordered_map<std::thread::id, eventLogType>;
+// the number of events each thread's ring buffer holds
+static long bufferSize = 65536;
 
-static eventLogType eventLog;
-static threadMapType activeEvents;
-static std::mutex eventLogMutex;
+// all of the thread logs, and all of the interned names. these are locked
+// only when a thread logs its first event or a name it has not seen before
+static std::vector<std::shared_ptr<ThreadLog>> threadLogs;
+static std::vector<std::string> eventNames;
+static std::unordered_map<std::string, uint32_t> eventNameIds;
+static std::mutex registryMutex;
+
+static thread_local ThreadLog *threadLog = nullptr;
 
 // memory profiler
 static sensei::MemoryProfiler memProf;
 
-// return high res system Time relative to system epoch
-static double getSystemTime()
+// return the monotonic clock in nanoseconds
+static uint64_t getSystemTime()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec)*1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+// return the offset in seconds from the monotonic clock to the system epoch,
+// such that logged times are comparable across nodes
+static double getEpochOffset()
 {
   struct timeval tv;
   gettimeofday(&tv, nullptr);
-  return tv.tv_sec + tv.tv_usec/1.0e6;
+  uint64_t mono = getSystemTime();
+  return tv.tv_sec + tv.tv_usec/1.0e6 - mono/1.0e9;
 }
 
+static double epochOffset = getEpochOffset();
+
 
 // --------------------------------------------------------------------------
-Event::Event() : Time{0,0,0}, NumBytes(-1ll), Depth(0),
-  Tid(std::this_thread::get_id())
+static ThreadLog *getThreadLog()
 {
+  if (!threadLog)
+    {
+    std::shared_ptr<ThreadLog> log = std::make_shared<ThreadLog>();
+
+    std::ostringstream oss;
+    oss << std::this_thread::get_id();
+    log->Tid = oss.str();
+    log->Active.reserve(64);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    log->Index = threadLogs.size();
+    threadLogs.push_back(log);
+    threadLog = log.get();
+    }
+  return threadLog;
 }
 
-//-----------------------------------------------------------------------------
-void Event::ToStream(std::ostream &str) const
+// --------------------------------------------------------------------------
+static uint32_t internName(ThreadLog *log, const char *name)
+{
+  // FNV-1a
+  uint64_t h = 14695981039346656037ull;
+  for (const char *c = name; *c; ++c)
+    h = (h ^ uint64_t((unsigned char)*c))*1099511628211ull;
+
+  std::vector<std::pair<std::string, uint32_t>> &ids = log->Names[h];
+
+  size_t n = ids.size();
+  for (size_t i = 0; i < n; ++i)
+    {
+    if (ids[i].first == name)
+      return ids[i].second;
+    }
+
+  uint32_t id = 0;
+    {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::unordered_map<std::string, uint32_t>::iterator it =
+      eventNameIds.find(name);
+    if (it == eventNameIds.end())
+      {
+      id = eventNames.size();
+      eventNames.push_back(name);
+      eventNameIds[name] = id;
+      }
+    else
+      {
+      id = it->second;
+      }
+    }
+
+  ids.push_back(std::make_pair(std::string(name), id));
+  return id;
+}
+
+// an event as merged from the thread logs
+struct MergedEvent
+{
+  const Event *Evt;
+  const ThreadLog *Log;
+};
+
+// --------------------------------------------------------------------------
+static void mergeThreadLogs(std::vector<MergedEvent> &events)
+{
+  // not locking the logs as this is intended to be accessed only from the
+  // main thread, and all other threads are required to be finished by now
+  uint64_t nDropped = 0;
+  size_t nLogs = threadLogs.size();
+  for (size_t i = 0; i < nLogs; ++i)
+    {
+    const ThreadLog *log = threadLogs[i].get();
+    uint64_t nEvents = log->Count.load(std::memory_order_acquire);
+    uint64_t nBuf = log->Events.size();
+    uint64_t n = std::min(nEvents, nBuf);
+    nDropped += nEvents - n;
+    for (uint64_t j = nEvents - n; j < nEvents; ++j)
+      events.push_back(MergedEvent{&log->Events[j % nBuf], log});
+    }
+
+  if (nDropped)
+    {
+    SENSEI_WARNING("The profiler ring buffers overflowed and the oldest "
+      << nDropped << " events were overwritten. Increase the buffer size "
+      "with PROFILER_BUFFER_SIZE or flush more often.")
+    }
+
+  // order by end time as the events are in each thread
+  std::stable_sort(events.begin(), events.end(),
+    [](const MergedEvent &l, const MergedEvent &r) -> bool
+    { return l.Evt->Time[Event::END] < r.Evt->Time[Event::END]; });
+}
+
+// --------------------------------------------------------------------------
+// discard the logged events. the per name statistics are kept, they cover
+// the whole run
+static void clearThreadLogs()
+{
+  size_t nLogs = threadLogs.size();
+  for (size_t i = 0; i < nLogs; ++i)
+    threadLogs[i]->Count.store(0, std::memory_order_release);
+}
+
+// --------------------------------------------------------------------------
+static void clearThreadStats()
+{
+  size_t nLogs = threadLogs.size();
+  for (size_t i = 0; i < nLogs; ++i)
+    threadLogs[i]->Stats.clear();
+}
+
+// --------------------------------------------------------------------------
+static int parseRanks(const std::string &ranks,
+  std::vector<std::pair<int,int>> &ranges)
+{
+  // one of all, none, or a comma separated list of ranks and ranges
+  ranges.clear();
+
+  if (ranks == "all")
+    {
+    ranges.push_back(std::make_pair(0, std::numeric_limits<int>::max()));
+    return 0;
+    }
+
+  if (ranks == "none")
+    return 0;
+
+  std::istringstream iss(ranks);
+  std::string range;
+  while (std::getline(iss, range, ','))
+    {
+    int first = 0;
+    int last = 0;
+    char extra = 0;
+    int n = sscanf(range.c_str(), " %d - %d %c", &first, &last, &extra);
+    if (n == 1)
+      last = first;
+    else if ((n != 2) || (first > last) || (first < 0))
+      return -1;
+    ranges.push_back(std::make_pair(first, last));
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+static void packNames(const std::vector<std::string> &names, std::string &buf)
+{
+  buf.clear();
+  size_t n = names.size();
+  for (size_t i = 0; i < n; ++i)
+    {
+    buf.append(names[i]);
+    buf.push_back('\0');
+    }
+}
+
+// --------------------------------------------------------------------------
+static void unpackNames(const char *buf, size_t n, std::map<std::string, int> &names)
+{
+  const char *end = buf + n;
+  while (buf < end)
+    {
+    std::string name(buf);
+    buf += name.size() + 1;
+    names[name] = 0;
+    }
+}
+
+// --------------------------------------------------------------------------
+static void getGlobalNames(MPI_Comm comm, std::vector<std::string> &names)
 {
-#if defined(ENABLE_PROFILER)
   int rank = 0;
-#if defined(SENSEI_HAS_MPI)
-  int ini = 0, fin = 0;
-  MPI_Initialized(&ini);
-  MPI_Finalized(&fin);
-  if (ini && !fin)
-    MPI_Comm_rank(impl::comm, &rank);
-#endif
-  str << rank << ", " << this->Tid << ", \"" << this->Name << "\", "
-    << this->Time[START] << ", " << this->Time[END] << ", "
-    << this->Time[DELTA] << ", " << this->NumBytes  << ", "
-    << this->Depth << std::endl;
-#else
-  (void)str;
-#endif
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  std::map<std::string, int> all;
+  size_t nNames = names.size();
+  for (size_t i = 0; i < nNames; ++i)
+    all[names[i]] = 0;
+
+  // merge the names up a binary tree, the messages stay the size of the set
+  // of distinct names no matter how many ranks there are
+  std::string buf;
+  for (int s = 1; s < nRanks; s *= 2)
+    {
+    if (rank % (2*s) == s)
+      {
+      names.clear();
+      for (auto &it : all)
+        names.push_back(it.first);
+      packNames(names, buf);
+      MPI_Send(buf.data(), buf.size(), MPI_CHAR, rank - s, 0, comm);
+      break;
+      }
+    else if ((rank % (2*s) == 0) && (rank + s < nRanks))
+      {
+      MPI_Status stat;
+      MPI_Probe(rank + s, 0, comm, &stat);
+      int n = 0;
+      MPI_Get_count(&stat, MPI_CHAR, &n);
+      std::vector<char> rbuf(n);
+      MPI_Recv(rbuf.data(), n, MPI_CHAR, rank + s, 0, comm, MPI_STATUS_IGNORE);
+      unpackNames(rbuf.data(), n, all);
+      }
+    }
+
+  // share the result with everyone
+  if (rank == 0)
+    {
+    names.clear();
+    for (auto &it : all)
+      names.push_back(it.first);
+    packNames(names, buf);
+    }
+
+  unsigned long n = buf.size();
+  MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, 0, comm);
+  buf.resize(n);
+  MPI_Bcast(&buf[0], n, MPI_CHAR, 0, comm);
+
+  if (rank != 0)
+    {
+    all.clear();
+    unpackNames(buf.data(), n, all);
+    names.clear();
+    for (auto &it : all)
+      names.push_back(it.first);
+    }
+}
+
+// --------------------------------------------------------------------------
+static void toSummary(bool haveMpi, std::string &summary)
+{
+  // combine the statistics of the threads
+  std::vector<EventStats> local(eventNames.size());
+  size_t nLogs = threadLogs.size();
+  for (size_t i = 0; i < nLogs; ++i)
+    {
+    const std::vector<EventStats> &stats = threadLogs[i]->Stats;
+    size_t nStats = stats.size();
+    for (size_t j = 0; j < nStats; ++j)
+      local[j].Update(stats[j]);
+    }
+
+  // the set of names logged on any rank
+  std::vector<std::string> names;
+  size_t nLocal = local.size();
+  for (size_t i = 0; i < nLocal; ++i)
+    {
+    if (local[i].Count)
+      names.push_back(eventNames[i]);
+    }
+
+  int nRanks = 1;
+  if (haveMpi)
+    {
+    MPI_Comm_size(comm, &nRanks);
+    getGlobalNames(comm, names);
+    }
+
+  // lay out the statistics in the order of the global names
+  int nNames = names.size();
+
+  std::vector<double> sums(4*nNames, 0.0);
+  std::vector<double> mins(nNames, std::numeric_limits<double>::max());
+  std::vector<double> maxs(nNames, 0.0);
+
+  struct rankTime { double Time; int Rank; };
+  std::vector<rankTime> minRank(nNames, {std::numeric_limits<double>::max(), rank});
+  std::vector<rankTime> maxRank(nNames, {-1.0, rank});
+
+  std::vector<unsigned long long> hist(numBins*nNames, 0);
+
+  for (int i = 0; i < nNames; ++i)
+    {
+    std::unordered_map<std::string, uint32_t>::iterator it =
+      eventNameIds.find(names[i]);
+
+    if ((it == eventNameIds.end()) || !local[it->second].Count)
+      continue;
+
+    const EventStats &stats = local[it->second];
+
+    double total = stats.Total/1.0e9;
+
+    sums[4*i] = stats.Count;
+    sums[4*i + 1] = total;
+    sums[4*i + 2] = stats.Bytes;
+    sums[4*i + 3] = 1.0;
+
+    mins[i] = stats.Min/1.0e9;
+    maxs[i] = stats.Max/1.0e9;
+
+    minRank[i].Time = total;
+    maxRank[i].Time = total;
+
+    for (int j = 0; j < numBins; ++j)
+      hist[numBins*i + j] = stats.Hist[j];
+    }
+
+  // reduce across ranks
+  if (haveMpi && (nRanks > 1))
+    {
+    void *sbuf = rank == 0 ? MPI_IN_PLACE : sums.data();
+    MPI_Reduce(sbuf, sums.data(), sums.size(), MPI_DOUBLE, MPI_SUM, 0, comm);
+
+    sbuf = rank == 0 ? MPI_IN_PLACE : mins.data();
+    MPI_Reduce(sbuf, mins.data(), nNames, MPI_DOUBLE, MPI_MIN, 0, comm);
+
+    sbuf = rank == 0 ? MPI_IN_PLACE : maxs.data();
+    MPI_Reduce(sbuf, maxs.data(), nNames, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    sbuf = rank == 0 ? MPI_IN_PLACE : minRank.data();
+    MPI_Reduce(sbuf, minRank.data(), nNames, MPI_DOUBLE_INT, MPI_MINLOC, 0, comm);
+
+    sbuf = rank == 0 ? MPI_IN_PLACE : maxRank.data();
+    MPI_Reduce(sbuf, maxRank.data(), nNames, MPI_DOUBLE_INT, MPI_MAXLOC, 0, comm);
+
+    sbuf = rank == 0 ? MPI_IN_PLACE : hist.data();
+    MPI_Reduce(sbuf, hist.data(), hist.size(), MPI_UNSIGNED_LONG_LONG,
+      MPI_SUM, 0, comm);
+    }
+
+  if (rank != 0)
+    return;
+
+  // report the events with the longest time on any rank first
+  std::vector<int> order(nNames);
+  for (int i = 0; i < nNames; ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+    [&maxRank](int l, int r) -> bool
+    { return maxRank[l].Time > maxRank[r].Time; });
+
+  std::ostringstream oss;
+  oss.precision(std::numeric_limits<double>::digits10 + 2);
+  oss.setf(std::ios::scientific, std::ios::floatfield);
+
+  oss << "# " << nRanks << " ranks. Times are in seconds. The rank times are"
+    " the sum of the durations on each rank that logged the event. Bin k of"
+    " the histogram counts durations of 2^k to 2^(k+1) nanoseconds" << std::endl
+    << "# Name, count, ranks, total Time, mean Time, min Time, max Time,"
+    " min rank Time, min rank, mean rank Time, max rank Time, max rank,"
+    " imbalance, bytes";
+  for (int j = 0; j < numBins; ++j)
+    oss << ", bin " << j;
+  oss << std::endl;
+
+  for (int k = 0; k < nNames; ++k)
+    {
+    int i = order[k];
+
+    double count = sums[4*i];
+    double total = sums[4*i + 1];
+    double nEvtRanks = sums[4*i + 3];
+    double meanRank = total/nEvtRanks;
+
+    oss << "\"" << names[i] << "\", " << (long long)count << ", "
+      << (long long)nEvtRanks << ", " << total << ", " << total/count << ", "
+      << mins[i] << ", " << maxs[i] << ", " << minRank[i].Time << ", "
+      << minRank[i].Rank << ", " << meanRank << ", " << maxRank[i].Time << ", "
+      << maxRank[i].Rank << ", " << (meanRank > 0.0 ? maxRank[i].Time/meanRank : 1.0)
+      << ", " << (long long)sums[4*i + 2];
+
+    for (int j = 0; j < numBins; ++j)
+      oss << ", " << hist[numBins*i + j];
+
+    oss << std::endl;
+    }
+
+  summary = oss.str();
+}
+
+// --------------------------------------------------------------------------
+static void eventToStream(std::ostream &str, int rank, const std::string &tid,
+  const std::string &name, const uint64_t time[2], long long nBytes,
+  int depth, double offset)
+{
+  // times are written in seconds since the epoch
+  str << rank << ", " << tid << ", \"" << name << "\", "
+    << offset + time[Event::START]/1.0e9 << ", "
+    << offset + time[Event::END]/1.0e9 << ", "
+    << (time[Event::END] - time[Event::START])/1.0e9 << ", "
+    << nBytes << ", " << depth << std::endl;
+}
+
+// --------------------------------------------------------------------------
+static void writeString(std::string &buf, const std::string &str)
+{
+  uint32_t len = str.size();
+  buf.append(reinterpret_cast<const char*>(&len), sizeof(len));
+  buf.append(str);
+}
+
+// --------------------------------------------------------------------------
+static int readString(std::istream &is, std::string &str)
+{
+  uint32_t len = 0;
+  if (!is.read(reinterpret_cast<char*>(&len), sizeof(len)))
+    return -1;
+  str.resize(len);
+  if (len && !is.read(&str[0], len))
+    return -1;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+static void toBinary(std::string &buf)
+{
+  std::vector<MergedEvent> events;
+  mergeThreadLogs(events);
+
+  DiskHeader hdr;
+  memcpy(hdr.Magic, diskMagic, sizeof(diskMagic));
+  hdr.Rank = rank;
+  hdr.NumThreads = threadLogs.size();
+  hdr.NumNames = eventNames.size();
+  hdr.Pad = 0;
+  hdr.NumEvents = events.size();
+  hdr.EpochOffset = epochOffset;
+
+  buf.append(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+
+  for (uint32_t i = 0; i < hdr.NumThreads; ++i)
+    writeString(buf, threadLogs[i]->Tid);
+
+  for (uint32_t i = 0; i < hdr.NumNames; ++i)
+    writeString(buf, eventNames[i]);
+
+  size_t pos = buf.size();
+  buf.resize(pos + hdr.NumEvents*sizeof(DiskEvent));
+  DiskEvent *devts = reinterpret_cast<DiskEvent*>(&buf[pos]);
+
+  for (uint64_t i = 0; i < hdr.NumEvents; ++i)
+    {
+    const Event *evt = events[i].Evt;
+    DiskEvent &devt = devts[i];
+    devt.Name = evt->Name;
+    devt.Thread = events[i].Log->Index;
+    devt.Time[Event::START] = evt->Time[Event::START];
+    devt.Time[Event::END] = evt->Time[Event::END];
+    devt.NumBytes = evt->NumBytes;
+    devt.Depth = evt->Depth;
+    devt.Pad = 0;
+    }
 }
 #endif
 }
@@ -145,6 +688,76 @@ void Profiler::SetTimerLogFile(const std::string &file)
 #endif
 }
 
+// ----------------------------------------------------------------------------
+void Profiler::SetSummaryLogFile(const std::string &file)
+{
+#if defined(ENABLE_PROFILER)
+  impl::summaryLogFile = file;
+#else
+  (void)file;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+int Profiler::SetTraceRanks(const std::string &ranks)
+{
+#if defined(ENABLE_PROFILER)
+  std::vector<std::pair<int,int>> ranges;
+  if (impl::parseRanks(ranks, ranges))
+    {
+    SENSEI_ERROR("Invalid trace ranks \"" << ranks << "\". Use one of "
+      "\"all\", \"none\", or a comma separated list of ranks and ranges")
+    return -1;
+    }
+  impl::traceRanks = ranks;
+#else
+  (void)ranks;
+#endif
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+int Profiler::SetLogFormat(int format)
+{
+#if defined(ENABLE_PROFILER)
+  if ((format != FORMAT_CSV) && (format != FORMAT_BINARY))
+    {
+    SENSEI_ERROR("Invalid log format " << format)
+    return -1;
+    }
+  impl::logFormat = format;
+#else
+  (void)format;
+#endif
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+int Profiler::SetLogFormat(const std::string &format)
+{
+  std::string fmt = format;
+  std::transform(fmt.begin(), fmt.end(), fmt.begin(), ::tolower);
+
+  if (fmt == "csv")
+    return Profiler::SetLogFormat(FORMAT_CSV);
+  else if (fmt == "binary")
+    return Profiler::SetLogFormat(FORMAT_BINARY);
+
+  SENSEI_ERROR("Invalid log format \"" << format << "\". Use one of "
+    "\"csv\" or \"binary\"")
+  return -1;
+}
+
+// ----------------------------------------------------------------------------
+void Profiler::SetBufferSize(long nEvents)
+{
+#if defined(ENABLE_PROFILER)
+  impl::bufferSize = nEvents;
+#else
+  (void)nEvents;
+#endif
+}
+
 // ----------------------------------------------------------------------------
 void Profiler::SetMemProfLogFile(const std::string &file)
 {
@@ -170,22 +783,27 @@ int Profiler::Validate()
 {
   int ierr = 0;
 #if defined(ENABLE_PROFILER)
-  if (impl::loggingEnabled & 0x01)
+  if (impl::loggingEnabled & 0x05)
     {
 #if !defined(NDEBUG)
-    impl::threadMapType::iterator tmit = impl::activeEvents.begin();
-    impl::threadMapType::iterator tmend = impl::activeEvents.end();
-    for (; tmit != tmend; ++tmit)
+    uint64_t now = impl::getSystemTime();
+    size_t nLogs = impl::threadLogs.size();
+    for (size_t i = 0; i < nLogs; ++i)
       {
-      unsigned int nLeft = tmit->second.size();
+      const impl::ThreadLog *log = impl::threadLogs[i].get();
+      unsigned int nLeft = log->Active.size();
       if (nLeft > 0)
         {
         std::ostringstream oss;
-        impl::eventLogType::iterator it = tmit->second.begin();
-        impl::eventLogType::iterator end = tmit->second.end();
-        for (; it != end; ++it)
-          it->ToStream(oss);
-        SENSEI_ERROR("Thread " << tmit->first << " has " << nLeft
+        for (unsigned int j = 0; j < nLeft; ++j)
+          {
+          const impl::ActiveEvent &evt = log->Active[j];
+          uint64_t time[2] = {evt.Start, now};
+          impl::eventToStream(oss, impl::rank, log->Tid,
+            impl::eventNames[evt.Name], time, evt.NumBytes, j,
+            impl::epochOffset);
+          }
+        SENSEI_ERROR("Thread " << log->Tid << " has " << nLeft
           << " unmatched active events. " << std::endl
           << oss.str())
         ierr += 1;
@@ -207,13 +825,17 @@ int Profiler::ToStream(std::ostream &os)
     os.precision(std::numeric_limits<double>::digits10 + 2);
     os.setf(std::ios::scientific, std::ios::floatfield);
 
-    // not locking this as it's intended to be accessed only from the main
-    // thread, and all other threads are required to be finished by now
-    impl::eventLogType::iterator iter = impl::eventLog.begin();
-    impl::eventLogType::iterator end = impl::eventLog.end();
+    std::vector<impl::MergedEvent> events;
+    impl::mergeThreadLogs(events);
 
-    for (; iter != end; ++iter)
-      iter->ToStream(os);
+    size_t nEvents = events.size();
+    for (size_t i = 0; i < nEvents; ++i)
+      {
+      const impl::Event *evt = events[i].Evt;
+      impl::eventToStream(os, impl::rank, events[i].Log->Tid,
+        impl::eventNames[evt->Name], evt->Time, evt->NumBytes,
+        evt->Depth, impl::epochOffset);
+      }
     }
 #else
   (void)os;
@@ -221,12 +843,85 @@ int Profiler::ToStream(std::ostream &os)
   return 0;
 }
 
+// ----------------------------------------------------------------------------
+int Profiler::BinaryToCSV(const std::string &fileName, std::ostream &os)
+{
+#if defined(ENABLE_PROFILER)
+  std::ifstream is(fileName, std::ios::binary);
+  if (!is.good())
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\"")
+    return -1;
+    }
+
+  os.precision(std::numeric_limits<double>::digits10 + 2);
+  os.setf(std::ios::scientific, std::ios::floatfield);
+
+  os << "# rank, thread, Name, start Time, end Time, delta, bytes, Depth" << std::endl;
+
+  // the file holds a chunk per rank and per flush
+  impl::DiskHeader hdr;
+  while (is.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)))
+    {
+    if (memcmp(hdr.Magic, impl::diskMagic, sizeof(impl::diskMagic)) != 0)
+      {
+      SENSEI_ERROR("\"" << fileName << "\" is not a binary profiler log")
+      return -1;
+      }
+
+    std::vector<std::string> tids(hdr.NumThreads);
+    for (uint32_t i = 0; i < hdr.NumThreads; ++i)
+      {
+      if (impl::readString(is, tids[i]))
+        {
+        SENSEI_ERROR("Failed to read the thread table from \""
+          << fileName << "\"")
+        return -1;
+        }
+      }
+
+    std::vector<std::string> names(hdr.NumNames);
+    for (uint32_t i = 0; i < hdr.NumNames; ++i)
+      {
+      if (impl::readString(is, names[i]))
+        {
+        SENSEI_ERROR("Failed to read the name table from \""
+          << fileName << "\"")
+        return -1;
+        }
+      }
+
+    impl::DiskEvent evt;
+    for (uint64_t i = 0; i < hdr.NumEvents; ++i)
+      {
+      if (!is.read(reinterpret_cast<char*>(&evt), sizeof(evt)) ||
+        (evt.Name >= hdr.NumNames) || (evt.Thread >= hdr.NumThreads))
+        {
+        SENSEI_ERROR("Failed to read event " << i << " of " << hdr.NumEvents
+          << " on rank " << hdr.Rank << " from \"" << fileName << "\"")
+        return -1;
+        }
+
+      impl::eventToStream(os, hdr.Rank, tids[evt.Thread], names[evt.Name],
+        evt.Time, evt.NumBytes, evt.Depth, hdr.EpochOffset);
+      }
+    }
+
+  return 0;
+#else
+  (void)fileName;
+  (void)os;
+  SENSEI_ERROR("The profiler was not enabled at compile time")
+  return -1;
+#endif
+}
+
 // ----------------------------------------------------------------------------
 int Profiler::Initialize()
 {
 #if defined(ENABLE_PROFILER)
 
-  int rank = 0;
+  impl::rank = 0;
 #if defined(SENSEI_HAS_MPI)
   int ok = 0;
   MPI_Initialized(&ok);
@@ -238,7 +933,7 @@ int Profiler::Initialize()
 
     impl::memProf.SetCommunicator(impl::comm);
 
-    MPI_Comm_rank(impl::comm, &rank);
+    MPI_Comm_rank(impl::comm, &impl::rank);
     }
 #endif
 
@@ -250,6 +945,28 @@ int Profiler::Initialize()
   if ((tmp = getenv("PROFILER_LOG_FILE")))
     impl::timerLogFile = tmp;
 
+  if ((tmp = getenv("PROFILER_LOG_FORMAT")))
+    Profiler::SetLogFormat(tmp);
+
+  if ((tmp = getenv("PROFILER_BUFFER_SIZE")))
+    impl::bufferSize = atol(tmp);
+
+  if ((tmp = getenv("PROFILER_SUMMARY_FILE")))
+    impl::summaryLogFile = tmp;
+
+  if ((tmp = getenv("PROFILER_TRACE_RANKS")))
+    Profiler::SetTraceRanks(tmp);
+
+  // only the selected ranks keep full traces
+  std::vector<std::pair<int,int>> ranges;
+  impl::parseRanks(impl::traceRanks, ranges);
+  impl::traceRank = false;
+  for (size_t i = 0; i < ranges.size(); ++i)
+    {
+    if ((impl::rank >= ranges[i].first) && (impl::rank <= ranges[i].second))
+      impl::traceRank = true;
+    }
+
   if ((tmp = getenv("MEMPROF_LOG_FILE")))
     impl::memProf.SetFilename(tmp);
 
@@ -260,14 +977,21 @@ int Profiler::Initialize()
     impl::memProf.Initialize();
 
   // report what options are in use
-  if ((rank == 0) && impl::loggingEnabled)
+  if ((impl::rank == 0) && impl::loggingEnabled)
     std::cerr << "Profiler configured with Event logging "
       << (impl::loggingEnabled & 0x01 ? "enabled" : "disabled")
       << " and memory logging " << (impl::loggingEnabled & 0x02 ? "enabled" : "disabled")
-      << ", timer log file \"" << impl::timerLogFile
-      << "\", memory profiler log file \"" << impl::memProf.GetFilename()
+      << ", timer log file \"" << impl::timerLogFile << "\" in "
+      << (impl::logFormat == FORMAT_BINARY ? "binary" : "CSV")
+      << " format, " << impl::bufferSize << " events per thread, trace ranks "
+      << impl::traceRanks << ", summary "
+      << (impl::loggingEnabled & 0x04 ? "enabled" : "disabled")
+      << ", summary log file \"" << impl::summaryLogFile << "\""
+      << ", memory profiler log file \"" << impl::memProf.GetFilename()
       << "\", sampling interval " << impl::memProf.GetInterval()
       << " seconds" << std::endl;
+
+  impl::initialized = true;
 #endif
   return 0;
 }
@@ -330,11 +1054,24 @@ int Profiler::WriteMpiIo(MPI_Comm comm, const char *fileName,
 int Profiler::Flush()
 {
 #if defined(ENABLE_PROFILER)
-  std::ostringstream oss;
-  Profiler::ToStream(oss);
-  Profiler::WriteCStdio(impl::timerLogFile.c_str(), "a", oss.str());
+  if (!(impl::loggingEnabled & 0x01) || !impl::traceRank)
+    {
+    // nothing to write
+    }
+  else if (impl::logFormat == FORMAT_BINARY)
+    {
+    std::string buf;
+    impl::toBinary(buf);
+    Profiler::WriteCStdio(impl::timerLogFile.c_str(), "ab", buf);
+    }
+  else
+    {
+    std::ostringstream oss;
+    Profiler::ToStream(oss);
+    Profiler::WriteCStdio(impl::timerLogFile.c_str(), "a", oss.str());
+    }
   Profiler::Validate();
-  impl::eventLog.clear();
+  impl::clearThreadLogs();
 #endif
   return 0;
 }
@@ -344,7 +1081,7 @@ int Profiler::WriteCStdio(const char *fileName, const char *mode,
   const std::string &str)
 {
 #if defined(ENABLE_PROFILER)
-  if (impl::loggingEnabled & 0x01)
+  if (impl::loggingEnabled & 0x05)
     {
     FILE *fh = fopen(fileName, mode);
     if (!fh)
@@ -378,6 +1115,10 @@ int Profiler::WriteCStdio(const char *fileName, const char *mode,
 int Profiler::Finalize()
 {
 #if defined(ENABLE_PROFILER)
+  // the logs have already been written
+  if (!impl::initialized)
+    return 0;
+
   int ok = 0;
 #if defined(SENSEI_HAS_MPI)
   MPI_Initialized(&ok);
@@ -385,38 +1126,61 @@ int Profiler::Finalize()
 
   if (impl::loggingEnabled & 0x01)
     {
-    int rank = 0;
-#if defined(SENSEI_HAS_MPI)
-    if (ok)
-      MPI_Comm_rank(impl::comm, &rank);
-#endif
-
-    // serialize the logged events in CSV format
-    std::ostringstream oss;
-
-    if (rank == 0)
-      oss << "# rank, thread, Name, start Time, end Time, delta, bytes, Depth" << std::endl;
+    // ranks that do not keep a trace take part in the collective write
+    std::string buf;
+    if (!impl::traceRank)
+      {
+      if ((impl::rank == 0) && (impl::logFormat == FORMAT_CSV))
+        buf = "# rank, thread, Name, start Time, end Time, delta, bytes, Depth\n";
+      }
+    else if (impl::logFormat == FORMAT_BINARY)
+      {
+      // serialize the logged events in the binary format
+      impl::toBinary(buf);
+      }
+    else
+      {
+      // serialize the logged events in CSV format
+      std::ostringstream oss;
 
-    Profiler::ToStream(oss);
+      if (impl::rank == 0)
+        oss << "# rank, thread, Name, start Time, end Time, delta, bytes, Depth" << std::endl;
 
-    // free up resources
-    impl::eventLog.clear();
+      Profiler::ToStream(oss);
+      buf = oss.str();
+      }
 
     if (ok)
-      Profiler::WriteMpiIo(impl::comm, impl::timerLogFile.c_str(), oss.str());
+      Profiler::WriteMpiIo(impl::comm, impl::timerLogFile.c_str(), buf);
     else
-      Profiler::WriteCStdio(impl::timerLogFile.c_str(), "w", oss.str());
+      Profiler::WriteCStdio(impl::timerLogFile.c_str(), "wb", buf);
     }
 
+  if (impl::loggingEnabled & 0x04)
+    {
+    // reduce the per name statistics across ranks, rank 0 writes them
+    std::string summary;
+    impl::toSummary(ok, summary);
+
+    if (impl::rank == 0)
+      Profiler::WriteCStdio(impl::summaryLogFile.c_str(), "w", summary);
+    }
+
+  // free up resources
+  impl::clearThreadLogs();
+  impl::clearThreadStats();
+
   // output the memory use profile and clean up resources
   if (impl::loggingEnabled & 0x02)
     impl::memProf.Finalize();
 
   // free up other resources
 #if defined(SENSEI_HAS_MPI)
-  if (ok)
+  if (ok && (impl::comm != MPI_COMM_NULL))
     MPI_Comm_free(&impl::comm);
 #endif
+
+  impl::initialized = false;
 #endif
   return 0;
 }
@@ -425,8 +1189,7 @@ int Profiler::Finalize()
 bool Profiler::Enabled()
 {
 #if defined(ENABLE_PROFILER)
-  std::lock_guard<std::mutex> lock(impl::eventLogMutex);
-  return impl::loggingEnabled & 0x01;
+  return impl::loggingEnabled.load(std::memory_order_relaxed) & 0x05;
 #else
   return false;
 #endif
@@ -436,7 +1199,6 @@ bool Profiler::Enabled()
 void Profiler::Enable(int arg)
 {
 #if defined(ENABLE_PROFILER)
-  std::lock_guard<std::mutex> lock(impl::eventLogMutex);
   impl::loggingEnabled = arg;
 #else
   (void)arg;
@@ -447,7 +1209,6 @@ void Profiler::Enable(int arg)
 void Profiler::Disable()
 {
 #if defined(ENABLE_PROFILER)
-  std::lock_guard<std::mutex> lock(impl::eventLogMutex);
   impl::loggingEnabled = 0x00;
 #endif
 }
@@ -456,15 +1217,18 @@ void Profiler::Disable()
 int Profiler::StartEvent(const char* eventname, long long nbytes)
 {
 #if defined(ENABLE_PROFILER)
-  if (impl::loggingEnabled & 0x01)
+  if (impl::loggingEnabled.load(std::memory_order_relaxed) & 0x05)
     {
-    impl::Event evt;
-    evt.Name = eventname;
-    evt.Time[impl::Event::START] = impl::getSystemTime();
+    // this thread's log, no locks are taken once a thread has logged its
+    // first event and the name has been seen before
+    impl::ThreadLog *log = impl::getThreadLog();
+
+    impl::ActiveEvent evt;
+    evt.Name = impl::internName(log, eventname);
     evt.NumBytes = nbytes;
+    evt.Start = impl::getSystemTime();
 
-    std::lock_guard<std::mutex> lock(impl::eventLogMutex);
-    impl::activeEvents[evt.Tid].push_back(evt);
+    log->Active.push_back(evt);
     }
 #else
   (void)eventname;
@@ -477,42 +1241,66 @@ int Profiler::StartEvent(const char* eventname, long long nbytes)
 int Profiler::EndEvent(const char* eventname, long long nbytes)
 {
 #if defined(ENABLE_PROFILER)
-  if (impl::loggingEnabled & 0x01)
+  int enabled = impl::loggingEnabled.load(std::memory_order_relaxed);
+  if (enabled & 0x05)
     {
     // get end Time
-    double endTime = impl::getSystemTime();
+    uint64_t endTime = impl::getSystemTime();
 
     // get this thread's Event log
-    std::thread::id tid = std::this_thread::get_id();
-
-    std::lock_guard<std::mutex> lock(impl::eventLogMutex);
-    impl::threadMapType::iterator iter = impl::activeEvents.find(tid);
-    if (iter == impl::activeEvents.end())
+    impl::ThreadLog *log = impl::getThreadLog();
+    if (log->Active.empty())
       {
       SENSEI_ERROR("failed to end Event \"" << eventname
-        << "\" thread  " << tid << " has no events")
+        << "\" thread  " << log->Tid << " has no events")
       return -1;
       }
 
-    impl::Event evt(std::move(iter->second.back()));
-    iter->second.pop_back();
+    const impl::ActiveEvent &active = log->Active.back();
 
 #ifdef NDEBUG
     (void)eventname;
 #else
-    if (strcmp(eventname, evt.Name.c_str()) != 0)
+    if (impl::internName(log, eventname) != active.Name)
       {
+      std::string name;
+        {
+        std::lock_guard<std::mutex> lock(impl::registryMutex);
+        name = impl::eventNames[active.Name];
+        }
       SENSEI_ERROR("Mismatched startEvent/endEvent. Expecting: '"
-        << evt.Name << "' Got: '" << eventname << "'")
+        << name << "' Got: '" << eventname << "'")
       abort();
       }
 #endif
-    evt.Time[impl::Event::END] = endTime;
-    evt.Time[impl::Event::DELTA] = endTime - evt.Time[impl::Event::START];
-    evt.NumBytes = nbytes;
-    evt.Depth = iter->second.size();
 
-    impl::eventLog.emplace_back(std::move(evt));
+    // update the statistics
+    if (enabled & 0x04)
+      {
+      if (active.Name >= log->Stats.size())
+        log->Stats.resize(active.Name + 1);
+
+      log->Stats[active.Name].Update(endTime - active.Start, nbytes);
+      }
+
+    // record the event in the ring buffer
+    if ((enabled & 0x01) && impl::traceRank)
+      {
+      if (log->Events.empty())
+        log->Events.resize(std::max(impl::bufferSize, 1l));
+
+      uint64_t count = log->Count.load(std::memory_order_relaxed);
+      impl::Event &evt = log->Events[count % log->Events.size()];
+      evt.Name = active.Name;
+      evt.Time[impl::Event::START] = active.Start;
+      evt.Time[impl::Event::END] = endTime;
+      evt.NumBytes = nbytes;
+      evt.Depth = log->Active.size() - 1;
+
+      log->Count.store(count + 1, std::memory_order_release);
+      }
+
+    log->Active.pop_back();
     }
 #else
   (void)eventname;
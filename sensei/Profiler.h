@@ -15,6 +15,13 @@ namespace sensei
 // A class containing methods managing memory and time profiling
 // Each timed event logs rank, event name, start and end time, and
 // duration.
+//
+// Events are recorded without locking in a ring buffer owned by the thread
+// that generated them, with names interned to integer ids and times taken
+// from the monotonic clock. The buffers are merged when the log is written
+// in Flush and Finalize, at which point other threads must be idle. When a
+// thread's buffer fills its oldest events are overwritten and a warning is
+// issued when the log is written.
 class SENSEI_EXPORT Profiler
 {
 public:
@@ -28,7 +35,12 @@ public:
   //   PROFILER_ENABLE     : bit mask turns on or off logging,
   //               0x01 -- event profiling enabled
   //               0x02 -- memory profiling enabled
+  //               0x04 -- aggregated summary enabled
   //   PROFILER_LOG_FILE   : path to write timer log to
+  //   PROFILER_LOG_FORMAT : csv or binary, see SetLogFormat
+  //   PROFILER_BUFFER_SIZE : number of events buffered per thread
+  //   PROFILER_SUMMARY_FILE : path to write the aggregated summary to
+  //   PROFILER_TRACE_RANKS : ranks that write full traces, see SetTraceRanks
   //   MEMPROF_LOG_FILE    : path to write memory profiler log to
   //   MEMPROF_INTERVAL    : number of seconds between memory recordings
   //
@@ -54,6 +66,40 @@ public:
   // default value; Timer.csv
   static void SetTimerLogFile(const std::string &fileName);
 
+  // Sets the path to write the aggregated summary to. When the summary is
+  // enabled each rank collapses its events into per name statistics, the
+  // count, total, min, max, bytes, and a histogram of durations, which are
+  // reduced across ranks in Finalize. Rank 0 writes one line per event name
+  // in CSV format with the min, mean and max per rank times and the ranks
+  // where the min and max occurred.
+  // overriden by PROFILER_SUMMARY_FILE environment variable
+  // default value: timer_summary.csv
+  static void SetSummaryLogFile(const std::string &fileName);
+
+  // Sets the ranks that write full traces when event profiling is enabled,
+  // one of "all", "none", or a comma separated list of ranks and ranges such
+  // as "0,16-31". Other ranks only contribute to the summary.
+  // overriden by PROFILER_TRACE_RANKS environment variable
+  // default value: all
+  static int SetTraceRanks(const std::string &ranks);
+
+  // the log formats
+  enum {FORMAT_CSV=0, FORMAT_BINARY=1};
+
+  // Sets the format of the timer log, one of "csv" or "binary". The binary
+  // format is compact and cheap to write, and is converted to CSV by
+  // BinaryToCSV.
+  // overriden by PROFILER_LOG_FORMAT environment variable
+  // default value: csv
+  static int SetLogFormat(int format);
+  static int SetLogFormat(const std::string &format);
+
+  // Sets the number of events each thread can hold between calls to Flush
+  // or Finalize. This must be called before the thread logs its first event.
+  // overriden by PROFILER_BUFFER_SIZE environment variable
+  // default value: 65536
+  static void SetBufferSize(long nEvents);
+
   // Sets the path to write the timer log to
   // overriden by MEMPROF_LOG_FILE environment variable
   // default value: MemProfLog.csv
@@ -69,7 +115,7 @@ public:
   static void Enable(int arg = 0x03);
   static void Disable();
 
-  // return true if loggin is enabled.
+  // return true if event profiling or the summary is enabled.
   static bool Enabled();
 
   // @brief Log start of an event.
@@ -100,6 +146,10 @@ public:
 
   // setnd the current contents of the log to the stream
   static int ToStream(std::ostream &os);
+
+  // read a timer log written in the binary format and send it to the
+  // stream in the CSV format
+  static int BinaryToCSV(const std::string &fileName, std::ostream &os);
 };
 
 // TimeEvent -- A helper class that times it's life.
@@ -1,13 +1,25 @@
 #include "PythonAnalysis.h"
 #include "DataAdaptor.h"
+#include "SharedMemoryDataAdaptor.h"
 #include "Error.h"
 
 #include <svtkObjectFactory.h>
+#include <svtkSmartPointer.h>
 #include <mpi4py/mpi4py.MPI_api.h>
 #include <string>
+#include <vector>
+#include <atomic>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <cstdint>
+#include <cctype>
 #include <errno.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <Python.h>
 
 #include "senseiPyString.h"
@@ -77,7 +89,7 @@ int callFunction(const std::string &funcName, PyObject *func, PyObject *args)
 // call the function with the given arguments
 static
 int callFunction(const std::string &funcName,
-  PyObject *func, PyObject *args, PyObject *ret)
+  PyObject *func, PyObject *args, PyObject *&ret)
 {
   ret = PyObject_CallObject(func, args);
   if (!ret || PyErr_Occurred())
@@ -110,13 +122,12 @@ int runString(PyObject *module, const std::string &code)
 }
 
 static
-int loadScript(MPI_Comm comm, const std::string &scriptFile, PyObject *&module)
+int readScript(MPI_Comm comm, const std::string &scriptFile, std::string &script)
 {
   // read and broadcast the script
   int rank = 0;
   MPI_Comm_rank(comm, &rank);
 
-  char *script = nullptr;
   long scriptLen = 0;
 
   if (rank == 0)
@@ -136,10 +147,9 @@ int loadScript(MPI_Comm comm, const std::string &scriptFile, PyObject *&module)
     scriptLen = ftell(f);
     fseek(f, 0, SEEK_SET);
 
-    script = static_cast<char*>(malloc(scriptLen+1));
-    script[scriptLen] = '\0';
+    script.resize(scriptLen);
 
-    long nrd = fread(script, 1, scriptLen, f);
+    long nrd = fread(&script[0], 1, scriptLen, f);
 
     fclose(f);
 
@@ -150,12 +160,11 @@ int loadScript(MPI_Comm comm, const std::string &scriptFile, PyObject *&module)
         << std::endl << estr)
       scriptLen = -1;
       MPI_Bcast(&scriptLen, 1, MPI_LONG, 0, comm);
-      free(script);
       return -1;
       }
 
     MPI_Bcast(&scriptLen, 1, MPI_LONG, 0, comm);
-    MPI_Bcast(script, scriptLen, MPI_CHAR, 0, comm);
+    MPI_Bcast(&script[0], scriptLen, MPI_CHAR, 0, comm);
     }
   else
     {
@@ -164,12 +173,18 @@ int loadScript(MPI_Comm comm, const std::string &scriptFile, PyObject *&module)
     if (scriptLen < 1)
       return -1;
 
-    script = static_cast<char*>(malloc(scriptLen+1));
-    script[scriptLen] = '\0';
+    script.resize(scriptLen);
 
-    MPI_Bcast(script, scriptLen, MPI_CHAR, 0, comm);
+    MPI_Bcast(&script[0], scriptLen, MPI_CHAR, 0, comm);
     }
 
+  return 0;
+}
+
+static
+int loadScript(const std::string &scriptFile, const std::string &script,
+  PyObject *&module)
+{
   // this does some internal initialization
   module = PyImport_AddModule("__main__");
   Py_INCREF(module);
@@ -179,39 +194,690 @@ int loadScript(MPI_Comm comm, const std::string &scriptFile, PyObject *&module)
   if (runString(module, script))
     {
     SENSEI_ERROR("Failed to import the script \"" << scriptFile << "\"")
-    free(script);
     return -1;
     }
 
-  free(script);
   return 0;
 }
 
+// messages exchanged with a worker process. each is a header followed by
+// Size bytes of payload. the values are repeated in the ProxyComm source
+// below.
+enum {MSG_STEP=1, MSG_FINALIZE=2, MSG_DONE=3, MSG_BARRIER=4, MSG_BCAST=5,
+  MSG_GATHER=6, MSG_ALLGATHER=7};
+
+struct MessageHeader
+{
+  int32_t Type;
+  int32_t Arg;
+  uint64_t Size;
+};
+
+// the communicator used by scripts in a worker process. it forwards
+// collectives to the simulation's process.
+static
+const char *proxyCommSource =
+  "import os, struct, pickle, operator, functools\n"
+  "\n"
+  "class ProxyComm(object):\n"
+  "    \"\"\" forwards collectives on picklable objects to the parent process \"\"\"\n"
+  "    def __init__(self, rank, size, fd):\n"
+  "        self.rank = rank\n"
+  "        self.size = size\n"
+  "        self._fd = fd\n"
+  "\n"
+  "    def Get_rank(self):\n"
+  "        return self.rank\n"
+  "\n"
+  "    def Get_size(self):\n"
+  "        return self.size\n"
+  "\n"
+  "    def _read(self, n):\n"
+  "        buf = bytearray()\n"
+  "        while len(buf) < n:\n"
+  "            chunk = os.read(self._fd, n - len(buf))\n"
+  "            if not chunk:\n"
+  "                raise RuntimeError('Lost the connection to the parent process')\n"
+  "            buf += chunk\n"
+  "        return bytes(buf)\n"
+  "\n"
+  "    def _call(self, msg, arg, data=b''):\n"
+  "        view = memoryview(struct.pack('=iiQ', msg, arg, len(data)) + data)\n"
+  "        while len(view):\n"
+  "            view = view[os.write(self._fd, view):]\n"
+  "        msg, arg, n = struct.unpack('=iiQ', self._read(16))\n"
+  "        return self._read(n)\n"
+  "\n"
+  "    def _split(self, data):\n"
+  "        n = 8*self.size\n"
+  "        objs = []\n"
+  "        for s in struct.unpack('=%dQ'%(self.size), data[:n]):\n"
+  "            objs.append(pickle.loads(data[n:n+s]))\n"
+  "            n += s\n"
+  "        return objs\n"
+  "\n"
+  "    @staticmethod\n"
+  "    def _op(op):\n"
+  "        if op is None:\n"
+  "            return operator.add\n"
+  "        if callable(op):\n"
+  "            return op\n"
+  "        ops = {'sum': operator.add, 'prod': operator.mul,\n"
+  "            'min': lambda a, b: b if b < a else a,\n"
+  "            'max': lambda a, b: b if b > a else a}\n"
+  "        return ops[op.lower()]\n"
+  "\n"
+  "    def barrier(self):\n"
+  "        self._call(4, 0)\n"
+  "\n"
+  "    Barrier = barrier\n"
+  "\n"
+  "    def bcast(self, obj=None, root=0):\n"
+  "        data = pickle.dumps(obj) if self.rank == root else b''\n"
+  "        return pickle.loads(self._call(5, root, data))\n"
+  "\n"
+  "    def gather(self, obj, root=0):\n"
+  "        data = self._call(6, root, pickle.dumps(obj))\n"
+  "        return self._split(data) if self.rank == root else None\n"
+  "\n"
+  "    def allgather(self, obj):\n"
+  "        return self._split(self._call(7, 0, pickle.dumps(obj)))\n"
+  "\n"
+  "    def reduce(self, obj, op=None, root=0):\n"
+  "        objs = self.gather(obj, root)\n"
+  "        return functools.reduce(self._op(op), objs) if objs is not None else None\n"
+  "\n"
+  "    def allreduce(self, obj, op=None):\n"
+  "        return functools.reduce(self._op(op), self.allgather(obj))\n";
+
+// send n bytes, retrying partial sends
+static
+int sendAll(int fd, const void *buf, size_t n)
+{
+  const char *p = static_cast<const char*>(buf);
+  while (n)
+    {
+    ssize_t ns = send(fd, p, n, MSG_NOSIGNAL);
+    if (ns < 0)
+      {
+      if (errno == EINTR)
+        continue;
+      return -1;
+      }
+    p += ns;
+    n -= ns;
+    }
+  return 0;
+}
+
+// receive n bytes, retrying partial receives. an error is returned if the
+// other end was closed
+static
+int recvAll(int fd, void *buf, size_t n)
+{
+  char *p = static_cast<char*>(buf);
+  while (n)
+    {
+    ssize_t nr = recv(fd, p, n, 0);
+    if (nr < 0)
+      {
+      if (errno == EINTR)
+        continue;
+      return -1;
+      }
+    if (nr == 0)
+      return -1;
+    p += nr;
+    n -= nr;
+    }
+  return 0;
+}
+
+static
+int sendMessage(int fd, int type, int arg, const char *payload = nullptr,
+  uint64_t n = 0)
+{
+  MessageHeader hdr = {type, arg, n};
+  if (sendAll(fd, &hdr, sizeof(hdr)) || (n && sendAll(fd, payload, n)))
+    return -1;
+  return 0;
+}
+
+static
+int recvMessage(int fd, MessageHeader &hdr, std::vector<char> &payload)
+{
+  if (recvAll(fd, &hdr, sizeof(hdr)))
+    return -1;
+
+  payload.resize(hdr.Size);
+
+  if (hdr.Size && recvAll(fd, payload.data(), hdr.Size))
+    return -1;
+
+  return 0;
+}
+
+// run the collectives requested by the worker until it reports the status
+// of the current call
+static
+int serveWorker(MPI_Comm comm, int fd, int &status)
+{
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  MessageHeader hdr;
+  std::vector<char> payload;
+  std::vector<char> reply;
+
+  while (true)
+    {
+    if (recvMessage(fd, hdr, payload))
+      {
+      SENSEI_ERROR("The Python worker process exited unexpectedly")
+      return -1;
+      }
+
+    reply.clear();
+
+    switch (hdr.Type)
+      {
+      case MSG_DONE:
+        status = hdr.Arg;
+        return 0;
+
+      case MSG_BARRIER:
+        MPI_Barrier(comm);
+        break;
+
+      case MSG_BCAST:
+        {
+        unsigned long n = payload.size();
+        MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG, hdr.Arg, comm);
+        payload.resize(n);
+        MPI_Bcast(payload.data(), n, MPI_BYTE, hdr.Arg, comm);
+        reply.swap(payload);
+        }
+        break;
+
+      case MSG_GATHER:
+      case MSG_ALLGATHER:
+        {
+        // the reply is the size of each rank's object followed by the
+        // objects in rank order
+        bool all = hdr.Type == MSG_ALLGATHER;
+        int root = all ? rank : hdr.Arg;
+
+        uint64_t n = payload.size();
+        std::vector<uint64_t> sizes(nRanks);
+
+        if (all)
+          MPI_Allgather(&n, 1, MPI_UINT64_T, sizes.data(), 1, MPI_UINT64_T, comm);
+        else
+          MPI_Gather(&n, 1, MPI_UINT64_T, sizes.data(), 1, MPI_UINT64_T, root, comm);
+
+        std::vector<int> counts(nRanks);
+        std::vector<int> displs(nRanks);
+        uint64_t nHead = nRanks*sizeof(uint64_t);
+        uint64_t total = 0;
+        for (int i = 0; i < nRanks; ++i)
+          {
+          counts[i] = sizes[i];
+          displs[i] = total;
+          total += sizes[i];
+          }
+
+        if (rank == root)
+          {
+          reply.resize(nHead + total);
+          memcpy(reply.data(), sizes.data(), nHead);
+          }
+
+        char *objs = rank == root ? reply.data() + nHead : nullptr;
+
+        if (all)
+          MPI_Allgatherv(payload.data(), n, MPI_BYTE, objs,
+            counts.data(), displs.data(), MPI_BYTE, comm);
+        else
+          MPI_Gatherv(payload.data(), n, MPI_BYTE, objs,
+            counts.data(), displs.data(), MPI_BYTE, root, comm);
+        }
+        break;
+
+      default:
+        SENSEI_ERROR("Invalid message " << hdr.Type << " from the Python worker")
+        return -1;
+      }
+
+    if (sendMessage(fd, hdr.Type, 0, reply.data(), reply.size()))
+      {
+      SENSEI_ERROR("Failed to reply to the Python worker")
+      return -1;
+      }
+    }
+}
+
+// close the descriptors a worker process inherited from the simulation, such
+// as those of MPI, files, and the sockets of other workers, except for the
+// standard streams and keep
+static
+void closeInheritedFds(int keep)
+{
+  std::vector<int> fds;
+
+  // list the open descriptors first since closing them changes the directory
+  if (DIR *dir = opendir("/dev/fd"))
+    {
+    int dirFd = dirfd(dir);
+    while (struct dirent *ent = readdir(dir))
+      {
+      if (isdigit(ent->d_name[0]))
+        {
+        int fd = atoi(ent->d_name);
+        if ((fd > 2) && (fd != keep) && (fd != dirFd))
+          fds.push_back(fd);
+        }
+      }
+    closedir(dir);
+    }
+  else
+    {
+    long maxFd = sysconf(_SC_OPEN_MAX);
+    for (int fd = 3; fd < maxFd; ++fd)
+      if (fd != keep)
+        fds.push_back(fd);
+    }
+
+  for (int fd : fds)
+    close(fd);
+}
+
+// interpret the value returned by the script's Execute function in a worker
+// process. a returned data adaptor can not be passed back to the simulation
+static
+int getStatus(PyObject *ret, bool &output)
+{
+  output = false;
+
+  if (!ret || (ret == Py_None))
+    return 1;
+
+  if (PyLong_Check(ret))
+    return PyLong_AsLong(ret) ? 1 : 0;
+
+  output = true;
+
+  if (PyTuple_Check(ret) && (PyTuple_Size(ret) == 2) &&
+    PyLong_Check(PyTuple_GetItem(ret, 0)))
+    return PyLong_AsLong(PyTuple_GetItem(ret, 0)) ? 1 : 0;
+
+  return 1;
+}
+
 namespace sensei
 {
 
 struct PythonAnalysis::InternalsType
 {
-  InternalsType() : Module(nullptr), Initialize(nullptr),
-    Execute(nullptr), Finalize(nullptr) {}
+  InternalsType() : Execution(PythonAnalysis::EXECUTION_EMBEDDED),
+    Module(nullptr), Initialize(nullptr), Execute(nullptr), Finalize(nullptr),
+    Worker(-1), Socket(-1) {}
 
   ~InternalsType();
 
+  // import the script or module, locate its functions, and import the
+  // baseline modules
+  int Load(const std::string &script);
+
+  // run the initialize source and the script's Initialize function
+  int Configure();
+
+  // fork the worker process and wait for it to initialize the script
+  int StartWorker(MPI_Comm comm, const std::string &script);
+
+  // the worker process' main loop. this does not return
+  void RunWorker(int fd, int rank, int nRanks, const std::string &script);
+
+  // finalize the script in the worker process and wait for it to exit
+  int StopWorker(MPI_Comm comm);
+
   std::string ScriptModule;
   std::string ScriptFile;
   std::string InitializeSource;
+  int Execution;
+  DataRequirements Requirements;
 
   PyObject *Module;
   PyObject *Initialize;
   PyObject *Execute;
   PyObject *Finalize;
+
+  // the worker process, the socket connected to it, and the shared memory
+  // through which it is passed the simulation's data
+  pid_t Worker;
+  int Socket;
+  svtkSmartPointer<SharedMemoryDataAdaptor> Data;
+  svtkSmartPointer<SharedMemoryDataAdaptor> WorkerData;
 };
 
 //-----------------------------------------------------------------------------
 PythonAnalysis::InternalsType::~InternalsType()
 {
-  if (this->Initialize || this->Execute || this->Finalize || this->Module)
+  if (this->Initialize || this->Execute || this->Finalize || this->Module ||
+    (this->Worker >= 0))
     SENSEI_ERROR("PythonAnalysis::Finalize not called")
+
+  // the worker exits when the socket is closed
+  if (this->Worker >= 0)
+    {
+    close(this->Socket);
+    waitpid(this->Worker, nullptr, 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+int PythonAnalysis::InternalsType::Load(const std::string &script)
+{
+  if (!this->ScriptFile.empty())
+    {
+    // run the script
+    if (loadScript(this->ScriptFile, script, this->Module))
+      return -1;
+    }
+  else
+    {
+    // import the script
+    PyObject *module = PyImport_ImportModule(this->ScriptModule.c_str());
+
+    if (!module || PyErr_Occurred())
+      {
+      SENSEI_PYTHON_ERROR("Failed to import module \""
+        << this->ScriptModule  << "\"")
+      return -1;
+      }
+
+    this->Module = module;
+    }
+
+  // look for AnalysisAdaptor API
+  int ierr = getFunction(this->Module,
+    this->ScriptModule, "Initialize", false,
+    this->Initialize);
+
+  ierr += getFunction(this->Module,
+    this->ScriptModule, "Execute", true,
+    this->Execute);
+
+  ierr += getFunction(this->Module,
+    this->ScriptModule, "Finalize", false,
+    this->Finalize);
+
+  if (ierr)
+    {
+    SENSEI_ERROR("Module \"" << this->ScriptModule <<
+      "\" does not provide the required API. The API consists of the "
+      "following functions defined at global scope:\n\n    Initialize() -> int\n"
+      "    Execute(dataAdaptor) -> int\n    Finalize() -> int\n\nOnly Execute is "
+      "required, Initialize and Finalize are optional.")
+    return -1;
+    }
+
+  // import the sensei wrapper and mpi4py
+  if (runString(this->Module,
+    "from mpi4py import *\n"
+    "from sensei.PythonAnalysis import *\n"))
+    {
+    SENSEI_ERROR("Failed to import baseline modules")
+    return -1;
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int PythonAnalysis::InternalsType::Configure()
+{
+  // set provided globals
+  if (!this->InitializeSource.empty())
+    {
+    if (runString(this->Module, this->InitializeSource))
+      {
+      SENSEI_ERROR("Failed to run initialize source")
+      return -1;
+      }
+    }
+
+  // call the provided initialize function
+  if (this->Initialize)
+    return callFunction("Initialize", this->Initialize, nullptr);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int PythonAnalysis::InternalsType::StartWorker(MPI_Comm comm,
+  const std::string &script)
+{
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  // the segment name must be unique on the node
+  static std::atomic<int> workerId(0);
+
+  std::string name = "/sensei-python-" + std::to_string(getpid())
+    + "-" + std::to_string(workerId++);
+
+  // both ends are constructed here since constructing a data adaptor
+  // duplicates MPI_COMM_WORLD, which the worker process must not do
+  this->Data = svtkSmartPointer<SharedMemoryDataAdaptor>::New();
+  this->WorkerData = svtkSmartPointer<SharedMemoryDataAdaptor>::New();
+
+  if (this->Data->SetSegmentName(name) || this->WorkerData->SetSegmentName(name))
+    return -1;
+
+  int fds[2] = {-1, -1};
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+    {
+    const char *estr = strerror(errno);
+    SENSEI_ERROR("Failed to create a socket for the Python worker"
+      << std::endl << estr)
+    return -1;
+    }
+
+  // pending output would otherwise be written by both processes
+  std::cout.flush();
+  std::cerr.flush();
+  fflush(nullptr);
+
+  // when the simulation has an interpreter its locks must be held across the
+  // fork so that the worker's copy is consistent
+#if PY_VERSION_HEX >= 0x03070000
+  bool havePython = Py_IsInitialized();
+  PyGILState_STATE gil = PyGILState_UNLOCKED;
+  if (havePython)
+    {
+    gil = PyGILState_Ensure();
+    PyOS_BeforeFork();
+    }
+#endif
+
+  pid_t pid = fork();
+  int forkErrno = errno;
+
+  if (pid == 0)
+    {
+    closeInheritedFds(fds[1]);
+    this->RunWorker(fds[1], rank, nRanks, script);
+    }
+
+#if PY_VERSION_HEX >= 0x03070000
+  if (havePython)
+    {
+    PyOS_AfterFork_Parent();
+    PyGILState_Release(gil);
+    }
+#endif
+
+  if (pid < 0)
+    {
+    const char *estr = strerror(forkErrno);
+    SENSEI_ERROR("Failed to fork the Python worker" << std::endl << estr)
+    close(fds[0]);
+    close(fds[1]);
+    return -1;
+    }
+
+  close(fds[1]);
+
+  this->Worker = pid;
+  this->Socket = fds[0];
+
+  // the script's Initialize function may make collective calls
+  int status = -1;
+  if (serveWorker(comm, this->Socket, status) || status)
+    {
+    SENSEI_ERROR("Failed to initialize the Python worker")
+    close(this->Socket);
+    waitpid(this->Worker, nullptr, 0);
+    this->Socket = -1;
+    this->Worker = -1;
+    return -1;
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void PythonAnalysis::InternalsType::RunWorker(int fd, int rank, int nRanks,
+  const std::string &script)
+{
+  // the simulation's process may already have an interpreter, in which case
+  // the copy made by fork is used
+  if (Py_IsInitialized())
+    {
+#if PY_VERSION_HEX >= 0x03070000
+    PyOS_AfterFork_Child();
+#else
+    PyOS_AfterFork();
+#endif
+    }
+  else
+    {
+    Py_SetProgramName(C_STRING_LITERAL("PythonAnalysis"));
+    Py_Initialize();
+    }
+
+  // serves the simulation's data from the segment written by the parent
+  SharedMemoryDataAdaptor *data = this->WorkerData;
+
+  // load the script and replace the communicator with a proxy
+  std::string setComm = "comm = ProxyComm(" + std::to_string(rank) + ", "
+    + std::to_string(nRanks) + ", " + std::to_string(fd) + ")\n";
+
+  int status = -1;
+  if (!this->Load(script) && !runString(this->Module, proxyCommSource) &&
+    !runString(this->Module, setComm) && !this->Configure())
+    status = 0;
+
+  sendMessage(fd, MSG_DONE, status);
+
+  // the simulation does not send steps to a worker that failed to initialize
+  bool initialized = status == 0;
+  bool warned = false;
+  MessageHeader hdr;
+  std::vector<char> payload;
+
+  while (initialized && !recvMessage(fd, hdr, payload))
+    {
+    if (hdr.Type == MSG_STEP)
+      {
+      uint64_t nBytes = 0;
+      if (payload.size() == sizeof(nBytes))
+        memcpy(&nBytes, payload.data(), sizeof(nBytes));
+
+      status = -1;
+
+      if (!data->Read(nBytes))
+        {
+        PyObject *pyDataAdaptor = SWIG_NewPointerObj(
+          SWIG_as_voidptr(static_cast<DataAdaptor*>(data)),
+          SWIGTYPE_p_sensei__DataAdaptor, 0);
+
+        PyObject *args = Py_BuildValue("(N)", pyDataAdaptor);
+        PyObject *ret = nullptr;
+
+        if (!callFunction("Execute", this->Execute, args, ret))
+          {
+          bool output = false;
+          status = getStatus(ret, output);
+
+          if (output && !warned)
+            {
+            SENSEI_WARNING("Execute returned a data adaptor. Results are not "
+              "returned to the simulation when the script runs in a worker process")
+            warned = true;
+            }
+          }
+
+        Py_DECREF(args);
+        Py_XDECREF(ret);
+
+        data->ReleaseData();
+        }
+
+      sendMessage(fd, MSG_DONE, status);
+      }
+    else if (hdr.Type == MSG_FINALIZE)
+      {
+      status = 0;
+      if (this->Finalize)
+        status = callFunction("Finalize", this->Finalize, nullptr);
+
+      sendMessage(fd, MSG_DONE, status);
+      break;
+      }
+    else
+      {
+      SENSEI_ERROR("Invalid message " << hdr.Type << " from the simulation")
+      break;
+      }
+    }
+
+  data->Close();
+
+  // exit without running the simulation's exit handlers, which may
+  // finalize MPI
+  PyRun_SimpleString("import sys\nsys.stdout.flush()\nsys.stderr.flush()\n");
+  fflush(nullptr);
+  _exit(0);
+}
+
+//-----------------------------------------------------------------------------
+int PythonAnalysis::InternalsType::StopWorker(MPI_Comm comm)
+{
+  if (this->Worker < 0)
+    return 0;
+
+  // the script's Finalize function may make collective calls
+  int status = -1;
+  if (sendMessage(this->Socket, MSG_FINALIZE, 0) ||
+    serveWorker(comm, this->Socket, status) || status)
+    SENSEI_ERROR("Failed to finalize the Python worker")
+
+  close(this->Socket);
+  waitpid(this->Worker, nullptr, 0);
+
+  this->Socket = -1;
+  this->Worker = -1;
+
+  this->Data->Close();
+  this->Data = nullptr;
+  this->WorkerData = nullptr;
+
+  return status ? -1 : 0;
 }
 
 
@@ -248,9 +914,65 @@ void PythonAnalysis::SetScriptFile(const std::string &scriptName)
   this->Internals->ScriptFile = scriptName;
 }
 
+//-----------------------------------------------------------------------------
+int PythonAnalysis::SetExecution(int mode)
+{
+  if ((mode != PythonAnalysis::EXECUTION_EMBEDDED) &&
+    (mode != PythonAnalysis::EXECUTION_PROCESS))
+    {
+    SENSEI_ERROR("Invalid execution " << mode)
+    return -1;
+    }
+
+  if (this->Internals->Module || (this->Internals->Worker >= 0))
+    {
+    SENSEI_ERROR("The execution must be set before Initialize")
+    return -1;
+    }
+
+  this->Internals->Execution = mode;
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int PythonAnalysis::SetExecution(std::string modeStr)
+{
+  unsigned int n = modeStr.size();
+  for (unsigned int i = 0; i < n; ++i)
+    modeStr[i] = tolower(modeStr[i]);
+
+  int mode = 0;
+  if (modeStr == "embedded")
+    {
+    mode = PythonAnalysis::EXECUTION_EMBEDDED;
+    }
+  else if (modeStr == "process")
+    {
+    mode = PythonAnalysis::EXECUTION_PROCESS;
+    }
+  else
+    {
+    SENSEI_ERROR("invalid execution \"" << modeStr << "\"")
+    return -1;
+    }
+
+  return this->SetExecution(mode);
+}
+
+//-----------------------------------------------------------------------------
+int PythonAnalysis::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Internals->Requirements = reqs;
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 int PythonAnalysis::Finalize()
 {
+  if (this->Internals->Execution == PythonAnalysis::EXECUTION_PROCESS)
+    return this->Internals->StopWorker(this->GetCommunicator());
+
   if (this->Internals->Finalize)
     callFunction("Finalize", this->Internals->Finalize, nullptr);
 
@@ -272,10 +994,6 @@ int PythonAnalysis::Finalize()
 //-----------------------------------------------------------------------------
 int PythonAnalysis::Initialize()
 {
-  // initialize the interpreter
-  Py_SetProgramName(C_STRING_LITERAL("PythonAnalysis"));
-  Py_Initialize();
-
   if (!this->Internals->ScriptFile.empty() && !this->Internals->ScriptModule.empty())
     {
     SENSEI_ERROR("Both a script file and script module were provided. "
@@ -290,79 +1008,28 @@ int PythonAnalysis::Initialize()
     return -1;
     }
 
-  if (!this->Internals->ScriptFile.empty())
-    {
-    // read, boradcast, and run the script
-    if (loadScript(this->GetCommunicator(), this->Internals->ScriptFile,
-      this->Internals->Module))
-      return -1;
-    }
-  else
-    {
-    // import the script
-    PyObject *module = PyImport_ImportModule(this->Internals->ScriptModule.c_str());
-
-    if (!module || PyErr_Occurred())
-      {
-      SENSEI_PYTHON_ERROR("Failed to import module \""
-        << this->Internals->ScriptModule  << "\"")
-      return -1;
-      }
-
-    this->Internals->Module = module;
-    }
-
-  // look for AnalysisAdaptor API
-  int ierr = getFunction(this->Internals->Module,
-    this->Internals->ScriptModule, "Initialize", false,
-    this->Internals->Initialize);
-
-  ierr += getFunction(this->Internals->Module,
-    this->Internals->ScriptModule, "Execute", true,
-    this->Internals->Execute);
+  // read and broadcast the script
+  std::string script;
+  if (!this->Internals->ScriptFile.empty() &&
+    readScript(this->GetCommunicator(), this->Internals->ScriptFile, script))
+    return -1;
 
-  ierr += getFunction(this->Internals->Module,
-    this->Internals->ScriptModule, "Finalize", false,
-    this->Internals->Finalize);
+  // the worker process runs its own interpreter
+  if (this->Internals->Execution == PythonAnalysis::EXECUTION_PROCESS)
+    return this->Internals->StartWorker(this->GetCommunicator(), script);
 
-  if (ierr)
-    {
-    SENSEI_ERROR("Module \"" << this->Internals->ScriptModule <<
-      "\" does not provide the required API. The API consists of the "
-      "following functions defined at global scope:\n\n    Initialize() -> int\n"
-      "    Execute(dataAdaptor) -> int\n    Finalize() -> int\n\nOnly Execute is "
-      "required, Initialize and Finalize are optional.")
-    return -1;
-    }
+  // initialize the interpreter
+  Py_SetProgramName(C_STRING_LITERAL("PythonAnalysis"));
+  Py_Initialize();
 
-  // import the sensei wrapper and mpi4py
-  if (runString(this->Internals->Module,
-    "from mpi4py import *\n"
-    "from sensei.PythonAnalysis import *\n"))
-    {
-    SENSEI_ERROR("Failed to import baseline modules")
+  if (this->Internals->Load(script))
     return -1;
-    }
 
   // set the communicator
   PyModule_AddObject(this->Internals->Module,
     "comm", PyMPIComm_New(this->GetCommunicator()));
 
-  // set provided globals
-  if (!this->Internals->InitializeSource.empty())
-    {
-    if (runString(this->Internals->Module, this->Internals->InitializeSource))
-      {
-      SENSEI_ERROR("Failed to run initialize source")
-      return -1;
-      }
-    }
-
-  // call the provided initialize function
-  if (this->Internals->Initialize)
-    return callFunction("Initialize", this->Internals->Initialize, nullptr);
-
-  return 0;
+  return this->Internals->Configure();
 }
 
 //-----------------------------------------------------------------------------
@@ -374,6 +1041,46 @@ bool PythonAnalysis::Execute(DataAdaptor *daIn, DataAdaptor **daOut)
     *daOut = nullptr;
     }
 
+  // pass the data to the worker process through shared memory
+  if (this->Internals->Execution == PythonAnalysis::EXECUTION_PROCESS)
+    {
+    if (this->Internals->Worker < 0)
+      {
+      SENSEI_ERROR("The Python worker is not running")
+      return false;
+      }
+
+    unsigned long nBytes = 0;
+    int writeError = 0;
+    if (this->Internals->Data->Write(daIn, this->Internals->Requirements, nBytes))
+      {
+      SENSEI_ERROR("Failed to pass the simulation's data to the Python worker")
+      writeError = 1;
+      }
+
+    // the workers' collectives are run by the simulation's processes, all
+    // ranks must send the step or none may
+    MPI_Allreduce(MPI_IN_PLACE, &writeError, 1, MPI_INT, MPI_MAX,
+      this->GetCommunicator());
+
+    if (writeError)
+      return false;
+
+    uint64_t n = nBytes;
+    int status = -1;
+
+    if (sendMessage(this->Internals->Socket, MSG_STEP, 0,
+      reinterpret_cast<const char*>(&n), sizeof(n)) ||
+      serveWorker(this->GetCommunicator(), this->Internals->Socket, status) ||
+      (status < 0))
+      {
+      SENSEI_ERROR("Execute failed in the Python worker")
+      return false;
+      }
+
+    return status;
+    }
+
   if (!this->Internals->Execute)
     {
     SENSEI_ERROR("Missing an Execute function")
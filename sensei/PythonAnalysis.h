@@ -3,7 +3,9 @@
 
 #include "senseiConfig.h"
 #include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
 #include <mpi.h>
+#include <string>
 
 namespace sensei
 {
@@ -64,6 +66,30 @@ class DataAdaptor;
  *
  * The user provided Execute function should call DataAdaptor::ReleaseData when
  * processing is completed to ensure all resources are released.
+ *
+ * By default the script runs in an interpreter embedded in the simulation.
+ * Scripts hold the Python global interpreter lock while they run, so several
+ * PythonAnalysis instances are serialized even when sensei::ConfigurableAnalysis
+ * executes them concurrently. With EXECUTION_PROCESS (see SetExecution) the
+ * script instead runs in a worker process forked by Initialize, one per
+ * PythonAnalysis instance and rank. Each step the required meshes and arrays
+ * (see SetDataRequirements) are copied into a shared memory segment, and the
+ * script is passed a sensei::SharedMemoryDataAdaptor whose arrays point
+ * directly into the segment. These arrays, and numpy views of them, are only
+ * valid during the call to Execute. The segment is released after Execute
+ * returns and may be remapped by the next step, so a script that keeps a view
+ * across steps reads invalid memory. Copy what must be kept. Only step
+ * control messages are exchanged with the worker, through a socket. The worker does not use MPI itself, `comm` is a
+ * stand in that forwards `Get_rank`, `Get_size`, `barrier`, `bcast`, `gather`,
+ * `allgather`, `reduce`, and `allreduce` on picklable objects to the
+ * simulation's process, which runs them on the analysis' communicator.
+ * Reductions take a Python callable, the mpi4py operators, or one of "sum",
+ * "prod", "min", or "max". The script must not communicate with mpi4py
+ * directly, and a data adaptor returned by Execute is not passed back to the
+ * simulation. Forking is not supported by some MPI networks. Sub interpreters
+ * are not used because they share the global interpreter lock with the
+ * simulation's interpreter, and the SWIG, numpy, and mpi4py modules used by
+ * SENSEI cannot be loaded in an interpreter that has its own.
  */
 class SENSEI_EXPORT PythonAnalysis : public AnalysisAdaptor
 {
@@ -92,6 +118,25 @@ public:
    */
   void SetInitializeSource(const std::string &source);
 
+  /// Methods of executing the script.
+  enum {EXECUTION_EMBEDDED=0, EXECUTION_PROCESS=1};
+
+  /** Sets how the script is executed. EXECUTION_EMBEDDED, the default, runs
+   * the script in an interpreter embedded in the simulation. EXECUTION_PROCESS
+   * runs the script in a worker process that is passed the simulation's data
+   * through shared memory. This must be called before Initialize.
+   */
+  int SetExecution(int mode);
+
+  /// Sets the execution by string, either "embedded" or "process".
+  int SetExecution(std::string mode);
+
+  /** Sets the meshes and arrays passed to the worker process each step. When
+   * empty, the default, all of the simulation's meshes and arrays are passed.
+   * Only used with EXECUTION_PROCESS.
+   */
+  int SetDataRequirements(const DataRequirements &reqs);
+
   /**  Initialize the interpreter. One must set file name or module name before
    * initialization.
    */
@@ -100,7 +145,7 @@ public:
   /// Invoke in situ processing by calling the user provided Python function.
   bool Execute(DataAdaptor* data, DataAdaptor**) override;
 
-  /// Shut down and clean up the embedded interpreter.
+  /// Shut down and clean up the embedded interpreter or worker process.
   int Finalize() override;
 
 protected:
@@ -0,0 +1,380 @@
+#include "QuantileAnalysis.h"
+#include "QuantileSketch.h"
+#include "DataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "MemoryUtils.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataObject.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkObjectFactory.h>
+#include <svtkSmartPointer.h>
+#include <svtkUnsignedCharArray.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+// **************************************************************************
+int Write(const std::string &fileName, int step, double time,
+  const std::string &meshName, const std::string &arrayName,
+  unsigned long long count, const std::vector<double> &result)
+{
+  // write the quantiles to a file
+  char fname[1024] = {'\0'};
+
+  snprintf(fname, 1024, "%s_%s_%s_%d.txt", fileName.c_str(),
+    meshName.c_str(), arrayName.c_str(), step);
+
+  FILE *file = fopen(fname, "w");
+  if (!file)
+    {
+    char *estr = strerror(errno);
+    SENSEI_ERROR("Failed to open \"" << fname << "\"" << std::endl << estr)
+    return -1;
+    }
+
+  int n = result.size();
+
+  fprintf(file, "step : %d\n", step);
+  fprintf(file, "time : %0.6g\n", time);
+  fprintf(file, "count : %llu\n", count);
+  fprintf(file, "num quantiles : %d\n", n);
+  fprintf(file, "quantiles : ");
+  for (int i = 0; i < n; ++i)
+    fprintf(file, "%0.6g ", double(i)/double(n - 1));
+  fprintf(file, "\n");
+  fprintf(file, "values : ");
+  for (int i = 0; i < n; ++i)
+    fprintf(file, "%0.6g ", result[i]);
+  fprintf(file, "\n");
+  fclose(file);
+
+  return 0;
+}
+
+// **************************************************************************
+int Write(int step, double time, const std::string &meshName,
+  const std::string &arrayName, unsigned long long count,
+  const std::vector<double> &result)
+{
+  // write the quantiles to std::cout
+  int origPrec = std::cout.precision();
+  std::cout.precision(4);
+
+  std::cout << "Quantiles mesh \"" << meshName << "\" data array \""
+    << arrayName << "\" step " << step << " time " << time
+    << " count " << count << std::endl;
+
+  int n = result.size();
+  for (int i = 0; i < n; ++i)
+    {
+    const int wid = 15;
+    std::cout << std::fixed << std::setw(wid) << std::right
+      << double(i)/double(n - 1) << " : " << std::scientific
+      << result[i] << std::endl;
+    }
+
+  std::cout.unsetf(std::ios_base::floatfield);
+  std::cout.precision(origPrec);
+
+  return 0;
+}
+
+// **************************************************************************
+// insert the values of a single component array into the sketch, skipping
+// ghosts. arrays that are not contiguous in memory are read through the
+// virtual API
+void Insert(sensei::QuantileSketch &sketch, svtkDataArray *array,
+  const unsigned char *ghosts)
+{
+  size_t nVals = array->GetNumberOfTuples();
+
+  switch (array->GetDataType())
+    {
+    svtkTemplateMacro(
+      if (dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(array) ||
+        dynamic_cast<svtkSOADataArrayTemplate<SVTK_TT>*>(array))
+        {
+        SVTK_TT *pArray = sensei::SVTKUtils::GetPointer<SVTK_TT>(array);
+        std::shared_ptr<const SVTK_TT> vals =
+          sensei::MemoryUtils::MakeCpuAccessible(pArray, nVals);
+        sketch.Insert(vals.get(), nVals, ghosts);
+        return;
+        }
+      );
+    }
+
+  for (size_t i = 0; i < nVals; ++i)
+    {
+    if (!ghosts || !ghosts[i])
+      sketch.Insert(array->GetTuple1(i));
+    }
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+senseiNewMacro(QuantileAnalysis);
+
+//-----------------------------------------------------------------------------
+QuantileAnalysis::QuantileAnalysis() : Association(svtkDataObject::POINT),
+  NumberOfQuantiles(10), SketchSize(200), LastCount(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+QuantileAnalysis::~QuantileAnalysis()
+{
+}
+
+//-----------------------------------------------------------------------------
+void QuantileAnalysis::Initialize(const std::string &meshName,
+  int association, const std::string &arrayName, int numberOfQuantiles,
+  const std::string &fileName)
+{
+  this->MeshName = meshName;
+  this->Association = association;
+  this->ArrayName = arrayName;
+  this->NumberOfQuantiles = numberOfQuantiles;
+  this->FileName = fileName;
+}
+
+//-----------------------------------------------------------------------------
+int QuantileAnalysis::SetSketchSize(int sketchSize)
+{
+  if (sketchSize < 8)
+    {
+    SENSEI_ERROR("Invalid sketch size " << sketchSize << ", must be at least 8")
+    return -1;
+    }
+
+  this->SketchSize = sketchSize;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int QuantileAnalysis::SetError(double eps)
+{
+  if (!((eps > 0.0) && (eps < 1.0)))
+    {
+    SENSEI_ERROR("Invalid error " << eps << ", must be in (0, 1)")
+    return -1;
+    }
+
+  this->SketchSize = QuantileSketch::SizeForError(eps);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool QuantileAnalysis::Execute(DataAdaptor* data, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("QuantileAnalysis::Execute");
+
+  // we do not return anything
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  if (this->NumberOfQuantiles < 2)
+    {
+    SENSEI_ERROR("Invalid number of quantiles " << this->NumberOfQuantiles)
+    return false;
+    }
+
+  int rank = 0;
+  MPI_Comm comm = this->GetCommunicator();
+  MPI_Comm_rank(comm, &rank);
+
+  int step = data->GetDataTimeStep();
+  double time = data->GetDataTime();
+
+  // see what the simulation is providing
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(data))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  // get the mesh metadata object
+  MeshMetadataPtr mmd;
+  if (mdMap.GetMeshMetadata(this->MeshName, mmd))
+    {
+    SENSEI_ERROR("Failed to get metadata for mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  // get the mesh object
+  svtkDataObject *dobj = nullptr;
+  if (data->GetMesh(this->MeshName, true, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  QuantileSketch sketch(this->SketchSize);
+
+  // it is not an necessarilly an error if all ranks do not have
+  // a dataset to process. However, all ranks must participate due
+  // to the use of MPI collectives. errors are reported after all ranks
+  // have reached the collective, rather than leaving the others waiting
+  int error = 0;
+  if (dobj)
+    {
+    if (data->AddArray(dobj, this->MeshName, this->Association, this->ArrayName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add "
+        << SVTKUtils::GetAttributesName(this->Association)
+        << " data array \""  << this->ArrayName << "\"")
+      error = 1;
+      }
+
+    // add the ghost zones
+    if (!error && (this->Association == svtkDataObject::CELL) &&
+      (mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
+      data->AddGhostCellsArray(dobj, this->MeshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
+      error = 1;
+      }
+
+    if (!error && (this->Association == svtkDataObject::POINT) &&
+      mmd->NumGhostNodes && data->AddGhostNodesArray(dobj, this->MeshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
+      error = 1;
+      }
+
+    svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+
+    // insert the values of all blocks into the sketch
+    svtkSmartPointer<svtkCompositeDataIterator> iter;
+    iter.TakeReference(mesh->NewIterator());
+    for (iter->InitTraversal(); !error && !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+      svtkDataObject *curObj = iter->GetCurrentDataObject();
+
+      svtkDataArray *array = this->GetArray(curObj, this->Association, this->ArrayName);
+      if (!array)
+        {
+        SENSEI_WARNING("Data block " << iter->GetCurrentFlatIndex()
+          << " of mesh \"" << this->MeshName << " has no array named \""
+          << this->ArrayName << "\"")
+        continue;
+        }
+
+      if (array->GetNumberOfComponents() != 1)
+        {
+        SENSEI_ERROR("Quantiles of array \"" << this->ArrayName
+          << "\" cannot be computed because the array has "
+          << array->GetNumberOfComponents() << " components")
+        error = 1;
+        break;
+        }
+
+      size_t nVals = array->GetNumberOfTuples();
+
+      svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
+        this->GetArray(curObj, this->Association, "svtkGhostType"));
+
+      std::shared_ptr<const unsigned char> ghosts;
+      if (ghostArray)
+        ghosts = MemoryUtils::MakeCpuAccessible(ghostArray->GetPointer(0), nVals);
+
+      ::Insert(sketch, array, ghosts.get());
+      }
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_MAX, comm);
+  if (error)
+    {
+    if (rank == 0)
+      {
+      SENSEI_ERROR("Failed to compute quantiles of array \""
+        << this->ArrayName << "\" on mesh \"" << this->MeshName << "\"")
+      }
+    return false;
+    }
+
+  // merge the sketches of all ranks onto rank 0. this is an MPI collective
+  if (sketch.Reduce(comm, 0))
+    {
+    SENSEI_ERROR("Failed to reduce the quantile sketches")
+    return false;
+    }
+
+  if (rank == 0)
+    {
+    this->LastCount = sketch.GetCount();
+    this->LastResult.clear();
+
+    if (this->LastCount == 0)
+      {
+      SENSEI_WARNING("No values of array \"" << this->ArrayName
+        << "\" on mesh \"" << this->MeshName << "\" step " << step)
+      return true;
+      }
+
+    if (sketch.GetQuantiles(this->NumberOfQuantiles, this->LastResult) ||
+      this->Write(step, time))
+      return false;
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int QuantileAnalysis::Write(int step, double time)
+{
+  if (this->FileName.empty())
+    {
+    ::Write(step, time, this->MeshName, this->ArrayName, this->LastCount,
+      this->LastResult);
+    }
+  else if (::Write(this->FileName, step, time, this->MeshName,
+    this->ArrayName, this->LastCount, this->LastResult))
+    {
+    SENSEI_ERROR("Failed to write quantiles.")
+    return -1;
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+svtkDataArray* QuantileAnalysis::GetArray(svtkDataObject* dobj, int association,
+  const std::string& arrayname)
+{
+  if (svtkFieldData* fd = dobj->GetAttributesAsFieldData(association))
+    {
+    return fd->GetArray(arrayname.c_str());
+    }
+  return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+int QuantileAnalysis::GetQuantiles(std::vector<double> &quantiles)
+{
+  if (this->LastResult.empty())
+    {
+    SENSEI_ERROR("No quantiles have been computed")
+    return -1;
+    }
+
+  quantiles = this->LastResult;
+  return 0;
+}
+
+}
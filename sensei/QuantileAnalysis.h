@@ -0,0 +1,84 @@
+#ifndef QuantileAnalysis_h
+#define QuantileAnalysis_h
+
+#include "AnalysisAdaptor.h"
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+class svtkDataObject;
+class svtkDataArray;
+
+namespace sensei
+{
+class QuantileSketch;
+
+/** Computes the quantiles, or equivalently the inverse CDF, of an array in
+ * parallel. The values of all local blocks are inserted into a
+ * sensei::QuantileSketch in a single pass, without copying or sorting the
+ * data, and the sketches of all MPI ranks are merged with a single tree
+ * reduction. The accuracy is controlled by the size of the sketch, see
+ * SetSketchSize.
+ */
+class SENSEI_EXPORT QuantileAnalysis : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static QuantileAnalysis* New();
+
+  senseiTypeMacro(QuantileAnalysis, AnalysisAdaptor);
+
+  /** initialize for the run to compute numberOfQuantiles evenly spaced
+   * quantiles, from the minimum to the maximum, of the named array. When
+   * fileName is empty the results are written to stdout */
+  void Initialize(const std::string &meshName, int association,
+    const std::string &arrayName, int numberOfQuantiles,
+    const std::string &fileName);
+
+  /** Sets the size of the sketch. The normalized rank error of the quantiles
+   * is about 1.7 divided by the size. The default is 200 */
+  int SetSketchSize(int sketchSize);
+
+  /// Sets the size of the sketch from the normalized rank error
+  int SetError(double eps);
+
+  /// compute the quantiles for this time step
+  bool Execute(DataAdaptor* data, DataAdaptor**) override;
+
+  /// finalize the run
+  int Finalize() override { return 0; }
+
+  /** return the quantiles computed by the most recent call to Execute. only
+   * valid on MPI rank 0 */
+  int GetQuantiles(std::vector<double> &quantiles);
+
+  /** return the number of values used by the most recent call to Execute.
+   * only valid on MPI rank 0 */
+  unsigned long long GetCount() const { return this->LastCount; }
+
+protected:
+  QuantileAnalysis();
+  ~QuantileAnalysis();
+
+  QuantileAnalysis(const QuantileAnalysis&) = delete;
+  void operator=(const QuantileAnalysis&) = delete;
+
+  /// write the result to a file or cout
+  int Write(int step, double time);
+
+  static svtkDataArray* GetArray(svtkDataObject* dobj, int association,
+    const std::string& arrayname);
+
+  std::string MeshName;
+  int Association;
+  std::string ArrayName;
+  int NumberOfQuantiles;
+  int SketchSize;
+  std::string FileName;
+  std::vector<double> LastResult;
+  unsigned long long LastCount;
+};
+
+}
+
+#endif
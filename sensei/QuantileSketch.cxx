@@ -0,0 +1,337 @@
+#include "QuantileSketch.h"
+#include "BinaryStream.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// the tag of the messages of the tree reduction
+constexpr int QuantileSketchTag = 5731;
+}
+
+namespace sensei
+{
+
+// --------------------------------------------------------------------------
+QuantileSketch::QuantileSketch(int k) : K(std::max(8, k)), Count(0),
+  Min(std::numeric_limits<double>::infinity()),
+  Max(-std::numeric_limits<double>::infinity()), Size(0), MaxSize(0),
+  Parity(0)
+{
+  this->Grow();
+}
+
+// --------------------------------------------------------------------------
+int QuantileSketch::SizeForError(double eps)
+{
+  eps = std::min(0.5, std::max(1.0e-6, eps));
+  return std::max(8, int(std::ceil(1.7 / eps)));
+}
+
+// --------------------------------------------------------------------------
+void QuantileSketch::Clear()
+{
+  this->Count = 0;
+  this->Min = std::numeric_limits<double>::infinity();
+  this->Max = -std::numeric_limits<double>::infinity();
+  this->Size = 0;
+  this->MaxSize = 0;
+  this->Parity = 0;
+  this->Levels.clear();
+  this->Grow();
+}
+
+// --------------------------------------------------------------------------
+size_t QuantileSketch::Capacity(size_t h) const
+{
+  // the capacity decays geometrically from the top level down
+  size_t depth = this->Levels.size() - h - 1;
+  size_t cap = size_t(std::ceil(this->K * std::pow(2.0/3.0, double(depth))));
+  return std::max(size_t(2), cap);
+}
+
+// --------------------------------------------------------------------------
+void QuantileSketch::Grow()
+{
+  this->Levels.emplace_back();
+
+  size_t nLevels = this->Levels.size();
+  this->MaxSize = 0;
+  for (size_t h = 0; h < nLevels; ++h)
+    this->MaxSize += this->Capacity(h);
+}
+
+// --------------------------------------------------------------------------
+void QuantileSketch::Compress()
+{
+  for (size_t h = 0; h < this->Levels.size(); ++h)
+    {
+    if (this->Levels[h].size() < this->Capacity(h))
+      continue;
+
+    if (h + 1 == this->Levels.size())
+      this->Grow();
+
+    std::vector<double> &level = this->Levels[h];
+    std::vector<double> &next = this->Levels[h + 1];
+
+    std::sort(level.begin(), level.end());
+
+    // promote one of each pair of values, alternating between the smaller
+    // and the larger so that the errors cancel. when the number of values is
+    // odd the smallest stays behind
+    size_t n = level.size();
+    size_t first = n % 2;
+    for (size_t i = first + this->Parity; i < n; i += 2)
+      next.push_back(level[i]);
+    this->Parity ^= 1;
+
+    level.resize(first);
+
+    this->Size -= (n - first) / 2;
+
+    if (this->Size < this->MaxSize)
+      break;
+    }
+}
+
+// --------------------------------------------------------------------------
+int QuantileSketch::Merge(const QuantileSketch &other)
+{
+  if (other.K != this->K)
+    {
+    SENSEI_ERROR("Can't merge sketches of different sizes "
+      << this->K << " and " << other.K)
+    return -1;
+    }
+
+  if (other.Count == 0)
+    return 0;
+
+  while (this->Levels.size() < other.Levels.size())
+    this->Grow();
+
+  size_t nLevels = other.Levels.size();
+  for (size_t h = 0; h < nLevels; ++h)
+    {
+    const std::vector<double> &olevel = other.Levels[h];
+    this->Levels[h].insert(this->Levels[h].end(), olevel.begin(), olevel.end());
+    }
+
+  this->Count += other.Count;
+  this->Size += other.Size;
+  this->Min = std::min(this->Min, other.Min);
+  this->Max = std::max(this->Max, other.Max);
+
+  while (this->Size >= this->MaxSize)
+    this->Compress();
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int QuantileSketch::Reduce(MPI_Comm comm, int root)
+{
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  // ranks relative to the root. at each stage the ranks with the bit set
+  // send to their partner and are done
+  int relRank = (rank - root + nRanks) % nRanks;
+
+  for (int mask = 1; mask < nRanks; mask <<= 1)
+    {
+    if (relRank & mask)
+      {
+      int dest = (relRank - mask + root) % nRanks;
+
+      BinaryStream str;
+      this->ToStream(str);
+
+      MPI_Send(str.GetData(), str.Size(), MPI_UNSIGNED_CHAR, dest,
+        QuantileSketchTag, comm);
+
+      break;
+      }
+    else if (relRank + mask < nRanks)
+      {
+      int src = (relRank + mask + root) % nRanks;
+
+      MPI_Status stat;
+      MPI_Probe(src, QuantileSketchTag, comm, &stat);
+
+      int nBytes = 0;
+      MPI_Get_count(&stat, MPI_UNSIGNED_CHAR, &nBytes);
+
+      BinaryStream str;
+      str.Resize(nBytes);
+      str.SetReadPos(0);
+      str.SetWritePos(nBytes);
+
+      MPI_Recv(str.GetData(), nBytes, MPI_UNSIGNED_CHAR, src,
+        QuantileSketchTag, comm, MPI_STATUS_IGNORE);
+
+      QuantileSketch other(this->K);
+      if (other.FromStream(str) || this->Merge(other))
+        {
+        SENSEI_ERROR("Failed to merge the sketch of rank " << src)
+        return -1;
+        }
+      }
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void QuantileSketch::GetSortedValues(
+  std::vector<std::pair<double, double>> &vals) const
+{
+  vals.clear();
+  vals.reserve(this->Size);
+
+  // a value at level h stands for 2^h of the inserted values
+  size_t nLevels = this->Levels.size();
+  for (size_t h = 0; h < nLevels; ++h)
+    {
+    double weight = std::ldexp(1.0, int(h));
+    for (double val : this->Levels[h])
+      vals.push_back(std::make_pair(val, weight));
+    }
+
+  std::sort(vals.begin(), vals.end());
+}
+
+// --------------------------------------------------------------------------
+double QuantileSketch::GetQuantile(double q) const
+{
+  if (this->Count == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  if (q <= 0.0)
+    return this->Min;
+
+  if (q >= 1.0)
+    return this->Max;
+
+  std::vector<std::pair<double, double>> vals;
+  this->GetSortedValues(vals);
+
+  double total = 0.0;
+  for (const auto &val : vals)
+    total += val.second;
+
+  double target = q*total;
+  double sum = 0.0;
+  for (const auto &val : vals)
+    {
+    sum += val.second;
+    if (sum >= target)
+      return val.first;
+    }
+
+  return this->Max;
+}
+
+// --------------------------------------------------------------------------
+int QuantileSketch::GetQuantiles(int n, std::vector<double> &result) const
+{
+  if (n < 2)
+    {
+    SENSEI_ERROR("Invalid number of quantiles " << n)
+    return -1;
+    }
+
+  if (this->Count == 0)
+    {
+    SENSEI_ERROR("The sketch is empty")
+    return -1;
+    }
+
+  std::vector<std::pair<double, double>> vals;
+  this->GetSortedValues(vals);
+
+  double total = 0.0;
+  for (const auto &val : vals)
+    total += val.second;
+
+  // the values and quantiles are both in ascending order, resolve all of
+  // them in one pass
+  result.resize(n);
+  result[0] = this->Min;
+  result[n - 1] = this->Max;
+
+  size_t nVals = vals.size();
+  size_t j = 0;
+  double sum = nVals ? vals[0].second : 0.0;
+  for (int i = 1; i < n - 1; ++i)
+    {
+    double target = total*double(i)/double(n - 1);
+    while ((sum < target) && (j + 1 < nVals))
+      {
+      ++j;
+      sum += vals[j].second;
+      }
+    result[i] = nVals ? vals[j].first : this->Max;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void QuantileSketch::ToStream(BinaryStream &str) const
+{
+  str.Pack(this->K);
+  str.Pack(this->Count);
+  str.Pack(this->Min);
+  str.Pack(this->Max);
+  str.Pack(this->Parity);
+
+  unsigned int nLevels = this->Levels.size();
+  str.Pack(nLevels);
+  for (unsigned int h = 0; h < nLevels; ++h)
+    str.Pack(this->Levels[h]);
+}
+
+// --------------------------------------------------------------------------
+int QuantileSketch::FromStream(BinaryStream &str)
+{
+  int k = 0;
+  str.Unpack(k);
+  if (k < 8)
+    {
+    SENSEI_ERROR("Invalid sketch size " << k)
+    return -1;
+    }
+
+  this->K = k;
+  str.Unpack(this->Count);
+  str.Unpack(this->Min);
+  str.Unpack(this->Max);
+  str.Unpack(this->Parity);
+
+  unsigned int nLevels = 0;
+  str.Unpack(nLevels);
+
+  this->Levels.resize(nLevels);
+  this->Size = 0;
+  this->MaxSize = 0;
+  for (unsigned int h = 0; h < nLevels; ++h)
+    {
+    str.Unpack(this->Levels[h]);
+    this->Size += this->Levels[h].size();
+    this->MaxSize += this->Capacity(h);
+    }
+
+  if (nLevels == 0)
+    this->Grow();
+
+  return 0;
+}
+
+}
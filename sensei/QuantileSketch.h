@@ -0,0 +1,152 @@
+#ifndef QuantileSketch_h
+#define QuantileSketch_h
+
+#include <mpi.h>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace sensei
+{
+class BinaryStream;
+
+/// A mergeable sketch for estimating the quantiles of distributed data
+/** The sketch estimates the quantiles of any number of values in a small,
+ * fixed amount of memory. It is a KLL style hierarchy of compactors. Values
+ * are inserted into the lowest level. When a level is full it is sorted and
+ * every other value is promoted to the next level, where each value stands
+ * for twice as many of the inserted values. Values are inserted in a single
+ * streaming pass without copying or sorting the data.
+ *
+ * Sketches built on different blocks or MPI ranks can be merged, and the
+ * error bound of the merged sketch is the same as that of a sketch built on
+ * all of the data. The sketches of all MPI ranks are merged with a single
+ * tree reduction, see Reduce.
+ *
+ * The size of the sketch, k, controls the accuracy. With high probability
+ * the rank of an estimated quantile is within about 1.7/k times the number of
+ * values of the true rank, see SizeForError. The sketch holds about 3k
+ * values. The minimum and maximum are tracked exactly.
+ *
+ * All methods returning int return 0 if successful.
+ */
+class QuantileSketch
+{
+public:
+  /// Creates an empty sketch of size k, k is at least 8
+  explicit QuantileSketch(int k = 200);
+
+  /** returns the size of the sketch with normalized rank error of at most
+   * eps, where eps is in (0, 1) */
+  static int SizeForError(double eps);
+
+  /// get the size of the sketch
+  int GetSize() const { return this->K; }
+
+  /// get the number of values inserted
+  unsigned long long GetCount() const { return this->Count; }
+
+  /// get the exact minimum of the values inserted
+  double GetMin() const { return this->Min; }
+
+  /// get the exact maximum of the values inserted
+  double GetMax() const { return this->Max; }
+
+  /// remove all values
+  void Clear();
+
+  /// insert a value. NaN's are skipped
+  void Insert(double val);
+
+  /** insert n values, skipping those where ghosts is non-zero. ghosts may be
+   * nullptr */
+  template <typename T>
+  void Insert(const T *vals, size_t n, const unsigned char *ghosts);
+
+  /// merge another sketch of the same size into this one
+  int Merge(const QuantileSketch &other);
+
+  /** merge the sketches of all ranks into the sketch of the root rank. This
+   * is a binomial tree reduction in which each rank sends its sketch once.
+   * This call uses MPI collectives, all ranks must participate. After this
+   * call returns only the root holds the merged sketch. */
+  int Reduce(MPI_Comm comm, int root);
+
+  /** estimate the value at the quantile q in [0, 1]. q of 0 and 1 give the
+   * exact minimum and maximum */
+  double GetQuantile(double q) const;
+
+  /** estimate the values at n evenly spaced quantiles, i/(n - 1) for i in 0
+   * to n - 1. This is the inverse of the cumulative distribution function.
+   * Fails if the sketch is empty */
+  int GetQuantiles(int n, std::vector<double> &vals) const;
+
+  /// serialize the sketch
+  void ToStream(BinaryStream &str) const;
+
+  /// deserialize the sketch
+  int FromStream(BinaryStream &str);
+
+private:
+  /// the number of values level h can hold before it is compacted
+  size_t Capacity(size_t h) const;
+
+  /// add a level to the top of the hierarchy
+  void Grow();
+
+  /// compact levels until the total size is within the capacity
+  void Compress();
+
+  /// sort the values with their weights
+  void GetSortedValues(std::vector<std::pair<double, double>> &vals) const;
+
+  int K;
+  unsigned long long Count;
+  double Min;
+  double Max;
+  size_t Size;
+  size_t MaxSize;
+  unsigned int Parity;
+  std::vector<std::vector<double>> Levels;
+};
+
+// --------------------------------------------------------------------------
+inline void QuantileSketch::Insert(double val)
+{
+  // NaN's have no place in the order
+  if (val != val)
+    return;
+
+  this->Min = val < this->Min ? val : this->Min;
+  this->Max = val > this->Max ? val : this->Max;
+
+  this->Levels[0].push_back(val);
+
+  this->Count += 1;
+  this->Size += 1;
+
+  if (this->Size >= this->MaxSize)
+    this->Compress();
+}
+
+// --------------------------------------------------------------------------
+template <typename T>
+void QuantileSketch::Insert(const T *vals, size_t n, const unsigned char *ghosts)
+{
+  if (ghosts)
+    {
+    for (size_t i = 0; i < n; ++i)
+      {
+      if (!ghosts[i])
+        this->Insert(double(vals[i]));
+      }
+    }
+  else
+    {
+    for (size_t i = 0; i < n; ++i)
+      this->Insert(double(vals[i]));
+    }
+}
+
+}
+#endif
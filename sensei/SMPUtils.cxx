@@ -0,0 +1,152 @@
+#include "SMPUtils.h"
+#include "MPIUtils.h"
+#include "Error.h"
+
+#include <svtkConfigure.h>
+
+#if defined(SVTK_SMP_OpenMP)
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <thread>
+
+namespace
+{
+// the number of threads per rank configured for SENSEI, and the cap on the
+// number of threads of any SENSEI component. zero means not configured.
+std::atomic<int> NumberOfThreads(0);
+std::atomic<int> MaxThreads(0);
+
+// --------------------------------------------------------------------------
+int GetThreadsPerRank(MPI_Comm comm)
+{
+  int nNodeRanks = 1;
+  int initialized = 0;
+  MPI_Initialized(&initialized);
+  if (initialized && (comm != MPI_COMM_NULL))
+    {
+    MPI_Comm nodeComm = MPI_COMM_NULL;
+    MPI_Comm leaderComm = MPI_COMM_NULL;
+    sensei::MPIUtils::GetHierarchicalComms(comm, nodeComm, leaderComm);
+    MPI_Comm_size(nodeComm, &nNodeRanks);
+    }
+
+  int nCores = std::thread::hardware_concurrency();
+  return std::max(1, nCores / nNodeRanks);
+}
+
+// --------------------------------------------------------------------------
+int Cap(int nThreads)
+{
+  int maxThreads = MaxThreads;
+  return std::max(1, maxThreads > 0 ? std::min(nThreads, maxThreads) : nThreads);
+}
+}
+
+namespace sensei
+{
+namespace SMPUtils
+{
+
+// --------------------------------------------------------------------------
+int Initialize(MPI_Comm comm, const std::string &backend, int nThreads,
+  int maxThreads)
+{
+  std::string compiled = SVTK_SMP_BACKEND;
+  std::string requested = backend;
+
+  std::transform(compiled.begin(), compiled.end(), compiled.begin(), ::tolower);
+  std::transform(requested.begin(), requested.end(), requested.begin(), ::tolower);
+
+  if (!requested.empty() && (requested != "auto") && (requested != compiled))
+    {
+    SENSEI_ERROR("The \"" << backend << "\" SMP backend was requested but the \""
+      << SVTK_SMP_BACKEND << "\" backend was compiled. The backend is selected "
+      "with the CMake variable SVTK_SMP_IMPLEMENTATION_TYPE")
+    return -1;
+    }
+
+  if ((nThreads < 0) || (maxThreads < 0))
+    {
+    SENSEI_ERROR("Invalid number of threads " << nThreads
+      << " or maximum number of threads " << maxThreads)
+    return -1;
+    }
+
+  MaxThreads = maxThreads;
+
+  int nThreadsUsed = ::Cap(nThreads > 0 ? nThreads : ::GetThreadsPerRank(comm));
+
+#if defined(SVTK_SMP_Sequential)
+  // the engines that manage their own threads still use nThreadsUsed
+  if (nThreads > 1)
+    {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0)
+      SENSEI_WARNING(<< nThreads << " threads were requested but the "
+        "Sequential SMP backend was compiled. Loops will run on one thread.")
+    }
+#elif defined(SVTK_SMP_TBB)
+  // TBB's scheduler is initialized once per process. The OpenMP backend is
+  // not initialized here since that would change the simulation's threads,
+  // see ThreadScope.
+  svtkSMPTools::Initialize(nThreadsUsed);
+#endif
+
+  NumberOfThreads = nThreadsUsed;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int GetNumberOfThreads()
+{
+#if defined(SVTK_SMP_Sequential)
+  return 1;
+#else
+  int nThreads = NumberOfThreads;
+  return nThreads > 0 ? nThreads : 1;
+#endif
+}
+
+// --------------------------------------------------------------------------
+int GetNumberOfThreads(int requested)
+{
+  if (requested > 0)
+    return ::Cap(requested);
+
+  // the count given to Initialize, even with the Sequential backend, or one
+  // when SENSEI's threads were not configured
+  int nThreads = NumberOfThreads;
+  return ::Cap(nThreads > 0 ? nThreads : 1);
+}
+
+// --------------------------------------------------------------------------
+const char *GetBackend()
+{
+  return SVTK_SMP_BACKEND;
+}
+
+// --------------------------------------------------------------------------
+ThreadScope::ThreadScope() : PreviousThreads(0)
+{
+#if defined(SVTK_SMP_OpenMP)
+  this->PreviousThreads = omp_get_max_threads();
+  omp_set_num_threads(GetNumberOfThreads());
+#endif
+}
+
+// --------------------------------------------------------------------------
+ThreadScope::~ThreadScope()
+{
+#if defined(SVTK_SMP_OpenMP)
+  omp_set_num_threads(this->PreviousThreads);
+#endif
+}
+
+}
+}
@@ -0,0 +1,142 @@
+#ifndef SMPUtils_h
+#define SMPUtils_h
+
+/// @file
+
+#include "senseiConfig.h"
+
+#include <svtkSMPTools.h>
+
+#include <mpi.h>
+#include <string>
+
+/// SENSEI
+namespace sensei
+{
+/** Functions for running loops in parallel on the threads of an MPI rank.
+ * The loops are executed by svtkSMPTools, whose backend (Sequential, OpenMP,
+ * or TBB) is selected when SENSEI is configured with the CMake variable
+ * SVTK_SMP_IMPLEMENTATION_TYPE. The number of threads used by SENSEI is set
+ * once, typically from the `smp-threads` and `smp-max-threads` attributes of
+ * the `<sensei>` XML root, and is independent of the number of threads used
+ * by the simulation. When the backend is OpenMP the number of threads is set
+ * only for the duration of SENSEI's parallel loops, the simulation's OpenMP
+ * settings are restored afterwards. Until Initialize is called loops run on
+ * one thread.
+ */
+namespace SMPUtils
+{
+
+/** Configure the threading layer.
+ *
+ * @param[in] comm       the communicator, used to count the ranks per node
+ * @param[in] backend    the expected backend, one of "sequential", "openmp",
+ *                       "tbb", or "auto" for whichever was compiled in. It is
+ *                       an error to request a backend that was not compiled.
+ * @param[in] nThreads   the number of threads per rank. Zero divides the
+ *                       node's cores evenly among the ranks on the node, as
+ *                       is done for `smp-threads="auto"`.
+ * @param[in] maxThreads an upper bound on the number of threads per rank, or
+ *                       zero for no bound. Use it to leave cores to the
+ *                       simulation.
+ * @returns zero if successful
+ */
+SENSEI_EXPORT
+int Initialize(MPI_Comm comm, const std::string &backend, int nThreads,
+  int maxThreads);
+
+/// get the number of threads used by SENSEI's parallel loops
+SENSEI_EXPORT
+int GetNumberOfThreads();
+
+/** Resolve the number of threads requested by a component that manages its
+ * own threads, such as the histogram and autocorrelation engines. A request
+ * less than one uses the count given to Initialize, or one thread when
+ * Initialize was not called. The result is capped by the maximum given to
+ * Initialize.
+ */
+SENSEI_EXPORT
+int GetNumberOfThreads(int requested);
+
+/// get the name of the compiled svtkSMPTools backend
+SENSEI_EXPORT
+const char *GetBackend();
+
+/** Sets the number of threads of the OpenMP backend for its lifetime, and
+ * restores the calling thread's previous setting on destruction. With the
+ * other backends this is a noop.
+ */
+class SENSEI_EXPORT ThreadScope
+{
+public:
+  ThreadScope();
+  ~ThreadScope();
+
+  ThreadScope(const ThreadScope &) = delete;
+  void operator=(const ThreadScope &) = delete;
+
+private:
+  int PreviousThreads;
+};
+
+/** Apply the functor to [first, last) in parallel, in ranges of about grain
+ * iterations. The functor is called with the bounds of each range. As with
+ * svtkSMPTools::For, the functor's Initialize method, if present, is called
+ * once per thread before its first range and its Reduce method, if present,
+ * is called once after all ranges complete. Ranges smaller than grain run on
+ * the calling thread.
+ */
+template <typename functor_t>
+void For(svtkIdType first, svtkIdType last, svtkIdType grain, functor_t &func)
+{
+  if ((GetNumberOfThreads() < 2) || (last - first <= grain))
+    {
+    svtkSMPTools::For(first, last, last - first, func);
+    return;
+    }
+
+  ThreadScope scope;
+  svtkSMPTools::For(first, last, grain, func);
+}
+
+/// @copydoc For
+template <typename functor_t>
+void For(svtkIdType first, svtkIdType last, svtkIdType grain,
+  const functor_t &func)
+{
+  if ((GetNumberOfThreads() < 2) || (last - first <= grain))
+    {
+    svtkSMPTools::For(first, last, last - first, func);
+    return;
+    }
+
+  ThreadScope scope;
+  svtkSMPTools::For(first, last, grain, func);
+}
+
+/// copy n values from src to dest in parallel
+template <typename data_t>
+void Copy(const data_t *src, data_t *dest, size_t n)
+{
+  SMPUtils::For(0, n, 65536, [src, dest](svtkIdType i0, svtkIdType i1)
+    {
+    for (svtkIdType i = i0; i < i1; ++i)
+      dest[i] = src[i];
+    });
+}
+
+/// set n values of dest to val in parallel
+template <typename data_t>
+void Fill(data_t *dest, size_t n, data_t val)
+{
+  SMPUtils::For(0, n, 65536, [dest, val](svtkIdType i0, svtkIdType i1)
+    {
+    for (svtkIdType i = i0; i < i1; ++i)
+      dest[i] = val;
+    });
+}
+
+}
+}
+
+#endif
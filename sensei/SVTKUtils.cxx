@@ -2,6 +2,7 @@
 #include "SVTKUtils.h"
 #include "MPIUtils.h"
 #include "MeshMetadata.h"
+#include "MemoryUtils.h"
 #include "Error.h"
 
 
@@ -64,6 +65,9 @@
 #include <svtkCallbackCommand.h>
 #include <svtkVersionMacros.h>
 #include <svtkType.h>
+#include <svtkInformation.h>
+#include <svtkInformationDoubleVectorKey.h>
+#include <svtkSMPThreadLocal.h>
 #if defined(ENABLE_VTK_IO)
 #include <vtkXMLUnstructuredGridWriter.h>
 #endif
@@ -125,6 +129,96 @@
 using svtkDataObjectPtr = svtkSmartPointer<svtkDataObject>;
 using svtkCompositeDataIteratorPtr = svtkSmartPointer<svtkCompositeDataIterator>;
 
+namespace
+{
+// the key under which an array's ghost masked range is cached in its
+// information, along with the modification times of the array and of the
+// ghost array it was computed at: {array MTime, ghost MTime, min, max}
+svtkInformationDoubleVectorKey *MASKED_RANGE()
+{
+  static svtkInformationDoubleVectorKey *key =
+    new svtkInformationDoubleVectorKey("MASKED_RANGE", "sensei::SVTKUtils", 4);
+  return key;
+}
+
+// an array whose range needs to be computed
+struct RangeArray
+{
+  int Id;
+  int Type;
+  int Stride;
+  bool Masked;
+  std::shared_ptr<const void> Data;
+};
+
+// --------------------------------------------------------------------------
+template <typename SVTK_TT>
+void UpdateRange(const SVTK_TT *data, int stride, const unsigned char *ghosts,
+  svtkIdType begin, svtkIdType end, std::array<double,2> &rng)
+{
+  // comparisons with NaN are false, NaNs are skipped
+  SVTK_TT mn = std::numeric_limits<SVTK_TT>::max();
+  SVTK_TT mx = std::numeric_limits<SVTK_TT>::lowest();
+  bool any = false;
+  for (svtkIdType i = begin; i < end; ++i)
+    {
+    if (ghosts && ghosts[i])
+      continue;
+
+    SVTK_TT val = data[i*stride];
+    mn = val < mn ? val : mn;
+    mx = val > mx ? val : mx;
+    any = true;
+    }
+
+  if (any)
+    {
+    rng[0] = std::min(rng[0], double(mn));
+    rng[1] = std::max(rng[1], double(mx));
+    }
+}
+
+// computes the ranges of a set of arrays in a single pass. the tuples are
+// split into chunks and each chunk is visited once for all of the arrays, so
+// the ghost array is read from cache
+struct RangeFunctor
+{
+  RangeFunctor(const std::vector<RangeArray> &arrays,
+    const unsigned char *ghosts) : Arrays(arrays), Ghosts(ghosts) {}
+
+  void Initialize()
+  {
+    this->Ranges.Local().assign(this->Arrays.size(),
+      {std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()});
+  }
+
+  void operator()(svtkIdType begin, svtkIdType end)
+  {
+    std::vector<std::array<double,2>> &rng = this->Ranges.Local();
+
+    size_t nArrays = this->Arrays.size();
+    for (size_t i = 0; i < nArrays; ++i)
+      {
+      const RangeArray &ra = this->Arrays[i];
+      const unsigned char *ghosts = ra.Masked ? this->Ghosts : nullptr;
+      switch (ra.Type)
+        {
+        svtkTemplateMacro(
+          ::UpdateRange(static_cast<const SVTK_TT*>(ra.Data.get()),
+            ra.Stride, ghosts, begin, end, rng[i]);
+          );
+        }
+      }
+  }
+
+  void Reduce() {}
+
+  const std::vector<RangeArray> &Arrays;
+  const unsigned char *Ghosts;
+  svtkSMPThreadLocal<std::vector<std::array<double,2>>> Ranges;
+};
+}
+
 namespace sensei
 {
 namespace SVTKUtils
@@ -178,6 +272,32 @@ unsigned int Size(int svtkt)
   return 0;
 }
 
+// --------------------------------------------------------------------------
+void *GetAOSPointer(svtkDataArray *da, svtkSmartPointer<svtkDataArray> &aos)
+{
+  aos = nullptr;
+
+  // SOA arrays would make the same copy in GetVoidPointer, with a warning,
+  // and keep it until the array is deleted
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      if (svtkSOADataArrayTemplate<SVTK_TT> *soa =
+        dynamic_cast<svtkSOADataArrayTemplate<SVTK_TT>*>(da))
+        {
+        if (soa->GetNumberOfComponents() == 1)
+          return soa->GetComponentArrayPointer(0);
+
+        aos.TakeReference(svtkAOSDataArrayTemplate<SVTK_TT>::New());
+        aos->DeepCopy(soa);
+        return aos->GetVoidPointer(0);
+        }
+      );
+    }
+
+  return da->GetVoidPointer(0);
+}
+
 // --------------------------------------------------------------------------
 int IsLegacyDataObject(int code)
 {
@@ -626,19 +746,150 @@ int GetArrayMetadata(svtkDataSetAttributes *dsa, int centering,
 }
 
 // --------------------------------------------------------------------------
-int GetArrayMetadata(svtkDataSetAttributes *dsa,
-  std::vector<std::array<double,2>> &arrayRange)
+int GetArrayRanges(svtkDataSetAttributes *dsa,
+  std::vector<std::array<double,2>> &ranges)
 {
   int na = dsa->GetNumberOfArrays();
+  svtkIdType nTuples = dsa->GetNumberOfTuples();
+
+  size_t r0 = ranges.size();
+  ranges.resize(r0 + na, {std::numeric_limits<double>::max(),
+    std::numeric_limits<double>::lowest()});
+
+  svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
+    dsa->GetAbstractArray("svtkGhostType"));
+
+  if (ghostArray && (ghostArray->GetNumberOfTuples() < nTuples))
+    ghostArray = nullptr;
+
+  double ghostMTime = ghostArray ? ghostArray->GetMTime() : 0.0;
+
+  // use cached values, collect the arrays whose ranges need computing
+  std::vector<RangeArray> arrays;
+  std::vector<int> others;
   for (int i = 0; i < na; ++i)
     {
     svtkDataArray *da = dsa->GetArray(i);
+    if (!da)
+      continue;
+
+    bool masked = ghostArray && (da != ghostArray);
+
+    double arrayMTime = da->GetMTime();
+    double maskMTime = masked ? ghostMTime : 0.0;
+
+    svtkInformation *info = da->GetInformation();
+    if (info->Has(MASKED_RANGE()))
+      {
+      const double *cached = info->Get(MASKED_RANGE());
+      if ((cached[0] == arrayMTime) && (cached[1] == maskMTime))
+        {
+        ranges[r0 + i] = {cached[2], cached[3]};
+        continue;
+        }
+      }
+
+    if (da->GetNumberOfTuples() < nTuples)
+      {
+      others.push_back(i);
+      continue;
+      }
 
-    double rng[2];
-    da->GetRange(rng);
+    // the range of the first component, as returned by svtkDataArray::GetRange
+    RangeArray ra;
+    ra.Id = i;
+    ra.Type = da->GetDataType();
+    ra.Stride = 1;
+    ra.Masked = masked;
 
-    arrayRange.emplace_back(std::array<double,2>({rng[0], rng[1]}));
+    switch (ra.Type)
+      {
+      svtkTemplateMacro(
+        SVTK_TT *ptr = nullptr;
+        if (svtkAOSDataArrayTemplate<SVTK_TT> *aos =
+          dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da))
+          {
+          ptr = aos->GetPointer(0);
+          ra.Stride = da->GetNumberOfComponents();
+          }
+        else if (svtkSOADataArrayTemplate<SVTK_TT> *soa =
+          dynamic_cast<svtkSOADataArrayTemplate<SVTK_TT>*>(da))
+          {
+          ptr = soa->GetComponentArrayPointer(0);
+          }
+        if (ptr)
+          ra.Data = MemoryUtils::MakeCpuAccessible(ptr, nTuples*ra.Stride);
+        );
+      }
+
+    if (ra.Data)
+      arrays.push_back(ra);
+    else
+      others.push_back(i);
     }
+
+  std::shared_ptr<const unsigned char> ghosts;
+  if (ghostArray && (arrays.size() + others.size()))
+    ghosts = MemoryUtils::MakeCpuAccessible(ghostArray->GetPointer(0), nTuples);
+
+  // make a single pass over the tuples for all of the arrays
+  if (!arrays.empty() && (nTuples > 0))
+    {
+    RangeFunctor rangeFunctor(arrays, ghosts.get());
+    SMPUtils::For(0, nTuples, 16384, rangeFunctor);
+
+    size_t nArrays = arrays.size();
+    for (svtkSMPThreadLocal<std::vector<std::array<double,2>>>::iterator
+      it = rangeFunctor.Ranges.begin(); it != rangeFunctor.Ranges.end(); ++it)
+      {
+      for (size_t j = 0; j < nArrays; ++j)
+        {
+        std::array<double,2> &rng = ranges[r0 + arrays[j].Id];
+        rng[0] = std::min(rng[0], (*it)[j][0]);
+        rng[1] = std::max(rng[1], (*it)[j][1]);
+        }
+      }
+    }
+
+  // arrays in other layouts go through the virtual API
+  size_t nOthers = others.size();
+  for (size_t j = 0; j < nOthers; ++j)
+    {
+    int i = others[j];
+    svtkDataArray *da = dsa->GetArray(i);
+    std::array<double,2> &rng = ranges[r0 + i];
+
+    if (!ghostArray || (da == ghostArray) || (da->GetNumberOfTuples() < nTuples))
+      {
+      da->GetRange(rng.data());
+      continue;
+      }
+
+    for (svtkIdType k = 0; k < nTuples; ++k)
+      {
+      if (ghosts.get()[k])
+        continue;
+
+      double val = da->GetComponent(k, 0);
+      rng[0] = val < rng[0] ? val : rng[0];
+      rng[1] = val > rng[1] ? val : rng[1];
+      }
+    }
+
+  // cache the results for the next request
+  for (int i = 0; i < na; ++i)
+    {
+    svtkDataArray *da = dsa->GetArray(i);
+    if (!da)
+      continue;
+
+    bool masked = ghostArray && (da != ghostArray);
+    double cached[4] = {double(da->GetMTime()), masked ? ghostMTime : 0.0,
+      ranges[r0 + i][0], ranges[r0 + i][1]};
+
+    da->GetInformation()->Set(MASKED_RANGE(), cached, 4);
+    }
+
   return 0;
 }
 
@@ -735,8 +986,8 @@ int GetBlockMetadata(int rank, int id, svtkDataSet *ds,
   if (flags.BlockArrayRangeSet())
     {
     std::vector<std::array<double,2>> arrayRange;
-    GetArrayMetadata(ds->GetPointData(), arrayRange);
-    GetArrayMetadata(ds->GetCellData(), arrayRange);
+    GetArrayRanges(ds->GetPointData(), arrayRange);
+    GetArrayRanges(ds->GetCellData(), arrayRange);
     blockArrayRange.emplace_back(std::move(arrayRange));
     }
 
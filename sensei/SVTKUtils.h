@@ -4,6 +4,7 @@
 /// @file
 
 #include "MeshMetadata.h"
+#include "SMPUtils.h"
 #include "Error.h"
 
 class svtkDataSet;
@@ -127,6 +128,14 @@ SVTK_TT *GetPointer(svtkDataArray *da)
   return nullptr;
 }
 
+/** given a svtkDataArray get a pointer to its values in AOS order. The
+ * values of SOA arrays with more than one component are interleaved into a
+ * copy held by aos, which must be kept while the pointer is in use. Otherwise
+ * no copy is made and aos is left empty.
+ */
+SENSEI_EXPORT
+void *GetAOSPointer(svtkDataArray *da, svtkSmartPointer<svtkDataArray> &aos);
+
 /// given a SVTK type enum returns the sizeof that type
 SENSEI_EXPORT
 unsigned int Size(int svtkt);
@@ -190,6 +199,16 @@ SENSEI_EXPORT
 int GetGhostLayerMetadata(svtkDataObject *mesh,
   int &nGhostCellLayers, int &nGhostNodeLayers);
 
+/** Compute the range of the first component of each array, appending one
+ * entry per array. Values flagged in the svtkGhostType array of the same
+ * attributes are skipped. All of the arrays are visited in a single pass
+ * parallelized with svtkSMPTools. Results are cached in each array's
+ * information and reused until the array or the ghost array is modified.
+ */
+SENSEI_EXPORT
+int GetArrayRanges(svtkDataSetAttributes *dsa,
+  std::vector<std::array<double,2>> &ranges);
+
 /*** Get  metadata, note that data set variant is not meant to be used on blocks
  * of a multi-block
  */
@@ -261,7 +280,8 @@ int WriteDomainDecomp(MPI_Comm comm, const sensei::MeshMetadataPtr &md,
 
 /** Packs data from a cell array into another cell array keeping track of
  * where to insert into the output array. Use it to serialze verys, lines, polys
- * strips form a polytdata into a single cell array for transport
+ * strips form a polytdata into a single cell array for transport. The copies
+ * are made in parallel by SMPUtils.
  */
 template <typename SVTK_TT, typename ARRAY_TT = svtkAOSDataArrayTemplate<SVTK_TT>>
 void PackCells(ARRAY_TT *coIn, ARRAY_TT *ccIn, ARRAY_TT *coOut, ARRAY_TT *ccOut,
@@ -272,8 +292,7 @@ void PackCells(ARRAY_TT *coIn, ARRAY_TT *ccIn, ARRAY_TT *coOut, ARRAY_TT *ccOut,
   const SVTK_TT *pSrc = coIn->GetPointer(0);
   SVTK_TT *pDest = coOut->GetPointer(0);
 
-  for (size_t i = 0; i < nOffs; ++i)
-    pDest[coId + i] = pSrc[i];
+  SMPUtils::Copy(pSrc, pDest + coId, nOffs);
 
   // update cell id
   coId += nOffs;
@@ -283,8 +302,7 @@ void PackCells(ARRAY_TT *coIn, ARRAY_TT *ccIn, ARRAY_TT *coOut, ARRAY_TT *ccOut,
   pSrc = ccIn->GetPointer(0);
   pDest = ccOut->GetPointer(0);
 
-  for (size_t i = 0; i < nConn; ++i)
-    pDest[ccId + i] = pSrc[i];
+  SMPUtils::Copy(pSrc, pDest + ccId, nConn);
 
   // update conn id
   ccId += nConn;
@@ -305,8 +323,7 @@ void UnpackCells(size_t nc, ARRAY_TT *coIn, ARRAY_TT *ccIn,
   coOut->SetNumberOfTuples(nCo);
   SVTK_TT *pCoOut = coOut->GetPointer(0);
 
-  for (size_t i = 0; i < nCo; ++i)
-    pCoOut[i] = pCoIn[coId + i];
+  SMPUtils::Copy(pCoIn + coId, pCoOut, nCo);
 
   coId += nCo;
 
@@ -321,8 +338,7 @@ void UnpackCells(size_t nc, ARRAY_TT *coIn, ARRAY_TT *ccIn,
     ccOut->SetNumberOfTuples(nCc);
     SVTK_TT *pCcOut = ccOut->GetPointer(0);
 
-    for (size_t i = 0; i < nCc; ++i)
-      pCcOut[i] = pCcIn[ccId + i];
+    SMPUtils::Copy(pCcIn + ccId, pCcOut, nCc);
 
     ccId += nCc;
     }
@@ -0,0 +1,1146 @@
+#include "SharedMemoryDataAdaptor.h"
+#include "BinaryStream.h"
+#include "DataRequirements.h"
+#include "MeshMetadata.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAbstractArray.h>
+#include <svtkCellArray.h>
+#include <svtkCellData.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkFieldData.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkObjectFactory.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkPolyData.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkSmartPointer.h>
+#include <svtkSOADataArrayTemplate.h>
+#include <svtkStructuredGrid.h>
+#include <svtkUnsignedCharArray.h>
+#include <svtkUnstructuredGrid.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <tuple>
+#include <utility>
+
+using svtkDataObjectPtr = svtkSmartPointer<svtkDataObject>;
+using svtkDataArrayPtr = svtkSmartPointer<svtkDataArray>;
+using svtkCompositeDataIteratorPtr = svtkSmartPointer<svtkCompositeDataIterator>;
+
+namespace
+{
+// (mesh name, association, array name)
+using ArrayKey = std::tuple<std::string, int, std::string>;
+
+// the layout of an array's values in the segment
+enum {LAYOUT_AOS=0, LAYOUT_SOA=1};
+
+// an array to copy into the segment
+struct CopyJob
+{
+  svtkDataArray *Array;
+  unsigned long Offset;
+  int Layout;
+};
+
+// array data is aligned for vectorized access
+const unsigned long Alignment = 64;
+
+// identifies the format of the header
+const unsigned int Version = 1;
+
+// --------------------------------------------------------------------------
+unsigned long Align(unsigned long n)
+{
+  return ((n + Alignment - 1)/Alignment)*Alignment;
+}
+
+// --------------------------------------------------------------------------
+bool IsSOA(svtkDataArray *da)
+{
+  bool soa = false;
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      soa = dynamic_cast<svtkSOADataArrayTemplate<SVTK_TT>*>(da) != nullptr;
+      );
+    }
+  return soa;
+}
+
+// **************************************************************************
+void WriteArray(sensei::BinaryStream &str, svtkAbstractArray *aa,
+  unsigned long &nBytes, std::vector<CopyJob> &jobs)
+{
+  // only data arrays are passed, the others are skipped
+  svtkDataArray *da = dynamic_cast<svtkDataArray*>(aa);
+
+  int present = da ? 1 : 0;
+  str.Pack(present);
+
+  if (!da)
+    return;
+
+  const char *name = da->GetName();
+  int layout = IsSOA(da) ? LAYOUT_SOA : LAYOUT_AOS;
+  long nTuples = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+
+  str.Pack(std::string(name ? name : ""));
+  str.Pack(da->GetDataType());
+  str.Pack(nTuples);
+  str.Pack(nComps);
+  str.Pack(layout);
+  str.Pack(nBytes);
+
+  jobs.push_back({da, nBytes, layout});
+
+  nBytes += Align(nTuples*nComps*da->GetDataTypeSize());
+}
+
+// **************************************************************************
+void WriteArrays(sensei::BinaryStream &str, svtkFieldData *fd,
+  unsigned long &nBytes, std::vector<CopyJob> &jobs)
+{
+  int nArrays = fd->GetNumberOfArrays();
+  str.Pack(nArrays);
+
+  for (int i = 0; i < nArrays; ++i)
+    WriteArray(str, fd->GetAbstractArray(i), nBytes, jobs);
+}
+
+// **************************************************************************
+void WriteCells(sensei::BinaryStream &str, svtkCellArray *cells,
+  unsigned long &nBytes, std::vector<CopyJob> &jobs)
+{
+  WriteArray(str, cells ? cells->GetOffsetsArray() : nullptr, nBytes, jobs);
+  WriteArray(str, cells ? cells->GetConnectivityArray() : nullptr, nBytes, jobs);
+}
+
+// **************************************************************************
+int WriteObject(sensei::BinaryStream &str, svtkDataObject *dobj,
+  unsigned long &nBytes, std::vector<CopyJob> &jobs)
+{
+  int type = dobj ? dobj->GetDataObjectType() : -1;
+  str.Pack(type);
+
+  // it is not an error for a rank to have no data
+  if (!dobj)
+    return 0;
+
+  if (svtkMultiBlockDataSet *mb = dynamic_cast<svtkMultiBlockDataSet*>(dobj))
+    {
+    unsigned int nBlocks = mb->GetNumberOfBlocks();
+    str.Pack(nBlocks);
+
+    for (unsigned int i = 0; i < nBlocks; ++i)
+      {
+      if (WriteObject(str, mb->GetBlock(i), nBytes, jobs))
+        return -1;
+      }
+
+    WriteArrays(str, mb->GetFieldData(), nBytes, jobs);
+    return 0;
+    }
+
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj);
+  if (!ds)
+    {
+    SENSEI_ERROR(<< dobj->GetClassName() << " is not supported")
+    return -1;
+    }
+
+  if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+    {
+    str.Pack(im->GetExtent(), 6);
+    str.Pack(im->GetOrigin(), 3);
+    str.Pack(im->GetSpacing(), 3);
+    }
+  else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+    {
+    str.Pack(rg->GetExtent(), 6);
+    WriteArray(str, rg->GetXCoordinates(), nBytes, jobs);
+    WriteArray(str, rg->GetYCoordinates(), nBytes, jobs);
+    WriteArray(str, rg->GetZCoordinates(), nBytes, jobs);
+    }
+  else if (svtkStructuredGrid *sg = dynamic_cast<svtkStructuredGrid*>(ds))
+    {
+    str.Pack(sg->GetExtent(), 6);
+    svtkPoints *pts = sg->GetPoints();
+    WriteArray(str, pts ? pts->GetData() : nullptr, nBytes, jobs);
+    }
+  else if (svtkPolyData *pd = dynamic_cast<svtkPolyData*>(ds))
+    {
+    svtkPoints *pts = pd->GetPoints();
+    WriteArray(str, pts ? pts->GetData() : nullptr, nBytes, jobs);
+    WriteCells(str, pd->GetVerts(), nBytes, jobs);
+    WriteCells(str, pd->GetLines(), nBytes, jobs);
+    WriteCells(str, pd->GetPolys(), nBytes, jobs);
+    WriteCells(str, pd->GetStrips(), nBytes, jobs);
+    }
+  else if (svtkUnstructuredGrid *ug = dynamic_cast<svtkUnstructuredGrid*>(ds))
+    {
+    svtkPoints *pts = ug->GetPoints();
+    WriteArray(str, pts ? pts->GetData() : nullptr, nBytes, jobs);
+    WriteArray(str, ug->GetCellTypesArray(), nBytes, jobs);
+    WriteCells(str, ug->GetCells(), nBytes, jobs);
+    }
+  else
+    {
+    SENSEI_ERROR(<< ds->GetClassName() << " is not supported")
+    return -1;
+    }
+
+  WriteArrays(str, ds->GetPointData(), nBytes, jobs);
+  WriteArrays(str, ds->GetCellData(), nBytes, jobs);
+  WriteArrays(str, ds->GetFieldData(), nBytes, jobs);
+
+  return 0;
+}
+
+// **************************************************************************
+void CopyArray(const CopyJob &job, unsigned char *data)
+{
+  svtkDataArray *da = job.Array;
+
+  unsigned char *dest = data + job.Offset;
+  unsigned long nTuples = da->GetNumberOfTuples();
+  unsigned long nComps = da->GetNumberOfComponents();
+  unsigned long nBytes = nTuples*nComps*da->GetDataTypeSize();
+
+  if (job.Layout == LAYOUT_SOA)
+    {
+    // one contiguous run of values per component
+    switch (da->GetDataType())
+      {
+      svtkTemplateMacro(
+        svtkSOADataArrayTemplate<SVTK_TT> *soa =
+          dynamic_cast<svtkSOADataArrayTemplate<SVTK_TT>*>(da);
+
+        for (unsigned long j = 0; j < nComps; ++j)
+          memcpy(dest + j*nTuples*sizeof(SVTK_TT),
+            soa->GetComponentArrayPointer(j), nTuples*sizeof(SVTK_TT));
+        );
+      }
+    }
+  else if (da->HasStandardMemoryLayout())
+    {
+    memcpy(dest, da->GetVoidPointer(0), nBytes);
+    }
+  else
+    {
+    // convert to the array of structures layout
+    svtkDataArrayPtr tmp;
+    tmp.TakeReference(svtkDataArray::CreateDataArray(da->GetDataType()));
+    tmp->DeepCopy(da);
+    memcpy(dest, tmp->GetVoidPointer(0), nBytes);
+    }
+}
+
+// **************************************************************************
+svtkDataArray *ReadArray(sensei::BinaryStream &str, unsigned char *data)
+{
+  int present = 0;
+  str.Unpack(present);
+
+  if (!present)
+    return nullptr;
+
+  std::string name;
+  int type = 0;
+  long nTuples = 0;
+  int nComps = 0;
+  int layout = 0;
+  unsigned long offset = 0;
+
+  str.Unpack(name);
+  str.Unpack(type);
+  str.Unpack(nTuples);
+  str.Unpack(nComps);
+  str.Unpack(layout);
+  str.Unpack(offset);
+
+  // the arrays point into the segment, which they do not free
+  svtkDataArray *da = nullptr;
+  if (layout == LAYOUT_SOA)
+    {
+    switch (type)
+      {
+      svtkTemplateMacro(
+        svtkSOADataArrayTemplate<SVTK_TT> *soa =
+          svtkSOADataArrayTemplate<SVTK_TT>::New();
+
+        soa->SetNumberOfComponents(nComps);
+
+        SVTK_TT *vals = reinterpret_cast<SVTK_TT*>(data + offset);
+        for (int j = 0; j < nComps; ++j)
+          soa->SetArray(j, vals + j*nTuples, nTuples, true, true);
+
+        da = soa;
+        );
+      }
+    }
+  else
+    {
+    da = svtkDataArray::CreateDataArray(type);
+    da->SetNumberOfComponents(nComps);
+    da->SetVoidArray(data + offset, nTuples*nComps, 1);
+    }
+
+  if (da && !name.empty())
+    da->SetName(name.c_str());
+
+  return da;
+}
+
+// **************************************************************************
+void ReadArrays(sensei::BinaryStream &str, unsigned char *data,
+  svtkFieldData *fd)
+{
+  int nArrays = 0;
+  str.Unpack(nArrays);
+
+  for (int i = 0; i < nArrays; ++i)
+    {
+    if (svtkDataArray *da = ReadArray(str, data))
+      {
+      fd->AddArray(da);
+      da->Delete();
+      }
+    }
+}
+
+// **************************************************************************
+svtkPoints *ReadPoints(sensei::BinaryStream &str, unsigned char *data)
+{
+  svtkDataArray *da = ReadArray(str, data);
+  if (!da)
+    return nullptr;
+
+  svtkPoints *pts = svtkPoints::New();
+  pts->SetData(da);
+  da->Delete();
+
+  return pts;
+}
+
+// **************************************************************************
+svtkCellArray *ReadCells(sensei::BinaryStream &str, unsigned char *data)
+{
+  svtkDataArrayPtr offsets;
+  offsets.TakeReference(ReadArray(str, data));
+
+  svtkDataArrayPtr conn;
+  conn.TakeReference(ReadArray(str, data));
+
+  svtkCellArray *cells = svtkCellArray::New();
+  if (offsets && conn && !cells->SetData(offsets, conn))
+    {
+    SENSEI_ERROR("Failed to read cells")
+    }
+
+  return cells;
+}
+
+// **************************************************************************
+int ReadObject(sensei::BinaryStream &str, unsigned char *data,
+  svtkDataObject *&dobj)
+{
+  dobj = nullptr;
+
+  int type = 0;
+  str.Unpack(type);
+
+  // it is not an error for a rank to have no data
+  if (type < 0)
+    return 0;
+
+  if (type == SVTK_MULTIBLOCK_DATA_SET)
+    {
+    unsigned int nBlocks = 0;
+    str.Unpack(nBlocks);
+
+    svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+    mb->SetNumberOfBlocks(nBlocks);
+
+    for (unsigned int i = 0; i < nBlocks; ++i)
+      {
+      svtkDataObject *block = nullptr;
+      if (ReadObject(str, data, block))
+        {
+        mb->Delete();
+        return -1;
+        }
+
+      if (block)
+        {
+        mb->SetBlock(i, block);
+        block->Delete();
+        }
+      }
+
+    ReadArrays(str, data, mb->GetFieldData());
+
+    dobj = mb;
+    return 0;
+    }
+
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(sensei::SVTKUtils::NewDataObject(type));
+  if (!ds)
+    {
+    SENSEI_ERROR("Data object type " << type << " is not supported")
+    return -1;
+    }
+
+  if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+    {
+    int ext[6] = {0};
+    double origin[3] = {0.0};
+    double spacing[3] = {0.0};
+
+    str.Unpack(ext, 6);
+    str.Unpack(origin, 3);
+    str.Unpack(spacing, 3);
+
+    im->SetExtent(ext);
+    im->SetOrigin(origin);
+    im->SetSpacing(spacing);
+    }
+  else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+    {
+    int ext[6] = {0};
+    str.Unpack(ext, 6);
+    rg->SetExtent(ext);
+
+    svtkDataArrayPtr coords[3];
+    for (int i = 0; i < 3; ++i)
+      coords[i].TakeReference(ReadArray(str, data));
+
+    rg->SetXCoordinates(coords[0]);
+    rg->SetYCoordinates(coords[1]);
+    rg->SetZCoordinates(coords[2]);
+    }
+  else if (svtkStructuredGrid *sg = dynamic_cast<svtkStructuredGrid*>(ds))
+    {
+    int ext[6] = {0};
+    str.Unpack(ext, 6);
+    sg->SetExtent(ext);
+
+    if (svtkPoints *pts = ReadPoints(str, data))
+      {
+      sg->SetPoints(pts);
+      pts->Delete();
+      }
+    }
+  else if (svtkPolyData *pd = dynamic_cast<svtkPolyData*>(ds))
+    {
+    if (svtkPoints *pts = ReadPoints(str, data))
+      {
+      pd->SetPoints(pts);
+      pts->Delete();
+      }
+
+    svtkCellArray *cells[4] = {nullptr};
+    for (int i = 0; i < 4; ++i)
+      cells[i] = ReadCells(str, data);
+
+    pd->SetVerts(cells[0]);
+    pd->SetLines(cells[1]);
+    pd->SetPolys(cells[2]);
+    pd->SetStrips(cells[3]);
+
+    for (int i = 0; i < 4; ++i)
+      cells[i]->Delete();
+    }
+  else if (svtkUnstructuredGrid *ug = dynamic_cast<svtkUnstructuredGrid*>(ds))
+    {
+    if (svtkPoints *pts = ReadPoints(str, data))
+      {
+      ug->SetPoints(pts);
+      pts->Delete();
+      }
+
+    svtkDataArrayPtr types;
+    types.TakeReference(ReadArray(str, data));
+
+    svtkCellArray *cells = ReadCells(str, data);
+
+    if (svtkUnsignedCharArray *uca = dynamic_cast<svtkUnsignedCharArray*>(types.Get()))
+      ug->SetCells(uca, cells);
+
+    cells->Delete();
+    }
+  else
+    {
+    SENSEI_ERROR(<< ds->GetClassName() << " is not supported")
+    ds->Delete();
+    return -1;
+    }
+
+  ReadArrays(str, data, ds->GetPointData());
+  ReadArrays(str, data, ds->GetCellData());
+  ReadArrays(str, data, ds->GetFieldData());
+
+  dobj = ds;
+  return 0;
+}
+
+// **************************************************************************
+svtkDataObject *NewMesh(svtkDataObject *dobj, bool structureOnly)
+{
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj))
+    {
+    svtkCompositeDataSet *cdo = cd->NewInstance();
+    cdo->CopyStructure(cd);
+
+    svtkCompositeDataIteratorPtr cdit;
+    cdit.TakeReference(cd->NewIterator());
+    for (cdit->InitTraversal(); !cdit->IsDoneWithTraversal(); cdit->GoToNextItem())
+      {
+      svtkDataObject *leaf = NewMesh(cd->GetDataSet(cdit), structureOnly);
+      cdo->SetDataSet(cdit, leaf);
+      leaf->Delete();
+      }
+
+    cdo->GetFieldData()->ShallowCopy(cd->GetFieldData());
+
+    return cdo;
+    }
+
+  svtkDataObject *dobjo = dobj->NewInstance();
+
+  if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj))
+    {
+    if (!structureOnly)
+      static_cast<svtkDataSet*>(dobjo)->CopyStructure(ds);
+    }
+
+  // field data carries the ghost layer metadata
+  dobjo->GetFieldData()->ShallowCopy(dobj->GetFieldData());
+
+  return dobjo;
+}
+}
+
+namespace sensei
+{
+
+struct SharedMemoryDataAdaptor::InternalsType
+{
+  InternalsType() : Fd(-1), Data(nullptr), Size(0), Owner(false) {}
+
+  // create, grow, or map the segment so that at least nBytes are mapped
+  int Map(unsigned long nBytes, bool create);
+
+  // unmap the segment, and when we created it remove it
+  int Unmap();
+
+  std::string Name;
+  int Fd;
+  unsigned char *Data;
+  unsigned long Size;
+  bool Owner;
+
+  std::vector<MeshMetadataPtr> Metadata;
+  std::map<std::string, std::pair<svtkDataObjectPtr, bool>> Meshes;
+  std::set<ArrayKey> Arrays;
+};
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::InternalsType::Map(unsigned long nBytes,
+  bool create)
+{
+  if (this->Data && (this->Size >= nBytes))
+    return 0;
+
+  if (this->Name.empty())
+    {
+    SENSEI_ERROR("The shared memory segment name was not set")
+    return -1;
+    }
+
+  if (this->Fd < 0)
+    {
+    this->Fd = shm_open(this->Name.c_str(),
+      create ? O_CREAT | O_RDWR : O_RDWR, S_IRUSR | S_IWUSR);
+
+    if (this->Fd < 0)
+      {
+      const char *estr = strerror(errno);
+      SENSEI_ERROR("Failed to open the shared memory segment \""
+        << this->Name << "\"" << std::endl << estr)
+      return -1;
+      }
+
+    this->Owner = create;
+    }
+
+  unsigned long newSize = nBytes;
+  if (create)
+    {
+    // leave room for growth so the segment is not resized every step
+    newSize = std::max(nBytes, this->Size + this->Size/4);
+    if (ftruncate(this->Fd, newSize))
+      {
+      const char *estr = strerror(errno);
+      SENSEI_ERROR("Failed to resize the shared memory segment \""
+        << this->Name << "\" to " << newSize << " bytes" << std::endl << estr)
+      return -1;
+      }
+    }
+  else
+    {
+    // map all of what the producer allocated
+    struct stat st;
+    if (fstat(this->Fd, &st) || (st.st_size < long(nBytes)))
+      {
+      SENSEI_ERROR("The shared memory segment \"" << this->Name
+        << "\" is smaller than " << nBytes << " bytes")
+      return -1;
+      }
+    newSize = st.st_size;
+    }
+
+  if (this->Data)
+    munmap(this->Data, this->Size);
+
+  void *data = mmap(nullptr, newSize, PROT_READ | PROT_WRITE,
+    MAP_SHARED, this->Fd, 0);
+
+  if (data == MAP_FAILED)
+    {
+    const char *estr = strerror(errno);
+    SENSEI_ERROR("Failed to map " << newSize << " bytes of the shared memory "
+      "segment \"" << this->Name << "\"" << std::endl << estr)
+    this->Data = nullptr;
+    this->Size = 0;
+    return -1;
+    }
+
+  this->Data = static_cast<unsigned char*>(data);
+  this->Size = newSize;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::InternalsType::Unmap()
+{
+  if (this->Data)
+    munmap(this->Data, this->Size);
+
+  if (this->Fd >= 0)
+    close(this->Fd);
+
+  if (this->Owner)
+    shm_unlink(this->Name.c_str());
+
+  this->Data = nullptr;
+  this->Size = 0;
+  this->Fd = -1;
+  this->Owner = false;
+
+  return 0;
+}
+
+
+
+//----------------------------------------------------------------------------
+senseiNewMacro(SharedMemoryDataAdaptor);
+
+//----------------------------------------------------------------------------
+SharedMemoryDataAdaptor::SharedMemoryDataAdaptor() :
+  Internals(new InternalsType)
+{
+}
+
+//----------------------------------------------------------------------------
+SharedMemoryDataAdaptor::~SharedMemoryDataAdaptor()
+{
+  this->ReleaseData();
+  this->Internals->Unmap();
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::SetSegmentName(const std::string &name)
+{
+  if (name.empty() || (name[0] != '/'))
+    {
+    SENSEI_ERROR("Invalid shared memory segment name \"" << name
+      << "\". The name must begin with a '/'")
+    return -1;
+    }
+
+  if (this->Internals->Fd >= 0)
+    {
+    SENSEI_ERROR("The shared memory segment \"" << this->Internals->Name
+      << "\" is already open")
+    return -1;
+    }
+
+  this->Internals->Name = name;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+const std::string &SharedMemoryDataAdaptor::GetSegmentName() const
+{
+  return this->Internals->Name;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::Write(DataAdaptor *source,
+  const DataRequirements &reqs, unsigned long &nBytes)
+{
+  TimeEvent<128> mark("SharedMemoryDataAdaptor::Write");
+
+  nBytes = 0;
+
+  if (!source)
+    {
+    SENSEI_ERROR("No data adaptor was provided")
+    return -1;
+    }
+
+  unsigned int nMeshes = 0;
+  if (source->GetNumberOfMeshes(nMeshes))
+    {
+    SENSEI_ERROR("Failed to get the number of meshes")
+    return -1;
+    }
+
+  MeshMetadataFlags flags;
+  flags.SetAll();
+
+  unsigned int nRequired = reqs.GetNumberOfRequiredMeshes();
+  unsigned int nFound = 0;
+
+  // the header describes the meshes and locates their arrays in the
+  // data section which follows it
+  BinaryStream str;
+  str.Pack(Version);
+  str.Pack(source->GetDataTime());
+  str.Pack(source->GetDataTimeStep());
+
+  std::vector<MeshMetadataPtr> metadata;
+  std::vector<std::pair<int, std::vector<std::pair<int, std::string>>>> meshArrays;
+  std::vector<svtkDataObjectPtr> meshes;
+
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    MeshMetadataPtr md = MeshMetadata::New(flags);
+    if (source->GetMeshMetadata(i, md))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh " << i)
+      return -1;
+      }
+
+    const std::string &meshName = md->MeshName;
+
+    // gather the arrays to copy
+    bool required = reqs.Empty();
+    bool structureOnly = false;
+    std::vector<std::pair<int, std::string>> arrays;
+
+    if (reqs.Empty())
+      {
+      for (int j = 0; j < md->NumArrays; ++j)
+        arrays.push_back(std::make_pair(md->ArrayCentering[j], md->ArrayName[j]));
+      }
+    else
+      {
+      MeshRequirementsIterator mit = reqs.GetMeshRequirementsIterator();
+      for (; mit; ++mit)
+        {
+        if (mit.MeshName() == meshName)
+          {
+          required = true;
+          structureOnly = mit.StructureOnly();
+          break;
+          }
+        }
+
+      if (!required)
+        continue;
+
+      ArrayRequirementsIterator ait = reqs.GetArrayRequirementsIterator(meshName);
+      for (; ait; ++ait)
+        arrays.push_back(std::make_pair(ait.Association(), ait.Array()));
+      }
+
+    ++nFound;
+
+    // fetch the mesh and arrays
+    svtkDataObject *dobj = nullptr;
+    if (source->GetMesh(meshName, structureOnly, dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      return -1;
+      }
+
+    svtkDataObjectPtr mesh;
+    mesh.TakeReference(dobj);
+
+    // it is not an error for a rank to have no data
+    if (mesh)
+      {
+      if (md->NumGhostCells && source->AddGhostCellsArray(mesh, meshName))
+        {
+        SENSEI_ERROR("Failed to add ghost cells to mesh \"" << meshName << "\"")
+        return -1;
+        }
+
+      if (md->NumGhostNodes && source->AddGhostNodesArray(mesh, meshName))
+        {
+        SENSEI_ERROR("Failed to add ghost nodes to mesh \"" << meshName << "\"")
+        return -1;
+        }
+
+      for (auto &array : arrays)
+        {
+        if (source->AddArray(mesh, meshName, array.first, array.second))
+          {
+          SENSEI_ERROR("Failed to add "
+            << SVTKUtils::GetAttributesName(array.first)
+            << " data array \"" << array.second << "\" to mesh \""
+            << meshName << "\"")
+          return -1;
+          }
+        }
+      }
+
+    // describe only the arrays that were copied
+    MeshMetadataPtr mdOut = md->NewCopy();
+    mdOut->ClearArrayInfo();
+    for (auto &array : arrays)
+      {
+      if (mdOut->CopyArrayInfo(md, array.second))
+        {
+        SENSEI_ERROR("Failed to copy metadata for array \""
+          << array.second << "\" on mesh \"" << meshName << "\"")
+        return -1;
+        }
+      }
+
+    if (md->NumGhostCells)
+      arrays.push_back(std::make_pair(int(svtkDataObject::CELL), "svtkGhostType"));
+
+    if (md->NumGhostNodes)
+      arrays.push_back(std::make_pair(int(svtkDataObject::POINT), "svtkGhostType"));
+
+    metadata.push_back(mdOut);
+    meshArrays.push_back(std::make_pair(int(structureOnly), arrays));
+    meshes.push_back(mesh);
+    }
+
+  if (nFound < nRequired)
+    {
+    SENSEI_ERROR("Only " << nFound << " of the " << nRequired
+      << " required meshes were found")
+    return -1;
+    }
+
+  unsigned int nMeshesOut = meshes.size();
+  str.Pack(nMeshesOut);
+
+  unsigned long nDataBytes = 0;
+  std::vector<CopyJob> jobs;
+
+  for (unsigned int i = 0; i < nMeshesOut; ++i)
+    {
+    metadata[i]->ToStream(str);
+
+    str.Pack(meshArrays[i].first);
+
+    unsigned int nArrays = meshArrays[i].second.size();
+    str.Pack(nArrays);
+    for (unsigned int j = 0; j < nArrays; ++j)
+      {
+      str.Pack(meshArrays[i].second[j].first);
+      str.Pack(meshArrays[i].second[j].second);
+      }
+
+    if (WriteObject(str, meshes[i], nDataBytes, jobs))
+      {
+      SENSEI_ERROR("Failed to serialize mesh \"" << metadata[i]->MeshName << "\"")
+      return -1;
+      }
+    }
+
+  // the segment holds the header size, the header, and the array data
+  unsigned long nHeaderBytes = str.Size();
+  unsigned long dataOffset = Align(sizeof(unsigned long) + nHeaderBytes);
+
+  nBytes = dataOffset + nDataBytes;
+
+  if (this->Internals->Map(nBytes, true))
+    return -1;
+
+  unsigned char *data = this->Internals->Data;
+
+  memcpy(data, &nHeaderBytes, sizeof(unsigned long));
+  memcpy(data + sizeof(unsigned long), str.GetData(), nHeaderBytes);
+
+  unsigned long nJobs = jobs.size();
+  for (unsigned long i = 0; i < nJobs; ++i)
+    CopyArray(jobs[i], data + dataOffset);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::Read(unsigned long nBytes)
+{
+  TimeEvent<128> mark("SharedMemoryDataAdaptor::Read");
+
+  this->ReleaseData();
+
+  if (nBytes < sizeof(unsigned long))
+    {
+    SENSEI_ERROR("Invalid segment size " << nBytes)
+    return -1;
+    }
+
+  if (this->Internals->Map(nBytes, false))
+    return -1;
+
+  unsigned char *data = this->Internals->Data;
+
+  unsigned long nHeaderBytes = 0;
+  memcpy(&nHeaderBytes, data, sizeof(unsigned long));
+
+  unsigned long dataOffset = Align(sizeof(unsigned long) + nHeaderBytes);
+  if (dataOffset > nBytes)
+    {
+    SENSEI_ERROR("Invalid header size " << nHeaderBytes)
+    return -1;
+    }
+
+  BinaryStream str;
+  str.Resize(nHeaderBytes);
+  str.SetReadPos(0);
+  str.SetWritePos(nHeaderBytes);
+  memcpy(str.GetData(), data + sizeof(unsigned long), nHeaderBytes);
+
+  unsigned int version = 0;
+  str.Unpack(version);
+  if (version != Version)
+    {
+    SENSEI_ERROR("Version " << version << " of the shared memory segment"
+      " is not supported")
+    return -1;
+    }
+
+  double time = 0.0;
+  long timeStep = 0;
+  str.Unpack(time);
+  str.Unpack(timeStep);
+
+  this->SetDataTime(time);
+  this->SetDataTimeStep(timeStep);
+
+  unsigned int nMeshes = 0;
+  str.Unpack(nMeshes);
+
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    MeshMetadataPtr md = MeshMetadata::New();
+    md->FromStream(str);
+
+    const std::string &meshName = md->MeshName;
+
+    int structureOnly = 0;
+    str.Unpack(structureOnly);
+
+    unsigned int nArrays = 0;
+    str.Unpack(nArrays);
+    for (unsigned int j = 0; j < nArrays; ++j)
+      {
+      int association = 0;
+      std::string arrayName;
+      str.Unpack(association);
+      str.Unpack(arrayName);
+      this->Internals->Arrays.insert(ArrayKey(meshName, association, arrayName));
+      }
+
+    svtkDataObject *dobj = nullptr;
+    if (ReadObject(str, data + dataOffset, dobj))
+      {
+      SENSEI_ERROR("Failed to deserialize mesh \"" << meshName << "\"")
+      this->ReleaseData();
+      return -1;
+      }
+
+    svtkDataObjectPtr mesh;
+    mesh.TakeReference(dobj);
+
+    this->Internals->Meshes[meshName] = std::make_pair(mesh, bool(structureOnly));
+    this->Internals->Metadata.push_back(md);
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::Close()
+{
+  this->ReleaseData();
+  return this->Internals->Unmap();
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
+{
+  numMeshes = this->Internals->Metadata.size();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::GetMeshMetadata(unsigned int id,
+  MeshMetadataPtr &metadata)
+{
+  if (id >= this->Internals->Metadata.size())
+    {
+    SENSEI_ERROR("Index " << id << " out of bounds")
+    return -1;
+    }
+
+  *metadata = *this->Internals->Metadata[id];
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::GetMesh(const std::string &meshName,
+  bool structureOnly, svtkDataObject *&mesh)
+{
+  mesh = nullptr;
+
+  auto it = this->Internals->Meshes.find(meshName);
+  if (it == this->Internals->Meshes.end())
+    {
+    SENSEI_ERROR("No mesh \"" << meshName << "\" in the shared memory segment")
+    return -1;
+    }
+
+  if (it->second.second && !structureOnly)
+    {
+    SENSEI_ERROR("The shared memory segment does not include the geometry"
+      " of mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  // it is not an error for a rank to have no data
+  if (!it->second.first)
+    return 0;
+
+  mesh = NewMesh(it->second.first, structureOnly);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::AddArray(svtkDataObject* mesh,
+  const std::string &meshName, int association, const std::string &arrayName)
+{
+  auto it = this->Internals->Meshes.find(meshName);
+  if (it == this->Internals->Meshes.end())
+    {
+    SENSEI_ERROR("No mesh \"" << meshName << "\" in the shared memory segment")
+    return -1;
+    }
+
+  if (!this->Internals->Arrays.count(ArrayKey(meshName, association, arrayName)))
+    {
+    SENSEI_ERROR("No " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" on mesh \"" << meshName
+      << "\" in the shared memory segment")
+    return -1;
+    }
+
+  svtkDataObject *shared = it->second.first;
+  if (!shared || !mesh)
+    return 0;
+
+  SVTKUtils::BinaryDatasetFunction addArray =
+    [&](svtkDataSet *ds, svtkDataSet *dsOut) -> int
+    {
+    svtkFieldData *dsa = SVTKUtils::GetAttributes(ds, association);
+    svtkFieldData *dsaOut = SVTKUtils::GetAttributes(dsOut, association);
+
+    if (!dsa || !dsaOut)
+      return -1;
+
+    // not all blocks are required to have the array
+    if (svtkAbstractArray *aa = dsa->GetAbstractArray(arrayName.c_str()))
+      dsaOut->AddArray(aa);
+
+    return 0;
+    };
+
+  if (SVTKUtils::Apply(shared, mesh, addArray))
+    {
+    SENSEI_ERROR("Failed to add " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" to mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::AddGhostNodesArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  return this->AddArray(mesh, meshName, svtkDataObject::POINT, "svtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::AddGhostCellsArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  return this->AddArray(mesh, meshName, svtkDataObject::CELL, "svtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int SharedMemoryDataAdaptor::ReleaseData()
+{
+  this->Internals->Metadata.clear();
+  this->Internals->Meshes.clear();
+  this->Internals->Arrays.clear();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryDataAdaptor::PrintSelf(ostream& os, svtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "SegmentName: " << this->Internals->Name << std::endl
+    << indent << "Size: " << this->Internals->Size << std::endl
+    << indent << "Meshes: " << this->Internals->Meshes.size() << std::endl
+    << indent << "Arrays: " << this->Internals->Arrays.size() << std::endl;
+}
+
+}
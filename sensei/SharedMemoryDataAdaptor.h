@@ -0,0 +1,119 @@
+#ifndef sensei_SharedMemoryDataAdaptor_h
+#define sensei_SharedMemoryDataAdaptor_h
+
+#include "DataAdaptor.h"
+
+#include <string>
+
+class svtkDataObject;
+
+namespace sensei
+{
+class DataRequirements;
+
+/** A sensei::DataAdaptor that passes one time step of another data adaptor's
+ * meshes and arrays to a different process on the same node through a POSIX
+ * shared memory segment.
+ *
+ * The producer calls Write, which copies the required meshes and arrays
+ * into the segment, creating or growing the segment as needed. The consumer,
+ * typically a worker process, calls Read with the number of bytes written and
+ * then serves the contents through the sensei::DataAdaptor API. On the
+ * consumer side array data is not copied, arrays point directly into the
+ * segment and are valid until the next call to Read or ReleaseData. This
+ * includes numpy views of them made in Python, which must not be kept after
+ * ReleaseData, since the next Read may remap the segment. The
+ * producer and consumer must agree not to access the segment at the same
+ * time, for instance by exchanging messages over a pipe or socket.
+ *
+ * The meshes and arrays to write are named by a sensei::DataRequirements
+ * instance. If the requirements are empty all meshes and arrays are written.
+ * Ghost cell and ghost node arrays are written when the mesh metadata reports
+ * ghost layers. The metadata served describes only the written arrays.
+ *
+ * svtkImageData, svtkUniformGrid, svtkRectilinearGrid, svtkStructuredGrid,
+ * svtkPolyData, and svtkUnstructuredGrid blocks, and svtkMultiBlockDataSet
+ * collections of them are supported. Arrays with the array of structures
+ * and structure of arrays layouts keep their layout, other arrays are
+ * written in the array of structures layout.
+ */
+class SENSEI_EXPORT SharedMemoryDataAdaptor : public DataAdaptor
+{
+public:
+  static SharedMemoryDataAdaptor *New();
+  senseiTypeMacro(SharedMemoryDataAdaptor, DataAdaptor);
+
+  /// Prints the current state of the adaptor.
+  void PrintSelf(ostream& os, svtkIndent indent) override;
+
+  /** Set the name of the shared memory segment. The name must begin with
+   * a '/' and must be unique on the node. It should be set before the first
+   * call to Write or Read.
+   */
+  int SetSegmentName(const std::string &name);
+
+  /// Get the name of the shared memory segment.
+  const std::string &GetSegmentName() const;
+
+  /** Copy the required meshes and arrays from the passed data adaptor into
+   * the segment. The metadata is generated with all flags set. The data
+   * adaptor's time and time step are copied as well.
+   *
+   * @param[in] source the data adaptor to copy from
+   * @param[in] reqs names the meshes and arrays to copy, when empty
+   *                 everything is copied
+   * @param[out] nBytes the number of bytes written, pass to Read
+   * @returns zero if successful, non zero if an error occurred
+   */
+  int Write(DataAdaptor *source, const DataRequirements &reqs,
+    unsigned long &nBytes);
+
+  /** Map the segment and serve the meshes and arrays written to it. Any
+   * meshes and arrays served from an earlier call are released.
+   *
+   * @param[in] nBytes the number of bytes written by Write
+   * @returns zero if successful, non zero if an error occurred
+   */
+  int Read(unsigned long nBytes);
+
+  /** Unmap the segment. When called by the producer the segment is also
+   * removed, the consumer may continue to use a mapping it already has.
+   */
+  int Close();
+
+  int GetNumberOfMeshes(unsigned int &numMeshes) override;
+
+  int GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  int GetMesh(const std::string &meshName, bool structureOnly,
+    svtkDataObject *&mesh) override;
+
+  using sensei::DataAdaptor::GetMesh;
+
+  int AddGhostNodesArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int AddGhostCellsArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int AddArray(svtkDataObject* mesh, const std::string &meshName,
+    int association, const std::string &arrayName) override;
+
+  /// Releases the meshes and arrays served from the segment.
+  int ReleaseData() override;
+
+protected:
+  SharedMemoryDataAdaptor();
+  ~SharedMemoryDataAdaptor();
+
+  SharedMemoryDataAdaptor(const SharedMemoryDataAdaptor&) = delete;
+  void operator=(const SharedMemoryDataAdaptor&) = delete;
+
+private:
+  struct InternalsType;
+  InternalsType *Internals;
+};
+
+}
+
+#endif
@@ -0,0 +1,505 @@
+#include "SnapshotDataAdaptor.h"
+#include "DataRequirements.h"
+#include "MeshMetadata.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAbstractArray.h>
+#include <svtkCellData.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkFieldData.h>
+#include <svtkObjectFactory.h>
+#include <svtkPointData.h>
+#include <svtkSmartPointer.h>
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <tuple>
+#include <utility>
+
+using svtkDataObjectPtr = svtkSmartPointer<svtkDataObject>;
+using svtkAbstractArrayPtr = svtkSmartPointer<svtkAbstractArray>;
+using svtkCompositeDataIteratorPtr = svtkSmartPointer<svtkCompositeDataIterator>;
+
+namespace
+{
+// (mesh name, association, array name)
+using ArrayKey = std::tuple<std::string, int, std::string>;
+
+// (mesh name, flat block index, association, array name)
+using BufferKey = std::tuple<std::string, unsigned int, int, std::string>;
+
+// **************************************************************************
+svtkDataObject *NewMesh(svtkDataObject *dobj, bool structureOnly)
+{
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj))
+    {
+    svtkCompositeDataSet *cdo = cd->NewInstance();
+    cdo->CopyStructure(cd);
+
+    svtkCompositeDataIteratorPtr cdit;
+    cdit.TakeReference(cd->NewIterator());
+    for (cdit->InitTraversal(); !cdit->IsDoneWithTraversal(); cdit->GoToNextItem())
+      {
+      svtkDataObject *leaf = NewMesh(cd->GetDataSet(cdit), structureOnly);
+      cdo->SetDataSet(cdit, leaf);
+      leaf->Delete();
+      }
+
+    cdo->GetFieldData()->ShallowCopy(cd->GetFieldData());
+
+    return cdo;
+    }
+
+  svtkDataObject *dobjo = dobj->NewInstance();
+
+  if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj))
+    {
+    if (!structureOnly)
+      static_cast<svtkDataSet*>(dobjo)->CopyStructure(ds);
+    }
+
+  // field data carries the ghost layer metadata
+  dobjo->GetFieldData()->ShallowCopy(dobj->GetFieldData());
+
+  return dobjo;
+}
+}
+
+namespace sensei
+{
+
+struct SnapshotDataAdaptor::InternalsType
+{
+  InternalsType() : NumberOfBytes(0) {}
+
+  // deep copy a mesh. composite datasets are copied leaf by leaf
+  svtkDataObject *CopyMesh(const std::string &meshName, svtkDataObject *dobj);
+
+  // deep copy one block of a mesh
+  svtkDataObject *CopyBlock(const std::string &meshName,
+    unsigned int blockId, svtkDataObject *dobj);
+
+  // deep copy arrays of one block, reusing buffers from earlier snapshots
+  void CopyArrays(const std::string &meshName, unsigned int blockId,
+    int association, svtkFieldData *fd, svtkFieldData *fdOut);
+
+  std::vector<MeshMetadataPtr> Metadata;
+  std::map<std::string, std::pair<svtkDataObjectPtr, bool>> Meshes;
+  std::set<ArrayKey> Arrays;
+
+  // array buffers retained for reuse
+  std::map<BufferKey, svtkAbstractArrayPtr> Buffers;
+
+  unsigned long NumberOfBytes;
+};
+
+//----------------------------------------------------------------------------
+svtkDataObject *SnapshotDataAdaptor::InternalsType::CopyMesh(
+  const std::string &meshName, svtkDataObject *dobj)
+{
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj))
+    {
+    svtkCompositeDataSet *cdo = cd->NewInstance();
+    cdo->CopyStructure(cd);
+
+    svtkCompositeDataIteratorPtr cdit;
+    cdit.TakeReference(cd->NewIterator());
+    for (cdit->InitTraversal(); !cdit->IsDoneWithTraversal(); cdit->GoToNextItem())
+      {
+      svtkDataObject *leaf = this->CopyBlock(meshName,
+        cdit->GetCurrentFlatIndex(), cd->GetDataSet(cdit));
+
+      cdo->SetDataSet(cdit, leaf);
+      leaf->Delete();
+      }
+
+    this->CopyArrays(meshName, 0, svtkDataObject::FIELD,
+      cd->GetFieldData(), cdo->GetFieldData());
+
+    return cdo;
+    }
+
+  return this->CopyBlock(meshName, 0, dobj);
+}
+
+//----------------------------------------------------------------------------
+svtkDataObject *SnapshotDataAdaptor::InternalsType::CopyBlock(
+  const std::string &meshName, unsigned int blockId, svtkDataObject *dobj)
+{
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj);
+  if (!ds)
+    {
+    svtkDataObject *dobjo = dobj->NewInstance();
+    dobjo->DeepCopy(dobj);
+    return dobjo;
+    }
+
+  // deep copy the geometry and topology only, the attributes are handled
+  // below so that their buffers can be reused
+  svtkDataSet *structure = ds->NewInstance();
+  structure->CopyStructure(ds);
+
+  svtkDataSet *dso = ds->NewInstance();
+  dso->DeepCopy(structure);
+  structure->Delete();
+
+  this->CopyArrays(meshName, blockId, svtkDataObject::POINT,
+    ds->GetPointData(), dso->GetPointData());
+
+  this->CopyArrays(meshName, blockId, svtkDataObject::CELL,
+    ds->GetCellData(), dso->GetCellData());
+
+  this->CopyArrays(meshName, blockId, svtkDataObject::FIELD,
+    ds->GetFieldData(), dso->GetFieldData());
+
+  return dso;
+}
+
+//----------------------------------------------------------------------------
+void SnapshotDataAdaptor::InternalsType::CopyArrays(
+  const std::string &meshName, unsigned int blockId, int association,
+  svtkFieldData *fd, svtkFieldData *fdOut)
+{
+  int nArrays = fd->GetNumberOfArrays();
+  for (int i = 0; i < nArrays; ++i)
+    {
+    svtkAbstractArray *aa = fd->GetAbstractArray(i);
+    const char *name = aa->GetName();
+
+    BufferKey key(meshName, blockId, association, name ? name : "");
+    svtkAbstractArrayPtr &buffer = this->Buffers[key];
+
+    // a buffer can be reused if the types match and nothing else holds
+    // a reference to it, analyses may keep arrays from earlier steps
+    if (!buffer || (buffer->GetReferenceCount() > 1) ||
+      (buffer->GetDataType() != aa->GetDataType()) ||
+      (buffer->GetArrayType() != aa->GetArrayType()))
+      buffer.TakeReference(aa->NewInstance());
+
+    buffer->DeepCopy(aa);
+    fdOut->AddArray(buffer);
+
+    this->NumberOfBytes += aa->GetNumberOfValues()*aa->GetDataTypeSize();
+    }
+}
+
+
+
+//----------------------------------------------------------------------------
+senseiNewMacro(SnapshotDataAdaptor);
+
+//----------------------------------------------------------------------------
+SnapshotDataAdaptor::SnapshotDataAdaptor() :
+  Internals(new InternalsType)
+{
+}
+
+//----------------------------------------------------------------------------
+SnapshotDataAdaptor::~SnapshotDataAdaptor()
+{
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::Snapshot(DataAdaptor *source,
+  const DataRequirements &reqs)
+{
+  TimeEvent<128> mark("SnapshotDataAdaptor::Snapshot");
+
+  this->ReleaseData();
+  this->Internals->NumberOfBytes = 0;
+
+  if (!source)
+    {
+    SENSEI_ERROR("No data adaptor was provided")
+    return -1;
+    }
+
+  this->SetDataTime(source->GetDataTime());
+  this->SetDataTimeStep(source->GetDataTimeStep());
+
+  unsigned int nMeshes = 0;
+  if (source->GetNumberOfMeshes(nMeshes))
+    {
+    SENSEI_ERROR("Failed to get the number of meshes")
+    return -1;
+    }
+
+  MeshMetadataFlags flags;
+  flags.SetAll();
+
+  unsigned int nRequired = reqs.GetNumberOfRequiredMeshes();
+  unsigned int nFound = 0;
+
+  for (unsigned int i = 0; i < nMeshes; ++i)
+    {
+    MeshMetadataPtr md = MeshMetadata::New(flags);
+    if (source->GetMeshMetadata(i, md))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh " << i)
+      return -1;
+      }
+
+    const std::string &meshName = md->MeshName;
+
+    // gather the arrays to copy
+    bool required = reqs.Empty();
+    bool structureOnly = false;
+    std::vector<std::pair<int, std::string>> arrays;
+
+    if (reqs.Empty())
+      {
+      for (int j = 0; j < md->NumArrays; ++j)
+        arrays.push_back(std::make_pair(md->ArrayCentering[j], md->ArrayName[j]));
+      }
+    else
+      {
+      MeshRequirementsIterator mit = reqs.GetMeshRequirementsIterator();
+      for (; mit; ++mit)
+        {
+        if (mit.MeshName() == meshName)
+          {
+          required = true;
+          structureOnly = mit.StructureOnly();
+          break;
+          }
+        }
+
+      if (!required)
+        continue;
+
+      ArrayRequirementsIterator ait = reqs.GetArrayRequirementsIterator(meshName);
+      for (; ait; ++ait)
+        arrays.push_back(std::make_pair(ait.Association(), ait.Array()));
+      }
+
+    ++nFound;
+
+    // fetch the mesh and arrays
+    svtkDataObject *dobj = nullptr;
+    if (source->GetMesh(meshName, structureOnly, dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      return -1;
+      }
+
+    svtkDataObjectPtr mesh;
+    mesh.TakeReference(dobj);
+
+    if (md->NumGhostCells)
+      this->Internals->Arrays.insert(ArrayKey(meshName,
+        svtkDataObject::CELL, "svtkGhostType"));
+
+    if (md->NumGhostNodes)
+      this->Internals->Arrays.insert(ArrayKey(meshName,
+        svtkDataObject::POINT, "svtkGhostType"));
+
+    for (auto &array : arrays)
+      this->Internals->Arrays.insert(ArrayKey(meshName,
+        array.first, array.second));
+
+    // it is not an error for a rank to have no data
+    if (mesh)
+      {
+      if (md->NumGhostCells && source->AddGhostCellsArray(mesh, meshName))
+        {
+        SENSEI_ERROR("Failed to add ghost cells to mesh \"" << meshName << "\"")
+        return -1;
+        }
+
+      if (md->NumGhostNodes && source->AddGhostNodesArray(mesh, meshName))
+        {
+        SENSEI_ERROR("Failed to add ghost nodes to mesh \"" << meshName << "\"")
+        return -1;
+        }
+
+      for (auto &array : arrays)
+        {
+        if (source->AddArray(mesh, meshName, array.first, array.second))
+          {
+          SENSEI_ERROR("Failed to add "
+            << SVTKUtils::GetAttributesName(array.first)
+            << " data array \"" << array.second << "\" to mesh \""
+            << meshName << "\"")
+          return -1;
+          }
+        }
+
+      mesh.TakeReference(this->Internals->CopyMesh(meshName, mesh));
+      }
+
+    this->Internals->Meshes[meshName] = std::make_pair(mesh, structureOnly);
+
+    // describe only the arrays that were copied
+    MeshMetadataPtr mdOut = md->NewCopy();
+    mdOut->ClearArrayInfo();
+    for (auto &array : arrays)
+      {
+      if (mdOut->CopyArrayInfo(md, array.second))
+        {
+        SENSEI_ERROR("Failed to copy metadata for array \""
+          << array.second << "\" on mesh \"" << meshName << "\"")
+        return -1;
+        }
+      }
+
+    this->Internals->Metadata.push_back(mdOut);
+    }
+
+  if (nFound < nRequired)
+    {
+    SENSEI_ERROR("Only " << nFound << " of the " << nRequired
+      << " required meshes were found")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+unsigned long SnapshotDataAdaptor::GetNumberOfBytes()
+{
+  return this->Internals->NumberOfBytes;
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
+{
+  numMeshes = this->Internals->Metadata.size();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::GetMeshMetadata(unsigned int id,
+  MeshMetadataPtr &metadata)
+{
+  if (id >= this->Internals->Metadata.size())
+    {
+    SENSEI_ERROR("Index " << id << " out of bounds")
+    return -1;
+    }
+
+  *metadata = *this->Internals->Metadata[id];
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::GetMesh(const std::string &meshName,
+  bool structureOnly, svtkDataObject *&mesh)
+{
+  mesh = nullptr;
+
+  auto it = this->Internals->Meshes.find(meshName);
+  if (it == this->Internals->Meshes.end())
+    {
+    SENSEI_ERROR("No mesh \"" << meshName << "\" in the snapshot")
+    return -1;
+    }
+
+  if (it->second.second && !structureOnly)
+    {
+    SENSEI_ERROR("The snapshot of mesh \"" << meshName
+      << "\" does not include its geometry")
+    return -1;
+    }
+
+  // it is not an error for a rank to have no data
+  if (!it->second.first)
+    return 0;
+
+  mesh = NewMesh(it->second.first, structureOnly);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::AddArray(svtkDataObject* mesh,
+  const std::string &meshName, int association, const std::string &arrayName)
+{
+  auto it = this->Internals->Meshes.find(meshName);
+  if (it == this->Internals->Meshes.end())
+    {
+    SENSEI_ERROR("No mesh \"" << meshName << "\" in the snapshot")
+    return -1;
+    }
+
+  if (!this->Internals->Arrays.count(ArrayKey(meshName, association, arrayName)))
+    {
+    SENSEI_ERROR("No " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" on mesh \"" << meshName
+      << "\" in the snapshot")
+    return -1;
+    }
+
+  svtkDataObject *snap = it->second.first;
+  if (!snap || !mesh)
+    return 0;
+
+  SVTKUtils::BinaryDatasetFunction addArray =
+    [&](svtkDataSet *ds, svtkDataSet *dsOut) -> int
+    {
+    svtkFieldData *dsa = SVTKUtils::GetAttributes(ds, association);
+    svtkFieldData *dsaOut = SVTKUtils::GetAttributes(dsOut, association);
+
+    if (!dsa || !dsaOut)
+      return -1;
+
+    // not all blocks are required to have the array
+    if (svtkAbstractArray *aa = dsa->GetAbstractArray(arrayName.c_str()))
+      dsaOut->AddArray(aa);
+
+    return 0;
+    };
+
+  if (SVTKUtils::Apply(snap, mesh, addArray))
+    {
+    SENSEI_ERROR("Failed to add " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" to mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::AddGhostNodesArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  return this->AddArray(mesh, meshName, svtkDataObject::POINT, "svtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::AddGhostCellsArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  return this->AddArray(mesh, meshName, svtkDataObject::CELL, "svtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int SnapshotDataAdaptor::ReleaseData()
+{
+  this->Internals->Metadata.clear();
+  this->Internals->Meshes.clear();
+  this->Internals->Arrays.clear();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void SnapshotDataAdaptor::PrintSelf(ostream& os, svtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Meshes: " << this->Internals->Meshes.size() << std::endl
+    << indent << "Arrays: " << this->Internals->Arrays.size() << std::endl
+    << indent << "Buffers: " << this->Internals->Buffers.size() << std::endl
+    << indent << "NumberOfBytes: " << this->Internals->NumberOfBytes << std::endl;
+}
+
+}
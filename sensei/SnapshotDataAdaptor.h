@@ -0,0 +1,92 @@
+#ifndef sensei_SnapshotDataAdaptor_h
+#define sensei_SnapshotDataAdaptor_h
+
+#include "DataAdaptor.h"
+
+#include <string>
+
+class svtkDataObject;
+
+namespace sensei
+{
+class DataRequirements;
+
+/** A sensei::DataAdaptor that serves a private copy of a subset of another
+ * data adaptor's meshes and arrays taken at one point in time. Once the
+ * snapshot has been taken the simulation is free to modify or release its
+ * data while analyses process the copy, for instance on another thread.
+ *
+ * The meshes and arrays to copy are named by a sensei::DataRequirements
+ * instance. If the requirements are empty all meshes and arrays are copied.
+ * Ghost cell and ghost node arrays are copied when the mesh metadata reports
+ * ghost layers. The metadata served describes only the copied arrays.
+ *
+ * Array buffers are retained when the snapshot is released and are reused
+ * by the next snapshot when the array's type matches, which avoids allocating
+ * new memory each time step. Buffers still referenced by an analysis are
+ * never reused.
+ *
+ * sensei::ConfigurableAnalysis uses this class when the analyses are executed
+ * asynchronously.
+ */
+class SENSEI_EXPORT SnapshotDataAdaptor : public DataAdaptor
+{
+public:
+  static SnapshotDataAdaptor *New();
+  senseiTypeMacro(SnapshotDataAdaptor, DataAdaptor);
+
+  /// Prints the current state of the adaptor.
+  void PrintSelf(ostream& os, svtkIndent indent) override;
+
+  /** Copy the required meshes and arrays from the passed data adaptor. Any
+   * previous snapshot is released. The metadata is generated with all flags
+   * set. The data adaptor's time and time step are copied as well.
+   *
+   * @param[in] source the data adaptor to copy from
+   * @param[in] reqs names the meshes and arrays to copy, when empty
+   *                 everything is copied
+   * @returns zero if successful, non zero if an error occurred
+   */
+  int Snapshot(DataAdaptor *source, const DataRequirements &reqs);
+
+  /// Get the number of bytes of array data copied by the last snapshot.
+  unsigned long GetNumberOfBytes();
+
+  int GetNumberOfMeshes(unsigned int &numMeshes) override;
+
+  int GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  int GetMesh(const std::string &meshName, bool structureOnly,
+    svtkDataObject *&mesh) override;
+
+  using sensei::DataAdaptor::GetMesh;
+
+  int AddGhostNodesArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int AddGhostCellsArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int AddArray(svtkDataObject* mesh, const std::string &meshName,
+    int association, const std::string &arrayName) override;
+
+  /** Releases the snapshot. The array buffers are kept for reuse by the
+   * next snapshot.
+   */
+  int ReleaseData() override;
+
+protected:
+  SnapshotDataAdaptor();
+  ~SnapshotDataAdaptor();
+
+  SnapshotDataAdaptor(const SnapshotDataAdaptor&) = delete;
+  void operator=(const SnapshotDataAdaptor&) = delete;
+
+private:
+  struct InternalsType;
+  InternalsType *Internals;
+};
+
+}
+
+#endif
@@ -0,0 +1,331 @@
+#include "SpaceFillingCurvePartitioner.h"
+#include "Profiler.h"
+
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+// the number of bits per coordinate, three of which fit in the key
+constexpr int NumBits = 21;
+
+// --------------------------------------------------------------------------
+unsigned long long MortonKey(unsigned int x[3])
+{
+  unsigned long long key = 0;
+  for (int b = NumBits - 1; b >= 0; --b)
+    {
+    for (int i = 0; i < 3; ++i)
+      key = (key << 1) | ((x[i] >> b) & 1u);
+    }
+  return key;
+}
+
+// --------------------------------------------------------------------------
+unsigned long long HilbertKey(unsigned int x[3])
+{
+  // transform the coordinates in place to the transposed Hilbert index. see
+  // J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004
+  unsigned int m = 1u << (NumBits - 1);
+
+  // inverse undo
+  for (unsigned int q = m; q > 1; q >>= 1)
+    {
+    unsigned int p = q - 1;
+    for (int i = 0; i < 3; ++i)
+      {
+      if (x[i] & q)
+        {
+        // invert
+        x[0] ^= p;
+        }
+      else
+        {
+        // exchange
+        unsigned int t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+        }
+      }
+    }
+
+  // gray encode
+  for (int i = 1; i < 3; ++i)
+    x[i] ^= x[i - 1];
+
+  unsigned int t = 0;
+  for (unsigned int q = m; q > 1; q >>= 1)
+    {
+    if (x[2] & q)
+      t ^= q - 1;
+    }
+
+  for (int i = 0; i < 3; ++i)
+    x[i] ^= t;
+
+  // the index is the interleaved bits of the transpose
+  return MortonKey(x);
+}
+
+// --------------------------------------------------------------------------
+void GetLoad(const std::vector<int> &owner, const std::vector<long long> &costs,
+  std::vector<long long> &load)
+{
+  std::fill(load.begin(), load.end(), 0);
+  int nBlocks = owner.size();
+  for (int i = 0; i < nBlocks; ++i)
+    load[owner[i]] += costs[i];
+}
+}
+
+namespace sensei
+{
+
+// --------------------------------------------------------------------------
+int SpaceFillingCurvePartitioner::SetCurve(int curve)
+{
+  if ((curve != CURVE_HILBERT) && (curve != CURVE_MORTON))
+    {
+    SENSEI_ERROR("Invalid curve " << curve)
+    return -1;
+    }
+
+  this->Curve = curve;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int SpaceFillingCurvePartitioner::SetCurve(const std::string &curve)
+{
+  if (curve == "hilbert")
+    return this->SetCurve(CURVE_HILBERT);
+  else if (curve == "morton")
+    return this->SetCurve(CURVE_MORTON);
+
+  SENSEI_ERROR("Invalid curve \"" << curve << "\". Use one of "
+    "\"hilbert\" or \"morton\"")
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+int SpaceFillingCurvePartitioner::GetBlockKeys(const MeshMetadataPtr &md,
+  std::vector<unsigned long long> &keys)
+{
+  int nBlocks = md->NumBlocks;
+
+  // the centroid of each block, from the bounds or the extents
+  std::vector<double> centroids(3*nBlocks);
+  if (int(md->BlockBounds.size()) == nBlocks)
+    {
+    for (int i = 0; i < nBlocks; ++i)
+      {
+      const std::array<double,6> &bds = md->BlockBounds[i];
+      for (int j = 0; j < 3; ++j)
+        centroids[3*i + j] = 0.5*(bds[2*j] + bds[2*j + 1]);
+      }
+    }
+  else if (int(md->BlockExtents.size()) == nBlocks)
+    {
+    for (int i = 0; i < nBlocks; ++i)
+      {
+      const std::array<int,6> &ext = md->BlockExtents[i];
+      for (int j = 0; j < 3; ++j)
+        centroids[3*i + j] = 0.5*(double(ext[2*j]) + double(ext[2*j + 1]));
+      }
+    }
+  else
+    {
+    SENSEI_ERROR("Mesh \"" << md->MeshName << "\" metadata has neither "
+      "block bounds nor block extents")
+    return -1;
+    }
+
+  // the bounding box of the centroids
+  double lo[3] = {std::numeric_limits<double>::max(),
+    std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+  double hi[3] = {std::numeric_limits<double>::lowest(),
+    std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    for (int j = 0; j < 3; ++j)
+      {
+      lo[j] = std::min(lo[j], centroids[3*i + j]);
+      hi[j] = std::max(hi[j], centroids[3*i + j]);
+      }
+    }
+
+  // quantize the centroids on to the curve's grid. a flat direction
+  // contributes nothing to the key
+  double maxCoord = double((1u << NumBits) - 1u);
+  double scale[3];
+  for (int j = 0; j < 3; ++j)
+    scale[j] = hi[j] > lo[j] ? maxCoord/(hi[j] - lo[j]) : 0.0;
+
+  keys.resize(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    unsigned int x[3];
+    for (int j = 0; j < 3; ++j)
+      x[j] = (unsigned int)((centroids[3*i + j] - lo[j])*scale[j] + 0.5);
+
+    keys[i] = this->Curve == CURVE_HILBERT ? ::HilbertKey(x) : ::MortonKey(x);
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int SpaceFillingCurvePartitioner::GetPartition(MPI_Comm comm,
+  const MeshMetadataPtr &mdIn, MeshMetadataPtr &mdOut)
+{
+  TimeEvent<128> mark("SpaceFillingCurvePartitioner::GetPartition");
+
+  mdOut = mdIn->NewCopy();
+
+  int nRanks = 1;
+  MPI_Comm_size(comm, &nRanks);
+
+  int nBlocks = mdIn->NumBlocks;
+
+  std::vector<long long> costs;
+  std::vector<unsigned long long> keys;
+  if (this->GetBlockCosts(mdIn, costs) || this->GetBlockKeys(mdIn, keys))
+    {
+    SENSEI_ERROR("Failed to partition mesh \"" << mdIn->MeshName << "\"")
+    return -1;
+    }
+
+  // order the blocks along the curve
+  std::vector<int> order(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+    [&keys](int a, int b) -> bool { return keys[a] < keys[b]; });
+
+  std::vector<long long> curveCosts(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    curveCosts[i] = costs[order[i]];
+
+  // cut the curve into segments of balanced cost
+  std::vector<int> curveSeg(nBlocks);
+  std::vector<long long> segLoad(nRanks, 0);
+  WeightedPartitioner::SplitContiguous(curveCosts, nRanks, curveSeg, segLoad);
+
+  std::vector<int> seg(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    seg[order[i]] = curveSeg[i];
+
+  long long segMax = *std::max_element(segLoad.begin(), segLoad.end());
+
+  // the previous step's partition, if it is compatible with this one
+  std::vector<int> &prevOwner = this->PreviousOwner[mdIn->MeshName];
+
+  bool havePrev = int(prevOwner.size()) == nBlocks;
+  for (int i = 0; havePrev && (i < nBlocks); ++i)
+    havePrev = (prevOwner[i] >= 0) && (prevOwner[i] < nRanks);
+
+  std::vector<long long> load(nRanks, 0);
+  if (havePrev && (this->Tolerance >= 0.0))
+    {
+    // keep the previous partition when it is nearly as good, no data moves
+    ::GetLoad(prevOwner, costs, load);
+    long long prevMax = *std::max_element(load.begin(), load.end());
+
+    if (double(prevMax) <= double(segMax)*(1.0 + this->Tolerance))
+      {
+      mdOut->BlockOwner = prevOwner;
+      this->ReportImbalance(comm, mdIn, load);
+      return 0;
+      }
+    }
+
+  // map segments to ranks. by default the segments are numbered along the
+  // curve, otherwise segments go to the ranks that held most of their cost
+  std::vector<int> rankOfSeg(nRanks);
+  for (int i = 0; i < nRanks; ++i)
+    rankOfSeg[i] = i;
+
+  if (havePrev)
+    {
+    std::map<std::pair<int,int>, long long> overlap;
+    for (int i = 0; i < nBlocks; ++i)
+      overlap[std::make_pair(seg[i], prevOwner[i])] += costs[i];
+
+    // match the largest overlaps first
+    using match = std::tuple<long long, int, int>;
+    std::vector<match> matches;
+    for (auto &it : overlap)
+      matches.push_back(match(-it.second, it.first.first, it.first.second));
+
+    std::sort(matches.begin(), matches.end());
+
+    std::vector<int> segRank(nRanks, -1);
+    std::vector<int> rankUsed(nRanks, 0);
+    for (auto &m : matches)
+      {
+      int s = std::get<1>(m);
+      int r = std::get<2>(m);
+      if ((segRank[s] < 0) && !rankUsed[r])
+        {
+        segRank[s] = r;
+        rankUsed[r] = 1;
+        }
+      }
+
+    // the rest in order
+    int r = 0;
+    for (int s = 0; s < nRanks; ++s)
+      {
+      if (segRank[s] >= 0)
+        continue;
+
+      while (rankUsed[r])
+        ++r;
+
+      segRank[s] = r;
+      rankUsed[r] = 1;
+      }
+
+    rankOfSeg.swap(segRank);
+    }
+
+  mdOut->BlockOwner.resize(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    mdOut->BlockOwner[i] = rankOfSeg[seg[i]];
+
+  prevOwner = mdOut->BlockOwner;
+
+  ::GetLoad(mdOut->BlockOwner, costs, load);
+  this->ReportImbalance(comm, mdIn, load);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int SpaceFillingCurvePartitioner::Initialize(pugi::xml_node &node)
+{
+  TimeEvent<128> mark("SpaceFillingCurvePartitioner::Initialize");
+
+  if (this->InitializeCostModel(node) ||
+    this->SetCurve(node.attribute("curve").as_string("hilbert")))
+    return -1;
+
+  this->Tolerance = node.attribute("tolerance").as_double(0.05);
+
+  SENSEI_STATUS("Configured SpaceFillingCurvePartitioner curve="
+    << node.attribute("curve").as_string("hilbert") << " cost="
+    << node.attribute("cost").as_string("cells") << " arrays="
+    << node.attribute("arrays").as_string("all") << " tolerance="
+    << this->Tolerance)
+
+  return 0;
+}
+
+}
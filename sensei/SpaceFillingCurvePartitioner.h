@@ -0,0 +1,84 @@
+#ifndef sensei_SpaceFillingCurvePartitioner_h
+#define sensei_SpaceFillingCurvePartitioner_h
+
+#include "WeightedPartitioner.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+class SpaceFillingCurvePartitioner;
+using SpaceFillingCurvePartitionerPtr = std::shared_ptr<sensei::SpaceFillingCurvePartitioner>;
+
+/// @class SpaceFillingCurvePartitioner
+/// The space filling curve partitioner keeps spatially adjacent blocks on the
+/// same rank. Blocks are ordered along a Hilbert or Morton curve by the key
+/// of their centroid, computed from MeshMetadata::BlockBounds, or from
+/// MeshMetadata::BlockExtents when bounds are not available. The curve is
+/// then cut into consecutive segments whose maximum cost is minimized, using
+/// the cost models of the WeightedPartitioner.
+///
+/// Block movement between steps is reduced in two ways. The previous step's
+/// BlockOwner of each mesh is kept, and when its imbalance under the current
+/// costs is within a tolerance of the new partition's it is reused as is.
+/// Otherwise the new segments are mapped to the ranks which held most of
+/// their cost on the previous step.
+///
+/// The XML attributes are `curve` (`hilbert` or `morton`), `tolerance`, the
+/// relative increase in imbalance accepted to keep the previous partition,
+/// and the `cost` and `arrays` attributes of the WeightedPartitioner.
+class SENSEI_EXPORT SpaceFillingCurvePartitioner : public sensei::WeightedPartitioner
+{
+public:
+  static sensei::SpaceFillingCurvePartitionerPtr New()
+  { return SpaceFillingCurvePartitionerPtr(new SpaceFillingCurvePartitioner); }
+
+  const char *GetClassName() override { return "SpaceFillingCurvePartitioner"; }
+
+  // given an existing partitioning of data passed in the first MeshMetadata
+  // argument,return a new partittioning in the second MeshMetadata argument.
+  // blocks are ordered along the curve and the curve is cut into segments
+  // of balanced cost.
+  int GetPartition(MPI_Comm comm, const sensei::MeshMetadataPtr &in,
+     sensei::MeshMetadataPtr &out) override;
+
+  // Initialize from XML
+  int Initialize(pugi::xml_node &node) override;
+
+  /// the curves
+  enum {CURVE_HILBERT=0, CURVE_MORTON=1};
+
+  /// Set/get the curve, one of "hilbert" or "morton"
+  int SetCurve(int curve);
+  int SetCurve(const std::string &curve);
+  int GetCurve() const { return this->Curve; }
+
+  /** Set/get the relative increase in imbalance accepted to keep the
+   * previous step's partition. A negative value always repartitions. The
+   * default is 0.05 */
+  void SetTolerance(double tol) { this->Tolerance = tol; }
+  double GetTolerance() const { return this->Tolerance; }
+
+  /// forget the partitions of previous steps
+  void ClearPreviousOwners() { this->PreviousOwner.clear(); }
+
+  /** compute the curve key of each block's centroid. fails if the metadata
+   * has neither block bounds nor block extents */
+  int GetBlockKeys(const sensei::MeshMetadataPtr &md,
+    std::vector<unsigned long long> &keys);
+
+protected:
+  SpaceFillingCurvePartitioner() : Curve(CURVE_HILBERT), Tolerance(0.05) {}
+  SpaceFillingCurvePartitioner(const SpaceFillingCurvePartitioner &) = default;
+
+  int Curve;
+  double Tolerance;
+  std::map<std::string, std::vector<int>> PreviousOwner;
+};
+
+}
+
+#endif
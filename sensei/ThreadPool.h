@@ -0,0 +1,104 @@
+#ifndef sensei_ThreadPool_h
+#define sensei_ThreadPool_h
+
+/// @file
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sensei
+{
+
+/** A fixed size pool of threads servicing a FIFO queue of tasks. Tasks are
+ * queued with Push which returns a std::future that can be used to wait for
+ * the task's result. The threads are started in the constructor and joined in
+ * the destructor after the queued tasks have completed.
+ */
+class ThreadPool
+{
+public:
+  ThreadPool() = delete;
+  ThreadPool(const ThreadPool &) = delete;
+  void operator=(const ThreadPool &) = delete;
+
+  /// start nThreads worker threads
+  explicit ThreadPool(unsigned int nThreads) : Done(false)
+  {
+    for (unsigned int i = 0; i < nThreads; ++i)
+      this->Threads.emplace_back([this]() { this->Work(); });
+  }
+
+  /// finish the queued tasks and join the worker threads
+  ~ThreadPool()
+  {
+    {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Done = true;
+    }
+    this->Ready.notify_all();
+
+    for (auto &thread : this->Threads)
+      thread.join();
+  }
+
+  /// get the number of worker threads
+  unsigned int Size() const { return this->Threads.size(); }
+
+  /// queue a task for execution and return a future for its result
+  template <typename func_t>
+  std::future<typename std::result_of<func_t()>::type> Push(func_t &&func)
+  {
+    using result_t = typename std::result_of<func_t()>::type;
+
+    auto task = std::make_shared<std::packaged_task<result_t()>>(
+      std::forward<func_t>(func));
+
+    std::future<result_t> result = task->get_future();
+
+    {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Tasks.emplace_back([task]() { (*task)(); });
+    }
+    this->Ready.notify_one();
+
+    return result;
+  }
+
+private:
+  void Work()
+  {
+    while (true)
+      {
+      std::function<void()> task;
+
+      {
+      std::unique_lock<std::mutex> lock(this->Mutex);
+      this->Ready.wait(lock, [this]() { return this->Done || !this->Tasks.empty(); });
+
+      if (this->Tasks.empty())
+        return;
+
+      task = std::move(this->Tasks.front());
+      this->Tasks.pop_front();
+      }
+
+      task();
+      }
+  }
+
+  bool Done;
+  std::mutex Mutex;
+  std::condition_variable Ready;
+  std::deque<std::function<void()>> Tasks;
+  std::vector<std::thread> Threads;
+};
+
+}
+
+#endif
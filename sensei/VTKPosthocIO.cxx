@@ -4,6 +4,9 @@
 #include "MeshMetadata.h"
 #include "MeshMetadataMap.h"
 #include "SVTKUtils.h"
+#include "MPIUtils.h"
+#include "BinaryStream.h"
+#include "Profiler.h"
 #include "Error.h"
 
 #include <svtkCellData.h>
@@ -23,6 +26,8 @@
 #include <svtkSmartPointer.h>
 
 #include <algorithm>
+#include <array>
+#include <climits>
 #include <sstream>
 #include <fstream>
 #include <cassert>
@@ -38,6 +43,17 @@
 #include <vtkDataSet.h>
 #include <vtkCellData.h>
 #include <vtkDataArray.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkImageData.h>
+#include <vtkRectilinearGrid.h>
+#include <vtkStructuredGrid.h>
+#include <vtkXMLWriter.h>
+#include <vtkXMLPolyDataWriter.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+#include <vtkXMLImageDataWriter.h>
+#include <vtkXMLRectilinearGridWriter.h>
+#include <vtkXMLStructuredGridWriter.h>
 
 #include <mpi.h>
 
@@ -91,6 +107,254 @@ std::string getBlockFileName(const std::string &outputDir,
   return oss.str();
 }
 
+//-----------------------------------------------------------------------------
+static
+std::string getAggregateFileName(const std::string &outputDir,
+  const std::string &meshName, long nodeId, long groupId, long fileId,
+  const std::string &blockExt)
+{
+  std::ostringstream oss;
+
+  oss << outputDir << "/" << meshName << "_node"
+    << std::setw(6) << std::setfill('0') << nodeId << "_"
+    << std::setw(2) << std::setfill('0') << groupId << "_"
+    << std::setw(6) << std::setfill('0') << fileId << blockExt;
+
+  return oss.str();
+}
+
+//-----------------------------------------------------------------------------
+static
+std::string getXMLExtension(const std::string &dataSetType)
+{
+  if (dataSetType == "PolyData")
+    return ".vtp";
+  else if (dataSetType == "UnstructuredGrid")
+    return ".vtu";
+  else if (dataSetType == "ImageData")
+    return ".vti";
+  else if (dataSetType == "RectilinearGrid")
+    return ".vtr";
+  else if (dataSetType == "StructuredGrid")
+    return ".vts";
+
+  SENSEI_ERROR("Failed to determine file extension for \""
+    << dataSetType << "\"")
+  return "";
+}
+
+//-----------------------------------------------------------------------------
+static
+vtkXMLWriter *newXMLWriter(vtkDataSet *ds)
+{
+  if (dynamic_cast<vtkPolyData*>(ds))
+    return vtkXMLPolyDataWriter::New();
+  else if (dynamic_cast<vtkUnstructuredGrid*>(ds))
+    return vtkXMLUnstructuredGridWriter::New();
+  else if (dynamic_cast<vtkImageData*>(ds))
+    return vtkXMLImageDataWriter::New();
+  else if (dynamic_cast<vtkRectilinearGrid*>(ds))
+    return vtkXMLRectilinearGridWriter::New();
+  else if (dynamic_cast<vtkStructuredGrid*>(ds))
+    return vtkXMLStructuredGridWriter::New();
+
+  SENSEI_ERROR("No XML writer for \"" << ds->GetClassName() << "\"")
+  return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+static
+void setCompressor(vtkXMLWriter *writer, int compressor)
+{
+  switch (compressor)
+    {
+    case sensei::VTKPosthocIO::COMPRESSOR_ZLIB:
+      writer->SetCompressorTypeToZLib();
+      break;
+    case sensei::VTKPosthocIO::COMPRESSOR_LZ4:
+      writer->SetCompressorTypeToLZ4();
+      break;
+    case sensei::VTKPosthocIO::COMPRESSOR_LZMA:
+      writer->SetCompressorTypeToLZMA();
+      break;
+    default:
+      writer->SetCompressorTypeToNone();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// copy the xml adding shift to the value of each offset attribute. the offset
+// attributes locate the arrays in the appended data
+static
+void shiftOffsets(const std::string &xml, unsigned long shift, std::string &out)
+{
+  const std::string key = " offset=\"";
+  size_t pos = 0;
+  while (1)
+    {
+    size_t at = xml.find(key, pos);
+    if (at == std::string::npos)
+      {
+      out.append(xml, pos, std::string::npos);
+      return;
+      }
+
+    size_t beg = at + key.size();
+    size_t end = xml.find('"', beg);
+
+    out.append(xml, pos, beg - pos);
+    out += std::to_string(std::stoul(xml.substr(beg, end - beg)) + shift);
+
+    pos = end;
+    }
+}
+
+// the pieces of the blocks that share a dataset element. the dataset
+// element's attributes, other than the whole extent, must match for blocks to
+// be written as pieces of the same file
+struct PieceGroup
+{
+  PieceGroup() : Extent{{0, -1, 0, -1, 0, -1}}, HaveExtent(0), BinarySize(0) {}
+
+  std::string Type;       // the dataset type, from the VTKFile element
+  std::string Head;       // through the dataset start tag, less the whole extent
+  std::string FieldData;  // the dataset's field data, if any
+  std::string Pieces;     // the Piece elements
+  std::array<int,6> Extent; // the union of the piece's extents
+  int HaveExtent;         // set for structured datasets
+  unsigned long BinarySize; // the size of the appended data
+};
+
+//-----------------------------------------------------------------------------
+// split a block serialized by the XML writer in appended raw mode into its
+// parts. the appended data is returned in binary
+static
+int splitXMLBlock(const std::string &xml, PieceGroup &parts,
+  std::string &binary)
+{
+  size_t typeAt = xml.find("type=\"", xml.find("<VTKFile"));
+  if (typeAt == std::string::npos)
+    {
+    SENSEI_ERROR("Invalid VTK XML, no type")
+    return -1;
+    }
+  typeAt += 6;
+  parts.Type = xml.substr(typeAt, xml.find('"', typeAt) - typeAt);
+
+  size_t dsAt = xml.find("<" + parts.Type, typeAt);
+  size_t dsEnd = xml.find('>', dsAt);
+  size_t pieceAt = xml.find("<Piece", dsEnd);
+  size_t dsClose = xml.find("</" + parts.Type + ">", pieceAt);
+  if ((dsAt == std::string::npos) || (dsEnd == std::string::npos) ||
+    (pieceAt == std::string::npos) || (dsClose == std::string::npos))
+    {
+    SENSEI_ERROR("Invalid VTK XML, no " << parts.Type << " Piece")
+    return -1;
+    }
+
+  // the head, with the whole extent moved into the group
+  parts.Head = xml.substr(0, dsEnd);
+  const std::string wholeKey = " WholeExtent=\"";
+  size_t weAt = parts.Head.find(wholeKey, dsAt);
+  if (weAt != std::string::npos)
+    {
+    size_t weBeg = weAt + wholeKey.size();
+    size_t weEnd = parts.Head.find('"', weBeg);
+
+    std::istringstream iss(parts.Head.substr(weBeg, weEnd - weBeg));
+    for (int i = 0; i < 6; ++i)
+      iss >> parts.Extent[i];
+
+    parts.HaveExtent = 1;
+    parts.Head.erase(weAt, weEnd + 1 - weAt);
+    }
+
+  std::string fieldData = xml.substr(dsEnd + 1, pieceAt - dsEnd - 1);
+  if (fieldData.find("<FieldData") != std::string::npos)
+    parts.FieldData = fieldData;
+
+  parts.Pieces = xml.substr(pieceAt, dsClose - pieceAt);
+
+  // the appended data starts after the underscore and runs up to the closing
+  // tag. trailing white space is included, it is not referenced
+  size_t adAt = xml.find("<AppendedData", dsClose);
+  if (adAt != std::string::npos)
+    {
+    size_t binBeg = xml.find('_', xml.find('>', adAt)) + 1;
+    size_t binEnd = xml.rfind("</AppendedData>");
+    binary.assign(xml, binBeg, binEnd - binBeg);
+    }
+
+  parts.BinarySize = binary.size();
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+// add the parts of a block, or of all of a rank's blocks, to the group. the
+// parts' offsets are shifted past the group's appended data
+static
+void appendPieces(PieceGroup &group, const PieceGroup &parts)
+{
+  if (group.Head.empty())
+    {
+    group.Type = parts.Type;
+    group.Head = parts.Head;
+    group.HaveExtent = parts.HaveExtent;
+    }
+
+  if (group.FieldData.empty() && !parts.FieldData.empty())
+    shiftOffsets(parts.FieldData, group.BinarySize, group.FieldData);
+
+  shiftOffsets(parts.Pieces, group.BinarySize, group.Pieces);
+
+  if (parts.HaveExtent && (parts.Extent[0] <= parts.Extent[1]))
+    {
+    if (group.Extent[0] > group.Extent[1])
+      {
+      group.Extent = parts.Extent;
+      }
+    else
+      {
+      for (int i = 0; i < 3; ++i)
+        {
+        group.Extent[2*i] = std::min(group.Extent[2*i], parts.Extent[2*i]);
+        group.Extent[2*i+1] = std::max(group.Extent[2*i+1], parts.Extent[2*i+1]);
+        }
+      }
+    }
+
+  group.BinarySize += parts.BinarySize;
+}
+
+//-----------------------------------------------------------------------------
+// send or receive appended data in pieces that fit in an MPI count
+static const unsigned long maxMessageSize = 1ul << 30;
+
+static
+void sendBinary(const std::string &binary, int dest, MPI_Comm comm)
+{
+  unsigned long n = binary.size();
+  for (unsigned long i = 0; i < n; i += maxMessageSize)
+    {
+    int count = std::min(maxMessageSize, n - i);
+    MPI_Send(binary.data() + i, count, MPI_BYTE, dest, 0, comm);
+    }
+}
+
+static
+void receiveBinary(std::ofstream &file, unsigned long n, int src,
+  MPI_Comm comm, std::vector<char> &buffer)
+{
+  for (unsigned long i = 0; i < n; i += maxMessageSize)
+    {
+    int count = std::min(maxMessageSize, n - i);
+    buffer.resize(count);
+    MPI_Recv(buffer.data(), count, MPI_BYTE, src, 0, comm, MPI_STATUS_IGNORE);
+    file.write(buffer.data(), count);
+    }
+}
+
 namespace sensei
 {
 //-----------------------------------------------------------------------------
@@ -98,7 +362,8 @@ senseiNewMacro(VTKPosthocIO);
 
 //-----------------------------------------------------------------------------
 VTKPosthocIO::VTKPosthocIO() :
-  Frequency(1), OutputDir("./"), Mode(MODE_PARAVIEW), Writer(WRITER_VTK_XML)
+  Frequency(1), OutputDir("./"), Mode(MODE_PARAVIEW), Writer(WRITER_VTK_XML),
+  Aggregation(AGGREGATE_NONE), Compressor(COMPRESSOR_NONE)
 {}
 
 //-----------------------------------------------------------------------------
@@ -207,6 +472,94 @@ int VTKPosthocIO::SetWriter(std::string writerStr)
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int VTKPosthocIO::SetAggregation(int mode)
+{
+  if ((mode != VTKPosthocIO::AGGREGATE_NONE) &&
+    (mode != VTKPosthocIO::AGGREGATE_NODE))
+    {
+    SENSEI_ERROR("Invalid aggregation mode " << mode)
+    return -1;
+    }
+
+  this->Aggregation = mode;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int VTKPosthocIO::SetAggregation(std::string modeStr)
+{
+  unsigned int n = modeStr.size();
+  for (unsigned int i = 0; i < n; ++i)
+    modeStr[i] = tolower(modeStr[i]);
+
+  int mode = 0;
+  if (modeStr == "none")
+    {
+    mode = VTKPosthocIO::AGGREGATE_NONE;
+    }
+  else if (modeStr == "node")
+    {
+    mode = VTKPosthocIO::AGGREGATE_NODE;
+    }
+  else
+    {
+    SENSEI_ERROR("invalid aggregation mode \"" << modeStr << "\"")
+    return -1;
+    }
+
+  this->Aggregation = mode;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int VTKPosthocIO::SetCompressor(int compressor)
+{
+  if ((compressor < VTKPosthocIO::COMPRESSOR_NONE) ||
+    (compressor > VTKPosthocIO::COMPRESSOR_LZMA))
+    {
+    SENSEI_ERROR("Invalid compressor " << compressor)
+    return -1;
+    }
+
+  this->Compressor = compressor;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int VTKPosthocIO::SetCompressor(std::string compressorStr)
+{
+  unsigned int n = compressorStr.size();
+  for (unsigned int i = 0; i < n; ++i)
+    compressorStr[i] = tolower(compressorStr[i]);
+
+  int compressor = 0;
+  if (compressorStr == "none")
+    {
+    compressor = VTKPosthocIO::COMPRESSOR_NONE;
+    }
+  else if (compressorStr == "zlib")
+    {
+    compressor = VTKPosthocIO::COMPRESSOR_ZLIB;
+    }
+  else if (compressorStr == "lz4")
+    {
+    compressor = VTKPosthocIO::COMPRESSOR_LZ4;
+    }
+  else if (compressorStr == "lzma")
+    {
+    compressor = VTKPosthocIO::COMPRESSOR_LZMA;
+    }
+  else
+    {
+    SENSEI_ERROR("invalid compressor \"" << compressorStr << "\"")
+    return -1;
+    }
+
+  this->Compressor = compressor;
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 void VTKPosthocIO::SetGhostArrayName(const std::string &name)
 {
@@ -268,6 +621,13 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
     return true;
     }
 
+  if ((this->Aggregation == VTKPosthocIO::AGGREGATE_NODE) &&
+    (this->Writer == VTKPosthocIO::WRITER_VTK_LEGACY))
+    {
+    SENSEI_ERROR("Aggregation requires the XML writer")
+    return false;
+    }
+
   // see what the simulation is providing
   MeshMetadataFlags flags;
   flags.SetBlockDecomp();
@@ -381,6 +741,13 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
     if (dynamic_cast<svtkUniformGridAMR*>(cd.GetPointer()))
       bidShift = 0;
 
+    // when aggregating, the serialized blocks
+    std::vector<std::string> blocks;
+
+    // failures are recorded and the remaining blocks are processed, so
+    // that all ranks reach the collective calls below
+    int error = 0;
+
     // write the blocks
     for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
       {
@@ -389,7 +756,8 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
         {
         // this should never happen
         SENSEI_ERROR("Block at " << it->GetCurrentFlatIndex() << " is null")
-        return false;
+        error = 1;
+        continue;
         }
 
       // skip writing blocks that have no data
@@ -402,7 +770,8 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
         {
         // this should never happen
         SENSEI_ERROR("Negative index! Dataset is " << cd->GetClassName())
-        return false;
+        error = 1;
+        continue;
         }
 
       std::string fileName =
@@ -420,7 +789,26 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
         vds->UpdateCellGhostArrayCache();
         }
 
-      if (this->Writer == VTKPosthocIO::WRITER_VTK_LEGACY)
+      if (this->Aggregation == VTKPosthocIO::AGGREGATE_NODE)
+        {
+        vtkXMLWriter *writer = newXMLWriter(vds);
+        if (!writer)
+          {
+          vds->Delete();
+          error = 1;
+          continue;
+          }
+        writer->SetInputData(vds);
+        writer->SetDataModeToAppended();
+        writer->EncodeAppendedDataOff();
+        writer->SetHeaderTypeToUInt64();
+        setCompressor(writer, this->Compressor);
+        writer->WriteToOutputStringOn();
+        writer->Write();
+        blocks.push_back(writer->GetOutputString());
+        writer->Delete();
+        }
+      else if (this->Writer == VTKPosthocIO::WRITER_VTK_LEGACY)
         {
         vtkDataSetWriter *writer = vtkDataSetWriter::New();
         writer->SetInputData(vds);
@@ -435,7 +823,7 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
         writer->SetInputData(vds);
         writer->SetDataModeToAppended();
         writer->EncodeAppendedDataOff();
-        writer->SetCompressorTypeToNone();
+        setCompressor(writer, this->Compressor);
         writer->SetFileName(fileName.c_str());
         writer->Write();
         writer->Delete();
@@ -445,6 +833,27 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
       }
     it->Delete();
 
+    // the aggregators can only write the step if all ranks succeeded
+    if (this->Aggregation == VTKPosthocIO::AGGREGATE_NODE)
+      MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_MAX,
+        this->GetCommunicator());
+
+    if (error)
+      {
+      SENSEI_ERROR("Failed to write mesh \"" << meshName << "\"")
+      dobj->Delete();
+      return false;
+      }
+
+    // send the blocks to the aggregators
+    std::vector<std::string> files;
+    if ((this->Aggregation == VTKPosthocIO::AGGREGATE_NODE) &&
+      this->WriteAggregated(meshName, this->FileId[meshName], blocks, files))
+      {
+      SENSEI_ERROR("Failed to write mesh \"" << meshName << "\"")
+      return false;
+      }
+
     // we count empty steps
     NameMap<long>::iterator fidIt = this->FileId.find(meshName);
     if (fidIt == this->FileId.end())
@@ -465,6 +874,12 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
       this->TimeStep[meshName].push_back(step);
 
       this->Metadata[meshName].push_back(mmd);
+
+      if (this->Aggregation == VTKPosthocIO::AGGREGATE_NODE)
+        {
+        this->AggregateFiles[meshName].push_back(files);
+        this->HaveBlockInfo[meshName] = 1;
+        }
       }
 
     dobj->Delete();
@@ -477,6 +892,240 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
   return true;
 }
 
+//-----------------------------------------------------------------------------
+int VTKPosthocIO::WriteAggregated(const std::string &meshName, long fileId,
+  const std::vector<std::string> &blocks, std::vector<std::string> &files)
+{
+  TimeEvent<128> mark("VTKPosthocIO::WriteAggregated");
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  MPI_Comm nodeComm = MPI_COMM_NULL;
+  MPI_Comm leaderComm = MPI_COMM_NULL;
+  MPIUtils::GetHierarchicalComms(comm, nodeComm, leaderComm);
+
+  int nodeRank = 0;
+  int nNodeRanks = 1;
+  MPI_Comm_rank(nodeComm, &nodeRank);
+  MPI_Comm_size(nodeComm, &nNodeRanks);
+
+  // group this rank's blocks by dataset element, and concatenate the
+  // appended data of each group
+  std::map<std::string, PieceGroup> groups;
+  std::map<std::string, std::string> binaries;
+
+  int error = 0;
+  unsigned int nBlocks = blocks.size();
+  for (unsigned int i = 0; i < nBlocks; ++i)
+    {
+    PieceGroup parts;
+    std::string binary;
+    if (splitXMLBlock(blocks[i], parts, binary))
+      {
+      SENSEI_ERROR("Failed to parse block " << i << " of mesh \""
+        << meshName << "\"")
+      error = 1;
+      continue;
+      }
+
+    appendPieces(groups[parts.Head], parts);
+    binaries[parts.Head] += binary;
+    }
+
+  // the node's aggregator can only write the file if all ranks succeeded
+  MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_MAX, comm);
+  if (error)
+    return -1;
+
+  // gather the description of the groups on the node's aggregator
+  BinaryStream str;
+  str.Pack(int(groups.size()));
+  std::map<std::string, PieceGroup>::iterator git = groups.begin();
+  for (; git != groups.end(); ++git)
+    {
+    PieceGroup &group = git->second;
+    str.Pack(group.Type);
+    str.Pack(group.Head);
+    str.Pack(group.FieldData);
+    str.Pack(group.Pieces);
+    str.Pack(group.Extent);
+    str.Pack(group.HaveExtent);
+    str.Pack(group.BinarySize);
+    }
+
+  int nBytes = str.Size();
+  std::vector<int> counts(nNodeRanks);
+  MPI_Gather(&nBytes, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, nodeComm);
+
+  std::vector<int> displ(nNodeRanks, 0);
+  for (int i = 1; i < nNodeRanks; ++i)
+    displ[i] = displ[i-1] + counts[i-1];
+
+  BinaryStream nodeStr;
+  if (nodeRank == 0)
+    nodeStr.Resize(displ[nNodeRanks-1] + counts[nNodeRanks-1]);
+
+  MPI_Gatherv(str.GetData(), nBytes, MPI_BYTE, nodeStr.GetData(),
+    counts.data(), displ.data(), MPI_BYTE, 0, nodeComm);
+
+  // ranks other than the aggregator send their appended data and are done
+  if (nodeRank != 0)
+    {
+    for (git = groups.begin(); git != groups.end(); ++git)
+      ::sendBinary(binaries[git->first], 0, nodeComm);
+
+    // learn if the aggregators wrote the files
+    MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_MAX, comm);
+    return error ? -1 : 0;
+    }
+
+  nodeStr.SetWritePos(displ[nNodeRanks-1] + counts[nNodeRanks-1]);
+
+  // merge the groups of the node's ranks, the appended data is ordered by rank
+  std::map<std::string, PieceGroup> nodeGroups;
+  std::vector<std::vector<std::pair<std::string, unsigned long>>>
+    rankGroups(nNodeRanks);
+
+  for (int i = 0; i < nNodeRanks; ++i)
+    {
+    int nGroups = 0;
+    nodeStr.Unpack(nGroups);
+    for (int j = 0; j < nGroups; ++j)
+      {
+      PieceGroup parts;
+      nodeStr.Unpack(parts.Type);
+      nodeStr.Unpack(parts.Head);
+      nodeStr.Unpack(parts.FieldData);
+      nodeStr.Unpack(parts.Pieces);
+      nodeStr.Unpack(parts.Extent);
+      nodeStr.Unpack(parts.HaveExtent);
+      nodeStr.Unpack(parts.BinarySize);
+
+      appendPieces(nodeGroups[parts.Head], parts);
+      rankGroups[i].push_back(std::make_pair(parts.Head, parts.BinarySize));
+      }
+    }
+
+  // write the head of each file, it contains the index of the appended data
+  int nodeId = 0;
+  MPI_Comm_rank(leaderComm, &nodeId);
+
+  std::map<std::string, std::ofstream> nodeFiles;
+  std::vector<std::string> nodeFileNames;
+
+  int groupId = 0;
+  for (git = nodeGroups.begin(); git != nodeGroups.end(); ++git, ++groupId)
+    {
+    PieceGroup &group = git->second;
+
+    std::string ext = getXMLExtension(group.Type);
+    std::string fileName = getAggregateFileName(this->OutputDir, meshName,
+      nodeId, groupId, fileId, ext);
+
+    std::ofstream &file = nodeFiles[git->first];
+    file.open(fileName, std::ios::binary);
+    if (!file)
+      {
+      // the appended data is still received below, writes to the
+      // failed stream are discarded
+      SENSEI_ERROR("Failed to open \"" << fileName << "\" for writing")
+      error = 1;
+      }
+
+    file << group.Head;
+    if (group.HaveExtent)
+      {
+      file << " WholeExtent=\"" << group.Extent[0];
+      for (int i = 1; i < 6; ++i)
+        file << " " << group.Extent[i];
+      file << "\"";
+      }
+    file << ">" << group.FieldData << group.Pieces << "</" << group.Type
+      << ">" << std::endl << "  <AppendedData encoding=\"raw\">" << std::endl
+      << "   _";
+
+    nodeFileNames.push_back(getAggregateFileName("./", meshName,
+      nodeId, groupId, fileId, ext));
+    }
+
+  // receive and write the appended data
+  std::vector<char> buffer;
+  for (int i = 0; i < nNodeRanks; ++i)
+    {
+    unsigned int nGroups = rankGroups[i].size();
+    for (unsigned int j = 0; j < nGroups; ++j)
+      {
+      const std::string &head = rankGroups[i][j].first;
+      std::ofstream &file = nodeFiles[head];
+
+      if (i == 0)
+        {
+        const std::string &binary = binaries[head];
+        file.write(binary.data(), binary.size());
+        }
+      else
+        {
+        ::receiveBinary(file, rankGroups[i][j].second, i, nodeComm, buffer);
+        }
+      }
+    }
+
+  std::map<std::string, std::ofstream>::iterator fit = nodeFiles.begin();
+  for (; fit != nodeFiles.end(); ++fit)
+    {
+    fit->second << std::endl << "  </AppendedData>" << std::endl
+      << "</VTKFile>" << std::endl;
+    fit->second.close();
+
+    if (!fit->second && !error)
+      {
+      SENSEI_ERROR("Failed to write the aggregated data of mesh \""
+        << meshName << "\"")
+      error = 1;
+      }
+    }
+
+  // rank 0 collects the file names of all nodes for the metadata files
+  BinaryStream nameStr;
+  nameStr.Pack(nodeFileNames);
+
+  int nNodes = 1;
+  MPI_Comm_size(leaderComm, &nNodes);
+
+  nBytes = nameStr.Size();
+  counts.resize(nNodes);
+  MPI_Gather(&nBytes, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, leaderComm);
+
+  displ.assign(nNodes, 0);
+  for (int i = 1; i < nNodes; ++i)
+    displ[i] = displ[i-1] + counts[i-1];
+
+  BinaryStream allNames;
+  if (nodeId == 0)
+    allNames.Resize(displ[nNodes-1] + counts[nNodes-1]);
+
+  MPI_Gatherv(nameStr.GetData(), nBytes, MPI_BYTE, allNames.GetData(),
+    counts.data(), displ.data(), MPI_BYTE, 0, leaderComm);
+
+  if (nodeId == 0)
+    {
+    allNames.SetWritePos(displ[nNodes-1] + counts[nNodes-1]);
+
+    files.clear();
+    for (int i = 0; i < nNodes; ++i)
+      {
+      std::vector<std::string> names;
+      allNames.Unpack(names);
+      files.insert(files.end(), names.begin(), names.end());
+      }
+    }
+
+  // agree with the other ranks on the outcome of the writes
+  MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_MAX, comm);
+
+  return error ? -1 : 0;
+}
+
 //-----------------------------------------------------------------------------
 int VTKPosthocIO::Finalize()
 {
@@ -511,6 +1160,26 @@ int VTKPosthocIO::Finalize()
 
     std::string &blockExt = this->BlockExt[meshName];
 
+    // the files written on each step
+    std::vector<std::vector<std::string>> files;
+    if (this->Aggregation == VTKPosthocIO::AGGREGATE_NODE)
+      {
+      files = this->AggregateFiles[meshName];
+      }
+    else
+      {
+      files.resize(nSteps);
+      for (long i = 0; i < nSteps; ++i)
+        {
+        for (long j = 0; j < mmd[i]->NumBlocks; ++j)
+          {
+          if (mmd[i]->BlockNumCells[j] > 0)
+            files[i].push_back(getBlockFileName("./", meshName,
+              mmd[i]->BlockIds[j], i, blockExt));
+          }
+        }
+      }
+
     if (this->Mode == VTKPosthocIO::MODE_PARAVIEW)
       {
       std::string pvdFileName = this->OutputDir + "/" + meshName + ".pvd";
@@ -529,19 +1198,12 @@ int VTKPosthocIO::Finalize()
 
       for (long i = 0; i < nSteps; ++i)
         {
-        for (long j = 0, k = 0; j < mmd[i]->NumBlocks; ++j)
+        long nFiles = files[i].size();
+        for (long k = 0; k < nFiles; ++k)
           {
-          if (mmd[i]->BlockNumCells[j] > 0)
-            {
-            std::string fileName =
-              getBlockFileName("./", meshName, mmd[i]->BlockIds[j], i, blockExt);
-
-            pvdFile << "<DataSet timestep=\"" << times[i]
-              << "\" group=\"\" part=\"" << k << "\" file=\"" << fileName
-              << "\"/>" << endl;
-
-            ++k;
-            }
+          pvdFile << "<DataSet timestep=\"" << times[i]
+            << "\" group=\"\" part=\"" << k << "\" file=\"" << files[i][k]
+            << "\"/>" << endl;
           }
         }
 
@@ -559,6 +1221,14 @@ int VTKPosthocIO::Finalize()
       int nBlocks = mmd[0]->NumBlocks;
       for (long i = 0; staticMesh && (i < nSteps); ++i)
         {
+        if (this->Aggregation == VTKPosthocIO::AGGREGATE_NODE)
+          {
+          if (files[i].size() != files[0].size())
+            staticMesh = 0;
+
+          continue;
+          }
+
         if (nBlocks != mmd[i]->NumBlocks)
           staticMesh = 0;
 
@@ -581,20 +1251,16 @@ int VTKPosthocIO::Finalize()
           return -1;
           }
 
-        visitFile << "!NBLOCKS " << mmd[0]->NumBlocks << std::endl;
+        visitFile << "!NBLOCKS " << files[0].size() << std::endl;
 
         for (long i = 0; i < nSteps; ++i)
           visitFile << "!TIME " << times[i] << std::endl;
 
         for (long i = 0; i < nSteps; ++i)
           {
-          for (long j = 0; j < mmd[i]->NumBlocks; ++j)
-            {
-            std::string fileName =
-              getBlockFileName("./", meshName, mmd[i]->BlockIds[j], i, blockExt);
-
-            visitFile << fileName << std::endl;
-            }
+          long nFiles = files[i].size();
+          for (long k = 0; k < nFiles; ++k)
+            visitFile << files[i][k] << std::endl;
           }
 
         visitFile.close();
@@ -604,14 +1270,7 @@ int VTKPosthocIO::Finalize()
         // write a .visit file per step
         for (long i = 0; i < nSteps; ++i)
           {
-          if (mmd[i]->NumBlocks < 1)
-            continue;
-
-          long numActiveBlocks = 0;
-          for (long j = 0; j < mmd[i]->NumBlocks; ++j)
-            if (mmd[i]->BlockNumCells[j] > 0)
-                ++numActiveBlocks;
-
+          long numActiveBlocks = files[i].size();
           if (numActiveBlocks < 1)
             continue;
 
@@ -631,16 +1290,8 @@ int VTKPosthocIO::Finalize()
           visitFile << "!NBLOCKS " << numActiveBlocks << std::endl;
           visitFile << "!TIME " << times[i] << std::endl;
 
-          for (long j = 0; j < mmd[i]->NumBlocks; ++j)
-            {
-            if (mmd[i]->BlockNumCells[j] > 0)
-              {
-              std::string fileName =
-                getBlockFileName("./", meshName, mmd[i]->BlockIds[j], i, blockExt);
-
-              visitFile << fileName << std::endl;
-              }
-            }
+          for (long k = 0; k < numActiveBlocks; ++k)
+            visitFile << files[i][k] << std::endl;
 
           visitFile.close();
           }
@@ -24,6 +24,17 @@ using VTKPosthocIOPtr = svtkSmartPointer<VTKPosthocIO>;
  * format. One must provide a set of data requirments, consisting of a list of
  * meshes and the arrays to write from each mesh. File names are derived using
  * the output directory, the mesh name, and the mode.
+ *
+ * By default each rank writes one file per block. At scale this results in
+ * a very large number of small files. In the aggregated mode the blocks of
+ * the ranks that share a node are sent to one aggregator rank per node, which
+ * writes them as the pieces of a single VTK XML file in appended mode. The
+ * Piece elements at the head of the file index the appended data by offset.
+ * Blocks whose dataset attributes differ, for instance the levels of an AMR
+ * mesh, are written to separate files. The .pvd and .visit files written by
+ * Finalize reference the aggregated files. The VTK XML writer's compressors
+ * may be used in either mode, compression takes place on the rank that owns
+ * the block before it is sent to the aggregator.
  */
 class SENSEI_EXPORT VTKPosthocIO : public AnalysisAdaptor
 {
@@ -60,6 +71,31 @@ public:
    */
   int SetWriter(std::string writer);
 
+  /// Aggregation modes.
+  enum {AGGREGATE_NONE=0, AGGREGATE_NODE=1};
+
+  /** Sets the aggregation mode. With AGGREGATE_NONE=0, the default, a file
+   * is written per block. With AGGREGATE_NODE=1 the blocks of each node are
+   * written to one file by an aggregator rank. Aggregation requires the XML
+   * writer.
+   */
+  int SetAggregation(int mode);
+
+  /// Sets the aggregation mode by string. Use either "none" or "node".
+  int SetAggregation(std::string mode);
+
+  /// Compressors for the XML writer.
+  enum {COMPRESSOR_NONE=0, COMPRESSOR_ZLIB=1, COMPRESSOR_LZ4=2,
+    COMPRESSOR_LZMA=3};
+
+  /** Sets the compressor used by the XML writer. COMPRESSOR_NONE=0 is the
+   * default. The legacy writer does not compress.
+   */
+  int SetCompressor(int compressor);
+
+  /// Sets the compressor by string. Use one of "none", "zlib", "lz4", or "lzma".
+  int SetCompressor(std::string compressor);
+
   /**  if set this overrides the default of vtkGhostType for ParaView and
    * avtGhostZones for VisIt
    */
@@ -104,6 +140,14 @@ protected:
   VTKPosthocIO(const VTKPosthocIO&) = delete;
   void operator=(const VTKPosthocIO&) = delete;
 
+  /** Sends the serialized blocks of this rank to the node's aggregator,
+   * which writes them. On rank 0 the names of the files written on all
+   * nodes are returned. This is collective over the communicator, and
+   * returns non-zero on all ranks if any rank failed.
+   */
+  int WriteAggregated(const std::string &meshName, long fileId,
+    const std::vector<std::string> &blocks, std::vector<std::string> &files);
+
 private:
 #if !defined(SWIG)
   unsigned int Frequency;
@@ -111,6 +155,8 @@ private:
   DataRequirements Requirements;
   int Mode;
   int Writer;
+  int Aggregation;
+  int Compressor;
   std::string GhostArrayName;
 
   template<typename T>
@@ -122,6 +168,7 @@ private:
   NameMap<std::string> BlockExt;
   NameMap<long> FileId;
   NameMap<int> HaveBlockInfo;
+  NameMap<std::vector<std::vector<std::string>>> AggregateFiles;
 #endif
 };
 
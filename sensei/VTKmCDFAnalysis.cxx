@@ -1,7 +1,7 @@
 #include "VTKmCDFAnalysis.h"
 
-#include "CDFReducer.h"
 #include "CinemaHelper.h"
+#include "QuantileSketch.h"
 #include "DataAdaptor.h"
 #include <Profiler.h>
 #include <Error.h>
@@ -9,8 +9,6 @@
 #include <vtkDataSet.h>
 #include <vtkCellData.h>
 #include <vtkIntArray.h>
-#include <vtkSortDataArray.h>
-#include <vtkDoubleArray.h>
 #include <vtkImageData.h>
 #ifdef ENABLE_VTK_MPI
 #  include <vtkMPICommunicator.h>
@@ -53,7 +51,7 @@ VTKmCDFAnalysis::VTKmCDFAnalysis()
   : Communicator(MPI_COMM_WORLD)
   , Helper(nullptr)
   , NumberOfQuantiles(10)
-  , RequestSize(10)
+  , SketchSize(200)
 {
 }
 
@@ -70,7 +68,7 @@ void VTKmCDFAnalysis::Initialize(
   const std::string& fieldAssoc,
   const std::string& workingDirectory,
   int numberOfQuantiles,
-  int requestSize,
+  int sketchSize,
   MPI_Comm comm
   )
 {
@@ -81,7 +79,7 @@ void VTKmCDFAnalysis::Initialize(
     vtkm::cont::Field::Association::POINTS;
   this->Communicator = comm;
   this->NumberOfQuantiles = numberOfQuantiles;
-  this->RequestSize = requestSize;
+  this->SketchSize = sketchSize;
 
 #ifdef ENABLE_VTK_MPI
   vtkNew<vtkMPIController> con;
@@ -169,42 +167,72 @@ bool VTKmCDFAnalysis::Execute(DataAdaptor* data, DataAdaptor** dataOut)
     }
   }
 
-  if (!array)
+  if (this->NumberOfQuantiles < 2)
   {
-    SENSEI_ERROR("Could not obtain array \"" << this->FieldName << "\" from data adaptor.");
+    SENSEI_ERROR("Invalid CDF request (bad number of quantiles).");
     return false;
   }
 
-  if (array->GetNumberOfComponents() > 1)
+  // errors found on one rank are agreed on by all before the collective
+  // reduction of the sketches
+  int error = 0;
+  if (!array)
+  {
+    SENSEI_ERROR("Could not obtain array \"" << this->FieldName << "\" from data adaptor.");
+    error = 1;
+  }
+  else if (array->GetNumberOfComponents() > 1)
   {
     SENSEI_ERROR("Cannot compute CDF of multi-component (vector, non-scalar)  array.");
-    return false;
+    error = 1;
   }
 
-  if (this->NumberOfQuantiles <= 0)
+  // stream the values into a sketch, and merge the sketches of all ranks
+  // on rank 0 with a single tree reduction
+  Profiler::StartEvent("VTKm CDF");
+  QuantileSketch sketch(this->SketchSize);
+  if (!error)
   {
-    SENSEI_ERROR("Invalid CDF request (bad number of quantiles).");
+    switch (array->GetDataType())
+    {
+      vtkTemplateMacro(
+        sketch.Insert(static_cast<VTK_TT*>(array->GetVoidPointer(0)),
+          array->GetNumberOfTuples(), nullptr));
+      default:
+      {
+        SENSEI_ERROR("Unsupported array type " << array->GetClassName());
+        error = 1;
+      }
+    }
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_MAX, this->Communicator);
+  if (error)
+  {
+    Profiler::EndEvent("VTKm CDF");
     return false;
   }
 
-  Profiler::StartEvent("VTKm CDF");
-  vtkNew<vtkDoubleArray> sorted;
-  sorted->DeepCopy(array);
-  vtkSortDataArray::SortArrayByComponent(sorted, 0);
+  if (sketch.Reduce(this->Communicator, 0))
+  {
+    SENSEI_ERROR("Failed to reduce the quantile sketches");
+    MPI_Abort(this->Communicator, -1);
+    return false;
+  }
 
-#ifdef ENABLE_VTK_MPI
-  vtkNew<vtkMPIController> controller;
-#else
-  vtkNew<vtkMultiProcessController> controller;
-#endif
-  CDFReducer reducer(controller);
-  reducer.SetBufferSize(this->RequestSize);
+  int rank = 0;
+  MPI_Comm_rank(this->Communicator, &rank);
 
-  double* cdf = reducer.Compute(sorted->GetPointer(0), sorted->GetNumberOfTuples(), this->NumberOfQuantiles);
+  std::vector<double> cdf;
+  if ((rank == 0) && (sketch.GetQuantiles(this->NumberOfQuantiles, cdf)))
+  {
+    Profiler::EndEvent("VTKm CDF");
+    return false;
+  }
   Profiler::EndEvent("VTKm CDF");
 
   Profiler::StartEvent("Cinema CDF export");
-  this->Helper->WriteCDF(this->NumberOfQuantiles, cdf);
+  this->Helper->WriteCDF(this->NumberOfQuantiles, cdf.data());
   this->Helper->WriteMetadata();
   Profiler::EndEvent("Cinema CDF export");
 
@@ -21,7 +21,7 @@ public:
     const std::string& fieldAssoc,
     const std::string& workingDirectory,
     int numberOfQuantiles,
-    int requestSize,
+    int sketchSize,
     MPI_Comm comm);
 
   bool Execute(DataAdaptor* data, DataAdaptor**) override;
@@ -38,7 +38,7 @@ protected:
   MPI_Comm Communicator;
   CinemaHelper* Helper;
   int NumberOfQuantiles;
-  int RequestSize;
+  int SketchSize;
 
 private:
   VTKmCDFAnalysis(const VTKmCDFAnalysis&);
@@ -0,0 +1,357 @@
+#include "WeightedPartitioner.h"
+#include "SVTKUtils.h"
+#include "Profiler.h"
+
+#include <svtkDataObject.h>
+
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+// --------------------------------------------------------------------------
+int AssignLPT(const std::vector<long long> &costs, int nRanks,
+  std::vector<int> &owner, std::vector<long long> &load)
+{
+  int nBlocks = costs.size();
+
+  // visit the blocks from the most to the least expensive
+  std::vector<int> order(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(),
+    [&costs](int a, int b) -> bool { return costs[a] > costs[b]; });
+
+  // the least loaded rank is on top, ties go to the lower rank
+  using rankLoad = std::pair<long long, int>;
+  std::priority_queue<rankLoad, std::vector<rankLoad>,
+    std::greater<rankLoad>> ranks;
+
+  for (int i = 0; i < nRanks; ++i)
+    ranks.push(rankLoad(0, i));
+
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    int bid = order[i];
+
+    rankLoad rl = ranks.top();
+    ranks.pop();
+
+    owner[bid] = rl.second;
+    rl.first += costs[bid];
+    load[rl.second] = rl.first;
+
+    ranks.push(rl);
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int CountRuns(const std::vector<long long> &costs, long long bound)
+{
+  // the number of runs of consecutive blocks, each with a cost of at most
+  // bound, needed to cover all of the blocks
+  int nRuns = 1;
+  long long sum = 0;
+  int nBlocks = costs.size();
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    if (sum + costs[i] > bound)
+      {
+      ++nRuns;
+      sum = 0;
+      }
+    sum += costs[i];
+    }
+  return nRuns;
+}
+
+}
+
+namespace sensei
+{
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::SplitContiguous(const std::vector<long long> &costs,
+  int nRanks, std::vector<int> &owner, std::vector<long long> &load)
+{
+  int nBlocks = costs.size();
+  if (nBlocks == 0)
+    return 0;
+
+  // the smallest maximum load is between the largest block and the total.
+  // search for the smallest for which the blocks fit on the ranks
+  long long lo = *std::max_element(costs.begin(), costs.end());
+  long long hi = 0;
+  for (int i = 0; i < nBlocks; ++i)
+    hi += costs[i];
+
+  while (lo < hi)
+    {
+    long long mid = lo + (hi - lo) / 2;
+    if (::CountRuns(costs, mid) <= nRanks)
+      hi = mid;
+    else
+      lo = mid + 1;
+    }
+
+  // assign the runs to ranks in order. stop starting new runs once the
+  // remaining blocks are needed one per rank, so that no rank goes idle
+  // when there are at least as many blocks as ranks
+  int rank = 0;
+  long long sum = 0;
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    bool full = sum + costs[i] > lo;
+    bool needed = (nBlocks - i) <= (nRanks - rank - 1);
+    if ((sum > 0) && (full || needed) && (rank < nRanks - 1))
+      {
+      ++rank;
+      sum = 0;
+      }
+    sum += costs[i];
+    owner[i] = rank;
+    load[rank] = sum;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::SetCostModel(int model)
+{
+  if ((model < COST_BLOCKS) || (model > COST_BYTES))
+    {
+    SENSEI_ERROR("Invalid cost model " << model)
+    return -1;
+    }
+
+  this->CostModel = model;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::SetCostModel(const std::string &model)
+{
+  if (model == "blocks")
+    return this->SetCostModel(COST_BLOCKS);
+  else if (model == "cells")
+    return this->SetCostModel(COST_CELLS);
+  else if (model == "points")
+    return this->SetCostModel(COST_POINTS);
+  else if (model == "bytes")
+    return this->SetCostModel(COST_BYTES);
+
+  SENSEI_ERROR("Invalid cost model \"" << model << "\". Use one of "
+    "\"blocks\", \"cells\", \"points\", or \"bytes\"")
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::SetMethod(int method)
+{
+  if ((method != METHOD_LPT) && (method != METHOD_CONTIGUOUS))
+    {
+    SENSEI_ERROR("Invalid method " << method)
+    return -1;
+    }
+
+  this->Method = method;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::SetMethod(const std::string &method)
+{
+  if (method == "lpt")
+    return this->SetMethod(METHOD_LPT);
+  else if (method == "contiguous")
+    return this->SetMethod(METHOD_CONTIGUOUS);
+
+  SENSEI_ERROR("Invalid method \"" << method << "\". Use one of "
+    "\"lpt\" or \"contiguous\"")
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::GetBlockCosts(const MeshMetadataPtr &md,
+  std::vector<long long> &costs)
+{
+  int nBlocks = md->NumBlocks;
+
+  // each block costs at least one so that empty blocks are spread out too
+  costs.assign(nBlocks, 1);
+
+  if (this->CostModel == COST_BLOCKS)
+    return 0;
+
+  bool haveCells = int(md->BlockNumCells.size()) == nBlocks;
+  bool havePoints = int(md->BlockNumPoints.size()) == nBlocks;
+
+  if (((this->CostModel == COST_CELLS) && !haveCells) ||
+    ((this->CostModel == COST_POINTS) && !havePoints) ||
+    ((this->CostModel == COST_BYTES) && !(haveCells && havePoints)))
+    {
+    SENSEI_WARNING("Mesh \"" << md->MeshName << "\" metadata is missing "
+      "the block sizes. Each block will have the same cost.")
+    return 0;
+    }
+
+  if (this->CostModel == COST_CELLS)
+    {
+    for (int i = 0; i < nBlocks; ++i)
+      costs[i] += md->BlockNumCells[i];
+    return 0;
+    }
+
+  if (this->CostModel == COST_POINTS)
+    {
+    for (int i = 0; i < nBlocks; ++i)
+      costs[i] += md->BlockNumPoints[i];
+    return 0;
+    }
+
+  // the bytes per point and per cell of the requested arrays
+  long long pointBytes = 0;
+  long long cellBytes = 0;
+  for (int j = 0; j < md->NumArrays; ++j)
+    {
+    if (!this->Arrays.empty() && (std::find(this->Arrays.begin(),
+      this->Arrays.end(), md->ArrayName[j]) == this->Arrays.end()))
+      continue;
+
+    long long nBytes = md->ArrayComponents[j] * SVTKUtils::Size(md->ArrayType[j]);
+
+    if (md->ArrayCentering[j] == svtkDataObject::POINT)
+      pointBytes += nBytes;
+    else if (md->ArrayCentering[j] == svtkDataObject::CELL)
+      cellBytes += nBytes;
+    }
+
+  if ((pointBytes == 0) && (cellBytes == 0))
+    {
+    SENSEI_WARNING("None of the requested arrays were found on mesh \""
+      << md->MeshName << "\". The number of cells will be used as the cost.")
+    cellBytes = 1;
+    }
+
+  for (int i = 0; i < nBlocks; ++i)
+    costs[i] += pointBytes*md->BlockNumPoints[i] + cellBytes*md->BlockNumCells[i];
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::GetPartition(MPI_Comm comm, const MeshMetadataPtr &mdIn,
+  MeshMetadataPtr &mdOut)
+{
+  TimeEvent<128> mark("WeightedPartitioner::GetPartition");
+
+  mdOut = mdIn->NewCopy();
+
+  int nRanks = 1;
+  MPI_Comm_size(comm, &nRanks);
+
+  std::vector<long long> costs;
+  if (this->GetBlockCosts(mdIn, costs))
+    {
+    SENSEI_ERROR("Failed to compute the block costs")
+    return -1;
+    }
+
+  mdOut->BlockOwner.resize(mdOut->NumBlocks);
+  std::vector<long long> load(nRanks, 0);
+
+  if (this->Method == METHOD_LPT)
+    ::AssignLPT(costs, nRanks, mdOut->BlockOwner, load);
+  else
+    WeightedPartitioner::SplitContiguous(costs, nRanks, mdOut->BlockOwner, load);
+
+  this->ReportImbalance(comm, mdIn, load);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void WeightedPartitioner::ReportImbalance(MPI_Comm comm,
+  const MeshMetadataPtr &md, const std::vector<long long> &load)
+{
+  int nRanks = load.size();
+
+  long long maxLoad = 0;
+  long long totalLoad = 0;
+  for (int i = 0; i < nRanks; ++i)
+    {
+    maxLoad = std::max(maxLoad, load[i]);
+    totalLoad += load[i];
+    }
+
+  this->Imbalance = totalLoad ?
+    double(maxLoad)*double(nRanks)/double(totalLoad) : 1.0;
+
+  // the event names are fixed so that the events of all steps can be
+  // aggregated. the imbalance is the ratio of the two values
+  long long meanLoad = nRanks ? (totalLoad + nRanks/2)/nRanks : 0;
+
+  Profiler::StartEvent("WeightedPartitioner::GetPartition maxLoad", maxLoad);
+  Profiler::EndEvent("WeightedPartitioner::GetPartition maxLoad", maxLoad);
+
+  Profiler::StartEvent("WeightedPartitioner::GetPartition meanLoad", meanLoad);
+  Profiler::EndEvent("WeightedPartitioner::GetPartition meanLoad", meanLoad);
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+  if ((rank == 0) && this->GetVerbose())
+    {
+    SENSEI_STATUS(<< this->GetClassName() << ": mesh=\"" << md->MeshName
+      << "\" NumBlocks=" << md->NumBlocks << " nRanks=" << nRanks
+      << " maxLoad=" << maxLoad << " meanLoad=" << double(totalLoad)/nRanks
+      << " imbalance=" << this->Imbalance)
+    }
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::Initialize(pugi::xml_node &node)
+{
+  TimeEvent<128> mark("WeightedPartitioner::Initialize");
+
+  if (this->InitializeCostModel(node) ||
+    this->SetMethod(node.attribute("method").as_string("lpt")))
+    return -1;
+
+  SENSEI_STATUS("Configured WeightedPartitioner cost="
+    << node.attribute("cost").as_string("cells") << " method="
+    << node.attribute("method").as_string("lpt") << " arrays="
+    << node.attribute("arrays").as_string("all"))
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int WeightedPartitioner::InitializeCostModel(pugi::xml_node &node)
+{
+  if (this->SetCostModel(node.attribute("cost").as_string("cells")))
+    return -1;
+
+  this->Arrays.clear();
+  std::istringstream iss(node.attribute("arrays").as_string(""));
+  std::string array;
+  while (std::getline(iss, array, ','))
+    {
+    array.erase(0, array.find_first_not_of(" \t"));
+    array.erase(array.find_last_not_of(" \t") + 1);
+    if (!array.empty())
+      this->Arrays.push_back(array);
+    }
+
+  return 0;
+}
+
+}
@@ -0,0 +1,107 @@
+#ifndef sensei_WeightedPartitioner_h
+#define sensei_WeightedPartitioner_h
+
+#include "Partitioner.h"
+
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+class WeightedPartitioner;
+using WeightedPartitionerPtr = std::shared_ptr<sensei::WeightedPartitioner>;
+
+/// @class WeightedPartitioner
+/// The weighted partitioner assigns blocks to ranks such that the maximum
+/// per rank load is minimized. The load of a block is given by a cost model
+/// computed from the block sizes in the MeshMetadata, one of: the number of
+/// cells, the number of points, or the number of bytes of the data arrays.
+/// Two methods are provided. The LPT (longest processing time first) method
+/// assigns blocks in decreasing order of cost to the least loaded rank. The
+/// contiguous method keeps consecutive blocks together, and finds the split
+/// of the block list into consecutive runs with the smallest maximum load.
+///
+/// The XML attributes are `cost` (`cells`, `points`, `bytes`, or `blocks`),
+/// `method` (`lpt` or `contiguous`), and `arrays`, a comma separated list of
+/// the arrays counted by the `bytes` cost model. When no arrays are given all
+/// arrays are counted.
+///
+/// The achieved imbalance is the maximum per rank load divided by the mean.
+/// It is returned by GetImbalance and printed when verbose. The loads are
+/// reported through the Profiler as zero length events named
+/// `WeightedPartitioner::GetPartition maxLoad` and
+/// `WeightedPartitioner::GetPartition meanLoad` which carry the load in the
+/// bytes field.
+class SENSEI_EXPORT WeightedPartitioner : public sensei::Partitioner
+{
+public:
+  static sensei::WeightedPartitionerPtr New()
+  { return WeightedPartitionerPtr(new WeightedPartitioner); }
+
+  const char *GetClassName() override { return "WeightedPartitioner"; }
+
+  // given an existing partitioning of data passed in the first MeshMetadata
+  // argument,return a new partittioning in the second MeshMetadata argument.
+  // blocks are distributed such that the maximum per rank cost is minimized.
+  int GetPartition(MPI_Comm comm, const sensei::MeshMetadataPtr &in,
+     sensei::MeshMetadataPtr &out) override;
+
+  // Initialize from XML
+  int Initialize(pugi::xml_node &node) override;
+
+  /// the cost models
+  enum {COST_BLOCKS=0, COST_CELLS=1, COST_POINTS=2, COST_BYTES=3};
+
+  /// Set/get the cost model, one of "blocks", "cells", "points", or "bytes"
+  int SetCostModel(int model);
+  int SetCostModel(const std::string &model);
+  int GetCostModel() const { return this->CostModel; }
+
+  /// the partitioning methods
+  enum {METHOD_LPT=0, METHOD_CONTIGUOUS=1};
+
+  /// Set/get the partitioning method, one of "lpt" or "contiguous"
+  int SetMethod(int method);
+  int SetMethod(const std::string &method);
+  int GetMethod() const { return this->Method; }
+
+  /// Set the arrays counted by the "bytes" cost model, empty means all
+  void SetArrays(const std::vector<std::string> &arrays)
+  { this->Arrays = arrays; }
+
+  /** compute the cost of each block of the mesh. when the metadata lacks the
+   * block sizes needed by the cost model each block has a cost of one */
+  int GetBlockCosts(const sensei::MeshMetadataPtr &md,
+    std::vector<long long> &costs);
+
+  /// get the imbalance achieved by the most recent call to GetPartition
+  double GetImbalance() const { return this->Imbalance; }
+
+protected:
+  WeightedPartitioner() : CostModel(COST_CELLS), Method(METHOD_LPT),
+    Imbalance(1.0) {}
+  WeightedPartitioner(const WeightedPartitioner &) = default;
+
+  /// initialize the cost model from the cost and arrays XML attributes
+  int InitializeCostModel(pugi::xml_node &node);
+
+  /** split the blocks into at most nRanks runs of consecutive blocks such
+   * that the maximum cost of a run is minimized. the run of each block and
+   * the cost of each run are returned */
+  static int SplitContiguous(const std::vector<long long> &costs, int nRanks,
+    std::vector<int> &owner, std::vector<long long> &load);
+
+  /// compute, record in the profiler, and optionally report the imbalance
+  void ReportImbalance(MPI_Comm comm, const sensei::MeshMetadataPtr &md,
+    const std::vector<long long> &load);
+
+  int CostModel;
+  int Method;
+  std::vector<std::string> Arrays;
+  double Imbalance;
+};
+
+}
+
+#endif
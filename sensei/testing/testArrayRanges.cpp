@@ -0,0 +1,118 @@
+#include <iostream>
+#include <limits>
+#include <vector>
+#include <array>
+#include <mpi.h>
+#include <svtkPointData.h>
+#include <svtkDoubleArray.h>
+#include <svtkFloatArray.h>
+#include <svtkIntArray.h>
+#include <svtkUnsignedCharArray.h>
+#include <svtkSOADataArrayTemplate.h>
+#include <svtkDataSetAttributes.h>
+#include "Error.h"
+#include "SVTKUtils.h"
+
+// the ghost zones hold values far outside the range of the valid data
+const double gGhostVal = 1.0e6;
+
+bool ghost(int i) { return (i < 8) || (i % 97 == 0); }
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int n = 100000;
+
+  svtkPointData *pd = svtkPointData::New();
+
+  svtkUnsignedCharArray *ga = svtkUnsignedCharArray::New();
+  ga->SetName("svtkGhostType");
+  ga->SetNumberOfTuples(n);
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName("d");
+  da->SetNumberOfTuples(n);
+
+  svtkFloatArray *fa = svtkFloatArray::New();
+  fa->SetName("f");
+  fa->SetNumberOfComponents(3);
+  fa->SetNumberOfTuples(n);
+
+  svtkSOADataArrayTemplate<int> *ia = svtkSOADataArrayTemplate<int>::New();
+  ia->SetName("i");
+  ia->SetNumberOfComponents(2);
+  ia->SetNumberOfTuples(n);
+
+  for (int i = 0; i < n; ++i)
+    {
+    bool g = ghost(i);
+    ga->SetValue(i, g ? svtkDataSetAttributes::DUPLICATEPOINT : 0);
+    da->SetValue(i, g ? gGhostVal : -double(i));
+    fa->SetTypedComponent(i, 0, g ? -gGhostVal : 0.5f*i);
+    fa->SetTypedComponent(i, 1, gGhostVal);
+    fa->SetTypedComponent(i, 2, -gGhostVal);
+    ia->SetTypedComponent(i, 0, g ? gGhostVal : i % 1000);
+    ia->SetTypedComponent(i, 1, -gGhostVal);
+    }
+
+  pd->AddArray(da);
+  pd->AddArray(ga);
+  pd->AddArray(fa);
+  pd->AddArray(ia);
+
+  // the expected ranges, without the ghost zones
+  std::vector<std::array<double,2>> expected(4,
+    {std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()});
+  for (int i = 0; i < n; ++i)
+    {
+    if (ghost(i))
+      continue;
+    double vals[3] = {-double(i), 0.5*i, double(i % 1000)};
+    int ids[3] = {0, 2, 3};
+    for (int j = 0; j < 3; ++j)
+      {
+      expected[ids[j]][0] = std::min(expected[ids[j]][0], vals[j]);
+      expected[ids[j]][1] = std::max(expected[ids[j]][1], vals[j]);
+      }
+    }
+  expected[1] = {0.0, double(svtkDataSetAttributes::DUPLICATEPOINT)};
+
+  int ierr = 0;
+  for (int pass = 0; pass < 3; ++pass)
+    {
+    // the second pass comes from the cache, the third follows a modification
+    if (pass == 2)
+      {
+      da->SetValue(n - 1, -2.0*n);
+      da->Modified();
+      expected[0][0] = -2.0*n;
+      }
+
+    std::vector<std::array<double,2>> ranges;
+    sensei::SVTKUtils::GetArrayRanges(pd, ranges);
+
+    for (int j = 0; j < 4; ++j)
+      {
+      if (ranges[j] != expected[j])
+        {
+        SENSEI_ERROR("Pass " << pass << " array " << j << " range ["
+          << ranges[j][0] << ", " << ranges[j][1] << "] expected ["
+          << expected[j][0] << ", " << expected[j][1] << "]")
+        ierr = -1;
+        }
+      }
+    }
+
+  da->Delete();
+  fa->Delete();
+  ia->Delete();
+  ga->Delete();
+  pd->Delete();
+
+  std::cerr << "testArrayRanges " << (ierr ? "failed" : "passed") << std::endl;
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
@@ -0,0 +1,350 @@
+#include "Autocorrelation.h"
+#include "SVTKDataAdaptor.h"
+#include "Error.h"
+
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataObject.h>
+#include <svtkFieldData.h>
+#include <svtkFloatArray.h>
+#include <svtkImageData.h>
+#include <svtkIntArray.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkPolyData.h>
+#include <svtkSmartPointer.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <vector>
+#include <iostream>
+
+#include <mpi.h>
+
+// the grid is split along x into blocks of nx by ny by nz points, each rank
+// has two blocks
+const int nx = 4;
+const int ny = 8;
+const int nz = 8;
+const int nBlocksPerRank = 2;
+
+const int nSteps = 24;
+const int outputFrequency = 12;
+const size_t window = 8;
+const size_t kMax = 3;
+const float dt = 0.05f;
+
+// a damped and a periodic oscillator as in the oscillator miniapp
+float evaluate(int i, int j, int k, float t)
+{
+  const float pi = 3.14159265358979323846f;
+  t *= 2.0f*pi;
+
+  auto gaussian = [&](float cx, float cy, float cz, float r) -> float
+    {
+    float dx = cx - i;
+    float dy = cy - j;
+    float dz = cz - k;
+    return std::exp(-(dx*dx + dy*dy + dz*dz)/(2.0f*r*r));
+    };
+
+  // damped
+  float omega0 = 3.14f;
+  float zeta = 0.3f;
+  float phi = std::acos(zeta);
+  float damped = (1.0f - std::exp(-zeta*omega0*t) *
+    (std::sin(std::sqrt(1.0f - zeta*zeta)*omega0*t + phi) / std::sin(phi))) *
+    gaussian(3.0f, 4.0f, 4.0f, 3.0f);
+
+  // periodic
+  float tp = t + 1.0f/omega0;
+  float periodic = std::sin(tp/omega0) * gaussian(6.0f, 2.0f, 5.0f, 4.0f);
+
+  return damped + periodic;
+}
+
+// the autocorrelation of every point of the grid computed directly in double
+// precision
+void reference(int nGlobalBlocks, std::map<std::array<int,3>, std::vector<double>> &corr)
+{
+  for (int i = 0; i < nx*nGlobalBlocks; ++i)
+    {
+    for (int j = 0; j < ny; ++j)
+      {
+      for (int k = 0; k < nz; ++k)
+        {
+        std::vector<double> vals(nSteps);
+        for (int t = 0; t < nSteps; ++t)
+          vals[t] = evaluate(i, j, k, t*dt);
+
+        std::vector<double> &c = corr[{{i, j, k}}];
+        c.assign(window, 0.0);
+        for (size_t lag = 1; lag <= window; ++lag)
+          for (int t = lag; t < nSteps; ++t)
+            c[lag - 1] += vals[t]*vals[t - lag];
+        }
+      }
+    }
+}
+
+bool equal(double a, double b)
+{
+  return std::fabs(a - b) <= 1.0e-3*std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+}
+
+// check the results returned by Execute against the reference. rank 0 has
+// all of the points, the other ranks none.
+int validate(sensei::DataAdaptor *result, int rank,
+  std::map<std::array<int,3>, std::vector<double>> &corr, const char *mode)
+{
+  if (!result)
+    {
+    SENSEI_ERROR(<< mode << " mode did not return results")
+    return -1;
+    }
+
+  svtkDataObject *dobj = nullptr;
+  if (result->GetMesh("autocorrelation", false, dobj) || !dobj)
+    {
+    SENSEI_ERROR(<< mode << " mode results have no mesh")
+    return -1;
+    }
+
+  svtkSmartPointer<svtkDataObject> mesh;
+  mesh.TakeReference(dobj);
+
+  if (result->AddArray(dobj, "autocorrelation", svtkDataObject::POINT, "autocorrelation") ||
+    result->AddArray(dobj, "autocorrelation", svtkDataObject::POINT, "lag") ||
+    result->AddArray(dobj, "autocorrelation", svtkDataObject::FIELD, "autocorrelation_sum"))
+    {
+    SENSEI_ERROR(<< mode << " mode results are missing arrays")
+    return -1;
+    }
+
+  // the polydata is the local block of the multiblock
+  svtkPolyData *pd = nullptr;
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj))
+    {
+    svtkCompositeDataIterator *it = cd->NewIterator();
+    if (!it->IsDoneWithTraversal())
+      pd = svtkPolyData::SafeDownCast(cd->GetDataSet(it));
+    it->Delete();
+    }
+
+  if (!pd)
+    {
+    SENSEI_ERROR(<< mode << " mode results are not polydata")
+    return -1;
+    }
+
+  svtkFloatArray *values = svtkFloatArray::SafeDownCast(
+    pd->GetPointData()->GetArray("autocorrelation"));
+
+  svtkIntArray *lags = svtkIntArray::SafeDownCast(
+    pd->GetPointData()->GetArray("lag"));
+
+  svtkFloatArray *sums = svtkFloatArray::SafeDownCast(
+    pd->GetFieldData()->GetArray("autocorrelation_sum"));
+
+  if (!values || !lags || !sums)
+    {
+    SENSEI_ERROR(<< mode << " mode results are missing arrays")
+    return -1;
+    }
+
+  svtkIdType nPts = pd->GetNumberOfPoints();
+
+  if (rank != 0)
+    {
+    if (nPts || pd->GetNumberOfVerts() || sums->GetNumberOfTuples())
+      {
+      SENSEI_ERROR(<< mode << " mode results on rank " << rank << " are not empty")
+      return -1;
+      }
+    return 0;
+    }
+
+  if ((nPts != svtkIdType(window*kMax)) || (pd->GetNumberOfVerts() != nPts) ||
+    (sums->GetNumberOfTuples() != svtkIdType(window)))
+    {
+    SENSEI_ERROR(<< mode << " mode returned " << nPts << " points and "
+      << sums->GetNumberOfTuples() << " sums")
+    return -1;
+    }
+
+  // the sum over all points of each lag
+  std::vector<double> refSums(window, 0.0);
+  for (auto &it : corr)
+    for (size_t w = 0; w < window; ++w)
+      refSums[w] += it.second[w];
+
+  for (size_t w = 0; w < window; ++w)
+    {
+    if (!equal(sums->GetValue(w), refSums[w]))
+      {
+      SENSEI_ERROR(<< mode << " mode sum of lag " << w + 1 << " is "
+        << sums->GetValue(w) << " expected " << refSums[w])
+      return -1;
+      }
+    }
+
+  // the strongest of each lag. points with nearly the same value may be
+  // reported in either order, so the values are compared in order, and the
+  // value reported for each point is checked against that point's reference
+  for (size_t w = 0; w < window; ++w)
+    {
+    std::vector<double> refMax;
+    for (auto &it : corr)
+      refMax.push_back(it.second[w]);
+
+    std::sort(refMax.begin(), refMax.end(), std::greater<double>());
+
+    for (size_t q = 0; q < kMax; ++q)
+      {
+      svtkIdType id = w*kMax + q;
+
+      double x[3];
+      pd->GetPoint(id, x);
+      std::array<int,3> pos{{int(x[0]), int(x[1]), int(x[2])}};
+
+      auto it = corr.find(pos);
+
+      if ((lags->GetValue(id) != int(w + 1)) || (it == corr.end()) ||
+        !equal(values->GetValue(id), it->second[w]) ||
+        !equal(values->GetValue(id), refMax[q]))
+        {
+        SENSEI_ERROR(<< mode << " mode strongest autocorrelation " << q
+          << " of lag " << w + 1 << " is " << values->GetValue(id) << " at "
+          << pos[0] << " " << pos[1] << " " << pos[2] << " with lag "
+          << lags->GetValue(id) << " expected " << refMax[q])
+        return -1;
+        }
+      }
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int nGlobalBlocks = nBlocksPerRank*nRanks;
+
+  sensei::Autocorrelation *direct = sensei::Autocorrelation::New();
+  direct->Initialize(window, "mesh", svtkDataObject::POINT, "data", kMax, 2);
+  direct->SetOutputFrequency(outputFrequency);
+
+  sensei::Autocorrelation *fft = sensei::Autocorrelation::New();
+  fft->Initialize(window, "mesh", svtkDataObject::POINT, "data", kMax, 2);
+  fft->SetMode(sensei::Autocorrelation::MODE_FFT);
+  fft->SetOutputFrequency(outputFrequency);
+
+  std::map<std::array<int,3>, std::vector<double>> corr;
+  if (rank == 0)
+    reference(nGlobalBlocks, corr);
+
+  int status = 0;
+
+  for (int step = 0; step < nSteps; ++step)
+    {
+    float t = step*dt;
+
+    svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+    mb->SetNumberOfBlocks(nGlobalBlocks);
+
+    for (int q = 0; q < nBlocksPerRank; ++q)
+      {
+      int bid = rank*nBlocksPerRank + q;
+      int i0 = bid*nx;
+
+      svtkImageData *im = svtkImageData::New();
+      im->SetExtent(i0, i0 + nx - 1, 0, ny - 1, 0, nz - 1);
+
+      svtkFloatArray *fa = svtkFloatArray::New();
+      fa->SetName("data");
+      fa->SetNumberOfTuples(nx*ny*nz);
+
+      // x varies fastest
+      float *pfa = fa->GetPointer(0);
+      for (int k = 0; k < nz; ++k)
+        for (int j = 0; j < ny; ++j)
+          for (int i = 0; i < nx; ++i)
+            pfa[(k*ny + j)*nx + i] = evaluate(i0 + i, j, k, t);
+
+      im->GetPointData()->AddArray(fa);
+      fa->Delete();
+
+      mb->SetBlock(bid, im);
+      im->Delete();
+      }
+
+    sensei::SVTKDataAdaptor *da = sensei::SVTKDataAdaptor::New();
+    da->SetDataObject("mesh", mb);
+    da->SetDataTimeStep(step);
+    da->SetDataTime(t);
+    mb->Delete();
+
+    sensei::DataAdaptor *directOut = nullptr;
+    sensei::DataAdaptor *fftOut = nullptr;
+
+    if (!direct->Execute(da, &directOut) || !fft->Execute(da, &fftOut))
+      {
+      SENSEI_ERROR("Failed to execute step " << step)
+      status = -1;
+      }
+
+    // results are not returned through dataOut, which simulations treat as
+    // steering data
+    if (directOut || fftOut)
+      {
+      SENSEI_ERROR("Results were returned through dataOut at step " << step)
+      status = -1;
+      }
+
+    // results are made available at the requested frequency
+    sensei::DataAdaptor *directRes = direct->GetResults();
+    sensei::DataAdaptor *fftRes = fft->GetResults();
+
+    bool haveOutput = ((step + 1) % outputFrequency) == 0;
+    if (haveOutput != bool(directRes) || haveOutput != bool(fftRes))
+      {
+      SENSEI_ERROR("Results " << (haveOutput ? "were not" : "were")
+        << " available at step " << step)
+      status = -1;
+      }
+
+    // check the final results
+    if ((step == nSteps - 1) &&
+      (validate(directRes, rank, corr, "direct") ||
+      validate(fftRes, rank, corr, "FFT")))
+      status = -1;
+
+    if (directOut)
+      directOut->Delete();
+
+    if (fftOut)
+      fftOut->Delete();
+
+    da->ReleaseData();
+    da->Delete();
+    }
+
+  direct->Finalize();
+  direct->Delete();
+
+  fft->Finalize();
+  fft->Delete();
+
+  MPI_Finalize();
+
+  return status;
+}
@@ -0,0 +1,220 @@
+#include "CachingDataAdaptor.h"
+#include "ProgrammableDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "Histogram.h"
+#include "Error.h"
+
+#include <svtkDataObject.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include <svtkDoubleArray.h>
+
+#include <vector>
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+#include <mpi.h>
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  std::vector<unsigned int> baselineHist = {1,2,4,6,5,3,1};
+
+  std::vector<double> data = {0, 1,1, 2,2,2,2,
+    3,3,3,3,3,3, 4,4,4,4,4, 5,5,5, 6};
+
+  int numGetMesh = 0;
+  int numAddArray = 0;
+  int numGetMeshMetadata = 0;
+
+  auto getNumberOfMeshes = [](unsigned int &n) -> int
+    {
+    n = 1;
+    return 0;
+    };
+
+  auto getMeshMetadata = [&](unsigned int id, sensei::MeshMetadataPtr &metadata) -> int
+    {
+    ++numGetMeshMetadata;
+    if (id == 0)
+      {
+      metadata->MeshName = "image";
+      metadata->MeshType = SVTK_IMAGE_DATA;
+      metadata->BlockType = SVTK_IMAGE_DATA;
+      metadata->NumBlocks = 1;
+      metadata->NumBlocksLocal = {1};
+      metadata->NumArrays = 1;
+      metadata->ArrayName = {"data"};
+      metadata->ArrayCentering = {svtkDataObject::POINT};
+      metadata->ArrayType = {SVTK_DOUBLE};
+      metadata->ArrayComponents = {1};
+      if (metadata->Flags.BlockBoundsSet())
+        metadata->BlockBounds = {{0.0, double(data.size() - 1), 0.0, 0.0, 0.0, 0.0}};
+      return 0;
+      }
+    return -1;
+    };
+
+  auto getMesh = [&](const std::string &meshName,
+    bool, svtkDataObject *&mesh) -> int
+    {
+    ++numGetMesh;
+    // give concurrent requests a chance to arrive while this one is served
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    if (meshName == "image")
+      {
+      svtkImageData *im = svtkImageData::New();
+      im->SetDimensions(data.size(), 1, 1);
+      mesh = im;
+      return 0;
+      }
+    return -1;
+    };
+
+  auto addArray = [&](svtkDataObject *mesh,
+    const std::string &meshName, int assoc, const std::string &name) -> int
+    {
+    ++numAddArray;
+    if ((meshName == "image") && (assoc == svtkDataObject::POINT) && (name == "data"))
+      {
+      svtkDoubleArray *da = svtkDoubleArray::New();
+      da->SetName("data");
+      da->SetArray(data.data(), data.size(), 1);
+
+      static_cast<svtkImageData*>(mesh)->GetPointData()->AddArray(da);
+      da->Delete();
+      return 0;
+      }
+    return -1;
+    };
+
+  sensei::ProgrammableDataAdaptor *pda = sensei::ProgrammableDataAdaptor::New();
+  pda->SetGetNumberOfMeshesCallback(getNumberOfMeshes);
+  pda->SetGetMeshMetadataCallback(getMeshMetadata);
+  pda->SetGetMeshCallback(getMesh);
+  pda->SetAddArrayCallback(addArray);
+
+  sensei::CachingDataAdaptor *cda = sensei::CachingDataAdaptor::New();
+  cda->SetDataAdaptor(pda);
+
+  int status = 0;
+
+  // two steps with three analyses each. the simulation should be asked for
+  // the mesh and the array once per step
+  for (int step = 0; step < 2; ++step)
+    {
+    pda->SetDataTimeStep(step);
+
+    for (int i = 0; i < 3; ++i)
+      {
+      sensei::Histogram *ha = sensei::Histogram::New();
+      ha->Initialize(7, "image", svtkDataObject::POINT, "data", "");
+      ha->Execute(cda, nullptr);
+
+      sensei::Histogram::Data result;
+      ha->GetHistogram(result);
+
+      if (result.Histogram != baselineHist)
+        {
+        SENSEI_ERROR("Wrong histogram in step " << step << " analysis " << i)
+        status = -1;
+        }
+
+      ha->Delete();
+      }
+
+    if ((numGetMesh != step + 1) || (numAddArray != step + 1))
+      {
+      SENSEI_ERROR("Step " << step << " the cache missed. GetMesh was called "
+        << numGetMesh << " times and AddArray was called " << numAddArray
+        << " times")
+      status = -1;
+      }
+
+    if ((cda->GetNumberOfHits() != 4) || (cda->GetNumberOfMisses() != 2))
+      {
+      SENSEI_ERROR("Step " << step << " wrong number of hits "
+        << cda->GetNumberOfHits() << " and misses " << cda->GetNumberOfMisses())
+      status = -1;
+      }
+    }
+
+  // concurrent requests for the same mesh and array are served by a single
+  // call to the simulation. the others wait for it without holding the lock
+  pda->SetDataTimeStep(2);
+
+  std::vector<int> threadStatus(4, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    {
+    threads.emplace_back([&, i]()
+      {
+      svtkDataObject *mesh = nullptr;
+      if (cda->GetMesh("image", false, mesh) ||
+        cda->AddArray(mesh, "image", svtkDataObject::POINT, "data") ||
+        !static_cast<svtkImageData*>(mesh)->GetPointData()->GetArray("data"))
+        threadStatus[i] = -1;
+      if (mesh)
+        mesh->Delete();
+      });
+    }
+
+  for (int i = 0; i < 4; ++i)
+    {
+    threads[i].join();
+    if (threadStatus[i])
+      {
+      SENSEI_ERROR("Thread " << i << " failed to get the mesh and array")
+      status = -1;
+      }
+    }
+
+  if ((numGetMesh != 3) || (numAddArray != 3))
+    {
+    SENSEI_ERROR("Concurrent requests missed the cache. GetMesh was called "
+      << numGetMesh << " times and AddArray was called " << numAddArray
+      << " times")
+    status = -1;
+    }
+
+  // metadata cached without optional fields is fetched again when a caller
+  // asks for them, and the refreshed metadata is cached
+  numGetMeshMetadata = 0;
+  if (cda->CacheMetadata(sensei::MeshMetadataFlags()))
+    {
+    SENSEI_ERROR("Failed to cache metadata")
+    status = -1;
+    }
+
+  for (int i = 0; i < 2; ++i)
+    {
+    sensei::MeshMetadataFlags flags;
+    flags.SetBlockBounds();
+
+    sensei::MeshMetadataPtr md = sensei::MeshMetadata::New(flags);
+    if (cda->GetMeshMetadata(0, md) || (md->BlockBounds.size() != 1) ||
+      (md->BlockBounds[0][1] != double(data.size() - 1)))
+      {
+      SENSEI_ERROR("Metadata request " << i << " did not return block bounds")
+      status = -1;
+      }
+    }
+
+  if (numGetMeshMetadata != 2)
+    {
+    SENSEI_ERROR("GetMeshMetadata was called " << numGetMeshMetadata
+      << " times, expected 2")
+    status = -1;
+    }
+
+  cda->ReleaseData();
+
+  cda->Delete();
+  pda->Delete();
+
+  MPI_Finalize();
+
+  return status;
+}
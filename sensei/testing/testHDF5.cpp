@@ -1,5 +1,6 @@
 #include "HDF5AnalysisAdaptor.h"
 #include "HDF5DataAdaptor.h"
+#include "ConfigurableInTransitDataAdaptor.h"
 #include "SVTKDataAdaptor.h"
 #include <svtkCellArray.h>
 #include <svtkCellData.h>
@@ -18,13 +19,22 @@
 #include <svtkPointData.h>
 #include <svtkPoints.h>
 #include <svtkPolyData.h>
+#include <svtkSOADataArrayTemplate.h>
 #include <svtkUnsignedCharArray.h>
 #include <svtkUnsignedIntArray.h>
 #include <svtkUnsignedLongArray.h>
 
+#include <pugixml.hpp>
+
+#include <chrono>
+#include <sstream>
 #include <stdlib.h>
+#include <string>
+#include <thread>
 
 using H5DataAdaptorPtr = svtkSmartPointer<sensei::HDF5DataAdaptor>;
+using InTransitDataAdaptorPtr =
+  svtkSmartPointer<sensei::ConfigurableInTransitDataAdaptor>;
 using H5AnalysisAdaptorPtr = svtkSmartPointer<sensei::HDF5AnalysisAdaptor>;
 
 void get_data_arrays(unsigned long size, svtkDataSetAttributes* dsa);
@@ -47,8 +57,10 @@ class TimedAdaptorWrap
 {
 public:
   TimedAdaptorWrap(H5DataAdaptorPtr& h5) { _h5 = h5; }
+  TimedAdaptorWrap(InTransitDataAdaptorPtr& it) { _it = it; }
 
   H5DataAdaptorPtr _h5 = nullptr;
+  InTransitDataAdaptorPtr _it = nullptr;
 
   ~TimedAdaptorWrap() {}
 
@@ -56,6 +68,8 @@ public:
   {
     if (_h5 != NULL)
       return _h5;
+    if (_it != NULL)
+      return _it;
     return NULL;
   }
 
@@ -63,6 +77,8 @@ public:
   {
     if (_h5 != NULL)
       return _h5->CloseStream();
+    if (_it != NULL)
+      return _it->CloseStream();
     return 0;
   }
 
@@ -70,6 +86,8 @@ public:
   {
     if (_h5 != NULL)
       return _h5->AdvanceStream();
+    if (_it != NULL)
+      return _it->AdvanceStream();
     return 0;
   }
 };
@@ -100,6 +118,26 @@ int check_array(svtkDataArray* array)
             }
         }
     }
+  else
+    {
+      for (int i = 0; i < n_tuple; i++)
+        {
+          for (int j = 0; j < n_comp; j++)
+            {
+              // multi-component arrays are numbered in AOS order
+              double expected = (i * n_comp + j) * typeSize;
+              if (array->GetComponent(i, j) != expected)
+                {
+                  std::cout << "............. oh no at " << i << " th, "
+                            << j << " th component.. "
+                            << array->GetComponent(i, j) << " != "
+                            << expected << std::endl
+                            << std::endl;
+                  return -1;
+                }
+            }
+        }
+    }
   return 0;
 }
 
@@ -130,6 +168,15 @@ int readMe(TimedAdaptorWrap* daWrap, MPI_Comm& comm)
                   << std::endl;
       ;
 
+      // the steps are written in order starting at 0, and none may be
+      // skipped or repeated
+      if (it != n_steps)
+        {
+          std::cerr << "Test failed, received step " << it << " expected "
+                    << n_steps << std::endl;
+          retval = -1;
+        }
+
       unsigned int nMeshes;
       da->GetNumberOfMeshes(nMeshes);
 
@@ -273,6 +320,12 @@ int readMe(TimedAdaptorWrap* daWrap, MPI_Comm& comm)
     std::cout << "closed stream after receiving " << n_steps << " steps."
               << std::endl;
 
+  if (n_steps < 1)
+    {
+      std::cerr << "Test failed, no steps were received" << std::endl;
+      retval = -1;
+    }
+
 #ifdef DBCK
   aw->Finalize();
 #endif
@@ -416,6 +469,27 @@ svtkDataArray* generate_array(const char* name,
   return result;
 }
 
+// a 3 component array in the SOA layout, the values are numbered in AOS order
+// so that they can be checked after the writers interleave them
+svtkDataArray* generate_soa_array(const char* name, unsigned long size)
+{
+  svtkSOADataArrayTemplate<double>* result =
+    svtkSOADataArrayTemplate<double>::New();
+  result->SetNumberOfComponents(3);
+  result->SetNumberOfTuples(size);
+  result->SetName(name);
+
+  for (unsigned long i = 0; i < size; i++)
+    {
+      for (int j = 0; j < 3; j++)
+        {
+          result->SetTypedComponent(i, j, (3 * i + j) * sizeof(double));
+        }
+    }
+
+  return result;
+}
+
 void get_data_arrays(unsigned long size, svtkDataSetAttributes* dsa)
 {
   // dsa->AddArray(generate_array<char>("char_array", size,
@@ -468,6 +542,10 @@ void get_data_arrays(unsigned long size, svtkDataSetAttributes* dsa)
     "unsigned_long_array", size, svtkUnsignedLongArray::New());
   dsa->AddArray(temp);
   temp->Delete();
+
+  temp = generate_soa_array("soa_array", size);
+  dsa->AddArray(temp);
+  temp->Delete();
 }
 
 svtkImageData* get_image(unsigned long i0,
@@ -491,7 +569,10 @@ svtkImageData* get_image(unsigned long i0,
   return im;
 }
 
-void writeMe(sensei::AnalysisAdaptor* aw, int n_its, MPI_Comm& comm)
+void writeMe(sensei::AnalysisAdaptor* aw,
+             int n_its,
+             MPI_Comm& comm,
+             int delay_ms = 0)
 {
 
   int rank, n_ranks;
@@ -536,6 +617,9 @@ void writeMe(sensei::AnalysisAdaptor* aw, int n_its, MPI_Comm& comm)
       da->SetDataObject(meshNames[0], meshObj[0]);
       da->SetDataObject(meshNames[1], meshObj[1]);
 
+      if (delay_ms > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+
       aw->Execute(da, nullptr);
       da->ReleaseData();
       da->Delete();
@@ -625,6 +709,57 @@ TimedAdaptorWrap* GetReadAdaptor(const std::string& file_name,
   return NULL;
 }
 
+// read through the ConfigurableInTransitDataAdaptor, which reads depth steps
+// ahead on a background thread when MPI_THREAD_MULTIPLE is available
+TimedAdaptorWrap* GetPrefetchReadAdaptor(const std::string& file_name,
+                                         const std::string& method,
+                                         unsigned int depth,
+                                         int threadLevel,
+                                         MPI_Comm& comm)
+{
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  if (rank == 0)
+    std::cout << " HDF5  DATA  Adaptor  method " << method
+              << " prefetch depth " << depth << std::endl;
+
+  pugi::xml_document doc;
+  pugi::xml_node root = doc.append_child("sensei");
+  pugi::xml_node node = root.append_child("transport");
+  node.append_attribute("type") = "hdf5";
+  node.append_attribute("file_name") = file_name.c_str();
+  node.append_attribute("method") = method.c_str();
+  node.append_attribute("prefetch-depth") = depth;
+
+  InTransitDataAdaptorPtr da = InTransitDataAdaptorPtr::New();
+  da->SetCommunicator(comm);
+  if (da->Initialize(root) || da->OpenStream())
+    {
+      std::cerr << "Test failed, could not open " << file_name << std::endl;
+      return NULL;
+    }
+
+  // the sender metadata is not available while prefetching. use this to
+  // check that prefetching is enabled only when it is supported
+  bool prefetching = (depth > 0) && (threadLevel >= MPI_THREAD_MULTIPLE);
+
+  std::ostringstream errs;
+  std::streambuf* cerrBuf = std::cerr.rdbuf(errs.rdbuf());
+  sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
+  bool haveSenderMd = (da->GetSenderMeshMetadata(0, md) == 0);
+  std::cerr.rdbuf(cerrBuf);
+
+  if (haveSenderMd == prefetching)
+    {
+      std::cerr << "Test failed, prefetching should be "
+                << (prefetching ? "enabled" : "disabled") << std::endl;
+      return NULL;
+    }
+
+  return new TimedAdaptorWrap(da);
+}
+
 // this show HDF5 is fine!!
 
 //
@@ -633,7 +768,15 @@ TimedAdaptorWrap* GetReadAdaptor(const std::string& file_name,
 //
 int main(int argc, char** argv)
 {
-  MPI_Init(&argc, &argv);
+  // reading with prefetching needs MPI_THREAD_MULTIPLE, the thread level may
+  // be lowered to test the fall back to reading on demand
+  int required = MPI_THREAD_SINGLE;
+  if ((argc > 5) && (argv[1][0] == 'r'))
+    required = std::string(argv[5]) == "single" ?
+      MPI_THREAD_SINGLE : MPI_THREAD_MULTIPLE;
+
+  int provided = 0;
+  MPI_Init_thread(&argc, &argv, required, &provided);
 
   MPI_Comm comm = MPI_COMM_WORLD;
   int n_ranks, rank;
@@ -643,11 +786,16 @@ int main(int argc, char** argv)
   if (argc == 1)
     {
       std::cout << " please use the following options: " << std::endl;
-      std::cout << argv[0] << "  w iter mode file-name " << std::endl;
-      std::cout << argv[0] << "  r file-name mode" << std::endl;
+      std::cout << argv[0] << "  w iter mode file-name [chunk-size]"
+                   " [compression-level] [writers] [delay-ms]" << std::endl;
+      std::cout << argv[0] << "  r file-name mode [prefetch-depth]"
+                   " [single|multiple]" << std::endl;
+      MPI_Finalize();
       return 0;
     }
 
+  int retval = 0;
+
   std::string method = "MPI"; // or "POSIX"
   if (argv[1][0] == 'w')
     {
@@ -669,14 +817,41 @@ int main(int argc, char** argv)
           base_file_name = argv[4];
         }
 
-      char file_name[base_file_name.size()];
-      sprintf(file_name, "%s.n%d", base_file_name.c_str(), n_ranks);
+      std::string file_name =
+        base_file_name + ".n" + std::to_string(n_ranks);
 
       if (rank == 0)
         std::cout << " ==> WRITING : " << file_name << std::endl;
 
       AAWrap* aw = GetWriteAdaptor(file_name, method, rank);
-      writeMe(aw->GetAA(), n_its, comm);
+
+      // optionally write chunked, compressed datasets through a subset of
+      // the ranks
+      if (argc > 5)
+        {
+          aw->_h5->SetChunkSize(atol(argv[5]));
+        }
+
+      if (argc > 6)
+        {
+          aw->_h5->SetCompressionLevel(atoi(argv[6]));
+          aw->_h5->SetShuffle(true);
+        }
+
+      if (argc > 7)
+        {
+          aw->_h5->SetNumWriters(atoi(argv[7]));
+        }
+
+      // optionally pause before each step so that a concurrent reader has
+      // to wait for it
+      int delay_ms = 0;
+      if (argc > 8)
+        {
+          delay_ms = atoi(argv[8]);
+        }
+
+      writeMe(aw->GetAA(), n_its, comm, delay_ms);
 
     }
   else
@@ -691,13 +866,23 @@ int main(int argc, char** argv)
           method = argv[3];
         }
 
-      TimedAdaptorWrap* result = GetReadAdaptor(file_name, method, comm);
+      TimedAdaptorWrap* result = nullptr;
+      if (argc > 4)
+        result = GetPrefetchReadAdaptor(file_name, method, atoi(argv[4]),
+                                        provided, comm);
+      else
+        result = GetReadAdaptor(file_name, method, comm);
 
-      readMe(result, comm);
+      if (result)
+        retval = readMe(result, comm);
+      else
+        retval = -1;
 
       delete result;
     }
 
+  MPI_Allreduce(MPI_IN_PLACE, &retval, 1, MPI_INT, MPI_MIN, comm);
+
   MPI_Finalize();
-  return 0;
+  return retval ? -1 : 0;
 }
@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+
+if [[ $# -lt 7 ]]
+then
+  echo "Num Args Detected... $#"
+  echo "testHDF5Streaming.sh [mpiexec] [npflag] [nproc] [test exec] [file] [nits] [delay ms] -- <optional MPI args>"
+  exit 1
+fi
+
+mpiexec=`basename $1`
+npflag=$2
+nproc=$3
+nproc_write=$nproc
+let nproc_read=$nproc/2
+nproc_read=$(( nproc_read < 1 ? 1 : nproc_read ))
+testexec=$4
+file=$5
+nits=$6
+delay=$7
+
+shift 7
+if [ "$1" == "--" ]; then
+  shift
+fi
+
+trap 'eval echo $BASH_COMMAND' DEBUG
+
+# a manifest left by an earlier run would be taken for this run's steps
+rm -fv ${file}.n${nproc_write}*
+
+echo "M=${nproc_write} x N=${nproc_read}"
+
+# the writer pauses before each step, the reader is started at the same time
+# and has to wait for each step to be published
+${mpiexec} ${@} ${npflag} ${nproc_write} ${testexec} w ${nits} s ${file} 0 0 0 ${delay} &
+writePid=$!
+
+${mpiexec} ${@} ${npflag} ${nproc_read} ${testexec} r ${file}.n${nproc_write} s | tee ${file}.log
+readStatus=${PIPESTATUS[0]}
+
+wait ${writePid}
+writeStatus=$?
+
+if [[ ${writeStatus} -ne 0 || ${readStatus} -ne 0 ]]
+then
+  echo "Test failed, the writer returned ${writeStatus} and the reader ${readStatus}"
+  exit 1
+fi
+
+if ! grep -q "after receiving ${nits} steps" ${file}.log
+then
+  echo "Test failed, the reader did not receive ${nits} steps"
+  exit 1
+fi
+
+rm -fv ${file}.n${nproc_write}* ${file}.log
+
+exit 0
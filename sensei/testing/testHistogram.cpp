@@ -1,11 +1,13 @@
 #include <random>
 #include <iostream>
+#include <sstream>
 #include <mpi.h>
 #include <svtkDoubleArray.h>
 #include <svtkImageData.h>
 #include <svtkPointData.h>
 #include "Error.h"
 #include "Histogram.h"
+#include "DataRequirements.h"
 #include "SVTKDataAdaptor.h"
 
 //#define GENERATE_SEQUENCE
@@ -108,6 +110,9 @@ int main(int argc, char **argv)
 {
   MPI_Init(&argc, &argv);
 
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
   std::vector<double> vals;
   getSequence(vals);
   unsigned int nVals = vals.size();
@@ -121,6 +126,13 @@ int main(int argc, char **argv)
   svtkImageData *im = svtkImageData::New();
   im->SetDimensions(gNx, gNy, gNz);
   im->GetPointData()->AddArray(da);
+
+  // a second array for computing multiple histograms at once
+  svtkDoubleArray *db = svtkDoubleArray::New();
+  db->DeepCopy(da);
+  db->SetName("normal_copy");
+  im->GetPointData()->AddArray(db);
+  db->Delete();
   da->Delete();
 
   sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
@@ -133,7 +145,6 @@ int main(int argc, char **argv)
      "normal", "");
 
   analysisAdaptor->Execute(dataAdaptor, nullptr);
-  dataAdaptor->Delete();
 
 
   sensei::Histogram::Data result;
@@ -144,6 +155,99 @@ int main(int argc, char **argv)
   analysisAdaptor->Finalize();
   analysisAdaptor->Delete();
 
+  // compute histograms of both arrays together using multiple threads
+  sensei::DataRequirements reqs;
+  reqs.AddRequirement("mesh", svtkDataObject::POINT,
+    std::vector<std::string>({"normal", "normal_copy"}));
+
+  analysisAdaptor = sensei::Histogram::New();
+  analysisAdaptor->SetNumberOfThreads(2);
+  analysisAdaptor->Initialize(gNBins, reqs, "");
+  analysisAdaptor->Execute(dataAdaptor, nullptr);
+
+  const char *arrays[] = {"normal", "normal_copy"};
+  for (int i = 0; i < 2; ++i)
+    {
+    if (analysisAdaptor->GetHistogram("mesh", svtkDataObject::POINT,
+      arrays[i], result) ||
+      validateHistogram(result.BinMin, result.BinMax, result.Histogram))
+      {
+      SENSEI_ERROR("Multiple histogram validation failed for \""
+        << arrays[i] << "\"")
+      status = -1;
+      }
+    }
+
+  analysisAdaptor->Finalize();
+  analysisAdaptor->Delete();
+
+  // with the bin edges fixed at the range of the data the histogram matches
+  analysisAdaptor = sensei::Histogram::New();
+  analysisAdaptor->SetBinning(sensei::Histogram::BINNING_FIXED);
+  analysisAdaptor->SetRange(gMin, gMax);
+  analysisAdaptor->Initialize(gNBins, "mesh", svtkDataObject::POINT,
+     "normal", "");
+  analysisAdaptor->Execute(dataAdaptor, nullptr);
+  analysisAdaptor->GetHistogram(result);
+
+  if (validateHistogram(result.BinMin, result.BinMax, result.Histogram) ||
+    result.Underflow || result.Overflow)
+    {
+    SENSEI_ERROR("Fixed binning histogram validation failed")
+    status = -1;
+    }
+
+  analysisAdaptor->Finalize();
+  analysisAdaptor->Delete();
+
+  // accumulate over a window of two steps with adaptive bins. the second
+  // step reuses the edges of the first and the counts double
+  analysisAdaptor = sensei::Histogram::New();
+  analysisAdaptor->SetBinning("adaptive");
+  analysisAdaptor->SetWindow(2);
+  analysisAdaptor->Initialize(gNBins, "mesh", svtkDataObject::POINT,
+     "normal", "");
+  analysisAdaptor->Execute(dataAdaptor, nullptr);
+  analysisAdaptor->Execute(dataAdaptor, nullptr);
+  analysisAdaptor->GetHistogram(result);
+
+  for (unsigned int i = 0; i < result.Histogram.size(); ++i)
+    result.Histogram[i] /= 2;
+
+  if (validateHistogram(result.BinMin, result.BinMax, result.Histogram) ||
+    ((result.NumberOfSteps != 2) && (rank == 0)))
+    {
+    SENSEI_ERROR("Accumulated histogram validation failed")
+    status = -1;
+    }
+
+  analysisAdaptor->Finalize();
+  analysisAdaptor->Delete();
+
+  // accumulation over a window requires fixed or adaptive bins, the invalid
+  // combination is rejected by the setters. the expected error messages are
+  // captured so that they are not mistaken for a failure.
+  std::ostringstream errs;
+  std::streambuf *cerrBuf = std::cerr.rdbuf(errs.rdbuf());
+
+  analysisAdaptor = sensei::Histogram::New();
+  int windowWithGlobal = analysisAdaptor->SetWindow(2);
+  analysisAdaptor->SetBinning("adaptive");
+  analysisAdaptor->SetWindow(2);
+  int globalWithWindow = analysisAdaptor->SetBinning(
+    sensei::Histogram::BINNING_GLOBAL);
+  analysisAdaptor->Delete();
+
+  std::cerr.rdbuf(cerrBuf);
+
+  if (!windowWithGlobal || !globalWithWindow)
+    {
+    SENSEI_ERROR("A window was accepted with global binning")
+    status = -1;
+    }
+
+  dataAdaptor->Delete();
+
   MPI_Finalize();
 
   return status;
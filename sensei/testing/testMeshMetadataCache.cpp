@@ -0,0 +1,181 @@
+#include "MeshMetadata.h"
+#include "MeshMetadataCache.h"
+#include "BinaryStream.h"
+#include "MPIUtils.h"
+#include "STLUtils.h"
+#include "Error.h"
+
+#include <svtkType.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+using sensei::MeshMetadata;
+using sensei::MeshMetadataPtr;
+
+// generate a local view of the metadata, a different number of blocks on
+// each rank. step changes the array ranges and nBlocks the decomposition
+MeshMetadataPtr newMetadata(int rank, int step, int nBlocks)
+{
+  MeshMetadataPtr md = MeshMetadata::New();
+  md->MeshName = "mesh";
+  md->MeshType = SVTK_MULTIBLOCK_DATA_SET;
+  md->BlockType = SVTK_IMAGE_DATA;
+  md->NumArrays = 2;
+  md->ArrayName = {"a", "b"};
+  md->ArrayCentering = {0, 1};
+  md->ArrayComponents = {1, 1};
+  md->ArrayType = {SVTK_DOUBLE, SVTK_DOUBLE};
+  md->ArrayRange.resize(2);
+  md->NumLevels = 2;
+  md->BlocksPerLevel = {rank, 2*rank + 1};
+  md->NumBlocksLocal = {nBlocks};
+
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    md->BlockOwner.push_back(rank);
+    md->BlockIds.push_back(10*rank + i);
+    md->BlockNumPoints.push_back(100*rank + i);
+    md->BlockNumCells.push_back(7*rank + i);
+    md->BlockExtents.push_back({rank, rank + i, 0, 1, 0, 2});
+    md->BlockBounds.push_back({double(rank), rank + 0.5*i, 0., 1., 0., 2.});
+    md->BlockArrayRange.push_back({{{double(-rank - step), double(i)}},
+      {{0., double(rank*i + step)}}});
+    md->BlockLevel.push_back(i % 2);
+    }
+
+  return md;
+}
+
+// globalize one field at a time
+void globalizeReference(MPI_Comm comm, MeshMetadataPtr &md)
+{
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockOwner);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockIds);
+  sensei::MPIUtils::GlobalViewV(comm, md->NumBlocksLocal);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockNumPoints);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockNumCells);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockCellArraySize);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockExtents);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockBounds);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockArrayRange);
+  sensei::MPIUtils::GlobalViewV(comm, md->BlockLevel);
+  sensei::MPIUtils::GlobalCounts(comm, md->BlocksPerLevel);
+
+  sensei::STLUtils::ReduceRange(md->BlockBounds, md->Bounds);
+  sensei::STLUtils::ReduceRange(md->BlockExtents, md->Extent);
+  sensei::STLUtils::ReduceRange(md->BlockArrayRange, md->ArrayRange);
+
+  md->NumBlocks = sensei::STLUtils::Sum(md->NumBlocksLocal);
+  md->NumPoints = sensei::STLUtils::Sum(md->BlockNumPoints);
+  md->NumCells = sensei::STLUtils::Sum(md->BlockNumCells);
+  md->CellArraySize = sensei::STLUtils::Sum(md->BlockCellArraySize);
+
+  md->GlobalView = true;
+}
+
+std::string toString(const MeshMetadataPtr &md)
+{
+  std::ostringstream oss;
+  md->ToStream(oss);
+  return oss.str();
+}
+
+int compare(int rank, const char *test, const MeshMetadataPtr &md,
+  const MeshMetadataPtr &ref)
+{
+  std::string mds = toString(md);
+  std::string refs = toString(ref);
+  if (mds != refs)
+    {
+    SENSEI_ERROR("Test \"" << test << "\" failed on rank " << rank
+      << ". Got" << std::endl << mds << std::endl << "but expected"
+      << std::endl << refs)
+    return -1;
+    }
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  int nBlocks = rank % 3 + 1;
+  int err = 0;
+
+  // the fused and hierarchical exchanges match exchanging each field
+  MeshMetadataPtr ref = newMetadata(rank, 0, nBlocks);
+  globalizeReference(comm, ref);
+
+  MeshMetadataPtr md = newMetadata(rank, 0, nBlocks);
+  md->GlobalizeView(comm, MeshMetadata::GLOBALIZE_FLAT);
+  err |= compare(rank, "flat", md, ref);
+
+  md = newMetadata(rank, 0, nBlocks);
+  md->GlobalizeView(comm, MeshMetadata::GLOBALIZE_HIERARCHICAL);
+  err |= compare(rank, "hierarchical", md, ref);
+
+  // the cache reuses the block structure when it is unchanged, but not the
+  // array ranges
+  sensei::MeshMetadataCache cache;
+  MeshMetadataPtr md0 = newMetadata(rank, 0, nBlocks);
+  cache.GlobalizeView(comm, md0);
+  ref->Generation = 1;
+  err |= compare(rank, "cache first step", md0, ref);
+
+  MeshMetadataPtr md1 = newMetadata(rank, 1, nBlocks);
+  cache.GlobalizeView(comm, md1);
+  ref = newMetadata(rank, 1, nBlocks);
+  globalizeReference(comm, ref);
+  ref->Generation = 1;
+  err |= compare(rank, "cache unchanged", md1, ref);
+
+  // a change on one rank is seen by all
+  MeshMetadataPtr md2 = newMetadata(rank, 2, nBlocks + (rank == 0 ? 1 : 0));
+  cache.GlobalizeView(comm, md2);
+  ref = newMetadata(rank, 2, nBlocks + (rank == 0 ? 1 : 0));
+  globalizeReference(comm, ref);
+  ref->Generation = 2;
+  err |= compare(rank, "cache changed", md2, ref);
+
+  // the block structure is omitted from the stream only when unchanged
+  sensei::BinaryStream full;
+  md1->ToStreamDelta(full, nullptr);
+
+  sensei::BinaryStream delta;
+  md1->ToStreamDelta(delta, md0);
+
+  if (delta.Size() >= full.Size())
+    {
+    SENSEI_ERROR("The block structure was not omitted")
+    err = -1;
+    }
+
+  MeshMetadataPtr mdIn = MeshMetadata::New();
+  if (mdIn->FromStreamDelta(delta, md0))
+    err = -1;
+  err |= compare(rank, "delta stream", mdIn, md1);
+
+  mdIn = MeshMetadata::New();
+  if (mdIn->FromStreamDelta(full, nullptr))
+    err = -1;
+  err |= compare(rank, "full stream", mdIn, md1);
+
+  int gerr = 0;
+  MPI_Allreduce(&err, &gerr, 1, MPI_INT, MPI_BOR, comm);
+
+  if ((rank == 0) && !gerr)
+    std::cerr << "Test passed" << std::endl;
+
+  MPI_Finalize();
+
+  return gerr ? -1 : 0;
+}
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <mpi.h>
+#include "Error.h"
+#include "Profiler.h"
+
+// each thread logs nested events whose names are formatted at run time
+void logEvents(int tid, int nEvents)
+{
+  for (int i = 0; i < nEvents; ++i)
+    {
+    sensei::TimeEvent<64> outer("testProfiler::outer");
+
+    char name[64];
+    snprintf(name, 64, "testProfiler::inner thread=%d event=%d", tid, i % 8);
+    sensei::Profiler::StartEvent(name, i);
+    sensei::Profiler::EndEvent(name, i);
+    }
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  const char *logFile = "testProfiler.bin";
+  const char *summaryFile = "testProfiler.csv";
+
+  // full traces from rank 0, a summary from everyone
+  sensei::Profiler::SetTimerLogFile(logFile);
+  sensei::Profiler::SetSummaryLogFile(summaryFile);
+  sensei::Profiler::SetTraceRanks("0");
+  sensei::Profiler::SetLogFormat("binary");
+  sensei::Profiler::Enable(0x05);
+  sensei::Profiler::Initialize();
+
+  int nThreads = 4;
+  int nEvents = 1000;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nThreads; ++i)
+    threads.emplace_back(logEvents, i, nEvents);
+
+  for (int i = 0; i < nThreads; ++i)
+    threads[i].join();
+
+  // the CSV log of this rank, before it is written in the binary format
+  std::ostringstream csv;
+  sensei::Profiler::ToStream(csv);
+
+  sensei::Profiler::Finalize();
+
+  int ierr = 0;
+
+  // convert back to CSV and find this rank's events
+  std::ostringstream conv;
+  if (sensei::Profiler::BinaryToCSV(logFile, conv))
+    {
+    SENSEI_ERROR("Failed to convert the binary log")
+    ierr = -1;
+    }
+
+  std::ostringstream prefix;
+  prefix << rank << ", ";
+
+  std::istringstream iss(conv.str());
+  std::ostringstream ours;
+  std::string line;
+  long nLines = 0;
+  while (std::getline(iss, line))
+    {
+    if (line.compare(0, prefix.str().size(), prefix.str()) == 0)
+      ours << line << std::endl;
+    ++nLines;
+    }
+
+  if (ours.str() != csv.str())
+    {
+    SENSEI_ERROR("The converted log differs from the CSV log")
+    ierr = -1;
+    }
+
+  int nRanks = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  long nExpected = 1 + 2l*nThreads*nEvents;
+  if (nLines != nExpected)
+    {
+    SENSEI_ERROR("The converted log has " << nLines
+      << " lines, expected " << nExpected)
+    ierr = -1;
+    }
+
+  // the summary has the events of all ranks
+  if (rank == 0)
+    {
+    std::ifstream summary(summaryFile);
+    long count = 0;
+    int nEvtRanks = 0;
+    while (std::getline(summary, line))
+      {
+      if (line.compare(0, 21, "\"testProfiler::outer\"") == 0)
+        sscanf(line.c_str() + 22, " %ld, %d", &count, &nEvtRanks);
+      }
+
+    if ((count != long(nRanks)*nThreads*nEvents) || (nEvtRanks != nRanks))
+      {
+      SENSEI_ERROR("The summary has " << count << " events from "
+        << nEvtRanks << " ranks, expected " << nRanks*nThreads*nEvents
+        << " from " << nRanks)
+      ierr = -1;
+      }
+    }
+
+  // the summary covers the events logged before a Flush, and a second
+  // Finalize leaves it in place
+  sensei::Profiler::Enable(0x04);
+  sensei::Profiler::Initialize();
+
+  logEvents(0, nEvents);
+  sensei::Profiler::Flush();
+  logEvents(0, nEvents);
+
+  sensei::Profiler::Finalize();
+  sensei::Profiler::Finalize();
+
+  if (rank == 0)
+    {
+    std::ifstream summary(summaryFile);
+    long count = 0;
+    while (std::getline(summary, line))
+      {
+      if (line.compare(0, 21, "\"testProfiler::outer\"") == 0)
+        sscanf(line.c_str() + 22, " %ld", &count);
+      }
+
+    if (count != 2l*nRanks*nEvents)
+      {
+      SENSEI_ERROR("The summary has " << count << " events across a Flush,"
+        " expected " << 2l*nRanks*nEvents)
+      ierr = -1;
+      }
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if (rank == 0)
+    {
+    remove(logFile);
+    remove(summaryFile);
+    std::cerr << "testProfiler " << (ierr ? "failed" : "passed") << std::endl;
+    }
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
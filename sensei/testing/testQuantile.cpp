@@ -0,0 +1,214 @@
+#include <random>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <mpi.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include "Error.h"
+#include "BinaryStream.h"
+#include "QuantileSketch.h"
+#include "QuantileAnalysis.h"
+#include "SVTKDataAdaptor.h"
+
+// the number of values on each rank
+const unsigned int gNx = 64;
+const unsigned int gNy = 64;
+const unsigned int gNz = 16;
+
+// the size of the sketches tested
+const int gSketchSize = 200;
+
+// generate the values of a rank, the distribution is skewed and differs
+// from rank to rank
+void getSequence(int rank, std::vector<double> &vals)
+{
+  std::mt19937 gen(1234 + rank);
+  std::gamma_distribution<double> dist(2.0 + rank % 3, 1.0);
+
+  unsigned int nVals = gNx*gNy*gNz;
+  vals.resize(nVals);
+  for (unsigned int i = 0; i < nVals; ++i)
+    vals[i] = dist(gen) + rank;
+}
+
+// check that the estimated quantiles are within the error bound of the
+// exact ones
+int validateQuantiles(const std::vector<double> &exact,
+  const std::vector<double> &quantiles)
+{
+  double n = exact.size();
+  int nq = quantiles.size();
+
+  if ((quantiles[0] != exact[0]) || (quantiles[nq - 1] != exact.back()))
+    {
+    SENSEI_ERROR("Incorrect minimum or maximum")
+    return -1;
+    }
+
+  // the bound holds with high probability, a factor of two leaves room
+  double eps = 2.0*1.7/gSketchSize;
+
+  for (int i = 1; i < nq - 1; ++i)
+    {
+    double q = double(i)/double(nq - 1);
+
+    // the range of ranks of the estimate
+    double r0 = std::lower_bound(exact.begin(), exact.end(), quantiles[i]) - exact.begin();
+    double r1 = std::upper_bound(exact.begin(), exact.end(), quantiles[i]) - exact.begin();
+
+    if ((r1/n < q - eps) || (r0/n > q + eps))
+      {
+      SENSEI_ERROR("Quantile " << q << " estimate " << quantiles[i]
+        << " has rank " << r0/n << " which exceeds the error bound " << eps)
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  std::vector<double> vals;
+  getSequence(rank, vals);
+  unsigned int nVals = vals.size();
+
+  // the exact quantiles
+  std::vector<double> exact;
+  for (int i = 0; i < nRanks; ++i)
+    {
+    std::vector<double> tmp;
+    getSequence(i, tmp);
+    exact.insert(exact.end(), tmp.begin(), tmp.end());
+    }
+  std::sort(exact.begin(), exact.end());
+
+  int nq = 21;
+  int ierr = 0;
+
+  // the sketch by itself. ghost values are skipped
+  std::vector<unsigned char> ghosts(nVals + 16, 0);
+  std::vector<double> gvals(vals);
+  for (int i = 0; i < 16; ++i)
+    {
+    gvals.push_back(1.0e30);
+    ghosts[nVals + i] = 1;
+    }
+
+  sensei::QuantileSketch sketch(gSketchSize);
+  sketch.Insert(gvals.data(), gvals.size(), ghosts.data());
+
+  // check that serialization round trips
+  sensei::BinaryStream bs;
+  sketch.ToStream(bs);
+  sensei::QuantileSketch sketchCopy;
+  if (sketchCopy.FromStream(bs) || (sketchCopy.GetCount() != nVals) ||
+    (sketchCopy.GetQuantile(0.5) != sketch.GetQuantile(0.5)))
+    {
+    SENSEI_ERROR("Serialization failed")
+    ierr = -1;
+    }
+
+  if (sketch.Reduce(MPI_COMM_WORLD, 0))
+    {
+    SENSEI_ERROR("Reduction failed")
+    ierr = -1;
+    }
+
+  if (rank == 0)
+    {
+    std::vector<double> quantiles;
+    if ((sketch.GetCount() != exact.size()) ||
+      sketch.GetQuantiles(nq, quantiles) ||
+      validateQuantiles(exact, quantiles))
+      {
+      SENSEI_ERROR("The reduced sketch is incorrect")
+      ierr = -1;
+      }
+    }
+
+  // the analysis
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetNumberOfTuples(nVals);
+  da->SetName("gamma");
+  for (unsigned int i = 0; i < nVals; ++i)
+    *da->GetPointer(i) = vals[i];
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetDimensions(gNx, gNy, gNz);
+  im->GetPointData()->AddArray(da);
+  da->Delete();
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetDataObject("mesh", im);
+
+  sensei::QuantileAnalysis *analysisAdaptor = sensei::QuantileAnalysis::New();
+  analysisAdaptor->Initialize("mesh", svtkDataObject::POINT, "gamma", nq, "");
+  analysisAdaptor->SetSketchSize(gSketchSize);
+
+  if (!analysisAdaptor->Execute(dataAdaptor, nullptr))
+    {
+    SENSEI_ERROR("Failed to execute the analysis")
+    ierr = -1;
+    }
+
+  if (rank == 0)
+    {
+    std::vector<double> quantiles;
+    if (analysisAdaptor->GetQuantiles(quantiles) ||
+      (analysisAdaptor->GetCount() != exact.size()) ||
+      validateQuantiles(exact, quantiles))
+      {
+      SENSEI_ERROR("The analysis result is incorrect")
+      ierr = -1;
+      }
+    }
+
+  // an error on one rank is reported on all of them rather than aborting.
+  // rank 0's array has 3 components
+  svtkDoubleArray *va = svtkDoubleArray::New();
+  va->SetNumberOfComponents(rank == 0 ? 3 : 1);
+  va->SetNumberOfTuples(nVals);
+  va->SetName("vector");
+  va->FillValue(1.0);
+  im->GetPointData()->AddArray(va);
+  va->Delete();
+
+  analysisAdaptor->Initialize("mesh", svtkDataObject::POINT, "vector", nq, "");
+
+  std::ostringstream errs;
+  std::streambuf *cerrBuf = std::cerr.rdbuf(errs.rdbuf());
+  bool executed = analysisAdaptor->Execute(dataAdaptor, nullptr);
+  std::cerr.rdbuf(cerrBuf);
+
+  if (executed)
+    {
+    SENSEI_ERROR("The analysis of an array with 3 components did not fail")
+    ierr = -1;
+    }
+
+  analysisAdaptor->Finalize();
+  analysisAdaptor->Delete();
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+  im->Delete();
+
+  MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if (rank == 0)
+    std::cerr << "testQuantile " << (ierr ? "failed" : "passed") << std::endl;
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
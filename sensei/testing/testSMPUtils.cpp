@@ -0,0 +1,99 @@
+#include <iostream>
+#include <vector>
+#include <mpi.h>
+#include <svtkSMPThreadLocal.h>
+#include "Error.h"
+#include "SMPUtils.h"
+
+// sums the values of an array with per thread partial sums
+struct Sum
+{
+  Sum(const std::vector<long> &vals) : Vals(vals), Total(0) {}
+
+  void Initialize() { this->Partial.Local() = 0; }
+
+  void operator()(svtkIdType i0, svtkIdType i1)
+    {
+    long &partial = this->Partial.Local();
+    for (svtkIdType i = i0; i < i1; ++i)
+      partial += this->Vals[i];
+    }
+
+  void Reduce()
+    {
+    for (auto it = this->Partial.begin(); it != this->Partial.end(); ++it)
+      this->Total += *it;
+    }
+
+  const std::vector<long> &Vals;
+  svtkSMPThreadLocal<long> Partial;
+  long Total;
+};
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int ierr = 0;
+
+  // until SENSEI's threads are configured one thread is used
+  if ((sensei::SMPUtils::GetNumberOfThreads() != 1) ||
+    (sensei::SMPUtils::GetNumberOfThreads(0) != 1))
+    {
+    SENSEI_ERROR("The unconfigured default is not one thread "
+      << sensei::SMPUtils::GetNumberOfThreads(0))
+    ierr = -1;
+    }
+
+  if (sensei::SMPUtils::Initialize(MPI_COMM_WORLD,
+    sensei::SMPUtils::GetBackend(), 4, 3))
+    {
+    SENSEI_ERROR("Failed to initialize the " << sensei::SMPUtils::GetBackend()
+      << " backend")
+    ierr = -1;
+    }
+
+  // the cap applies to the configured count and to explicit requests
+  int nThreads = sensei::SMPUtils::GetNumberOfThreads(0);
+  int nRequested = sensei::SMPUtils::GetNumberOfThreads(8);
+  if ((nThreads != 3) || (nRequested != 3))
+    {
+    SENSEI_ERROR("The thread cap was not applied " << nThreads
+      << ", " << nRequested)
+    ierr = -1;
+    }
+
+  size_t n = 1000000;
+  std::vector<long> vals(n);
+  for (size_t i = 0; i < n; ++i)
+    vals[i] = i % 1000;
+
+  Sum sum(vals);
+  sensei::SMPUtils::For(0, n, 1024, sum);
+
+  long total = 0;
+  for (size_t i = 0; i < n; ++i)
+    total += vals[i];
+
+  if (sum.Total != total)
+    {
+    SENSEI_ERROR("The parallel sum " << sum.Total << " is not " << total)
+    ierr = -1;
+    }
+
+  std::vector<long> copy(n, -1);
+  sensei::SMPUtils::Copy(vals.data(), copy.data(), n);
+  if (copy != vals)
+    {
+    SENSEI_ERROR("The parallel copy differs")
+    ierr = -1;
+    }
+
+  std::cerr << "testSMPUtils " << sensei::SMPUtils::GetBackend() << " "
+    << sensei::SMPUtils::GetNumberOfThreads() << " threads "
+    << (ierr ? "failed" : "passed") << std::endl;
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
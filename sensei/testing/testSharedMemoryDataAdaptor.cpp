@@ -0,0 +1,261 @@
+#include <iostream>
+#include <string>
+#include <mpi.h>
+#include <unistd.h>
+#include <svtkCellData.h>
+#include <svtkCellType.h>
+#include <svtkDoubleArray.h>
+#include <svtkFloatArray.h>
+#include <svtkIdTypeArray.h>
+#include <svtkImageData.h>
+#include <svtkIntArray.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkSOADataArrayTemplate.h>
+#include <svtkSmartPointer.h>
+#include <svtkUnstructuredGrid.h>
+#include "DataRequirements.h"
+#include "SVTKDataAdaptor.h"
+#include "SharedMemoryDataAdaptor.h"
+#include "Error.h"
+
+// an n^3 image with a point array and a three component structure of arrays
+// cell array
+svtkImageData *newImage(int n, double t)
+{
+  svtkImageData *im = svtkImageData::New();
+  im->SetDimensions(n + 1, n + 1, n + 1);
+  im->SetSpacing(0.5, 0.5, 0.5);
+
+  long nPts = im->GetNumberOfPoints();
+  svtkDoubleArray *p = svtkDoubleArray::New();
+  p->SetName("pressure");
+  p->SetNumberOfTuples(nPts);
+  for (long i = 0; i < nPts; ++i)
+    p->SetValue(i, t + i);
+  im->GetPointData()->AddArray(p);
+  p->Delete();
+
+  long nCells = im->GetNumberOfCells();
+  svtkSOADataArrayTemplate<float> *v = svtkSOADataArrayTemplate<float>::New();
+  v->SetName("velocity");
+  v->SetNumberOfComponents(3);
+  v->SetNumberOfTuples(nCells);
+  for (long i = 0; i < nCells; ++i)
+    for (int j = 0; j < 3; ++j)
+      v->SetTypedComponent(i, j, 10*i + j);
+  im->GetCellData()->AddArray(v);
+  v->Delete();
+
+  return im;
+}
+
+// two triangles sharing an edge
+svtkUnstructuredGrid *newTriangles()
+{
+  svtkPoints *pts = svtkPoints::New();
+  pts->InsertNextPoint(0.0, 0.0, 0.0);
+  pts->InsertNextPoint(1.0, 0.0, 0.0);
+  pts->InsertNextPoint(1.0, 1.0, 0.0);
+  pts->InsertNextPoint(0.0, 1.0, 0.0);
+
+  svtkUnstructuredGrid *ug = svtkUnstructuredGrid::New();
+  ug->SetPoints(pts);
+  pts->Delete();
+
+  svtkIdType tri[2][3] = {{0, 1, 2}, {0, 2, 3}};
+  ug->Allocate(2);
+  ug->InsertNextCell(SVTK_TRIANGLE, 3, tri[0]);
+  ug->InsertNextCell(SVTK_TRIANGLE, 3, tri[1]);
+
+  svtkIntArray *ids = svtkIntArray::New();
+  ids->SetName("id");
+  ids->SetNumberOfTuples(2);
+  ids->SetValue(0, 7);
+  ids->SetValue(1, 8);
+  ug->GetCellData()->AddArray(ids);
+  ids->Delete();
+
+  return ug;
+}
+
+// write a step from one adaptor and read it with another
+int testStep(sensei::SharedMemoryDataAdaptor *producer,
+  sensei::SharedMemoryDataAdaptor *consumer, int n, double t)
+{
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(2);
+  svtkImageData *im = newImage(n, t);
+  mb->SetBlock(0, im);
+  im->Delete();
+  svtkImageData *im1 = newImage(n, t + 1);
+  mb->SetBlock(1, im1);
+  im1->Delete();
+
+  svtkUnstructuredGrid *ug = newTriangles();
+
+  sensei::SVTKDataAdaptor *source = sensei::SVTKDataAdaptor::New();
+  source->SetDataObject("image", mb);
+  source->SetDataObject("triangles", ug);
+  source->SetDataTime(t);
+  source->SetDataTimeStep(n);
+  mb->Delete();
+  ug->Delete();
+
+  unsigned long nBytes = 0;
+  if (producer->Write(source, sensei::DataRequirements(), nBytes) ||
+    consumer->Read(nBytes))
+    {
+    SENSEI_ERROR("Failed to pass step " << n << " through shared memory")
+    source->Delete();
+    return -1;
+    }
+
+  source->Delete();
+
+  int ierr = 0;
+
+  unsigned int nMeshes = 0;
+  consumer->GetNumberOfMeshes(nMeshes);
+  if ((nMeshes != 2) || (consumer->GetDataTime() != t) ||
+    (consumer->GetDataTimeStep() != n))
+    {
+    SENSEI_ERROR("Wrong number of meshes " << nMeshes << " or time "
+      << consumer->GetDataTime() << " or step " << consumer->GetDataTimeStep())
+    ierr = -1;
+    }
+
+  svtkDataObject *dobj = nullptr;
+  consumer->GetMesh("image", false, dobj);
+  consumer->AddArray(dobj, "image", svtkDataObject::POINT, "pressure");
+  consumer->AddArray(dobj, "image", svtkDataObject::CELL, "velocity");
+
+  svtkMultiBlockDataSet *mbOut = dynamic_cast<svtkMultiBlockDataSet*>(dobj);
+  for (int b = 0; mbOut && (b < 2); ++b)
+    {
+    svtkImageData *imOut = dynamic_cast<svtkImageData*>(mbOut->GetBlock(b));
+    if (!imOut || (imOut->GetNumberOfCells() != n*n*n) ||
+      (imOut->GetSpacing()[0] != 0.5))
+      {
+      SENSEI_ERROR("Wrong image structure in block " << b)
+      ierr = -1;
+      continue;
+      }
+
+    svtkDataArray *p = imOut->GetPointData()->GetArray("pressure");
+    long nPts = imOut->GetNumberOfPoints();
+    for (long i = 0; p && (i < nPts); ++i)
+      {
+      if (p->GetTuple1(i) != t + b + i)
+        {
+        SENSEI_ERROR("Wrong pressure at " << i << " in block " << b)
+        ierr = -1;
+        break;
+        }
+      }
+
+    // the structure of arrays layout is kept
+    svtkSOADataArrayTemplate<float> *v = dynamic_cast<svtkSOADataArrayTemplate<float>*>(
+      imOut->GetCellData()->GetArray("velocity"));
+
+    long nCells = imOut->GetNumberOfCells();
+    for (long i = 0; v && (i < nCells); ++i)
+      {
+      if ((v->GetTypedComponent(i, 0) != 10*i) ||
+        (v->GetTypedComponent(i, 2) != 10*i + 2))
+        {
+        SENSEI_ERROR("Wrong velocity at " << i << " in block " << b)
+        ierr = -1;
+        break;
+        }
+      }
+
+    if (!p || !v)
+      {
+      SENSEI_ERROR("Missing arrays in block " << b)
+      ierr = -1;
+      }
+    }
+
+  if (!mbOut)
+    {
+    SENSEI_ERROR("The image mesh was not served")
+    ierr = -1;
+    }
+
+  if (dobj)
+    dobj->Delete();
+
+  dobj = nullptr;
+  consumer->GetMesh("triangles", false, dobj);
+  consumer->AddArray(dobj, "triangles", svtkDataObject::CELL, "id");
+
+  // the source adaptor serves datasets as multiblocks with a block per rank
+  svtkMultiBlockDataSet *mbUg = dynamic_cast<svtkMultiBlockDataSet*>(dobj);
+  svtkUnstructuredGrid *ugOut = mbUg ?
+    dynamic_cast<svtkUnstructuredGrid*>(mbUg->GetBlock(rank)) : nullptr;
+  svtkDataArray *ids = ugOut ? ugOut->GetCellData()->GetArray("id") : nullptr;
+  if (!ugOut || (ugOut->GetNumberOfCells() != 2) ||
+    (ugOut->GetNumberOfPoints() != 4) || (ugOut->GetCellType(1) != SVTK_TRIANGLE) ||
+    !ids || (ids->GetTuple1(1) != 8))
+    {
+    SENSEI_ERROR("Wrong unstructured mesh")
+    ierr = -1;
+    }
+  else
+    {
+    svtkIdType npts = 0;
+    const svtkIdType *pts = nullptr;
+    ugOut->GetCellPoints(1, npts, pts);
+    if ((npts != 3) || (pts[2] != 3))
+      {
+      SENSEI_ERROR("Wrong connectivity")
+      ierr = -1;
+      }
+    }
+
+  if (dobj)
+    dobj->Delete();
+
+  consumer->ReleaseData();
+
+  return ierr;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  std::string name = "/senseiTestShm" + std::to_string(getpid());
+
+  sensei::SharedMemoryDataAdaptor *producer = sensei::SharedMemoryDataAdaptor::New();
+  sensei::SharedMemoryDataAdaptor *consumer = sensei::SharedMemoryDataAdaptor::New();
+
+  int ierr = 0;
+  if (producer->SetSegmentName(name) || consumer->SetSegmentName(name))
+    ierr = -1;
+
+  // the segment grows with the data
+  for (int n = 4; !ierr && (n <= 32); n *= 2)
+    ierr = testStep(producer, consumer, n, 0.25*n);
+
+  consumer->Close();
+  producer->Close();
+
+  consumer->Delete();
+  producer->Delete();
+
+  if (rank == 0)
+    std::cerr << "testSharedMemoryDataAdaptor " << (ierr ? "failed" : "passed") << std::endl;
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
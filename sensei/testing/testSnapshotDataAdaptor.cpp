@@ -0,0 +1,244 @@
+#include "SnapshotDataAdaptor.h"
+#include "ProgrammableDataAdaptor.h"
+#include "DataRequirements.h"
+#include "MeshMetadata.h"
+#include "Error.h"
+
+#include <svtkDataObject.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include <svtkDoubleArray.h>
+#include <svtkSmartPointer.h>
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <mpi.h>
+
+// get the snapshot's mesh with the named point data array
+svtkDoubleArray *getArray(sensei::DataAdaptor *da, const std::string &name,
+  svtkSmartPointer<svtkDataObject> &mesh)
+{
+  svtkDataObject *dobj = nullptr;
+  if (da->GetMesh("image", false, dobj) || !dobj)
+    return nullptr;
+
+  mesh.TakeReference(dobj);
+
+  if (da->AddArray(dobj, "image", svtkDataObject::POINT, name))
+    return nullptr;
+
+  return svtkDoubleArray::SafeDownCast(
+    static_cast<svtkImageData*>(dobj)->GetPointData()->GetArray(name.c_str()));
+}
+
+// check that the array holds the expected values
+bool equal(svtkDoubleArray *da, const std::vector<double> &vals)
+{
+  if (!da || (da->GetNumberOfTuples() != svtkIdType(vals.size())))
+    return false;
+
+  for (size_t i = 0; i < vals.size(); ++i)
+    if (da->GetValue(i) != vals[i])
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  std::vector<double> data = {0, 1, 2, 3, 4, 5, 6, 7};
+  std::vector<double> other = {7, 6, 5, 4, 3, 2, 1, 0};
+
+  auto getNumberOfMeshes = [](unsigned int &n) -> int
+    {
+    n = 1;
+    return 0;
+    };
+
+  auto getMeshMetadata = [](unsigned int id, sensei::MeshMetadataPtr &metadata) -> int
+    {
+    if (id == 0)
+      {
+      metadata->MeshName = "image";
+      metadata->MeshType = SVTK_IMAGE_DATA;
+      metadata->BlockType = SVTK_IMAGE_DATA;
+      metadata->NumBlocks = 1;
+      metadata->NumBlocksLocal = {1};
+      metadata->NumArrays = 2;
+      metadata->ArrayName = {"data", "other"};
+      metadata->ArrayCentering = {svtkDataObject::POINT, svtkDataObject::POINT};
+      metadata->ArrayType = {SVTK_DOUBLE, SVTK_DOUBLE};
+      metadata->ArrayComponents = {1, 1};
+      return 0;
+      }
+    return -1;
+    };
+
+  auto getMesh = [&](const std::string &meshName,
+    bool, svtkDataObject *&mesh) -> int
+    {
+    if (meshName == "image")
+      {
+      svtkImageData *im = svtkImageData::New();
+      im->SetDimensions(data.size(), 1, 1);
+      mesh = im;
+      return 0;
+      }
+    return -1;
+    };
+
+  auto addArray = [&](svtkDataObject *mesh,
+    const std::string &meshName, int assoc, const std::string &name) -> int
+    {
+    if ((meshName == "image") && (assoc == svtkDataObject::POINT) &&
+      ((name == "data") || (name == "other")))
+      {
+      std::vector<double> &vals = name == "data" ? data : other;
+
+      // zero copy, as a simulation would
+      svtkDoubleArray *da = svtkDoubleArray::New();
+      da->SetName(name.c_str());
+      da->SetArray(vals.data(), vals.size(), 1);
+
+      static_cast<svtkImageData*>(mesh)->GetPointData()->AddArray(da);
+      da->Delete();
+      return 0;
+      }
+    return -1;
+    };
+
+  sensei::ProgrammableDataAdaptor *pda = sensei::ProgrammableDataAdaptor::New();
+  pda->SetGetNumberOfMeshesCallback(getNumberOfMeshes);
+  pda->SetGetMeshMetadataCallback(getMeshMetadata);
+  pda->SetGetMeshCallback(getMesh);
+  pda->SetAddArrayCallback(addArray);
+
+  sensei::SnapshotDataAdaptor *sda = sensei::SnapshotDataAdaptor::New();
+
+  int status = 0;
+
+  // only the required array is copied
+  sensei::DataRequirements reqs;
+  reqs.AddRequirement("image", false);
+  reqs.AddRequirement("image", svtkDataObject::POINT, "data");
+
+  pda->SetDataTimeStep(0);
+  if (sda->Snapshot(pda, reqs))
+    {
+    SENSEI_ERROR("Failed to take the first snapshot")
+    status = -1;
+    }
+
+  if (sda->GetDataTimeStep() != 0)
+    {
+    SENSEI_ERROR("The time step was not copied")
+    status = -1;
+    }
+
+  if (sda->GetNumberOfBytes() != data.size()*sizeof(double))
+    {
+    SENSEI_ERROR("The snapshot copied " << sda->GetNumberOfBytes()
+      << " bytes, expected " << data.size()*sizeof(double))
+    status = -1;
+    }
+
+  sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
+  if (sda->GetMeshMetadata(0, md) || (md->NumArrays != 1) ||
+    (md->ArrayName[0] != "data"))
+    {
+    SENSEI_ERROR("The metadata should describe only the copied array")
+    status = -1;
+    }
+
+  svtkSmartPointer<svtkDataObject> mesh;
+
+  // the snapshot is a deep copy, changes made by the simulation after the
+  // snapshot is taken are not seen by the analysis
+  std::vector<double> snapData = data;
+  for (double &v : data)
+    v += 10.0;
+
+  svtkDoubleArray *da = getArray(sda, "data", mesh);
+  if (!da || (da->GetPointer(0) == data.data()) || !equal(da, snapData))
+    {
+    SENSEI_ERROR("The snapshot is not independent of the simulation's data")
+    status = -1;
+    }
+
+  svtkDoubleArray *buffer = da;
+  mesh = nullptr;
+  sda->ReleaseData();
+
+  // the buffer is reused by the next snapshot once it has been released
+  pda->SetDataTimeStep(1);
+  if (sda->Snapshot(pda, reqs))
+    {
+    SENSEI_ERROR("Failed to take the second snapshot")
+    status = -1;
+    }
+
+  da = getArray(sda, "data", mesh);
+  if (da != buffer)
+    {
+    SENSEI_ERROR("The released buffer was not reused")
+    status = -1;
+    }
+
+  if (!equal(da, data))
+    {
+    SENSEI_ERROR("The reused buffer holds the wrong values")
+    status = -1;
+    }
+
+  // a buffer an analysis still holds is not reused, and keeps its values
+  svtkSmartPointer<svtkDoubleArray> held = da;
+  std::vector<double> heldData = data;
+  for (double &v : data)
+    v += 10.0;
+
+  mesh = nullptr;
+  sda->ReleaseData();
+
+  pda->SetDataTimeStep(2);
+  if (sda->Snapshot(pda, sensei::DataRequirements()))
+    {
+    SENSEI_ERROR("Failed to take the third snapshot")
+    status = -1;
+    }
+
+  da = getArray(sda, "data", mesh);
+  if ((da == held.GetPointer()) || !equal(da, data))
+    {
+    SENSEI_ERROR("A buffer held by an analysis was reused")
+    status = -1;
+    }
+
+  if (!equal(held, heldData))
+    {
+    SENSEI_ERROR("A buffer held by an analysis was modified")
+    status = -1;
+    }
+
+  // without requirements everything is copied
+  if (!equal(getArray(sda, "other", mesh), other))
+    {
+    SENSEI_ERROR("The snapshot without requirements is missing an array")
+    status = -1;
+    }
+
+  mesh = nullptr;
+  held = nullptr;
+
+  sda->ReleaseData();
+
+  sda->Delete();
+  pda->Delete();
+
+  MPI_Finalize();
+
+  return status;
+}
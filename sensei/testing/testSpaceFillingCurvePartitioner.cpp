@@ -0,0 +1,172 @@
+#include <random>
+#include <iostream>
+#include <algorithm>
+#include <mpi.h>
+#include <pugixml.hpp>
+#include "Error.h"
+#include "MeshMetadata.h"
+#include "BlockPartitioner.h"
+#include "SpaceFillingCurvePartitioner.h"
+#include "ConfigurablePartitioner.h"
+
+// the blocks are on an nx by ny by nz grid
+const int gNx = 16;
+const int gNy = 16;
+const int gNz = 4;
+
+// make metadata for a mesh whose blocks are numbered in random order, as
+// happens with AMR and load balanced simulations
+sensei::MeshMetadataPtr makeMetadata(unsigned int seed)
+{
+  int nBlocks = gNx*gNy*gNz;
+
+  std::vector<int> ids(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    ids[i] = i;
+
+  std::mt19937 gen(1234);
+  std::shuffle(ids.begin(), ids.end(), gen);
+
+  // block sizes vary a little from step to step
+  std::mt19937 sgen(seed);
+  std::uniform_int_distribution<int> size(900, 1100);
+
+  sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
+  md->MeshName = "mesh";
+  md->NumBlocks = nBlocks;
+  md->BlockBounds.resize(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    int id = ids[i];
+    int ii = id % gNx;
+    int jj = (id / gNx) % gNy;
+    int kk = id / (gNx*gNy);
+
+    md->BlockBounds[i] = {double(ii), ii + 1.0, double(jj), jj + 1.0,
+      double(kk), kk + 1.0};
+
+    md->BlockNumCells.push_back(size(sgen));
+    md->BlockNumPoints.push_back(md->BlockNumCells.back());
+    md->BlockOwner.push_back(0);
+    md->BlockIds.push_back(i);
+    }
+
+  return md;
+}
+
+// count the face adjacent pairs of blocks owned by different ranks
+int countCuts(const sensei::MeshMetadataPtr &md)
+{
+  int nBlocks = md->NumBlocks;
+  std::vector<int> owner(nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    const std::array<double,6> &bds = md->BlockBounds[i];
+    int id = int(bds[0]) + gNx*(int(bds[2]) + gNy*int(bds[4]));
+    owner[id] = md->BlockOwner[i];
+    }
+
+  int nCuts = 0;
+  for (int k = 0; k < gNz; ++k)
+    for (int j = 0; j < gNy; ++j)
+      for (int i = 0; i < gNx; ++i)
+        {
+        int id = i + gNx*(j + gNy*k);
+        nCuts += (i + 1 < gNx) && (owner[id] != owner[id + 1]);
+        nCuts += (j + 1 < gNy) && (owner[id] != owner[id + gNx]);
+        nCuts += (k + 1 < gNz) && (owner[id] != owner[id + gNx*gNy]);
+        }
+
+  return nCuts;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int ierr = 0;
+  int nBlocks = gNx*gNy*gNz;
+
+  sensei::MeshMetadataPtr md0 = makeMetadata(1);
+
+  sensei::MeshMetadataPtr mdBlock;
+  sensei::BlockPartitioner::New()->GetPartition(MPI_COMM_WORLD, md0, mdBlock);
+  int blockCuts = countCuts(mdBlock);
+
+  const char *curves[] = {"hilbert", "morton"};
+  for (int i = 0; i < 2; ++i)
+    {
+    pugi::xml_document doc;
+    pugi::xml_node node = doc.append_child("partitioner");
+    node.append_attribute("type") = "sfc";
+    node.append_attribute("curve") = curves[i];
+    node.append_attribute("tolerance") = 0.05;
+
+    sensei::ConfigurablePartitionerPtr cp = sensei::ConfigurablePartitioner::New();
+    sensei::MeshMetadataPtr md1;
+    if (cp->Initialize(node) || cp->GetPartition(MPI_COMM_WORLD, md0, md1))
+      {
+      SENSEI_ERROR("Failed to partition with the " << curves[i] << " curve")
+      ierr = -1;
+      continue;
+      }
+
+    // spatially adjacent blocks share a rank far more often
+    int sfcCuts = countCuts(md1);
+    if ((nRanks > 1) && (2*sfcCuts > blockCuts))
+      {
+      SENSEI_ERROR("The " << curves[i] << " curve cut " << sfcCuts
+        << " faces, the block partitioner " << blockCuts)
+      ierr = -1;
+      }
+
+    // the next step's sizes differ slightly, the partition is kept
+    sensei::MeshMetadataPtr md2;
+    cp->GetPartition(MPI_COMM_WORLD, makeMetadata(2), md2);
+    if (md2->BlockOwner != md1->BlockOwner)
+      {
+      SENSEI_ERROR("The partition changed within the tolerance")
+      ierr = -1;
+      }
+
+    // refinement in one corner repartitions, but most blocks stay put
+    sensei::MeshMetadataPtr md3 = makeMetadata(3);
+    for (int j = 0; j < nBlocks; ++j)
+      {
+      const std::array<double,6> &bds = md3->BlockBounds[j];
+      if ((bds[0] < gNx/4) && (bds[2] < gNy/4))
+        md3->BlockNumCells[j] *= 4;
+      }
+
+    sensei::MeshMetadataPtr md4;
+    cp->GetPartition(MPI_COMM_WORLD, md3, md4);
+
+    int nMoved = 0;
+    for (int j = 0; j < nBlocks; ++j)
+      nMoved += md4->BlockOwner[j] != md1->BlockOwner[j];
+
+    if (nMoved > nBlocks/2)
+      {
+      SENSEI_ERROR(<< nMoved << " of " << nBlocks << " blocks moved")
+      ierr = -1;
+      }
+
+    if (rank == 0)
+      std::cerr << curves[i] << " cuts " << sfcCuts << " block partitioner cuts "
+        << blockCuts << " blocks moved " << nMoved << std::endl;
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if (rank == 0)
+    std::cerr << "testSpaceFillingCurvePartitioner " << (ierr ? "failed" : "passed") << std::endl;
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
@@ -0,0 +1,94 @@
+import sys, os
+import xml.etree.ElementTree as ET
+import vtk
+
+# reads back the node aggregated output written by testVTKPosthocIOAggregate.xml
+# through the .pvd and .visit files, and compares it to the output written
+# without aggregation
+
+def error_message(msg):
+  sys.stderr.write('ERROR: %s\n'%(msg))
+
+def status_message(msg):
+  sys.stderr.write('STATUS: %s\n'%(msg))
+
+def read_pvd(fileName):
+  # returns the files of each step, in step order
+  steps = {}
+  for ds in ET.parse(fileName).getroot().iter('DataSet'):
+    steps.setdefault(float(ds.get('timestep')), []).append(ds.get('file'))
+  return [steps[t] for t in sorted(steps)]
+
+def read_visit(fileName):
+  # returns the files of each step, in step order
+  nBlocks = 0
+  files = []
+  with open(fileName) as f:
+    for line in f:
+      line = line.strip()
+      if line.startswith('!NBLOCKS'):
+        nBlocks = int(line.split()[1])
+      elif line and not line.startswith('!'):
+        files.append(line)
+  return [files[i:i + nBlocks] for i in range(0, len(files), nBlocks)]
+
+def read_image(dirName, fileName):
+  # returns the number of pieces in the file and its cell values by cell index
+  r = vtk.vtkXMLImageDataReader()
+  r.SetFileName(os.path.join(dirName, fileName))
+  r.Update()
+  im = r.GetOutput()
+  data = im.GetCellData().GetArray('data')
+  ext = im.GetExtent()
+  vals = {}
+  for k in range(ext[4], max(ext[5], ext[4] + 1)):
+    for j in range(ext[2], max(ext[3], ext[2] + 1)):
+      for i in range(ext[0], max(ext[1], ext[0] + 1)):
+        vals[(i,j,k)] = data.GetTuple1(im.ComputeCellId([i,j,k]))
+  return r.GetNumberOfPieces(), vals
+
+def check(steps, dirName, refSteps, refDir, nBlocks, kind):
+  retval = 0
+  if len(steps) != len(refSteps):
+    error_message('%s has %d steps, expected %d'%(kind, len(steps), len(refSteps)))
+    return -1
+  for s in range(len(steps)):
+    # the blocks written without aggregation
+    ref = {}
+    for fileName in refSteps[s]:
+      ref.update(read_image(refDir, fileName)[1])
+    # the pieces of the node files
+    nPieces = 0
+    vals = {}
+    for fileName in steps[s]:
+      n, v = read_image(dirName, fileName)
+      nPieces += n
+      vals.update(v)
+    if nPieces != nBlocks:
+      error_message('%s step %d has %d blocks, expected %d'%(kind, s, nPieces, nBlocks))
+      retval = -1
+    if vals != ref:
+      nDiff = sum(1 for c in ref if vals.get(c) != ref[c])
+      error_message('%s step %d has %d cells, %d differ from the %d written ' \
+        'without aggregation'%(kind, s, len(vals), nDiff, len(ref)))
+      retval = -1
+    status_message('%s step %d has %d blocks in %d files'%(kind, s, nPieces, len(steps[s])))
+  return retval
+
+if __name__ == '__main__':
+  if len(sys.argv) != 5:
+    error_message('usage: testVTKPosthocIOAggregate.py [pvd dir] [visit dir] [ref dir] [num blocks]')
+    sys.exit(-1)
+
+  pvDir, visitDir, refDir = sys.argv[1:4]
+  nBlocks = int(sys.argv[4])
+
+  refSteps = read_pvd(os.path.join(refDir, 'mesh.pvd'))
+
+  retval = check(read_pvd(os.path.join(pvDir, 'mesh.pvd')), pvDir,
+    refSteps, refDir, nBlocks, 'pvd')
+
+  retval |= check(read_visit(os.path.join(visitDir, 'mesh.visit')), visitDir,
+    refSteps, refDir, nBlocks, 'visit')
+
+  sys.exit(retval)
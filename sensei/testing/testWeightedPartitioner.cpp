@@ -0,0 +1,144 @@
+#include <random>
+#include <iostream>
+#include <algorithm>
+#include <mpi.h>
+#include <pugixml.hpp>
+#include <svtkDataObject.h>
+#include <svtkType.h>
+#include "Error.h"
+#include "MeshMetadata.h"
+#include "BlockPartitioner.h"
+#include "WeightedPartitioner.h"
+#include "ConfigurablePartitioner.h"
+
+// make metadata for a mesh whose block sizes vary by orders of magnitude,
+// as is typical of AMR and unstructured meshes
+sensei::MeshMetadataPtr makeMetadata(int nBlocks)
+{
+  sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
+  md->MeshName = "mesh";
+  md->NumBlocks = nBlocks;
+  md->NumArrays = 2;
+  md->ArrayName = {"p", "v"};
+  md->ArrayCentering = {svtkDataObject::POINT, svtkDataObject::CELL};
+  md->ArrayComponents = {1, 3};
+  md->ArrayType = {SVTK_DOUBLE, SVTK_FLOAT};
+
+  std::mt19937 gen(4321);
+  std::uniform_int_distribution<int> level(0, 3);
+
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    long nCells = 1000l << (3*level(gen));
+    md->BlockNumCells.push_back(nCells);
+    md->BlockNumPoints.push_back(nCells + nCells/4);
+    md->BlockOwner.push_back(0);
+    md->BlockIds.push_back(i);
+    }
+
+  return md;
+}
+
+// compute the maximum and mean per rank load of a partition
+void getLoad(const sensei::MeshMetadataPtr &md,
+  const std::vector<long long> &costs, int nRanks,
+  long long &maxLoad, double &meanLoad)
+{
+  std::vector<long long> load(nRanks, 0);
+  long long total = 0;
+  for (int i = 0; i < md->NumBlocks; ++i)
+    {
+    load[md->BlockOwner[i]] += costs[i];
+    total += costs[i];
+    }
+  maxLoad = *std::max_element(load.begin(), load.end());
+  meanLoad = double(total)/nRanks;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int ierr = 0;
+  int nBlocks = 16*nRanks + 3;
+  sensei::MeshMetadataPtr mdIn = makeMetadata(nBlocks);
+
+  const char *costModels[] = {"cells", "points", "bytes"};
+  const char *methods[] = {"lpt", "contiguous"};
+
+  for (int i = 0; i < 3; ++i)
+    {
+    // the reference, assigning equal numbers of blocks
+    sensei::WeightedPartitionerPtr wp = sensei::WeightedPartitioner::New();
+    wp->SetCostModel(costModels[i]);
+
+    std::vector<long long> costs;
+    wp->GetBlockCosts(mdIn, costs);
+
+    sensei::MeshMetadataPtr mdBlock;
+    sensei::BlockPartitioner::New()->GetPartition(MPI_COMM_WORLD, mdIn, mdBlock);
+
+    long long blockMax = 0;
+    double meanLoad = 0.0;
+    getLoad(mdBlock, costs, nRanks, blockMax, meanLoad);
+
+    for (int j = 0; j < 2; ++j)
+      {
+      // configure from XML as an end point would
+      pugi::xml_document doc;
+      pugi::xml_node node = doc.append_child("partitioner");
+      node.append_attribute("type") = "weighted";
+      node.append_attribute("cost") = costModels[i];
+      node.append_attribute("method") = methods[j];
+
+      sensei::ConfigurablePartitionerPtr cp = sensei::ConfigurablePartitioner::New();
+      sensei::MeshMetadataPtr mdOut;
+      if (cp->Initialize(node) || cp->GetPartition(MPI_COMM_WORLD, mdIn, mdOut))
+        {
+        SENSEI_ERROR("Failed to partition with " << methods[j])
+        ierr = -1;
+        continue;
+        }
+
+      long long maxLoad = 0;
+      getLoad(mdOut, costs, nRanks, maxLoad, meanLoad);
+
+      // the greedy assignment is never more than one block above the mean,
+      // and the contiguous split is optimal among contiguous splits, which
+      // the block partitioner's is one of
+      long long largest = *std::max_element(costs.begin(), costs.end());
+      bool lptOk = (j != 0) || (maxLoad <= meanLoad + largest);
+
+      bool orderOk = true;
+      for (int k = 1; (j == 1) && (k < nBlocks); ++k)
+        orderOk &= mdOut->BlockOwner[k] >= mdOut->BlockOwner[k-1];
+
+      if ((maxLoad > blockMax) || !lptOk || !orderOk)
+        {
+        SENSEI_ERROR(<< methods[j] << " with cost model " << costModels[i]
+          << " produced a poor partition maxLoad=" << maxLoad
+          << " blockMax=" << blockMax << " meanLoad=" << meanLoad)
+        ierr = -1;
+        }
+
+      if (rank == 0)
+        std::cerr << costModels[i] << " " << methods[j] << " imbalance "
+          << maxLoad/meanLoad << " block partitioner imbalance "
+          << blockMax/meanLoad << std::endl;
+      }
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, &ierr, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if (rank == 0)
+    std::cerr << "testWeightedPartitioner " << (ierr ? "failed" : "passed") << std::endl;
+
+  MPI_Finalize();
+
+  return ierr ? -1 : 0;
+}
@@ -233,12 +233,25 @@ class svtk_array_handle:
 
     __array_interface__ = property(get_array_interface, None, None, 'Numpy array interface')
 
-def svtk_to_numpy(svtk_array):
+class svtk_array_view:
+    """ A helper class to present a SVTK AOS or SOA data array, or one of its
+    components, to Numpy without a copy. References to the array and to an
+    optional owner, such as the mesh holding the array, are kept for the
+    lifetime of the view """
+    def __init__(self, arr, component=-1, owner=None):
+        self.__array_interface__ = arr.GetArrayInterface(component)
+        self.ref = arr
+        self.owner = owner
+
+def svtk_to_numpy(svtk_array, component=-1, owner=None):
     """Converts a SVTK data array to a numpy array.
 
     Given a subclass of svtkDataArray, this function returns an
     appropriate numpy array containing the same data -- it actually
-    points to the same data.
+    points to the same data. AOS and SOA arrays, and any one of their
+    components, are viewed without a copy. The whole of a SOA array is
+    viewed without a copy when its components are stored back to back in
+    one block of memory, otherwise it is copied.
 
     WARNING: This does not work for bit arrays.
 
@@ -247,6 +260,20 @@ def svtk_to_numpy(svtk_array):
     svtk_array
       The SVTK data array to be converted.
 
+    component
+      When not negative, a one dimensional view of this component is
+      returned. The default returns a view of shape (tuples, components).
+
+    owner
+      An object, such as the mesh holding the array, kept alive for the
+      lifetime of the returned view.
+
     """
+    try:
+        return numpy.asarray(svtk_array_view(svtk_array, component, owner))
+    except TypeError:
+        if component >= 0:
+            raise
+
     h = svtk_array_handle(svtk_array)
     return numpy.array(h, copy=False)
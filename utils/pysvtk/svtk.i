@@ -9,7 +9,12 @@
 #include "kwiml/abi.h"
 #include "svtkSetGet.h"
 
+#include "svtkAOSDataArrayTemplate.h"
+#include "svtkSOADataArrayTemplate.h"
+
 #include <sstream>
+#include <string>
+#include <type_traits>
 
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -108,9 +113,14 @@
   }
   else
   {
-    std::cerr << "NOTE: Automatic conversions for "
-      << $1->GetClassName() << " are not implemented."
-      << std::endl;
+    /* AOS and SOA arrays are viewed through svtkDataArray's array interface */
+    if (($1->GetArrayType() != svtkAbstractArray::AoSDataArrayTemplate) &&
+      ($1->GetArrayType() != svtkAbstractArray::SoADataArrayTemplate))
+    {
+      std::cerr << "NOTE: Automatic conversions for "
+        << $1->GetClassName() << " are not implemented."
+        << std::endl;
+    }
     $result = SWIG_NewPointerObj(
       (void*)static_cast<svtkDataArray*>($1),
       SWIGTYPE_p_svtkDataArray, 0);
@@ -296,7 +306,128 @@ SVTK_WRAP_CLASS(svtkObject)
 /****************************************************************************
  * Data Arrays
  ***************************************************************************/
+%{
+// the numpy typestr of a C++ type
+template <typename T>
+std::string svtkNumpyTypestr()
+{
+  unsigned int one = 1;
+  char order = sizeof(T) == 1 ? '|' : (*(char*)&one ? '<' : '>');
+  char kind = std::is_floating_point<T>::value ? 'f' :
+    (std::is_signed<T>::value ? 'i' : 'u');
+
+  std::ostringstream oss;
+  oss << order << kind << sizeof(T);
+  return oss.str();
+}
+
+// package a pointer, shape and strides as a numpy array interface. when
+// nComps is 0 the array is one dimensional
+PyObject *svtkNewArrayInterface(void *data, const std::string &typestr,
+  Py_ssize_t nTups, Py_ssize_t tupStride, Py_ssize_t nComps,
+  Py_ssize_t compStride)
+{
+  // numpy needs an address even when there is no data
+  static double empty = 0.0;
+  if (!data || (nTups == 0))
+    data = &empty;
+
+  PyObject *shape = nComps ? Py_BuildValue("(nn)", nTups, nComps) :
+    Py_BuildValue("(n)", nTups);
+
+  PyObject *strides = nComps ? Py_BuildValue("(nn)", tupStride, compStride) :
+    Py_BuildValue("(n)", tupStride);
+
+  return Py_BuildValue("{s:N,s:s,s:(NO),s:N,s:i}", "shape", shape,
+    "typestr", typestr.c_str(), "data", PyLong_FromVoidPtr(data), Py_False,
+    "strides", strides, "version", 3);
+}
+
+// get the numpy array interface of an AOS or SOA array, or of one of its
+// components when comp is not negative. the data is not copied
+PyObject *svtkGetArrayInterface(svtkDataArray *da, int comp)
+{
+  Py_ssize_t nTups = da->GetNumberOfTuples();
+  Py_ssize_t nComps = da->GetNumberOfComponents();
+
+  if (comp >= nComps)
+  {
+    PyErr_Format(PyExc_IndexError, "Component %d of %s \"%s\" is out of "
+      "bounds, it has %d", comp, da->GetClassName(),
+      (da->GetName() ? da->GetName() : ""), int(nComps));
+    return nullptr;
+  }
+
+  switch (da->GetDataType())
+  {
+    svtkTemplateMacro(
+      std::string typestr = svtkNumpyTypestr<SVTK_TT>();
+      Py_ssize_t size = sizeof(SVTK_TT);
+
+      if (svtkAOSDataArrayTemplate<SVTK_TT> *aos =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da))
+      {
+        // a component is strided by the tuple size
+        SVTK_TT *data = aos->GetPointer(0);
+        if (comp < 0)
+          return svtkNewArrayInterface(data, typestr, nTups, nComps*size,
+            nComps, size);
+
+        return svtkNewArrayInterface(data + comp, typestr, nTups,
+          nComps*size, 0, 0);
+      }
+      else if (svtkSOADataArrayTemplate<SVTK_TT> *soa =
+        dynamic_cast<svtkSOADataArrayTemplate<SVTK_TT>*>(da))
+      {
+        // each component is contiguous
+        if (comp >= 0)
+          return svtkNewArrayInterface(soa->GetComponentArrayPointer(comp),
+            typestr, nTups, size, 0, 0);
+
+        // the components can be viewed together only when they are stored
+        // back to back in one block, each directly following the previous
+        char *c0 = (char*)soa->GetComponentArrayPointer(0);
+        Py_ssize_t delta = nTups*size;
+
+        bool contiguous = true;
+        for (Py_ssize_t j = 1; contiguous && (j < nComps); ++j)
+          contiguous = ((char*)soa->GetComponentArrayPointer(j) == c0 + j*delta);
+
+        if (contiguous)
+          return svtkNewArrayInterface(c0, typestr, nTups, size, nComps, delta);
+
+        PyErr_Format(PyExc_TypeError, "The components of %s \"%s\" are not "
+          "contiguous in memory. View them one at a time by passing the "
+          "component to GetArrayInterface", da->GetClassName(),
+          (da->GetName() ? da->GetName() : ""));
+        return nullptr;
+      }
+    );
+  }
+
+  PyErr_Format(PyExc_TypeError, "Zero-copy views of %s are not supported",
+    da->GetClassName());
+  return nullptr;
+}
+%}
+
 SVTK_WRAP_DATA_ARRAY(svtkAbstractArray)
+
+/* numpy views of AOS and SOA arrays, and of their components, share the
+   array's memory. the array must outlive the view */
+%extend svtkDataArray
+{
+    PyObject *GetArrayInterface(int comp = -1)
+    {
+        return svtkGetArrayInterface(self, comp);
+    }
+
+    %pythoncode
+    %{
+    __array_interface__ = property(GetArrayInterface, None, None,
+        'Numpy array interface, a zero-copy view of the array')
+    %}
+};
 SVTK_WRAP_DATA_ARRAY(svtkDataArray)
 
 %ignore svtkGenericDataArray::DoComputeScalarRange;